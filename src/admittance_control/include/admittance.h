@@ -0,0 +1,221 @@
+#ifndef ADMITTANCE_H
+#define ADMITTANCE_H
+
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+#include "wrench_compensation.h"
+
+typedef Eigen::Matrix<double, 6, 1> Vector6d;
+typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+
+/**
+ * @brief 角度与位姿转换的模板实现, Scalar 可为 AutoDiffScalar (dynamic_derivative.h), 给出位姿转换的解析导数
+ *        double 版本为下方的非模板函数
+ */
+template <class Scalar>
+Scalar AngularPI(const Scalar &angular)
+{
+    using std::abs;
+    const double pi = 3.1415926;
+
+    if (abs(angular) > pi)
+        return angular - angular / abs(angular) * 2 * pi;
+
+    return angular;
+}
+
+template <class Scalar>
+Eigen::Matrix<Scalar, 4, 4> Pose2HomogeneousTransform(const Eigen::Matrix<Scalar, 6, 1> &pose)
+{
+    typedef Eigen::Matrix<Scalar, 3, 1> Vector3;
+    Eigen::Matrix<Scalar, 4, 4> homogeneous_transform = Eigen::Matrix<Scalar, 4, 4>::Identity();
+
+    homogeneous_transform.template block<3, 3>(0, 0) = (Eigen::AngleAxis<Scalar>(pose(5), Vector3::UnitZ()) *
+                                                         Eigen::AngleAxis<Scalar>(pose(4), Vector3::UnitY()) *
+                                                         Eigen::AngleAxis<Scalar>(pose(3), Vector3::UnitX()))
+                                                            .toRotationMatrix();
+    homogeneous_transform.template block<3, 1>(0, 3) = pose.template head<3>();
+
+    return homogeneous_transform;
+}
+
+template <class Scalar>
+Eigen::Matrix<Scalar, 6, 1> HomogeneousTransform2Pose(const Eigen::Matrix<Scalar, 4, 4> &homogeneous_transform)
+{
+    using std::atan2;
+    using std::cos;
+    using std::sin;
+
+    Eigen::Matrix<Scalar, 6, 1> pose;
+    Eigen::Matrix<Scalar, 3, 1> n = homogeneous_transform.template block<3, 1>(0, 0);
+    Eigen::Matrix<Scalar, 3, 1> o = homogeneous_transform.template block<3, 1>(0, 1);
+    Eigen::Matrix<Scalar, 3, 1> a = homogeneous_transform.template block<3, 1>(0, 2);
+
+    pose.template head<3>() = homogeneous_transform.template block<3, 1>(0, 3);
+
+    pose(5) = atan2(n(1), n(0));
+    pose(4) = atan2(-n(2), n(0) * cos(pose(5)) + n(1) * sin(pose(5)));
+    pose(3) = atan2(a(0) * sin(pose(5)) - a(1) * cos(pose(5)), -o(0) * sin(pose(5)) + o(1) * cos(pose(5)));
+
+    pose(3) = AngularPI(pose(3));
+    pose(4) = AngularPI(pose(4));
+    pose(5) = AngularPI(pose(5));
+
+    return pose;
+}
+
+double AngularPI(double angular);
+
+/**
+ * @brief 按阻尼比由 M, K 求 D = 2 * zeta * M^1/2 * (M^-1/2 * K * M^-1/2)^1/2 * M^1/2
+ *        M, K 对称正定, 各模态阻尼比均为 zeta; 对角 M, K 时即 2 * zeta * sqrt(m * k)
+ */
+Matrix6d DampingFromMassStiffness(const Matrix6d &M, const Matrix6d &K, double damping_ratio);
+
+/**
+ * @brief 按阻尼比替换显式给出的 D; damping_ratio <= 0 时直接返回 D
+ *        K 对角元为零的轴 (无刚度, 如自由拖动) 没有固有频率, 该轴的行与列保持 D, 避免阻尼被置零
+ */
+Matrix6d DampingFromRatio(const Matrix6d &M, const Matrix6d &K, const Matrix6d &D, double damping_ratio);
+
+/**
+ * @brief M x'' + D x' + K x = u 的零阶保持精确离散化 (矩阵指数), u 在一个周期内不变
+ *        状态 z = [x; x'], z(k+1) = Phi * z(k) + Gamma * u(k); M 可逆时任意 dt 均与连续系统一致
+ */
+void DiscretizeAdmittance(const Matrix6d &M, const Matrix6d &D, const Matrix6d &K, double dt,
+                          Eigen::Matrix<double, 12, 12> &Phi, Eigen::Matrix<double, 12, 6> &Gamma);
+
+/**
+ * @brief 一版导纳参数及其导出量, 在控制线程之外由 PrepareAdmittanceParameters 算好,
+ *        控制周期边界经 Admittance::SetParameters 整体替换, 控制线程中不再求逆或离散化
+ */
+struct AdmittanceParameters
+{
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    Matrix6d M;
+    Matrix6d D;
+    Matrix6d K;
+    Matrix6d M_inverse;
+    double dt; // Phi, Gamma 对应的控制周期 (s), 不大于 0 时未离散化
+    Eigen::Matrix<double, 12, 12> Phi;
+    Eigen::Matrix<double, 12, 6> Gamma;
+};
+
+/* dt 不大于 0 时只求 M^-1, 离散矩阵留给 Admittance 在首次步进时计算 */
+void PrepareAdmittanceParameters(const Matrix6d &M, const Matrix6d &D, const Matrix6d &K, double dt,
+                                 AdmittanceParameters &parameters);
+
+/* 位姿 (x, y, z, rx, ry, rz) 与齐次变换互转, R = Rz * Ry * Rx */
+Eigen::Matrix4d Pose2HomogeneousTransform(const Vector6d &pose);
+Vector6d HomogeneousTransform2Pose(const Eigen::Matrix4d &homogeneous_transform);
+
+/**
+ * @brief 末端导纳控制的单步计算: 传感器零漂/重力补偿, 导纳方程, 期望位姿
+ *        不含任何 ROS 通信, admittance_control 与 latency_benchmark 共用
+ */
+class Admittance
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    /**
+     * EXACT: 相对 Reset 时的参考位姿积分 M x'' + D x' + K x = delta_wrench, 离散矩阵在 MDK 或 dt 变化时重算,
+     *        每周期两次定长矩阵-向量乘, 不使用测量位姿, 任意控制频率下稳定
+     * EULER: 原有方式, 以相邻两次测量位姿之差为 x, 差分得速度, x + v * dt + a * dt^2 为下一步
+     */
+    enum Integration
+    {
+        EXACT,
+        EULER
+    };
+
+    Admittance();
+
+    /* MDK 与上次相同时不重算离散矩阵 */
+    void SetMDK(const Matrix6d &M, const Matrix6d &D, const Matrix6d &K);
+    /* 整体替换为预先算好的一版参数, dt 与步进周期一致时直接使用其中的离散矩阵 */
+    void SetParameters(const AdmittanceParameters &parameters);
+    void SetIntegration(Integration integration) { integration_ = integration; }
+    /* 负载重力/质心/零漂见 netft_utils 的 wrench_compensation.h, 与 netft_utils 共用同一份标定文件 */
+    void SetSensor(const WrenchCompensation &compensation, const Matrix6d &jacobian_sensor2end);
+    /* G_basis 为基坐标系重力, 仅 z 分量有效 */
+    void SetSensor(const Vector6d &zero_drift_compensation, const Eigen::Vector3d &centroid_sensor,
+                   const Eigen::Vector3d &G_basis, const Matrix6d &jacobian_sensor2end);
+    /* 只替换零漂, 如 bias_estimation 的在线估计 */
+    void SetZeroDrift(const Vector6d &zero_drift);
+    void SetExpectedWrench(const Vector6d &expected_wrench) { expected_wrench_ = expected_wrench; }
+    /**
+     * @brief 力/位混合控制, 均在末端坐标系下
+     * @param selection    1 的轴为力控: PI 力环跟踪期望外力, 输出该轴速度; 0 的轴仍为导纳; 全 0 即纯导纳
+     * @param kp, ki       力环增益, 外力误差 (N, Nm) 到速度 (m/s, rad/s)
+     * @param max_velocity 力环输出速度限幅, 积分项同样限幅, 输出饱和时停止向饱和方向积分 (抗饱和)
+     *        重新选中的轴积分清零
+     */
+    void SetHybrid(const Vector6d &selection, const Vector6d &kp, const Vector6d &ki, const Vector6d &max_velocity);
+
+    /* 以 pose 作为上一周期位姿与 EXACT 的参考位姿, 导纳状态清零 */
+    void Reset(const Vector6d &pose);
+
+    /**
+     * @brief 一个控制周期
+     * @param current_pose  当前末端位姿 (m, rad)
+     * @param FTsensor_data 传感器读数 (滤波后, 未补偿)
+     * @param dt            控制周期 (s)
+     * @return 期望末端位姿 (m, rad)
+     */
+    Vector6d Step(const Vector6d &current_pose, const Vector6d &FTsensor_data, double dt);
+    /* 同 Step, 但传入已补偿的传感器外力, 如按每帧采样时刻的位姿逐帧补偿后的结果 */
+    Vector6d StepWithExternalWrench(const Vector6d &current_pose, const Vector6d &external_wrench_sensor, double dt);
+    /**
+     * @brief 期望位姿被约束投影后回写 EXACT 的状态: 偏移取投影后的位姿, 被限制的轴上指向约束外的速度清零,
+     *        避免状态越过约束继续积分, 外力撤去时再从约束外弹回; EULER 以测量位姿为起点, 不需要回写
+     */
+    void Limit(const Vector6d &limited_pose);
+
+    const Vector6d &ExternalWrench() const { return external_wrench_sensor_; }
+    const Vector6d &DeltaWrench() const { return delta_wrench_; }
+    const Vector6d &DeltaPose() const { return delta_pose_; }
+    const Vector6d &DeltaPoseVelocity() const { return delta_pose_velocity_; }
+    const Vector6d &DeltaPoseAcceleration() const { return delta_pose_acceleration_; }
+    const Vector6d &ForceIntegral() const { return force_integral_; }
+
+private:
+    /* 力控轴 i 的 PI 力环, 返回速度 */
+    double ForceLoopVelocity(int i, double dt);
+
+    Matrix6d M_;
+    Matrix6d D_;
+    Matrix6d K_;
+    Matrix6d M_inverse_;
+
+    Integration integration_;
+    bool discrete_valid_;
+    double discrete_dt_;
+    Eigen::Matrix<double, 12, 12> Phi_;
+    Eigen::Matrix<double, 12, 6> Gamma_;
+    Eigen::Matrix<double, 12, 1> state_; // EXACT: [x; x'], 相对参考位姿
+    Eigen::Matrix4d reference_transform_;
+
+    WrenchCompensation compensation_;
+    Matrix6d jacobian_sensor2end_;
+    Vector6d expected_wrench_;
+
+    /* 力/位混合控制 */
+    Vector6d selection_;
+    Vector6d force_kp_;
+    Vector6d force_ki_;
+    Vector6d force_max_velocity_;
+    Vector6d force_integral_;
+
+    Eigen::Matrix4d pre_homogeneous_transform_;
+    Vector6d pre_delta_pose_;
+
+    Vector6d external_wrench_sensor_;
+    Vector6d delta_wrench_;
+    Vector6d delta_pose_;
+    Vector6d delta_pose_velocity_;
+    Vector6d delta_pose_acceleration_;
+};
+
+#endif
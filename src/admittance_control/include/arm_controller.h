@@ -0,0 +1,159 @@
+#ifndef ARM_CONTROLLER_H
+#define ARM_CONTROLLER_H
+
+#include <pthread.h>
+#include <atomic>
+#include <string>
+#include "ros/ros.h"
+#include "ros/callback_queue.h"
+#include "geometry_msgs/WrenchStamped.h"
+#include "geometry_msgs/TwistStamped.h"
+#include "sensor_msgs/JointState.h"
+#include "robot_msgs/ServoL.h"
+#include "admittance_control/MDK_msg.h"
+#include "admittance_control/MDKUpdate.h"
+#include "admittance_control/Plot.h"
+#include "admittance_control/SensorBias.h"
+#include "admittance_control/HybridForce.h"
+#include "admittance.h"
+#include "constraint_engine.h"
+#include "parameter_channel.h"
+#include "gain_scheduler.h"
+#include "force_recorder.h"
+
+/**
+ * @brief 单臂导纳控制, 每个手臂一个实例, 同一进程内可有多个
+ *        话题以 /<name> 为前缀 (如 /l_arm_controller/robot_driver/tool_point), name 为空时即原单臂话题;
+ *        参数在 ~<name>/ 下, name 为空时在 ~ 下
+ *        订阅回调在自己的 CallbackQueue 与线程中执行, 控制周期 (Sense/Step/Command) 由 RealtimeExecutor 调用
+ */
+class ArmController
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    explicit ArmController(const std::string &name);
+    ~ArmController();
+
+    /* 读取参数, 建立订阅/发布, 启动回调线程 */
+    bool Initialize(ros::NodeHandle &n, const ros::NodeHandle &private_n);
+    /* 经 move_line 到达起始位姿 (阻塞), 导纳状态与约束以起始位姿为准 */
+    bool MoveToStart();
+    /* 进入伺服前的检查, 如关节限位所需的关节状态 */
+    void Prepare();
+
+    /* 一个控制周期: 取最新的位姿/外力快照, 有新版 MDK 时在此整体替换; 末端位姿不可用时返回 false, 本周期不下发 */
+    bool Sense();
+    /* 单臂导纳, 结果写入 ExpectedPose */
+    void Step(double dt);
+    /* 约束投影后下发 servo_move; 本周期未经 Step 或 SetExpectedPose 给出期望位姿时不下发 */
+    void Command();
+    /* Sense + Step + Command, 作为执行器任务 */
+    void Update(double dt);
+    /* 退出伺服, 之后不再下发 */
+    void Stop();
+
+    const std::string &Name() const { return name_; }
+    bool Active() const { return active_; }
+    bool SafetyTripped() const { return safety_tripped_once_; }
+    /* 本周期 Sense 是否取得了可用的末端位姿 */
+    bool Sensed() const { return sensed_; }
+    const Vector6d &CurrentPose() const { return current_pose_; }
+    /* 末端坐标系下的外力, 供物体层导纳合成 */
+    const Vector6d &ExternalWrenchEnd() const { return external_wrench_end_; }
+    const Vector6d &ExpectedPose() const { return expected_pose_; }
+    void SetExpectedPose(const Vector6d &expected_pose)
+    {
+        expected_pose_ = expected_pose;
+        has_expected_pose_ = true;
+    }
+
+private:
+    void ToolPointRecord(const geometry_msgs::TwistStamped::ConstPtr &msg);
+    void ForceRecord(const geometry_msgs::WrenchStamped::ConstPtr &msg);
+    void MDKRecord(const admittance_control::MDK_msg::ConstPtr &msg);
+    void MDKUpdateRecord(const admittance_control::MDKUpdate::ConstPtr &msg);
+    /* 订阅线程: M/D/K_received_ 有变化后求逆、离散化并发布到 MDK_channel_ */
+    void PublishMDK();
+    void BiasRecord(const admittance_control::SensorBias::ConstPtr &msg);
+    void JointStateRecord(const sensor_msgs::JointState::ConstPtr &msg);
+    void HybridRecord(const admittance_control::HybridForce::ConstPtr &msg);
+    static void *CallbackThread(void *args);
+
+    void LoadConstraints(const Vector6d &start_pose);
+    void LoadGainSchedule();
+    std::string Topic(const std::string &topic) const { return prefix_ + topic; }
+
+    std::string name_;
+    std::string prefix_;
+    ros::NodeHandle n_;
+    ros::NodeHandle param_n_;
+    ros::CallbackQueue callback_queue_;
+    pthread_t callback_thread_;
+    bool callback_thread_started_;
+    std::atomic<bool> shutdown_;
+    std::atomic<bool> active_;
+
+    /* 订阅线程写入, mutex_ 保护 */
+    pthread_mutex_t mutex_;
+    Vector6d FTsensor_data_;             // 滑动平均后的传感器外力, 每帧已按其采样时刻的位姿补偿
+    ros::Time FTsensor_stamp_;           // 最新一帧传感器数据的时间戳, 随 servo_move 下发
+    Vector6d tool_point_;                // 最新的末端位姿
+    ros::Time tool_point_stamp_;
+    Vector6d joint_position_;            // 关节限位投影使用的当前关节角
+    bool joint_received_;
+    bool safety_tripped_;                // 控制周期据此停止伺服
+    bool hybrid_update_;                 // 力/位混合控制参数有更新, 由控制周期取走
+    bool hybrid_enable_;
+    Vector6d hybrid_selection_;
+    Vector6d hybrid_expected_wrench_;
+    Vector6d hybrid_kp_;
+    Vector6d hybrid_ki_;
+    Vector6d hybrid_max_velocity_;
+
+    /* MDK 由订阅线程求逆并离散化后经无锁通道交给控制周期, 控制周期在 Sense 中取用 */
+    ParameterChannel<AdmittanceParameters> MDK_channel_;
+
+    /* 仅订阅线程使用 */
+    Matrix6d M_received_, D_received_, K_received_; // 最近一版 MDK, 相同时不再发布
+    double control_period_;              // 预先离散化所用的控制周期 (s), 即 1 / ~rate
+    uint32_t MDK_sequence_;              // 已应用的 /MDK_update 序号
+    bool MDK_synchronized_;              // 已收到完整更新且之后的增量连续
+    ForceRecorder force_recorder_;       // 按采样时刻的位姿补偿负载重力/质心/零漂, 逐帧限幅, 滑动平均
+    Vector6d max_bias_std_;              // 零漂估计的标准差不超过此值时才采用
+
+    /* 仅控制周期使用 */
+    Admittance admittance_;
+    ConstraintEngine constraints_;
+    GainScheduler scheduler_;            // 按接触状态调度 MDK, 启用时不再使用 /MDK
+    bool gain_schedule_;
+    Matrix6d jacobian_sensor2end_;
+    Vector6d approach_pose_;
+    Vector6d start_pose_;
+    double max_pose_age_;
+    Vector6d current_pose_;
+    Vector6d FTsensor_data_once_;
+    ros::Time FTsensor_stamp_once_;
+    Vector6d joint_position_once_;
+    bool safety_tripped_once_;
+    bool sensed_;
+    bool has_expected_pose_;
+    Vector6d expected_wrench_;
+    Vector6d external_wrench_end_;
+    Vector6d expected_pose_;
+    robot_msgs::ServoL servo_msg_;
+    admittance_control::Plot plot_data_;
+
+    ros::Subscriber MDK_sub_;
+    ros::Subscriber MDK_update_sub_;
+    ros::Subscriber FTsensor_sub_;
+    ros::Subscriber tool_point_sub_;
+    ros::Subscriber bias_sub_;
+    ros::Subscriber joint_state_sub_;
+    ros::Subscriber hybrid_sub_;
+    ros::Publisher servo_move_pub_;
+    ros::Publisher plot_pub_;
+    ros::Publisher motion_abort_pub_;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef BATCH_KINEMATICS_H
+#define BATCH_KINEMATICS_H
+
+#include <memory>
+#include "Eigen/Core"
+
+namespace Eigen
+{
+class ThreadPoolInterface;
+}
+
+/**
+ * @brief 多组关节角的批量正运动学与雅可比, 用于离线标定、辨识与工作空间扫描
+ *        数据按结构数组存放: 第 k 行为第 k 组, 每个关节角/位姿元素的所有组在内存中连续,
+ *        逐关节的矩阵乘以 Eigen 数组表达式跨组按 SIMD 包计算, 每块 kBlockSize 组, 中间量在栈上
+ *        threads > 0 时各块分发到 Eigen 线程池
+ *        MDH 每行 a (m), d (m), theta (rad), alpha (rad), 与 RobotDynamics 相同
+ */
+class BatchKinematics
+{
+public:
+    static const int kBlockSize = 128;
+
+    typedef Eigen::Matrix<double, Eigen::Dynamic, 6> JointBatch;
+    /* 列 0-8 为姿态按行展开, 列 9-11 为位置 (m) */
+    typedef Eigen::Matrix<double, Eigen::Dynamic, 12> PoseBatch;
+    /* 基坐标系下, 以法兰原点为参考点的雅可比按列展开: 列 6 * j + r 为 J(r, j), 前三行线速度, 后三行角速度 */
+    typedef Eigen::Matrix<double, Eigen::Dynamic, 36> JacobianBatch;
+
+    explicit BatchKinematics(const Eigen::Matrix<double, 6, 4> &MDH, int threads = 0);
+    ~BatchKinematics();
+
+    void SetMDH(const Eigen::Matrix<double, 6, 4> &MDH);
+
+    void Forward(const JointBatch &q, PoseBatch &pose);
+    void Jacobian(const JointBatch &q, PoseBatch &pose, JacobianBatch &jacobian);
+
+    /* 取出第 k 组的齐次变换/雅可比 */
+    static Eigen::Matrix4d PoseAt(const PoseBatch &pose, int k);
+    static Eigen::Matrix<double, 6, 6> JacobianAt(const JacobianBatch &jacobian, int k);
+
+private:
+    void Run(const JointBatch &q, PoseBatch &pose, JacobianBatch *jacobian);
+    void Block(const JointBatch &q, int begin, int size, PoseBatch &pose, JacobianBatch *jacobian) const;
+
+    double a_[6];
+    double d_[6];
+    double theta_[6];
+    double cos_alpha_[6];
+    double sin_alpha_[6];
+
+    std::unique_ptr<Eigen::ThreadPoolInterface> pool_;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef BIAS_ESTIMATOR_H
+#define BIAS_ESTIMATOR_H
+
+#include "Eigen/Core"
+#include "wrench_compensation.h"
+
+typedef Eigen::Matrix<double, 6, 1> Vector6d;
+
+/**
+ * @brief 传感器零漂的在线估计, 长时间运行时跟踪温漂, 无需停机重新置零
+ *        每个采样减去负载重力 (wrench_compensation.h 的模型, 不含零漂) 得到零漂观测值,
+ *        按 window_num 个采样一组统计均值与方差; 只有满足以下条件的窗口才参与更新:
+ *          1. 窗口内机器人静止, 且距上次运动已超过 settle_time (排除加减速惯性力与振动)
+ *          2. 各轴标准差不超过 noise_std (排除振动、滑动接触)
+ *          3. 均值与当前估计之差不超过 contact + 3 倍估计标准差 (排除静止接触)
+ *        零漂按随机游走建模, 每轴一个标量卡尔曼滤波: 方差按 drift_rate^2 * dt 随时间增长,
+ *        接受窗口时以窗口均值 (方差 max(var / n, min_std^2)) 更新. ZeroDriftStd 即估计的置信度
+ *        不分配内存, 不含 ROS 通信
+ */
+class BiasEstimator
+{
+public:
+    /* 最近一个窗口的结果 */
+    enum WindowState
+    {
+        COLLECTING = 0,
+        MOVING = 1,
+        NOISY = 2,
+        CONTACT = 3,
+        ACCEPTED = 4
+    };
+
+    BiasEstimator();
+
+    /* 负载重力与质心取自 compensation, 其零漂作为初值, 初值标准差为 zero_drift_std */
+    void Reset(const WrenchCompensation &compensation, const Vector6d &zero_drift_std);
+
+    void SetWindow(int window_num) { window_num_ = window_num > 1 ? window_num : 2; }
+    /* still_velocity: 关节速度上限 (rad/s), settle_time: 停止后等待时间 (s) */
+    void SetMotionThreshold(double still_velocity, double settle_time);
+    void SetThreshold(const Vector6d &noise_std, const Vector6d &contact);
+    /* drift_rate: 零漂随机游走强度 (N/sqrt(s), Nm/sqrt(s)), min_std: 单个窗口均值的最小标准差 */
+    void SetDriftModel(const Vector6d &drift_rate, const Vector6d &min_std);
+
+    /**
+     * @param wrench         传感器读数 (N, Nm)
+     * @param rotation       传感器坐标系在基坐标系下的姿态
+     * @param joint_velocity 关节速度绝对值的最大值 (rad/s), 关节状态超时时应传入无穷大
+     * @param time           采样时间 (s)
+     * @return 本次采样结束了一个窗口并更新了估计时返回 true
+     */
+    bool AddSample(const Vector6d &wrench, const Eigen::Matrix3d &rotation, double joint_velocity, double time);
+
+    const Vector6d &ZeroDrift() const { return zero_drift_; }
+    /* 当前时刻的估计标准差, 未接受新窗口时随时间增大 */
+    Vector6d ZeroDriftStd() const { return variance_.cwiseSqrt(); }
+    /* 距上次接受窗口的时间 (s), 尚未接受过时为自 Reset 起的时间 */
+    double Age() const { return time_ - update_time_; }
+    int AcceptedNum() const { return accepted_num_; }
+    int RejectedNum() const { return rejected_num_; }
+    WindowState LastWindow() const { return last_window_; }
+    /* 最近一个完整窗口的均值与标准差, 供调试阈值 */
+    const Vector6d &WindowMean() const { return window_mean_; }
+    Vector6d WindowStd() const { return window_variance_.cwiseSqrt(); }
+
+    /* 零漂替换为当前估计后的补偿模型 */
+    WrenchCompensation Compensation() const;
+
+private:
+    void RestartWindow();
+    void CloseWindow();
+
+    WrenchCompensation gravity_; // 零漂置零, 只预测重力
+    double centroid_[3];
+
+    int window_num_;
+    double still_velocity_;
+    double settle_time_;
+    Vector6d noise_std_;
+    Vector6d contact_;
+    Vector6d drift_rate_;
+    Vector6d min_std_;
+
+    Vector6d zero_drift_;
+    Vector6d variance_;
+    double time_;
+    double update_time_;
+    double moving_time_; // 最近一次运动的时间
+    bool started_;
+
+    /* Welford 递推均值与平方和 */
+    int sample_num_;
+    Vector6d sample_mean_;
+    Vector6d sample_square_;
+
+    Vector6d window_mean_;
+    Vector6d window_variance_;
+    WindowState last_window_;
+    int accepted_num_;
+    int rejected_num_;
+};
+
+#endif
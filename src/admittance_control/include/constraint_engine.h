@@ -0,0 +1,96 @@
+#ifndef CONSTRAINT_ENGINE_H
+#define CONSTRAINT_ENGINE_H
+
+#include <string>
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+#include "dynamic_model.h"
+
+/**
+ * @brief 期望位姿的约束: 基坐标系下的位置盒/球, 工具姿态的锥, 关节限位
+ *        每个控制周期把导纳给出的期望位姿投影到可行域上, 代替越界即停止伺服
+ *        约束个数有上限, 位置约束固定迭代 kPositionPasses 轮交替投影, 每步计算量恒定且不分配堆内存
+ *        位姿为 (x, y, z, rx, ry, rz), m rad, R = Rz * Ry * Rx, 与 tool_point 一致
+ */
+class ConstraintEngine
+{
+public:
+    static const int kMaxConstraints = 16;
+    static const int kPositionPasses = 4;
+    /* ActiveMask 中关节限位占用的起始位, 关节 i 为 1 << (kJointLimitBit + i) */
+    static const int kJointLimitBit = kMaxConstraints;
+
+    ConstraintEngine();
+
+    void Clear();
+
+    /* 轴对齐的位置盒, 各轴 |p - center| <= half_extent; 超出 kMaxConstraints 时返回 false */
+    bool AddBox(const Eigen::Vector3d &center, const Eigen::Vector3d &half_extent, const std::string &name);
+    bool AddSphere(const Eigen::Vector3d &center, double radius, const std::string &name);
+    /**
+     * @brief 工具姿态的锥: 相对 reference_rotation, 工具 z 轴的偏摆不超过 swing_half_angle,
+     *        绕工具 z 轴的转动不超过 max_twist (rad); 小于等于 0 时不限制该项
+     */
+    bool AddCone(const Eigen::Matrix3d &reference_rotation, double swing_half_angle, double max_twist, const std::string &name);
+
+    /**
+     * @brief 关节限位 (rad), MDH 每行 a d theta alpha (m rad)
+     *        在当前关节角处把期望位姿的增量线性化到关节空间, 触限的关节固定在限位上, 其余关节重新按最小二乘跟踪,
+     *        再映射回末端; 在位置与姿态约束之后执行, 优先级最高
+     */
+    void SetJointLimits(const Eigen::Matrix<double, 6, 4> &MDH, const Vector6d &lower, const Vector6d &upper);
+    void ClearJointLimits() { has_joint_limits_ = false; }
+    bool HasJointLimits() const { return has_joint_limits_; }
+
+    /**
+     * @brief 把 pose 投影到可行域
+     * @param pose         期望位姿, 原地修改
+     * @param current_pose 当前末端位姿, 仅关节限位使用
+     * @param q            当前关节角 (rad), 仅关节限位使用
+     * @return pose 原本就可行时返回 true
+     */
+    bool Project(Vector6d &pose, const Vector6d &current_pose, const Vector6d &q);
+
+    int Size() const { return size_; }
+    /* 上一次 Project 中起作用的约束, 第 i 位对应第 i 个添加的约束, 关节限位见 kJointLimitBit */
+    unsigned int ActiveMask() const { return active_mask_; }
+    /* 如 "workspace box, joint5 limit", 仅用于日志 */
+    std::string ActiveNames() const;
+
+private:
+    enum Type
+    {
+        BOX,
+        SPHERE,
+        CONE
+    };
+
+    struct Constraint
+    {
+        Type type;
+        Eigen::Vector3d center;
+        Eigen::Vector3d half_extent;
+        double radius;
+        Eigen::Matrix3d reference_rotation;
+        double swing_half_angle;
+        double max_twist;
+        std::string name;
+    };
+
+    bool Add(const Constraint &constraint);
+    /* 投影后移动了位置时返回 true */
+    static bool ProjectPosition(const Constraint &constraint, Eigen::Vector3d &position);
+    static bool ProjectOrientation(const Constraint &constraint, Eigen::Matrix3d &rotation);
+    bool ProjectJoints(Eigen::Vector3d &position, Eigen::Matrix3d &rotation, const Vector6d &current_pose, const Vector6d &q);
+
+    Constraint constraints_[kMaxConstraints];
+    int size_;
+    unsigned int active_mask_;
+
+    bool has_joint_limits_;
+    RobotDynamics robot_;
+    Vector6d joint_lower_;
+    Vector6d joint_upper_;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef DYNAMIC_DERIVATIVE_H
+#define DYNAMIC_DERIVATIVE_H
+
+#include "dynamic_model.h"
+#include "Eigen/unsupported/AutoDiff"
+
+/* 对 6 个关节量 / 60 个动力学参数的前向自动微分标量, 导数向量定长, 不分配堆内存 */
+typedef AutoDiffScalar<Vector6d> JointAutoDiff;
+typedef AutoDiffScalar<Matrix<double, 60, 1>> ParameterAutoDiff;
+
+/**
+ * @brief 由前向自动微分得到的解析导数, 与 MDHDynamics<Model> 共用连杆描述与动力学参数
+ *        雅可比与末端质量矩阵均在法兰坐标系下, 与 FlangeJacobian / TaskMassMatrix 一致
+ */
+template <class Model>
+class DynamicsDerivative
+{
+public:
+    typedef Matrix<double, 60, 1> ParameterVector;
+    typedef Matrix<double, 6, 60> RegressorMatrix;
+
+    DynamicsDerivative();
+    DynamicsDerivative(const Model &model, const ParameterVector &dynamic_parameter);
+
+    void SetDynamicParameter(const ParameterVector &dynamic_parameter);
+    void SetGravity(const Vector3d &gravity);
+
+    /* dJ/dq_k */
+    void JacobianPartial(const Vector6d &q, Matrix6d &jacobian, Matrix6d jacobian_partial[6]);
+    /* dJ/dt = sum_k dJ/dq_k * qd_k */
+    void JacobianDerivative(const Vector6d &q, const Vector6d &qd, Matrix6d &jacobian, Matrix6d &jacobian_derivative);
+    /* dM/dq_k */
+    void MassMatrixPartial(const Vector6d &q, Matrix6d &mass_matrix, Matrix6d mass_partial[6]);
+    /**
+     * @brief 末端质量矩阵及 dΛ/dq_k = A^T dM_k A - A^T dJ_k^T Λ - Λ dJ_k A, A = J^-1
+     * @return 雅可比接近奇异 (rcond < min_rcond) 时返回 false, 输出不变
+     */
+    bool TaskMassMatrixPartial(const Vector6d &q, Matrix6d &task_mass_matrix, Matrix6d task_mass_partial[6], double min_rcond = 1e-6);
+    /* 逆动力学及其对 q, qd 的偏导 (第 k 列为对 q_k / qd_k), 用于线性化 */
+    void InverseDynamicsPartial(const Vector6d &q, const Vector6d &qd, const Vector6d &qdd,
+                                Vector6d &torque, Matrix6d &torque_q, Matrix6d &torque_qd);
+    /* 关节力矩对动力学参数的偏导, 即回归矩阵: torque = regressor * dynamic_parameter */
+    void Regressor(const Vector6d &q, const Vector6d &qd, const Vector6d &qdd, RegressorMatrix &regressor);
+
+private:
+    MDHDynamics<Model, JointAutoDiff> joint_dynamics_;
+    MDHDynamics<Model, ParameterAutoDiff> parameter_dynamics_;
+};
+
+/* 编译期 MDH 的本机机械臂导数 */
+typedef DynamicsDerivative<JakaMDH> JakaDynamicsDerivative;
+
+#endif
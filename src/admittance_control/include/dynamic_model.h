@@ -5,10 +5,105 @@
 #include "std_msgs/String.h"
 #include "Eigen/Core"
 #include "Eigen/Geometry"
+#include <type_traits>
+#include "robot_description.h"
 
 using namespace std;
 using namespace Eigen;
 
+typedef Matrix<double, 6, 1> Vector6d;
+typedef Matrix<double, 6, 6> Matrix6d;
+
+/**
+ * @brief 定长刚体动力学, 计算过程中没有堆内存分配
+ *        Model 为 robot_description.h 中的连杆描述: StaticMDH 的连杆常量在编译期折叠, RuntimeMDH 运行期设置
+ *        Scalar 为 double 或定长 AutoDiffScalar (见 dynamic_derivative.h), 后者给出对关节量或参数的前向自动微分
+ *        动力学参数每连杆 10 个, 均在该连杆的 MDH 坐标系下:
+ *        6 * i 起为惯量 Ixx Ixy Ixz Iyy Iyz Izz (对坐标系原点), 6 * N + 4 * i 起为一阶矩 mx my mz 与质量 m
+ *        实现在 dynamic_model.cpp 中, 新的 Model/Scalar 需在该文件末尾显式实例化
+ */
+template <class Model, class Scalar = double>
+class MDHDynamics
+{
+public:
+    static const int kJointNum = Model::kJointNum;
+    static const int kParameterNum = 10 * kJointNum;
+
+    typedef Matrix<Scalar, kJointNum, 1> JointVector;
+    typedef Matrix<Scalar, kJointNum, kJointNum> JointMatrix;
+    typedef Matrix<Scalar, 6, kJointNum> JacobianMatrix;
+    typedef Matrix<Scalar, kParameterNum, 1> ParameterVector;
+    typedef Matrix<Scalar, 3, 1> Vector3;
+    typedef Matrix<Scalar, 3, 3> Matrix3;
+    typedef Matrix<Scalar, 4, 4> Matrix4;
+
+    MDHDynamics();
+    explicit MDHDynamics(const ParameterVector &dynamic_parameter);
+    MDHDynamics(const Model &model, const ParameterVector &dynamic_parameter);
+
+    void SetDynamicParameter(const ParameterVector &dynamic_parameter);
+    /* 基坐标系下的重力加速度, 默认 (0, 0, -9.8) */
+    void SetGravity(const Vector3 &gravity) { gravity_ = gravity; }
+
+    const Model &model() const { return model_; }
+
+    /* 递推牛顿-欧拉: torque = M(q) qdd + C(q, qd) qd + G(q) */
+    void InverseDynamics(const JointVector &q, const JointVector &qd, const JointVector &qdd, JointVector &torque);
+    void GravityTorque(const JointVector &q, JointVector &torque);
+    /* C(q, qd) qd */
+    void CoriolisTorque(const JointVector &q, const JointVector &qd, JointVector &torque);
+    /* 复合刚体法 */
+    void MassMatrix(const JointVector &q, JointMatrix &mass_matrix);
+    /* 基坐标系下的法兰位姿 */
+    void FlangePose(const JointVector &q, Matrix4 &pose);
+    /* 法兰坐标系下的雅可比, 前三行线速度, 后三行角速度 */
+    void FlangeJacobian(const JointVector &q, JacobianMatrix &jacobian);
+    /**
+     * @brief 法兰坐标系下的末端质量矩阵 J^-T * M * J^-1, 仅 6 关节, 仅 double
+     * @return 雅可比接近奇异 (rcond < min_rcond) 时返回 false, task_mass_matrix 不变
+     */
+    bool TaskMassMatrix(const JointVector &q, Matrix6d &task_mass_matrix, double min_rcond = 1e-6);
+
+protected:
+    Model model_;
+
+private:
+    template <int I>
+    void Kinematics(const JointVector &q, integral_constant<int, I>);
+    void Kinematics(const JointVector &, integral_constant<int, kJointNum>) {}
+    void Kinematics(const JointVector &q) { Kinematics(q, integral_constant<int, 0>()); }
+    void Rnea(const JointVector &qd, const JointVector &qdd, const Vector3 &base_acceleration, JointVector &torque) const;
+
+    Matrix3 inertia_[kJointNum];
+    Vector3 first_moment_[kJointNum];
+    Scalar mass_[kJointNum];
+    Vector3 gravity_;
+
+    Matrix3 rotation_[kJointNum];    // R of frame i+1 in frame i
+    Vector3 translation_[kJointNum]; // origin of frame i+1 in frame i
+};
+
+/**
+ * @brief 运行期 MDH 的 6 关节动力学
+ *        MDH 每行 a (m), d (m), theta (rad), alpha (rad), theta 列作为关节零位叠加在 q 上
+ */
+class RobotDynamics : public MDHDynamics<RuntimeMDH<6>>
+{
+public:
+    RobotDynamics() {}
+    RobotDynamics(const Matrix<double, 6, 4> &MDH, const Matrix<double, 60, 1> &dynamic_parameter)
+        : MDHDynamics<RuntimeMDH<6>>(dynamic_parameter)
+    {
+        SetMDH(MDH);
+    }
+
+    void SetMDH(const Matrix<double, 6, 4> &MDH) { model_.SetMDH(MDH); }
+};
+
+/* 编译期 MDH 的本机机械臂动力学 */
+typedef MDHDynamics<JakaMDH> JakaDynamics;
+
+/* 末端 (法兰坐标系) 质量矩阵 J^-T * M * J^-1, MDH 的 theta 列为当前关节角 */
 MatrixXd MassMatrixComputation(MatrixXd, MatrixXd);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,86 @@
+#ifndef EXCITATION_TRAJECTORY_H
+#define EXCITATION_TRAJECTORY_H
+
+#include <vector>
+#include "Eigen/Core"
+#include "batch_kinematics.h"
+#include "payload_identification.h"
+
+/**
+ * @brief 负载/零漂标定用的傅里叶级数激励轨迹, 优化目标为 PayloadIdentification 回归矩阵的条件数
+ *        q_j(t) = q0_j + sum_k a_jk / (w k) sin(w k t) - b_jk / (w k) (cos(w k t) - 1), w = 2 pi / period
+ *        t = 0 时位于 q0; 回归矩阵只与传感器坐标系下的重力方向有关, 与传感器相对法兰的固定安装姿态无关,
+ *        因此按法兰姿态计算; 关节 1 绕竖直轴转动, 不改变重力方向, 默认不参与
+ *        每次评估在一个周期内取 sample_num 个点, 由 BatchKinematics 批量正解
+ */
+class ExcitationTrajectory
+{
+public:
+    ExcitationTrajectory(const Eigen::Matrix<double, 6, 4> &MDH, double period, int harmonic_num, int sample_num = 200);
+
+    void SetCenter(const Vector6d &center) { center_ = center; }
+    /* 关节位置上下限 (rad), 速度与加速度绝对值上限 */
+    void SetLimit(const Vector6d &lower, const Vector6d &upper, const Vector6d &velocity, const Vector6d &acceleration);
+    /* 参与运动的关节, 其余关节保持 q0 */
+    void SetActiveJoint(const Eigen::Matrix<bool, 6, 1> &active);
+
+    /**
+     * @brief Nelder-Mead 最小化 cond(力) + cond(力矩) + 超限罚函数, 从随机初值多次重启取最优
+     * @return 结果满足全部限位时返回 true
+     */
+    bool Optimize(int evaluation_num, int restart_num, unsigned int seed = 0);
+
+    void Evaluate(double t, Vector6d &q, Vector6d &qd, Vector6d &qdd) const;
+    /* 一个周期内均匀取 point_num 个点, 第 k 行为 t = k * period / point_num */
+    void Sample(int point_num, BatchKinematics::JointBatch &q) const;
+
+    /* 回归矩阵条件数 (非信息矩阵) */
+    double ForceCondition() const { return force_condition_; }
+    double TorqueCondition() const { return torque_condition_; }
+    /* 最大超限量, 0 为满足限位 */
+    double Violation() const { return violation_; }
+
+    /**
+     * @brief 按周期内采样预测辨识标准差, 与 PayloadIdentification 的输出对应
+     * @param force_noise / torque_noise 传感器每轴噪声标准差 (N, Nm)
+     * @param sample_num 参与辨识的传感器采样总数
+     * @param gravity / centroid 负载的名义值, 用于质心误差传播
+     */
+    void PredictStd(double force_noise, double torque_noise, double sample_num, double gravity, const Eigen::Vector3d &centroid,
+                    double &gravity_std, Eigen::Vector3d &centroid_std, Vector6d &zero_drift_std) const;
+
+    /* 任意一组离散姿态 (如原 Test_Joint_Angle) 的回归矩阵条件数, 用于对比 */
+    void PoseCondition(const BatchKinematics::JointBatch &q, double &force_condition, double &torque_condition);
+
+    double Period() const { return period_; }
+    /* 第 j 行为关节 j 的 a_j1..a_jK, b_j1..b_jK */
+    const Eigen::MatrixXd &Coefficient() const { return coefficient_; }
+
+private:
+    double Cost(const Eigen::VectorXd &x);
+    void Unpack(const Eigen::VectorXd &x);
+    /* 由各组关节角的正解累加平均信息矩阵并求回归矩阵条件数 */
+    void Information(const BatchKinematics::JointBatch &q, Eigen::Matrix4d &force_information, Eigen::Matrix<double, 6, 6> &torque_information,
+                     double &force_condition, double &torque_condition);
+
+    BatchKinematics kinematics_;
+    double period_;
+    int harmonic_num_;
+    int sample_num_;
+
+    Vector6d center_;
+    Vector6d lower_, upper_, velocity_limit_, acceleration_limit_;
+    std::vector<int> active_joint_;
+    Eigen::MatrixXd coefficient_;
+
+    Eigen::Matrix4d force_information_;
+    Eigen::Matrix<double, 6, 6> torque_information_;
+    double force_condition_;
+    double torque_condition_;
+    double violation_;
+
+    BatchKinematics::JointBatch sample_q_;
+    BatchKinematics::PoseBatch sample_pose_;
+};
+
+#endif
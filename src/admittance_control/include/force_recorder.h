@@ -0,0 +1,62 @@
+#ifndef FORCE_RECORDER_H
+#define FORCE_RECORDER_H
+
+#include "Eigen/Core"
+#include "pose_buffer.h"
+#include "safety_monitor.h"
+#include "wrench_compensation.h"
+
+typedef Eigen::Matrix<double, 6, 1> Vector6d;
+
+/**
+ * @brief 传感器数据的逐帧处理: 按采样时刻的末端姿态补偿负载重力与零漂, 逐帧限幅检查, 定长滑动平均
+ *        ArmController 的 netft_data 回调与 latency_benchmark 共用; 不含 ROS 通信, 不分配堆内存
+ *        AddPose 与 Record 可在不同线程 (PoseBuffer 无锁), 其余方法与 Record 在同一线程调用
+ */
+class ForceRecorder
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    static const int kWindow = 10; // 滑动平均的帧数
+
+    ForceRecorder();
+
+    /* 末端位姿 (m, rad), stamp 为其时刻 (s) */
+    void AddPose(double stamp, const Vector6d &pose);
+
+    /**
+     * @brief 一帧传感器数据
+     * @param raw   传感器读数 (N, Nm)
+     * @param stamp 采样时刻 (s)
+     * @return 末端姿态的查找结果, EMPTY 时尚无末端位姿, 本帧丢弃
+     */
+    PoseBuffer::Status Record(const double raw[6], double stamp);
+
+    /* 最近一帧补偿后的外力 */
+    const Vector6d &Compensated() const { return compensated_; }
+    /* 最近一帧使限幅触发, 即连续超限的帧数达到 SafetyMonitor 的 trip_samples */
+    bool Tripped() const { return tripped_; }
+    /* 补偿后外力的滑动平均, 尚无数据时为 0 */
+    const Vector6d &Average() const { return average_; }
+
+    PoseBuffer &Poses() { return poses_; }
+    WrenchCompensation &Payload() { return payload_; }
+    SafetyMonitor &Safety() { return safety_; }
+
+private:
+    PoseBuffer poses_;
+    WrenchCompensation payload_;
+    SafetyMonitor safety_;
+
+    Vector6d window_[kWindow];
+    Vector6d sum_;
+    int count_;
+    int index_;
+
+    Vector6d compensated_;
+    Vector6d average_;
+    bool tripped_;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef GAIN_SCHEDULER_H
+#define GAIN_SCHEDULER_H
+
+#include "Eigen/Core"
+#include "admittance.h"
+
+/**
+ * @brief 按接触状态切换导纳参数: 自由空间接近 / 接触 / 插入三组对角 M, D, K
+ *        状态由末端外力与导纳速度判定 (带滞回与驻留帧数), 切换时在一段时间内按 smoothstep 平滑插值
+ *        插值量化为 kBlendSteps 级, 只有级数变化时 MDK 才改变, 导纳的离散矩阵只在这些时刻重算
+ *        无源性: 能量箱 (energy tank) 由阻尼耗散的能量充能, 参数变化使储能 1/2 x^T K x + 1/2 v^T M v 增加时
+ *        从能量箱中扣除, 能量不足时插值暂停, 直到耗散补足; 因而调度过程不向系统注入超出耗散的能量
+ *        不含任何 ROS 通信, 计算过程中没有堆内存分配
+ */
+class GainScheduler
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    enum ContactState
+    {
+        FREE,
+        CONTACT,
+        INSERTION,
+        kStateNum
+    };
+
+    static const int kBlendSteps = 16;
+
+    GainScheduler();
+
+    /* 各状态的对角参数, M, D 须为正, K 非负 */
+    void SetGains(ContactState state, const Vector6d &mass, const Vector6d &damping, const Vector6d &stiffness);
+
+    /**
+     * @param contact_force      合外力超过此值 (N) 判为接触, 低于 contact_force * release_ratio 判为脱离
+     * @param release_ratio      脱离阈值比例 (0 ~ 1)
+     * @param insertion_velocity 接触中沿插入方向的速度超过此值 (m/s) 判为插入, 低于其 release_ratio 倍时回到接触
+     * @param insertion_axis     末端坐标系下的插入方向
+     * @param dwell_samples      新状态连续满足的帧数
+     */
+    void SetThresholds(double contact_force, double release_ratio, double insertion_velocity,
+                       const Eigen::Vector3d &insertion_axis, int dwell_samples);
+    /* 一次切换的插值时间 (s), 为 0 时立即切换 (仍受能量箱限制) */
+    void SetTransitionTime(double transition_time) { transition_time_ = transition_time; }
+    /* 能量箱的初始能量与上限 (J) */
+    void SetTank(double initial_energy, double max_energy);
+
+    /* 回到自由空间参数, 能量箱恢复初始能量 */
+    void Reset();
+
+    /**
+     * @brief 一个控制周期, 在导纳步进之前调用
+     * @param wrench_end 末端坐标系下的外力 (已补偿)
+     * @param deviation  导纳的当前偏移 x (DeltaPose)
+     * @param velocity   导纳的当前速度 v (DeltaPoseVelocity)
+     * @param dt         控制周期 (s)
+     * @return MDK 本周期有变化时返回 true
+     */
+    bool Update(const Vector6d &wrench_end, const Vector6d &deviation, const Vector6d &velocity, double dt);
+
+    const Matrix6d &M() const { return M_; }
+    const Matrix6d &D() const { return D_; }
+    const Matrix6d &K() const { return K_; }
+    ContactState State() const { return state_; }
+    /* 当前切换的完成程度 (0 ~ 1) */
+    double Blend() const { return (double)applied_step_ / kBlendSteps; }
+    double TankEnergy() const { return tank_energy_; }
+    /* 能量不足而暂停插值的周期数, 累计 */
+    long HeldCycles() const { return held_cycles_; }
+
+    static const char *StateName(ContactState state);
+
+private:
+    ContactState Classify(const Vector6d &wrench_end, const Vector6d &velocity) const;
+    /* 按插值级数计算参数 */
+    void Interpolate(int step, Vector6d &mass, Vector6d &damping, Vector6d &stiffness) const;
+
+    Vector6d mass_[kStateNum];
+    Vector6d damping_[kStateNum];
+    Vector6d stiffness_[kStateNum];
+
+    double contact_force_;
+    double release_ratio_;
+    double insertion_velocity_;
+    Eigen::Vector3d insertion_axis_;
+    int dwell_samples_;
+    double transition_time_;
+    double initial_energy_;
+    double max_energy_;
+
+    ContactState state_;
+    ContactState candidate_;
+    int candidate_count_;
+    /*切换起点 (切换开始时正在使用的参数) 与终点*/
+    Vector6d from_mass_, from_damping_, from_stiffness_;
+    double progress_;     // 时间进度 0 ~ 1
+    int applied_step_;    // 已应用的插值级数 0 ~ kBlendSteps
+    double tank_energy_;
+    long held_cycles_;
+
+    Vector6d mass_applied_, damping_applied_, stiffness_applied_;
+    Matrix6d M_, D_, K_;
+};
+
+#endif
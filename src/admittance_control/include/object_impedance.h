@@ -0,0 +1,60 @@
+#ifndef OBJECT_IMPEDANCE_H
+#define OBJECT_IMPEDANCE_H
+
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+#include "admittance.h"
+
+/**
+ * @brief 双臂协同装配的物体层导纳: 两臂抓持同一物体, 两臂外力合成到物体坐标系驱动一个导纳,
+ *        再按抓持时的相对位姿给出各臂的期望位姿, 两臂之间的相对位姿保持不变
+ *        各臂位姿在自己的基坐标系下, 经 SetBase 给出的基座位姿换算到共同的世界坐标系后再求物体位姿
+ *        物体坐标系在 Grasp 时确定: 原点为两 TCP 的中点, 姿态为两 TCP 姿态的中间姿态 (世界坐标系下)
+ *        不含任何 ROS 通信, 计算过程中没有堆内存分配
+ */
+class ObjectImpedance
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    static const int kArmNum = 2;
+
+    ObjectImpedance();
+
+    void SetMDK(const Matrix6d &M, const Matrix6d &D, const Matrix6d &K) { admittance_.SetMDK(M, D, K); }
+    /* 物体坐标系下的期望外力, 如装配时的压入力 */
+    void SetExpectedWrench(const Vector6d &expected_wrench) { admittance_.SetExpectedWrench(expected_wrench); }
+
+    /* 手臂 arm 的基座在世界坐标系下的位姿 (world <- base, m, rad), 默认与世界坐标系重合; 须在 Grasp 之前设置 */
+    void SetBase(int arm, const Vector6d &base_pose);
+
+    /* 以当前两臂 TCP 位姿 (m, rad, 各自基坐标系) 确定抓持关系, 导纳状态清零 */
+    void Grasp(const Vector6d pose[kArmNum]);
+
+    /**
+     * @brief 一个控制周期
+     * @param pose          当前两臂 TCP 位姿 (m, rad, 各自基坐标系)
+     * @param wrench_end    两臂末端坐标系下的外力 (已补偿)
+     * @param dt            控制周期 (s)
+     * @param expected_pose 输出, 两臂的期望 TCP 位姿 (各自基坐标系)
+     */
+    void Step(const Vector6d pose[kArmNum], const Vector6d wrench_end[kArmNum], double dt, Vector6d expected_pose[kArmNum]);
+
+    /* 世界坐标系下的物体位姿 */
+    const Vector6d &ObjectPose() const { return object_pose_; }
+    /* 物体坐标系下的合外力 */
+    const Vector6d &ObjectWrench() const { return object_wrench_; }
+    const Admittance &ObjectAdmittance() const { return admittance_; }
+
+private:
+    /* 由两臂当前位姿估计世界坐标系下的物体位姿 */
+    Eigen::Matrix4d ObjectTransform(const Vector6d pose[kArmNum]) const;
+
+    Admittance admittance_;
+    Eigen::Matrix4d world2base_[kArmNum];
+    Eigen::Matrix4d object2tcp_[kArmNum];
+    Vector6d object_pose_;
+    Vector6d object_wrench_;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef PARAMETER_CHANNEL_H
+#define PARAMETER_CHANNEL_H
+
+#include <atomic>
+#include "Eigen/Core"
+
+/**
+ * @brief 单生产者/单消费者的无锁参数通道 (三缓冲)
+ *        生产者 (订阅线程) 在 Write() 给出的缓冲中写好完整的参数后 Publish, 消费者 (控制周期) 在周期边界 Acquire 取得最新一版;
+ *        两侧各持有一个缓冲, 第三个缓冲在两者之间原子交换, 任何一方都不会等待或看到写了一半的参数
+ *        每次 Publish 版本号加一, 生产者连续发布多次时消费者只取最新一版
+ *        T 须可默认构造, 缓冲在构造时分配, 运行中不分配内存
+ */
+template <class T>
+class ParameterChannel
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    ParameterChannel()
+        : write_(0), middle_(1), read_(2), published_version_(0), read_version_(0)
+    {
+        for (int i = 0; i < 3; i++)
+            versions_[i] = 0;
+    }
+
+    /* 生产者: 下一版参数的写入缓冲, 内容是之前某一版的旧参数, 须整体写入 */
+    T &Write() { return buffer_[write_]; }
+
+    /* 生产者: 发布写入缓冲中的参数 */
+    void Publish()
+    {
+        versions_[write_] = ++published_version_;
+        write_ = middle_.exchange(write_ | kFresh) & kIndexMask;
+    }
+
+    /* 消费者: 有新参数时返回最新一版, 否则返回 NULL; 返回的参数在下一次 Acquire 之前有效 */
+    const T *Acquire()
+    {
+        if (!(middle_.load() & kFresh))
+            return NULL;
+
+        read_ = middle_.exchange(read_) & kIndexMask;
+        read_version_ = versions_[read_];
+        return &buffer_[read_];
+    }
+
+    /* 消费者: 最近一次 Acquire 取得的版本, 尚未取得时为 0 */
+    unsigned long ReadVersion() const { return read_version_; }
+    /* 生产者: 已发布的版本数 */
+    unsigned long PublishedVersion() const { return published_version_; }
+
+private:
+    static const int kIndexMask = 3;
+    static const int kFresh = 4; // 中间缓冲中是尚未被取走的新参数
+
+    T buffer_[3];
+    unsigned long versions_[3];
+    int write_;              // 仅生产者
+    std::atomic<int> middle_;
+    int read_;               // 仅消费者
+    unsigned long published_version_;
+    unsigned long read_version_;
+};
+
+#endif
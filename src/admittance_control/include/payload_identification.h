@@ -0,0 +1,81 @@
+#ifndef PAYLOAD_IDENTIFICATION_H
+#define PAYLOAD_IDENTIFICATION_H
+
+#include "Eigen/Core"
+
+typedef Eigen::Matrix<double, 6, 1> Vector6d;
+
+/**
+ * @brief 负载重力、质心与传感器零漂的流式最小二乘辨识, 每个传感器采样都参与计算
+ *        传感器坐标系下, g = R^T * (0, 0, 1) 为基坐标系 z 轴方向:
+ *          F = G * g + F0
+ *          T = c x (G * g) + T0 = -[g]x * (G * c) + T0
+ *        力 (G, F0) 与力矩 (G * c, T0) 两组参数互不耦合, 各自累加信息矩阵 A^T A 与 A^T y,
+ *        求解时用 LDLT; forgetting_factor < 1 时按指数遗忘旧数据
+ *        G 与 admittance_control 中 G_basis 的 z 分量同义 (负载重力为 -G)
+ */
+class PayloadIdentification
+{
+public:
+    explicit PayloadIdentification(double forgetting_factor = 1.0);
+
+    void Reset();
+
+    /**
+     * @param wrench   传感器读数 (N, Nm)
+     * @param rotation 传感器坐标系在基坐标系下的姿态
+     */
+    void AddSample(const Vector6d &wrench, const Eigen::Matrix3d &rotation);
+
+    /* 更新估计值与标准差, 信息矩阵不满秩 (姿态变化不足) 时返回 false */
+    bool Solve();
+
+    int SampleNum() const { return sample_num_; }
+    double Gravity() const { return gravity_; }
+    const Eigen::Vector3d &Centroid() const { return centroid_; }
+    /* F0, T0 */
+    const Vector6d &ZeroDrift() const { return zero_drift_; }
+
+    /* 由残差估计的标准差: G, 质心 (m), 零漂 */
+    double GravityStd() const { return gravity_std_; }
+    const Eigen::Vector3d &CentroidStd() const { return centroid_std_; }
+    const Vector6d &ZeroDriftStd() const { return zero_drift_std_; }
+    /* 残差均方根: 力 (N), 力矩 (Nm) */
+    double ForceResidual() const { return force_residual_; }
+    double TorqueResidual() const { return torque_residual_; }
+
+    bool Converged(double gravity_std, double centroid_std) const;
+
+    /* g 为传感器坐标系下的基坐标系 z 轴方向, 即姿态矩阵第 3 行; 力回归矩阵 [g, I], 力矩回归矩阵 [-[g]x, I] */
+    static void Regressor(const Eigen::Vector3d &g, Eigen::Matrix<double, 3, 4> &force_regressor, Eigen::Matrix<double, 3, 6> &torque_regressor)
+    {
+        force_regressor << g, Eigen::Matrix3d::Identity();
+        torque_regressor << 0, g(2), -g(1), 1, 0, 0,
+            -g(2), 0, g(0), 0, 1, 0,
+            g(1), -g(0), 0, 0, 0, 1;
+    }
+
+private:
+    double forgetting_factor_;
+    int sample_num_;
+    double weight_; // 遗忘后的等效采样数
+
+    Eigen::Matrix4d force_information_;
+    Eigen::Vector4d force_vector_;
+    double force_square_;
+    Eigen::Matrix<double, 6, 6> torque_information_;
+    Vector6d torque_vector_;
+    double torque_square_;
+
+    bool solved_;
+    double gravity_;
+    Eigen::Vector3d centroid_;
+    Vector6d zero_drift_;
+    double gravity_std_;
+    Eigen::Vector3d centroid_std_;
+    Vector6d zero_drift_std_;
+    double force_residual_;
+    double torque_residual_;
+};
+
+#endif
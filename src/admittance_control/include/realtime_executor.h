@@ -0,0 +1,93 @@
+#ifndef REALTIME_EXECUTOR_H
+#define REALTIME_EXECUTOR_H
+
+#include <pthread.h>
+#include <atomic>
+#include <functional>
+#include <string>
+
+/**
+ * @brief 固定周期的实时执行器: 一个线程按绝对时刻 (clock_nanosleep, CLOCK_MONOTONIC) 依次执行各任务,
+ *        可绑定 CPU 并设为 SCHED_FIFO; 逐任务统计耗时, 供多臂共用同一个控制周期
+ *        任务在 Start 前添加, 执行器自身运行中不分配堆内存; 任务返回 false 时执行器停止
+ *        统计只由执行线程写入, 经各自的序号 (seqlock) 发布, 读取方重试而不加锁, 不会因优先级反转阻塞执行线程
+ */
+class RealtimeExecutor
+{
+public:
+    static const int kMaxTasks = 16;
+
+    struct Statistics
+    {
+        long count;
+        double last;   // s
+        double mean;   // s
+        double max;    // s
+        long overruns; // 仅周期统计: 超过周期的次数
+    };
+
+    explicit RealtimeExecutor(double rate);
+    ~RealtimeExecutor();
+
+    /* 超出 kMaxTasks 或已启动时返回 -1, 否则返回任务序号 */
+    int AddTask(const std::function<bool()> &task, const std::string &name);
+
+    /**
+     * @brief 启动执行线程
+     * @param cpu      绑定的 CPU, 小于 0 时不绑定
+     * @param priority SCHED_FIFO 优先级 (1 ~ 99), 小于等于 0 时使用默认调度
+     * @return 线程创建失败时返回 false; 绑定或实时调度失败 (如权限不足) 时照常运行, 原因见 Warning
+     */
+    bool Start(int cpu, int priority);
+    /* 请求停止并等待线程退出 */
+    void Stop();
+    bool Running() const;
+
+    const std::string &Warning() const { return warning_; }
+    int TaskNum() const { return task_num_; }
+    const std::string &TaskName(int i) const { return names_[i]; }
+    Statistics TaskStatistics(int i) const;
+    /* 整个周期 (所有任务) 的耗时与超时次数 */
+    Statistics CycleStatistics() const;
+    /* 运行中由执行线程在下一周期开始时清零 */
+    void ResetStatistics();
+
+private:
+    /* 执行线程发布的一份统计, seq 为奇数时正在写入 */
+    struct SharedStatistics
+    {
+        std::atomic<unsigned long> seq;
+        std::atomic<long> count;
+        std::atomic<double> last;
+        std::atomic<double> mean;
+        std::atomic<double> max;
+        std::atomic<long> overruns;
+    };
+
+    static void *Run(void *args);
+    void Loop();
+    void ClearStatistics();
+    static void Update(Statistics &statistics, double time);
+    static void Store(SharedStatistics &shared, const Statistics &statistics);
+    static Statistics Load(const SharedStatistics &shared);
+
+    double period_;
+    std::function<bool()> tasks_[kMaxTasks];
+    std::string names_[kMaxTasks];
+    int task_num_;
+
+    pthread_t thread_;
+    bool started_;
+    std::atomic<bool> stop_;
+    std::atomic<bool> running_;
+    std::string warning_;
+
+    /* 仅执行线程 (未启动时为调用方) 使用, 每次更新后 Store 到 shared_ */
+    Statistics task_statistics_[kMaxTasks];
+    Statistics cycle_statistics_;
+    std::atomic<bool> reset_requested_;
+    SharedStatistics shared_task_statistics_[kMaxTasks];
+    SharedStatistics shared_cycle_statistics_;
+};
+
+#endif
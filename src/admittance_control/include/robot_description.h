@@ -0,0 +1,145 @@
+#ifndef ROBOT_DESCRIPTION_H
+#define ROBOT_DESCRIPTION_H
+
+#include <cmath>
+#include "Eigen/Core"
+
+/**
+ * @brief MDH 连杆描述, 作为 MDHDynamics 的模板参数
+ *        每个描述提供 kJointNum 与 template <int I, class Scalar> LinkTransform(q, R, p):
+ *        关节 I 的 MDH 变换, R 为坐标系 I+1 在坐标系 I 下的姿态, p 为其原点; Scalar 可为自动微分标量
+ */
+
+/* C++11 constexpr 的 sin/cos, 供编译期折叠常量 alpha; 0, +-90, 180 度时结果精确 */
+namespace constexpr_math
+{
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr double Reduce(double x)
+{
+    return x > kPi ? Reduce(x - 2 * kPi) : (x < -kPi ? Reduce(x + 2 * kPi) : x);
+}
+
+constexpr double SinSeries(double x2, double term, int k)
+{
+    return k > 15 ? 0.0 : term + SinSeries(x2, -term * x2 / ((2 * k + 2) * (2 * k + 3)), k + 1);
+}
+
+constexpr double CosSeries(double x2, double term, int k)
+{
+    return k > 15 ? 0.0 : term + CosSeries(x2, -term * x2 / ((2 * k + 1) * (2 * k + 2)), k + 1);
+}
+
+constexpr double Sin(double x) { return SinSeries(Reduce(x) * Reduce(x), Reduce(x), 0); }
+constexpr double Cos(double x) { return CosSeries(Reduce(x) * Reduce(x), 1.0, 0); }
+
+constexpr double DegreeSin(double degree)
+{
+    return degree == 0 || degree == 180 || degree == -180 ? 0.0 : (degree == 90 ? 1.0 : (degree == -90 ? -1.0 : Sin(degree / 180 * kPi)));
+}
+
+constexpr double DegreeCos(double degree)
+{
+    return degree == 90 || degree == -90 ? 0.0 : (degree == 0 ? 1.0 : (degree == 180 || degree == -180 ? -1.0 : Cos(degree / 180 * kPi)));
+}
+} // namespace constexpr_math
+
+/**
+ * @brief 编译期 MDH: Table 提供 kJointNum 与 constexpr 数组
+ *        kA (m), kD (m), kTheta (rad, 关节零位), kAlphaDegree (deg)
+ *        每个关节的 a, d, alpha 及 cos/sin(alpha) 均为常量, 逐关节按模板展开
+ */
+template <class Table>
+struct StaticMDH
+{
+    static const int kJointNum = Table::kJointNum;
+
+    template <int I, class Scalar>
+    void LinkTransform(const Scalar &q, Eigen::Matrix<Scalar, 3, 3> &R, Eigen::Matrix<Scalar, 3, 1> &p) const
+    {
+        using std::cos;
+        using std::sin;
+
+        constexpr double a = Table::kA[I];
+        constexpr double d = Table::kD[I];
+        constexpr double theta = Table::kTheta[I];
+        constexpr double ca = constexpr_math::DegreeCos(Table::kAlphaDegree[I]);
+        constexpr double sa = constexpr_math::DegreeSin(Table::kAlphaDegree[I]);
+
+        Scalar ct = cos(theta + q);
+        Scalar st = sin(theta + q);
+
+        R << ct, -st, Scalar(0),
+            st * ca, ct * ca, Scalar(-sa),
+            st * sa, ct * sa, Scalar(ca);
+        p << Scalar(a), Scalar(-sa * d), Scalar(ca * d);
+    }
+
+    /* 同一组参数的 MDH 表 (a d theta alpha, m rad), 用于构造 RobotDynamics */
+    static Eigen::Matrix<double, kJointNum, 4> MDH()
+    {
+        Eigen::Matrix<double, kJointNum, 4> MDH;
+        for (int i = 0; i < kJointNum; i++)
+            MDH.row(i) << Table::kA[i], Table::kD[i], Table::kTheta[i], Table::kAlphaDegree[i] / 180 * constexpr_math::kPi;
+        return MDH;
+    }
+};
+
+/* 运行期 MDH, 由 MDH 表 (a d theta alpha, m rad) 设置, 如从参数服务器加载的 YAML */
+template <int N>
+struct RuntimeMDH
+{
+    static const int kJointNum = N;
+
+    RuntimeMDH() { SetMDH(Eigen::Matrix<double, N, 4>::Zero()); }
+
+    void SetMDH(const Eigen::Matrix<double, N, 4> &MDH)
+    {
+        for (int i = 0; i < N; i++)
+        {
+            a_[i] = MDH(i, 0);
+            d_[i] = MDH(i, 1);
+            theta_[i] = MDH(i, 2);
+            cos_alpha_[i] = std::cos(MDH(i, 3));
+            sin_alpha_[i] = std::sin(MDH(i, 3));
+        }
+    }
+
+    template <int I, class Scalar>
+    void LinkTransform(const Scalar &q, Eigen::Matrix<Scalar, 3, 3> &R, Eigen::Matrix<Scalar, 3, 1> &p) const
+    {
+        using std::cos;
+        using std::sin;
+
+        Scalar ct = cos(theta_[I] + q);
+        Scalar st = sin(theta_[I] + q);
+        double ca = cos_alpha_[I];
+        double sa = sin_alpha_[I];
+
+        R << ct, -st, Scalar(0),
+            st * ca, ct * ca, Scalar(-sa),
+            st * sa, ct * sa, Scalar(ca);
+        p << Scalar(a_[I]), Scalar(-sa * d_[I]), Scalar(ca * d_[I]);
+    }
+
+private:
+    double a_[N];
+    double d_[N];
+    double theta_[N];
+    double cos_alpha_[N];
+    double sin_alpha_[N];
+};
+
+/* 本机 JAKA 机械臂标定后的 MDH, 与 config/jaka_mdh.yaml 一致 */
+struct JakaMDHTable
+{
+    static const int kJointNum = 6;
+    static constexpr double kA[6] = {0.0, 0.0, 0.55524, 0.48228, 0.0, 0.0};
+    static constexpr double kD[6] = {0.11987, 0.0, 0.0, -0.11533, 0.11323, 0.10717};
+    static constexpr double kTheta[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    static constexpr double kAlphaDegree[6] = {-0.13, 90.00, 0.28, 0.08, 90.01, -89.83};
+};
+
+typedef StaticMDH<JakaMDHTable> JakaMDH;
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef ROS_PARAM_H
+#define ROS_PARAM_H
+
+#include <string>
+#include <vector>
+#include "Eigen/Core"
+#include "ros/ros.h"
+
+typedef Eigen::Matrix<double, 6, 1> Vector6d;
+typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+
+/**
+ * @brief 各节点共用的参数服务器读取函数
+ *        参数不存在或长度不对时返回 false 并保持原值
+ */
+
+const double PI = 3.1415926;
+
+/* MDH 表 (每行一个关节 a d theta alpha, 单位 mm/deg), 转为 m/rad */
+inline bool LoadMDH(const ros::NodeHandle &n, const std::string &name, Eigen::Matrix<double, 6, 4> &MDH)
+{
+    std::vector<double> table;
+    if (!n.getParam(name, table) || table.size() != 24)
+        return false;
+
+    for (int i = 0; i < 6; i++)
+        MDH.row(i) << table[4 * i] / 1000, table[4 * i + 1] / 1000, table[4 * i + 2] / 180 * PI, table[4 * i + 3] / 180 * PI;
+
+    return true;
+}
+
+/* 6 维参数 */
+inline bool LoadVector6d(const ros::NodeHandle &n, const std::string &name, Vector6d &value)
+{
+    std::vector<double> list;
+    if (!n.getParam(name, list) || list.size() != 6)
+        return false;
+
+    for (int i = 0; i < 6; i++)
+        value(i) = list[i];
+    return true;
+}
+
+/* 6 维对角矩阵参数, 只写对角元 */
+inline bool LoadDiagonal(const ros::NodeHandle &n, const std::string &name, Matrix6d &matrix)
+{
+    Vector6d diagonal = matrix.diagonal();
+    if (!LoadVector6d(n, name, diagonal))
+        return false;
+
+    matrix.diagonal() = diagonal;
+    return true;
+}
+
+#endif
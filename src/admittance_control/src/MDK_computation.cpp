@@ -1,22 +1,262 @@
 #include "ros/ros.h"
 #include <cmath>
+#include <sstream>
 #include "std_msgs/String.h"
 #include "Eigen/Core"
 #include "Eigen/Geometry"
 #include "Eigen/unsupported/MatrixFunctions"
 #include "admittance_control/reconfigureConfig.h"
 #include "dynamic_reconfigure/server.h"
+#include "sensor_msgs/JointState.h"
 #include "dynamic_model.h"
+#include "admittance.h"
 #include "admittance_control/MDK_msg.h"
+#include "admittance_control/MDKUpdate.h"
+#include "admittance_control/HybridForce.h"
 #include "admittance_control/Plot.h"
+#include "ros_param.h"
 
 using namespace std;
 using namespace Eigen;
 
-const double PI = 3.1415926;
+/* 关节状态, 由 JointStateRecord 在 spinOnce 中更新 */
+Vector6d joint_position = Vector6d::Zero();
+ros::Time joint_stamp;
+bool joint_update = false;
 
-void CallbackFunc(admittance_control::reconfigureConfig &ConfigType_obj, uint32_t level, MatrixXd &M, MatrixXd &D, MatrixXd &K, ros::Publisher &MDK_publisher, admittance_control::MDK_msg &MDK)
+void JointStateRecord(const sensor_msgs::JointState::ConstPtr &msg)
 {
+    if (msg->position.size() < 6)
+        return;
+
+    for (int i = 0; i < 6; i++)
+        joint_position(i) = msg->position[i];
+    joint_stamp = msg->header.stamp;
+    joint_update = true;
+}
+
+void PublishMDK(const Matrix6d &M, const Matrix6d &D, const Matrix6d &K, ros::Publisher &MDK_publisher, admittance_control::MDK_msg &MDK)
+{
+    // 列主序, 与 Eigen 默认存储一致, admittance_control 按同样的方式读取
+    Map<Matrix6d>(MDK.M.data()) = M;
+    Map<Matrix6d>(MDK.D.data()) = D;
+    Map<Matrix6d>(MDK.K.data()) = K;
+
+    MDK_publisher.publish(MDK);
+}
+
+/* 力/位混合控制参数整体发布, 力与力矩各一组增益与速度限幅 */
+void PublishHybrid(const admittance_control::reconfigureConfig &config, ros::Publisher &hybrid_publisher)
+{
+    admittance_control::HybridForce hybrid;
+    hybrid.enable = config.hybrid_enable;
+
+    bool selection[6] = {config.select_F_x, config.select_F_y, config.select_F_z, config.select_T_x, config.select_T_y, config.select_T_z};
+    double expected_wrench[6] = {config.Fd_F_x, config.Fd_F_y, config.Fd_F_z, config.Fd_T_x, config.Fd_T_y, config.Fd_T_z};
+    for (int i = 0; i < 6; i++)
+    {
+        hybrid.selection[i] = selection[i] ? 1.0 : 0.0;
+        hybrid.expected_wrench[i] = expected_wrench[i];
+        hybrid.kp[i] = i < 3 ? config.Kp_F : config.Kp_T;
+        hybrid.ki[i] = i < 3 ? config.Ki_F : config.Ki_T;
+        hybrid.max_velocity[i] = i < 3 ? config.V_max_F : config.V_max_T;
+    }
+
+    hybrid_publisher.publish(hybrid);
+}
+
+/**
+ * @brief 动态调参的合并下发: 回调只修改 M, D, K, 每 ~batch_window 由定时器与上次下发的参数比较一次
+ *        非 apparent_mass 模式下变化的元素作为增量 (矩阵, 行, 列, 值) 发布到 /MDK_update, 并每 ~snapshot_period
+ *        发布一次完整参数 (latched), 后启动或丢失增量的 admittance_control 据此重新同步; 预设作为一次完整更新发布
+ *        apparent_mass 模式下 M, D, K 随 /MDK 按周期整体发布, 这里只合并打印
+ */
+struct MDKBatch
+{
+    Matrix6d sent[3];     // 上次下发的 M, D, K
+    uint32_t sequence;
+    bool full_pending;    // 下一次合并整体下发, 如加载了预设
+    string preset;        // 当前的预设名
+    bool publish;         // 非 apparent_mass 模式
+    double damping_ratio; // > 0 时由 M, K 按阻尼比计算下发的 D, 见 DampingFromRatio
+    bool preset_damping;  // 当前预设给出了 damping, 不按阻尼比替换
+    ros::Publisher publisher;
+};
+
+/**
+ * @brief 每周期: 末端质量矩阵 -> M, 阻尼比 -> D, 发布 /MDK; 计算耗时超过周期时告警
+ *        D 的规则与 FlushMDK 相同: damping_ratio 为 0 (默认) 或预设给出了 damping 时使用动态调参的 D
+ *        Dynamics 为编译期 MDH 的 JakaDynamics 或运行期加载的 RobotDynamics
+ */
+template <class Dynamics>
+void ApparentMassLoop(Dynamics &dynamics, const MatrixXd &M, const MatrixXd &D, const MatrixXd &K, double mass_scale, const MDKBatch &batch,
+                      double loop_rate, ros::Publisher &MDK_publisher, admittance_control::MDK_msg &MDK)
+{
+    Matrix6d task_mass_matrix, M_once, D_once;
+    ros::Rate rate(loop_rate);
+
+    while (ros::ok())
+    {
+        ros::spinOnce();
+
+        if (joint_update)
+        {
+            joint_update = false;
+            ros::WallTime start = ros::WallTime::now();
+
+            if (dynamics.TaskMassMatrix(joint_position, task_mass_matrix))
+            {
+                M_once = mass_scale * task_mass_matrix + M;
+                D_once = DampingFromRatio(M_once, K, D, batch.preset_damping ? 0 : batch.damping_ratio);
+                PublishMDK(M_once, D_once, K, MDK_publisher, MDK);
+            }
+            else
+                ROS_WARN_THROTTLE(1, "jacobian is close to singular, keep the last MDK");
+
+            double elapsed = (ros::WallTime::now() - start).toSec();
+            if (elapsed > 1.0 / loop_rate)
+                ROS_WARN_THROTTLE(1, "MDK computation took %.3f ms, over the %.3f ms cycle", elapsed * 1e3, 1e3 / loop_rate);
+        }
+
+        rate.sleep();
+    }
+}
+
+/**
+ * @brief 合并一次: 与上次下发的参数比较, 有变化时发布一条 MDKUpdate 并打印变化的元素
+ * @param full 整体下发 (周期性的重新同步), 不打印
+ */
+void FlushMDK(const MatrixXd &M, const MatrixXd &D, const MatrixXd &K, MDKBatch &batch, bool full)
+{
+    // 只替换下发的 D, 动态调参的 D 保持不变
+    double damping_ratio = batch.publish && !batch.preset_damping ? batch.damping_ratio : 0;
+
+    const char *names[3] = {"M", "D", "K"};
+    Matrix6d current[3] = {M, DampingFromRatio(M, K, D, damping_ratio), K};
+    bool whole = full || batch.full_pending;
+
+    admittance_control::MDKUpdate update;
+    ostringstream changes;
+    int change_count = 0;
+    for (int m = 0; m < 3; m++)
+        for (int j = 0; j < 6; j++)
+            for (int i = 0; i < 6; i++)
+            {
+                bool changed = current[m](i, j) != batch.sent[m](i, j);
+                if (changed && change_count++ < 6)
+                    changes << " " << names[m] << "(" << i << "," << j << ") " << batch.sent[m](i, j) << " -> " << current[m](i, j);
+                if (!changed && !whole)
+                    continue;
+                update.matrix.push_back(m);
+                update.row.push_back(i);
+                update.col.push_back(j);
+                update.value.push_back(current[m](i, j));
+            }
+    if (update.matrix.empty())
+        return;
+
+    if (batch.publish)
+    {
+        update.sequence = ++batch.sequence;
+        update.full = whole;
+        update.preset = batch.full_pending ? batch.preset : "";
+        batch.publisher.publish(update);
+    }
+
+    if (batch.full_pending)
+        ROS_INFO("MDK update %u: preset '%s'", batch.sequence, batch.preset.c_str());
+    else if (change_count > 0 && !full)
+        ROS_INFO("MDK update %u:%s%s", batch.sequence, changes.str().c_str(), change_count > 6 ? " ..." : "");
+
+    for (int m = 0; m < 3; m++)
+        batch.sent[m] = current[m];
+    batch.full_pending = false;
+}
+
+/**
+ * @brief 读取 ~presets/<name>/mass, damping, stiffness: 6 个值为对角, 36 个值为完整矩阵 (按行);
+ *        缺少的项保持不变, 任一项长度不对时不修改并返回 false; has_damping 返回预设是否给出了 damping
+ */
+bool LoadPreset(const ros::NodeHandle &n, const string &name, MatrixXd &M, MatrixXd &D, MatrixXd &K, bool &has_damping)
+{
+    const char *fields[3] = {"mass", "damping", "stiffness"};
+    MatrixXd loaded[3] = {M, D, K};
+    bool found = false;
+    for (int m = 0; m < 3; m++)
+    {
+        vector<double> list;
+        if (!n.getParam("presets/" + name + "/" + fields[m], list))
+            continue;
+
+        if (list.size() == 6)
+            loaded[m] = Map<Vector6d>(list.data()).asDiagonal();
+        else if (list.size() == 36)
+            loaded[m] = Map<Matrix<double, 6, 6, RowMajor>>(list.data());
+        else
+        {
+            ROS_WARN("preset %s: %s needs 6 or 36 values, got %d", name.c_str(), fields[m], (int)list.size());
+            return false;
+        }
+        found = true;
+    }
+    if (!found)
+        return false;
+
+    M = loaded[0];
+    D = loaded[1];
+    K = loaded[2];
+    has_damping = n.hasParam("presets/" + name + "/damping");
+    return true;
+}
+
+/* 滑块显示预设的对角元素 */
+void SyncSliders(admittance_control::reconfigureConfig &config, const MatrixXd &M, const MatrixXd &D, const MatrixXd &K)
+{
+    double *sliders[18] = {&config.M_F_x, &config.M_F_y, &config.M_F_z, &config.M_T_x, &config.M_T_y, &config.M_T_z,
+                           &config.D_F_x, &config.D_F_y, &config.D_F_z, &config.D_T_x, &config.D_T_y, &config.D_T_z,
+                           &config.K_F_x, &config.K_F_y, &config.K_F_z, &config.K_T_x, &config.K_T_y, &config.K_T_z};
+    for (int i = 0; i < 6; i++)
+    {
+        *sliders[i] = M(i, i);
+        *sliders[6 + i] = D(i, i);
+        *sliders[12 + i] = K(i, i);
+    }
+}
+
+/**
+ * @brief 动态调参回调, 滑块只修改 M, D, K 的对角元素, 下发与打印由 FlushMDK 合并
+ *        apparent_mass 模式下 M 为叠加在末端质量矩阵上的虚拟质量, 由主循环计算并发布
+ *        level 18 为力/位混合控制参数, 整体发布到 /hybrid_force; 启动时的首次回调 (level 全 1) 同样发布
+ *        preset 改变时整体加载 ~presets 下的同名参数 (可为非对角矩阵), 下一次合并时作为一次完整更新下发
+ */
+void CallbackFunc(admittance_control::reconfigureConfig &ConfigType_obj, uint32_t level, MatrixXd &M, MatrixXd &D, MatrixXd &K,
+                  const ros::NodeHandle &private_n, MDKBatch &batch, ros::Publisher &hybrid_publisher)
+{
+    if (level == 18 || level > 19)
+    {
+        PublishHybrid(ConfigType_obj, hybrid_publisher);
+        if (level == 18)
+            return;
+    }
+
+    if (ConfigType_obj.preset != batch.preset)
+    {
+        bool has_damping = false;
+        if (ConfigType_obj.preset.empty() || LoadPreset(private_n, ConfigType_obj.preset, M, D, K, has_damping))
+        {
+            batch.preset = ConfigType_obj.preset;
+            batch.preset_damping = has_damping;
+            batch.full_pending = !batch.preset.empty();
+            SyncSliders(ConfigType_obj, M, D, K);
+        }
+        else
+        {
+            ROS_WARN("preset '%s' not found under ~presets", ConfigType_obj.preset.c_str());
+            ConfigType_obj.preset = batch.preset;
+        }
+        return;
+    }
+
     switch (level)
     {
     case 0:
@@ -74,21 +314,6 @@ void CallbackFunc(admittance_control::reconfigureConfig &ConfigType_obj, uint32_
         K(5, 5) = ConfigType_obj.K_T_z;
         break;
     }
-
-    // D = M * K;
-    // D = 2 * D.sqrt();
-
-    memcpy(&(MDK.M), M.data(), 8 * 36);
-    memcpy(&(MDK.D), D.data(), 8 * 36);
-    memcpy(&(MDK.K), K.data(), 8 * 36);
-
-    MDK_publisher.publish(MDK);
-
-    // cout << "M^-1:" << M.inverse() << endl;
-    cout << level << endl;
-    cout << "M修改为:" << M << endl;
-    cout << "D修改为:" << D << endl;
-    cout << "K修改为:" << K << endl;
 }
 
 int main(int argc, char **argv)
@@ -96,30 +321,47 @@ int main(int argc, char **argv)
     ros::init(argc, argv, "MDK_computation");
 
     ros::NodeHandle n;
+    ros::NodeHandle private_n("~");
 
     MatrixXd M(6, 6);
     MatrixXd D(6, 6);
     MatrixXd K(6, 6);
 
-    MatrixXd MDH(6, 4);
-    VectorXd dynamic_parameter(60);
-    VectorXd expected_joint(6);
+    Matrix<double, 6, 4> MDH;
+    Matrix<double, 60, 1> dynamic_parameter;
 
     admittance_control::MDK_msg MDK;
 
+    /*
+     * apparent_mass: 每周期由实时关节角计算末端质量矩阵 mass_scale * J^-T * M_q * J^-1, 加上动态调参的 M 对角项
+     * damping_ratio: 默认 0, 使用动态调参或预设给出的 D; 显式设为 > 0 时由 M, K 按该阻尼比计算 D,
+     *                但给出了 damping 的预设与 K 为零的轴仍使用显式的 D
+     * mdh, dynamic_parameter: 运行期加载的 MDH 表 (如 config/ur5_mdh.yaml) 与 60 个动力学参数,
+     *                         未给出 mdh 时使用编译期的本机 MDH (JakaMDH)
+     */
+    bool apparent_mass;
+    double damping_ratio;
+    double mass_scale;
+    double loop_rate;
+    double batch_window;
+    double snapshot_period;
+    private_n.param("apparent_mass", apparent_mass, true);
+    private_n.param("damping_ratio", damping_ratio, 0.0);
+    private_n.param("mass_scale", mass_scale, 1.0);
+    private_n.param("rate", loop_rate, 1000.0);
+    // 动态调参的合并窗口与完整参数的重发周期 (s), 见 MDKBatch
+    private_n.param("batch_window", batch_window, 0.05);
+    private_n.param("snapshot_period", snapshot_period, 1.0);
+
     ros::Publisher MDK_publisher = n.advertise<admittance_control::MDK_msg>("/MDK", 10);
+    // latched, 最后一条通常是周期性的完整参数
+    ros::Publisher MDK_update_publisher = n.advertise<admittance_control::MDKUpdate>("/MDK_update", 10, true);
+    // latched, admittance_control 启动晚于本节点时也能收到
+    ros::Publisher hybrid_publisher = n.advertise<admittance_control::HybridForce>("/hybrid_force", 1, true);
     ros::Publisher plot_pub = n.advertise<admittance_control::Plot>("/plot_data", 100);
+    ros::Subscriber joint_state_sub = n.subscribe<sensor_msgs::JointState>("/robot_driver/joint_states", 1, &JointStateRecord);
 
     /*计算末端质量矩阵*/
-    expected_joint << 0.16522547684382893, 2.026115249482023, 1.9502954394352305, 0.7277293271572154, -1.5764709940311654, 1.7271638412619614;
-    // a d theta alpha
-    MDH << 0.0, 119.87 / 1000, expected_joint(0), -0.13 / 180 * PI,
-        0.0, 0.0, expected_joint(1), 90.00 / 180 * PI,
-        555.24 / 1000, 0.0, expected_joint(2), 0.28 / 180 * PI,
-        482.28 / 1000, -115.33 / 1000, expected_joint(3), 0.08 / 180 * PI,
-        0.0, 113.23 / 1000, expected_joint(4), 90.01 / 180 * PI,
-        0.0, 107.17 / 1000, expected_joint(5), -89.83 / 180 * PI;
-
     dynamic_parameter << 0, 0, 0, 0, 0, 9.7748, -3.4619, 0.0707, 0.3706, 0,
         0.2326, 7.9749, -1.6275, -0.0187, 0.2293, 0, -0.0997, 1.4314, 0.0172, 0.0085,
         0.0193, 0, 0.0333, 0.0301, 0.0081, 0.0051, 1.0000e-04, 0, -0.0127, 0.0154,
@@ -127,7 +369,17 @@ int main(int argc, char **argv)
         5.8022, 0.0472, 0, 0, 2.4664, 0.0436, 0, 0, 0.0039, -0.2274,
         0, 0, 0.0027, 0.0486, 0, 0, 0.0016, 2.0000e-04, 0, 0;
 
-    // M = MassMatrixComputation(MDH, dynamic_parameter);
+    vector<double> parameter_list;
+    if (private_n.getParam("dynamic_parameter", parameter_list))
+    {
+        if (parameter_list.size() == 60)
+            dynamic_parameter = Map<Matrix<double, 60, 1>>(parameter_list.data());
+        else
+            ROS_WARN("dynamic_parameter needs 60 values, got %d, keep the default", (int)parameter_list.size());
+    }
+
+    bool runtime_mdh = LoadMDH(private_n, "mdh", MDH);
+
     M = MatrixXd::Identity(6, 6);
     D = MatrixXd::Identity(6, 6);
     K = MatrixXd::Identity(6, 6);
@@ -144,24 +396,51 @@ int main(int argc, char **argv)
         D(i, i) = D_array[i];
     }
 
-    // D = M * K;
-    // D = 2 * D.sqrt();
-
-    memcpy(&(MDK.M), M.data(), 8 * 36);
-    memcpy(&(MDK.D), D.data(), 8 * 36);
-    memcpy(&(MDK.K), K.data(), 8 * 36);
-
-    MDK_publisher.publish(MDK);
+    MDKBatch batch;
+    batch.sequence = 0;
+    batch.full_pending = false;
+    batch.publish = !apparent_mass;
+    batch.damping_ratio = damping_ratio;
+    batch.preset_damping = false;
+    batch.publisher = MDK_update_publisher;
+    batch.sent[0] = M;
+    batch.sent[1] = D;
+    batch.sent[2] = K;
 
     /*动态调参服务*/
     dynamic_reconfigure::Server<admittance_control::reconfigureConfig> server;
     dynamic_reconfigure::Server<admittance_control::reconfigureConfig>::CallbackType Callback;
-    Callback = boost::bind(&CallbackFunc, _1, _2, M, D, K, MDK_publisher, MDK);
+    // 参数超过 boost::bind 的上限, 以 lambda 转发
+    Callback = [&](admittance_control::reconfigureConfig &config, uint32_t level) {
+        CallbackFunc(config, level, M, D, K, private_n, batch, hybrid_publisher);
+    };
     server.setCallback(Callback);
 
-    // cout << "M^-1:" << M.inverse() << endl;
+    ros::WallTimer batch_timer = n.createWallTimer(ros::WallDuration(batch_window), [&](const ros::WallTimerEvent &) {
+        FlushMDK(M, D, K, batch, false);
+    });
+
+    if (!apparent_mass)
+    {
+        FlushMDK(M, D, K, batch, true);
+        ros::WallTimer snapshot_timer = n.createWallTimer(ros::WallDuration(snapshot_period), [&](const ros::WallTimerEvent &) {
+            FlushMDK(M, D, K, batch, true);
+        });
+        ros::spin();
+
+        return 0;
+    }
 
-    ros::spin();
+    if (runtime_mdh)
+    {
+        RobotDynamics dynamics(MDH, dynamic_parameter);
+        ApparentMassLoop(dynamics, M, D, K, mass_scale, batch, loop_rate, MDK_publisher, MDK);
+    }
+    else
+    {
+        JakaDynamics dynamics(dynamic_parameter);
+        ApparentMassLoop(dynamics, M, D, K, mass_scale, batch, loop_rate, MDK_publisher, MDK);
+    }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,277 @@
+#include "admittance.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Eigen/LU"
+#include "Eigen/Eigenvalues"
+#include "Eigen/unsupported/MatrixFunctions"
+
+using namespace Eigen;
+
+double AngularPI(double angular)
+{
+    return AngularPI<double>(angular);
+}
+
+Matrix6d DampingFromMassStiffness(const Matrix6d &M, const Matrix6d &K, double damping_ratio)
+{
+    SelfAdjointEigenSolver<Matrix6d> mass_solver(M);
+    Matrix6d mass_sqrt = mass_solver.operatorSqrt();
+    Matrix6d mass_inverse_sqrt = mass_solver.operatorInverseSqrt();
+
+    // K 含零刚度轴时特征值可能为极小的负数, 截断为 0 后开方, 避免 NaN
+    SelfAdjointEigenSolver<Matrix6d> stiffness_solver(mass_inverse_sqrt * K * mass_inverse_sqrt);
+    Matrix6d stiffness_sqrt = stiffness_solver.eigenvectors() *
+                              stiffness_solver.eigenvalues().cwiseMax(0).cwiseSqrt().asDiagonal() *
+                              stiffness_solver.eigenvectors().transpose();
+    Matrix6d D = 2 * damping_ratio * mass_sqrt * stiffness_sqrt * mass_sqrt;
+
+    return 0.5 * (D + D.transpose());
+}
+
+Matrix6d DampingFromRatio(const Matrix6d &M, const Matrix6d &K, const Matrix6d &D, double damping_ratio)
+{
+    if (damping_ratio <= 0)
+        return D;
+
+    Matrix6d D_ratio = DampingFromMassStiffness(M, K, damping_ratio);
+    for (int i = 0; i < 6; i++)
+    {
+        if (K(i, i) > 0)
+            continue;
+
+        D_ratio.row(i) = D.row(i);
+        D_ratio.col(i) = D.col(i);
+    }
+
+    return D_ratio;
+}
+
+void DiscretizeAdmittance(const Matrix6d &M, const Matrix6d &D, const Matrix6d &K, double dt,
+                          Matrix<double, 12, 12> &Phi, Matrix<double, 12, 6> &Gamma)
+{
+    Matrix6d M_inverse = M.inverse();
+
+    /*exp([A B; 0 0] * dt) = [Phi Gamma; 0 I], A = [0 I; -M^-1 K  -M^-1 D], B = [0; M^-1]*/
+    Matrix<double, 18, 18> augmented = Matrix<double, 18, 18>::Zero();
+    augmented.block<6, 6>(0, 6) = Matrix6d::Identity();
+    augmented.block<6, 6>(6, 0) = -M_inverse * K;
+    augmented.block<6, 6>(6, 6) = -M_inverse * D;
+    augmented.block<6, 6>(6, 12) = M_inverse;
+
+    Matrix<double, 18, 18> exponential = (augmented * dt).exp();
+    Phi = exponential.block<12, 12>(0, 0);
+    Gamma = exponential.block<12, 6>(0, 12);
+}
+
+void PrepareAdmittanceParameters(const Matrix6d &M, const Matrix6d &D, const Matrix6d &K, double dt,
+                                 AdmittanceParameters &parameters)
+{
+    parameters.M = M;
+    parameters.D = D;
+    parameters.K = K;
+    parameters.M_inverse = M.inverse();
+    parameters.dt = dt;
+    if (dt > 0)
+        DiscretizeAdmittance(M, D, K, dt, parameters.Phi, parameters.Gamma);
+}
+
+Matrix4d Pose2HomogeneousTransform(const Vector6d &pose)
+{
+    return Pose2HomogeneousTransform<double>(pose);
+}
+
+Vector6d HomogeneousTransform2Pose(const Matrix4d &homogeneous_transform)
+{
+    return HomogeneousTransform2Pose<double>(homogeneous_transform);
+}
+
+Admittance::Admittance()
+    : integration_(EXACT), discrete_valid_(false), discrete_dt_(0)
+{
+    M_ = Matrix6d::Zero();
+    D_ = Matrix6d::Zero();
+    K_ = Matrix6d::Zero();
+    SetMDK(Matrix6d::Identity(), Matrix6d::Identity(), Matrix6d::Identity());
+    SetSensor(WrenchCompensation(), Matrix6d::Identity());
+    expected_wrench_ = Vector6d::Zero();
+    selection_ = Vector6d::Zero();
+    force_kp_ = Vector6d::Zero();
+    force_ki_ = Vector6d::Zero();
+    force_max_velocity_ = Vector6d::Zero();
+    Reset(Vector6d::Zero());
+}
+
+void Admittance::SetMDK(const Matrix6d &M, const Matrix6d &D, const Matrix6d &K)
+{
+    if (M == M_ && D == D_ && K == K_)
+        return;
+
+    discrete_valid_ = false;
+    M_ = M;
+    D_ = D;
+    K_ = K;
+    M_inverse_ = M.inverse();
+}
+
+void Admittance::SetParameters(const AdmittanceParameters &parameters)
+{
+    M_ = parameters.M;
+    D_ = parameters.D;
+    K_ = parameters.K;
+    M_inverse_ = parameters.M_inverse;
+
+    discrete_valid_ = parameters.dt > 0;
+    if (discrete_valid_)
+    {
+        Phi_ = parameters.Phi;
+        Gamma_ = parameters.Gamma;
+        discrete_dt_ = parameters.dt;
+    }
+}
+
+void Admittance::SetSensor(const WrenchCompensation &compensation, const Matrix6d &jacobian_sensor2end)
+{
+    compensation_ = compensation;
+    jacobian_sensor2end_ = jacobian_sensor2end;
+}
+
+void Admittance::SetSensor(const Vector6d &zero_drift_compensation, const Vector3d &centroid_sensor,
+                           const Vector3d &G_basis, const Matrix6d &jacobian_sensor2end)
+{
+    WrenchCompensation compensation;
+    compensation.setCalibration(G_basis(2), centroid_sensor.data(), zero_drift_compensation.data());
+    SetSensor(compensation, jacobian_sensor2end);
+}
+
+void Admittance::SetZeroDrift(const Vector6d &zero_drift)
+{
+    compensation_.setCalibration(compensation_.gravity(), compensation_.centroid(), zero_drift.data());
+}
+
+void Admittance::SetHybrid(const Vector6d &selection, const Vector6d &kp, const Vector6d &ki, const Vector6d &max_velocity)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        double select = selection(i) != 0 ? 1.0 : 0.0;
+        if (select != selection_(i))
+            force_integral_(i) = 0;
+        selection_(i) = select;
+    }
+    force_kp_ = kp;
+    force_ki_ = ki;
+    force_max_velocity_ = max_velocity.cwiseAbs();
+}
+
+void Admittance::Reset(const Vector6d &pose)
+{
+    pre_homogeneous_transform_ = Pose2HomogeneousTransform(pose);
+    reference_transform_ = pre_homogeneous_transform_;
+    state_ = Matrix<double, 12, 1>::Zero();
+    pre_delta_pose_ = Vector6d::Zero();
+
+    external_wrench_sensor_ = Vector6d::Zero();
+    delta_wrench_ = Vector6d::Zero();
+    delta_pose_ = Vector6d::Zero();
+    delta_pose_velocity_ = Vector6d::Zero();
+    delta_pose_acceleration_ = Vector6d::Zero();
+    force_integral_ = Vector6d::Zero();
+}
+
+Vector6d Admittance::Step(const Vector6d &current_pose, const Vector6d &FTsensor_data, double dt)
+{
+    Matrix<double, 3, 3, RowMajor> rotation_basis2end = Pose2HomogeneousTransform(current_pose).block<3, 3>(0, 0);
+
+    /*计算传感器外力*/
+    Vector6d external_wrench_sensor;
+    compensation_.compensate(rotation_basis2end.data(), FTsensor_data.data(), external_wrench_sensor.data());
+
+    return StepWithExternalWrench(current_pose, external_wrench_sensor, dt);
+}
+
+double Admittance::ForceLoopVelocity(int i, double dt)
+{
+    double error = delta_wrench_(i);
+    double limit = force_max_velocity_(i);
+    double velocity = force_kp_(i) * error + force_integral_(i) + force_ki_(i) * error * dt;
+    // 输出饱和且误差仍推向饱和方向时不积分
+    if (std::abs(velocity) <= limit || velocity * error < 0)
+        force_integral_(i) = std::max(-limit, std::min(limit, force_integral_(i) + force_ki_(i) * error * dt));
+
+    return std::max(-limit, std::min(limit, force_kp_(i) * error + force_integral_(i)));
+}
+
+Vector6d Admittance::StepWithExternalWrench(const Vector6d &current_pose, const Vector6d &external_wrench_sensor, double dt)
+{
+    external_wrench_sensor_ = external_wrench_sensor;
+    delta_wrench_ = jacobian_sensor2end_ * (external_wrench_sensor_ - expected_wrench_);
+
+    if (integration_ == EXACT)
+    {
+        if (!discrete_valid_ || dt != discrete_dt_)
+        {
+            DiscretizeAdmittance(M_, D_, K_, dt, Phi_, Gamma_);
+            discrete_valid_ = true;
+            discrete_dt_ = dt;
+        }
+
+        Vector6d pre_x = state_.head<6>();
+        state_ = Phi_ * state_ + Gamma_ * delta_wrench_;
+
+        /*力控轴: PI 力环给出速度, 替换导纳的状态*/
+        for (int i = 0; i < 6; i++)
+            if (selection_(i) != 0)
+            {
+                double velocity = ForceLoopVelocity(i, dt);
+                state_(i) = pre_x(i) + velocity * dt;
+                state_(6 + i) = velocity;
+            }
+
+        delta_pose_ = state_.head<6>();
+        delta_pose_velocity_ = state_.tail<6>();
+        delta_pose_acceleration_ = M_inverse_ * (delta_wrench_ - D_ * delta_pose_velocity_ - K_ * delta_pose_);
+
+        return HomogeneousTransform2Pose(Matrix4d(reference_transform_ * Pose2HomogeneousTransform(delta_pose_)));
+    }
+
+    Matrix4d homogeneous_transform_current = Pose2HomogeneousTransform(current_pose);
+
+    /*计算xt,dotxt,dotdotxt*/
+    Matrix4d delta_homogeneous_transform = homogeneous_transform_current.inverse() * pre_homogeneous_transform_;
+    delta_pose_ = -HomogeneousTransform2Pose(delta_homogeneous_transform);
+    delta_pose_velocity_ = (delta_pose_ - pre_delta_pose_) / dt;
+    delta_pose_acceleration_ = M_inverse_ * (delta_wrench_ - D_ * delta_pose_velocity_ - K_ * delta_pose_);
+
+    pre_homogeneous_transform_ = homogeneous_transform_current;
+    pre_delta_pose_ = delta_pose_;
+
+    /*计算xt+1,期望位姿*/
+    delta_pose_ = delta_pose_ + delta_pose_velocity_ * dt + delta_pose_acceleration_ * dt * dt;
+
+    /*力控轴: PI 力环给出速度, 替换导纳的步进量*/
+    for (int i = 0; i < 6; i++)
+        if (selection_(i) != 0)
+            delta_pose_(i) = ForceLoopVelocity(i, dt) * dt;
+
+    return HomogeneousTransform2Pose(homogeneous_transform_current * Pose2HomogeneousTransform(delta_pose_));
+}
+
+void Admittance::Limit(const Vector6d &limited_pose)
+{
+    if (integration_ != EXACT)
+        return;
+
+    Vector6d x = HomogeneousTransform2Pose(Matrix4d(reference_transform_.inverse() * Pose2HomogeneousTransform(limited_pose)));
+    for (int i = 0; i < 6; i++)
+    {
+        // 被限制的轴: 原状态在约束外, 速度仍向外时清零
+        double excess = state_(i) - x(i);
+        if (std::abs(excess) > 1e-9 && excess * state_(6 + i) > 0)
+            state_(6 + i) = 0;
+        state_(i) = x(i);
+    }
+
+    delta_pose_ = state_.head<6>();
+    delta_pose_velocity_ = state_.tail<6>();
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include "admittance.h"
+
+using namespace std;
+using namespace Eigen;
+
+/**
+ * 导纳离散化对比 (EULER: 原有差分方式, EXACT: 零阶保持精确离散化):
+ *   1. 阶跃响应: 机器人理想跟踪期望位姿, 末端 z 向恒定外力 F, 各控制频率下的超调与稳态 (应为 F / K)
+ *   2. 每周期耗时与 MDK 变化时重新离散化的耗时 (us)
+ * 用法: admittance_benchmark [steps]
+ */
+
+double Seconds(const chrono::steady_clock::time_point &start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+struct StepResponse
+{
+    double final_z;
+    double max_z;
+    bool diverged;
+};
+
+StepResponse Simulate(Admittance::Integration integration, const Matrix6d &M, const Matrix6d &D, const Matrix6d &K,
+                      const Vector6d &wrench, double rate, double duration)
+{
+    Admittance admittance;
+    admittance.SetIntegration(integration);
+    admittance.SetMDK(M, D, K);
+    Vector6d pose = Vector6d::Zero();
+    admittance.Reset(pose);
+
+    StepResponse response = {0, 0, false};
+    double dt = 1.0 / rate;
+    for (int k = 0; k < (int)(duration * rate); k++)
+    {
+        pose = admittance.StepWithExternalWrench(pose, wrench, dt);
+        if (!pose.allFinite() || fabs(pose(2)) > 1.0)
+        {
+            response.diverged = true;
+            break;
+        }
+        response.max_z = fmax(response.max_z, pose(2));
+    }
+    response.final_z = pose(2);
+    return response;
+}
+
+void Print(const char *name, const StepResponse &response)
+{
+    cout << name;
+    if (response.diverged)
+        cout << "diverged             ";
+    else
+        cout << "final " << response.final_z << " max " << response.max_z;
+}
+
+int main(int argc, char **argv)
+{
+    int steps = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    /*刚度较大的接触工况: 自然频率约 16 Hz, 阻尼比 0.7*/
+    Matrix6d M = Matrix6d::Identity() * 2.0;
+    Matrix6d K = Matrix6d::Identity() * 20000.0;
+    Matrix6d D = DampingFromMassStiffness(M, K, 0.7);
+    Vector6d wrench = Vector6d::Zero();
+    wrench(2) = 10.0;
+    double expected_z = wrench(2) / K(2, 2);
+
+    bool pass = true;
+    const double rates[] = {10, 100, 1000};
+    cout << "step response, F_z = " << wrench(2) << " N, K_z = " << K(2, 2) << " N/m, expected z = " << expected_z << " m" << endl;
+    cout << setprecision(4) << scientific;
+    for (double rate : rates)
+    {
+        StepResponse euler = Simulate(Admittance::EULER, M, D, K, wrench, rate, 3.0);
+        StepResponse exact = Simulate(Admittance::EXACT, M, D, K, wrench, rate, 3.0);
+        cout << fixed << setprecision(0) << setw(5) << rate << " Hz  " << scientific << setprecision(4);
+        Print("euler: ", euler);
+        Print("  |  exact: ", exact);
+        cout << endl;
+        pass = pass && !exact.diverged && fabs(exact.final_z - expected_z) < 1e-6 * expected_z + 1e-12;
+    }
+
+    Admittance euler, exact;
+    euler.SetIntegration(Admittance::EULER);
+    euler.SetMDK(M, D, K);
+    exact.SetMDK(M, D, K);
+    euler.Reset(Vector6d::Zero());
+    exact.Reset(Vector6d::Zero());
+    double dt = 0.001, sink = 0;
+    Vector6d small_wrench = wrench * 1e-3;
+
+    Vector6d pose = Vector6d::Zero();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int k = 0; k < steps; k++)
+        pose = euler.StepWithExternalWrench(pose, small_wrench, dt);
+    double euler_step = Seconds(start) / steps * 1e6;
+    sink += pose(2);
+
+    pose = Vector6d::Zero();
+    start = chrono::steady_clock::now();
+    for (int k = 0; k < steps; k++)
+        pose = exact.StepWithExternalWrench(pose, small_wrench, dt);
+    double exact_step = Seconds(start) / steps * 1e6;
+    sink += pose(2);
+
+    Matrix<double, 12, 12> Phi;
+    Matrix<double, 12, 6> Gamma;
+    int discretizations = steps / 1000 + 1;
+    start = chrono::steady_clock::now();
+    for (int k = 0; k < discretizations; k++)
+    {
+        DiscretizeAdmittance(M, D, K, dt * (1 + k % 2), Phi, Gamma);
+        sink += Phi(0, 0);
+    }
+    double discretize = Seconds(start) / discretizations * 1e6;
+
+    cout << fixed << setprecision(4);
+    cout << "euler step        (us): " << euler_step << endl;
+    cout << "exact step        (us): " << exact_step << endl;
+    cout << "discretize on MDK (us): " << discretize << endl;
+    cout << "(" << sink << ")" << endl;
+    cout << (pass ? "PASS" : "FAIL") << endl;
+
+    return pass ? 0 : 1;
+}
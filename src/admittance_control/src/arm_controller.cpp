@@ -0,0 +1,627 @@
+#include "arm_controller.h"
+
+#include <cmath>
+#include <vector>
+#include "robot_msgs/Move.h"
+#include "robot_msgs/MotionAbort.h"
+#include "ros_param.h"
+
+using namespace std;
+using namespace Eigen;
+
+namespace
+{
+bool CallMoveLine(ros::ServiceClient &client, const Vector6d &pose)
+{
+    robot_msgs::Move srv;
+    srv.request.is_block = true;
+    srv.request.mvvelo = 0.1;
+    srv.request.mvacc = 0.1;
+    for (int i = 0; i < 6; i++)
+        srv.request.pose.push_back(pose(i));
+
+    return client.call(srv);
+}
+} // namespace
+
+ArmController::ArmController(const string &name)
+    : name_(name), prefix_(name.empty() ? "" : "/" + name),
+      callback_thread_started_(false), shutdown_(false), active_(false),
+      joint_received_(false), safety_tripped_(false), hybrid_update_(false), hybrid_enable_(false),
+      control_period_(0.1), MDK_sequence_(0), MDK_synchronized_(false),
+      gain_schedule_(false), max_pose_age_(0.1), safety_tripped_once_(false), sensed_(false), has_expected_pose_(false)
+{
+    pthread_mutex_init(&mutex_, NULL);
+
+    M_received_ = Matrix6d::Zero();
+    D_received_ = Matrix6d::Zero();
+    K_received_ = Matrix6d::Zero();
+    double M_array[6] = {100, 100, 150, 1, 1, 20};
+    double D_array[6] = {500, 500, 500, 20, 20, 50};
+    double K_array[6] = {80, 100, 200, 10, 10, 50};
+    for (int i = 0; i < 6; i++)
+    {
+        M_received_(i, i) = M_array[i];
+        K_received_(i, i) = K_array[i];
+        // D_received_(i, i) = 2 * sqrt(M_array[i] * K_array[i]);
+        D_received_(i, i) = D_array[i];
+    }
+
+    FTsensor_data_ = Vector6d::Zero();
+    tool_point_ = Vector6d::Zero();
+    joint_position_ = Vector6d::Zero();
+    hybrid_selection_ = Vector6d::Zero();
+    hybrid_expected_wrench_ = Vector6d::Zero();
+    hybrid_kp_ = Vector6d::Zero();
+    hybrid_ki_ = Vector6d::Zero();
+    hybrid_max_velocity_ = Vector6d::Zero();
+    max_bias_std_ << 0.1, 0.1, 0.1, 0.005, 0.005, 0.005;
+
+    jacobian_sensor2end_ = Matrix6d::Identity();
+    jacobian_sensor2end_(3, 1) = -28.6 / 1000.0;
+    jacobian_sensor2end_(4, 0) = 28.6 / 1000.0;
+
+    approach_pose_ = Vector6d::Zero();
+    start_pose_ = Vector6d::Zero();
+    current_pose_ = Vector6d::Zero();
+    FTsensor_data_once_ = Vector6d::Zero();
+    joint_position_once_ = Vector6d::Zero();
+    expected_wrench_ << 0, 0, -5, 0, 0, 0;
+    external_wrench_end_ = Vector6d::Zero();
+    expected_pose_ = Vector6d::Zero();
+}
+
+ArmController::~ArmController()
+{
+    shutdown_ = true;
+    if (callback_thread_started_)
+        pthread_join(callback_thread_, NULL);
+    pthread_mutex_destroy(&mutex_);
+}
+
+bool ArmController::Initialize(ros::NodeHandle &n, const ros::NodeHandle &private_n)
+{
+    param_n_ = name_.empty() ? private_n : ros::NodeHandle(private_n, name_);
+
+    /*起始位姿: 先到 approach_pose 再直线到 start_pose; 单臂时默认沿用原有位姿*/
+    if (name_.empty())
+    {
+        approach_pose_ << -0.699384694946, 0.0029545274708, 0.16970396014, 3.14058525409, 0.0026023751631, 0.0105711930739;
+        start_pose_ << -0.698439031234, 0.00107985579317, 0.147448071114, -3.1372717645, 0.00903196524481, 0.00885404342115;
+    }
+    bool has_start_pose = LoadVector6d(param_n_, "start_pose", start_pose_);
+    if (!LoadVector6d(param_n_, "approach_pose", approach_pose_) && has_start_pose)
+        approach_pose_ = start_pose_;
+    if (!name_.empty() && !has_start_pose)
+    {
+        ROS_ERROR("%s: ~%s/start_pose not set", name_.c_str(), name_.c_str());
+        return false;
+    }
+
+    // 负载重力/质心/零漂, 与 netft_utils 共用 config/payload_calibration.yaml
+    if (!force_recorder_.Payload().loadCalibration(n, name_.empty() ? "payload" : name_ + "/payload"))
+    {
+        // 未加载标定文件时使用原有标定值
+        const double zero_drift_compensation[6] = {-5.49, -2.99, -0.21, -0.393, 0.172, -0.157};
+        const double centroid_sensor[3] = {0.000226404, -4.35079e-05, 0.00441495};
+        force_recorder_.Payload().setCalibration(-18.9807, centroid_sensor, zero_drift_compensation);
+        ROS_WARN("%s: payload calibration not found, using built-in values", name_.c_str());
+    }
+    LoadVector6d(param_n_, "expected_wrench", expected_wrench_);
+    admittance_.SetSensor(force_recorder_.Payload(), jacobian_sensor2end_);
+    admittance_.SetExpectedWrench(expected_wrench_);
+
+    // euler: 原有的差分方式 (默认); exact: 零阶保持精确离散化, 任意控制频率下稳定, 约束投影后的位姿回写其状态
+    std::string integration;
+    param_n_.param("integration", integration, std::string("euler"));
+    if (integration == "euler")
+        admittance_.SetIntegration(Admittance::EULER);
+    else if (integration == "exact")
+        admittance_.SetIntegration(Admittance::EXACT);
+    else
+    {
+        admittance_.SetIntegration(Admittance::EULER);
+        ROS_WARN("%s: unknown integration '%s', using euler", name_.c_str(), integration.c_str());
+    }
+
+    LoadGainSchedule();
+
+    /*默认 MDK 作为第一版参数, 订阅线程启动前发布, 通道仍只有一个生产者*/
+    double rate;
+    private_n.param("rate", rate, 10.0);
+    control_period_ = rate > 0 ? 1.0 / rate : 0;
+    PublishMDK();
+
+    double max_pose_extrapolation;
+    param_n_.param("max_pose_extrapolation", max_pose_extrapolation, 0.05);
+    force_recorder_.Poses().setMaxExtrapolation(max_pose_extrapolation);
+    param_n_.param("max_pose_age", max_pose_age_, 0.1);
+    LoadVector6d(param_n_, "max_bias_std", max_bias_std_);
+
+    // 接触力限制: 逐轴 100 N / 5 Nm, 可选合力/合力矩限制; 连续 trip_samples 帧超限才触发, 单帧尖峰不中止运动
+    Vector6d axis_limits;
+    axis_limits << 100.0, 100.0, 100.0, 5.0, 5.0, 5.0;
+    LoadVector6d(param_n_, "axis_limits", axis_limits);
+    double max_force, max_torque, release_ratio;
+    int trip_samples, release_samples;
+    param_n_.param("max_force", max_force, 0.0);
+    param_n_.param("max_torque", max_torque, 0.0);
+    param_n_.param("release_ratio", release_ratio, 0.8);
+    param_n_.param("trip_samples", trip_samples, (int)SafetyMonitor::DEFAULT_TRIP_SAMPLES);
+    param_n_.param("release_samples", release_samples, 250);
+    force_recorder_.Safety().setAxisLimits(axis_limits.data());
+    force_recorder_.Safety().setMagnitudeLimits(max_force, max_torque);
+    force_recorder_.Safety().setHysteresis(release_ratio, trip_samples, release_samples);
+
+    /*订阅回调在本臂的队列与线程中执行, 与其他手臂和控制周期互不阻塞*/
+    n_ = n;
+    n_.setCallbackQueue(&callback_queue_);
+
+    // 如何初始化MDK参数即先收到一次topic
+    MDK_sub_ = n_.subscribe(Topic("/MDK"), 1, &ArmController::MDKRecord, this);
+    // 动态调参的合并增量, 须逐条应用, 队列不能丢
+    MDK_update_sub_ = n_.subscribe(Topic("/MDK_update"), 100, &ArmController::MDKUpdateRecord, this);
+    FTsensor_sub_ = n_.subscribe(name_.empty() ? "netft_data" : Topic("/netft_data"), 1, &ArmController::ForceRecord, this);
+    // 末端位姿历史, 供逐帧补偿时按时间戳插值, 也是控制周期的当前位姿
+    tool_point_sub_ = n_.subscribe(Topic("/robot_driver/tool_point"), 10, &ArmController::ToolPointRecord, this);
+    // 在线零漂估计, 未运行 bias_estimation 时沿用标定文件中的零漂
+    bias_sub_ = n_.subscribe(Topic("/netft_bias"), 1, &ArmController::BiasRecord, this);
+    // 关节限位投影使用
+    joint_state_sub_ = n_.subscribe(Topic("/robot_driver/joint_states"), 1, &ArmController::JointStateRecord, this);
+    // 力/位混合控制参数, 由 MDK_computation 的动态调参发布
+    hybrid_sub_ = n_.subscribe(Topic("/hybrid_force"), 1, &ArmController::HybridRecord, this);
+
+    servo_move_pub_ = n_.advertise<robot_msgs::ServoL>(Topic("/robot_driver/servo_move"), 1);
+    plot_pub_ = n_.advertise<admittance_control::Plot>(Topic("/plot_data"), 100);
+    motion_abort_pub_ = n_.advertise<robot_msgs::MotionAbort>(Topic("/robot_driver/motion_abort"), 1);
+
+    if (pthread_create(&callback_thread_, NULL, CallbackThread, this))
+    {
+        ROS_ERROR("%s: failed to start the callback thread", name_.c_str());
+        return false;
+    }
+    callback_thread_started_ = true;
+
+    return true;
+}
+
+void *ArmController::CallbackThread(void *args)
+{
+    ArmController *arm = (ArmController *)args;
+
+    while (arm->n_.ok() && !arm->shutdown_)
+        arm->callback_queue_.callAvailable(ros::WallDuration(0.1));
+
+    return NULL;
+}
+
+bool ArmController::MoveToStart()
+{
+    ros::ServiceClient client = n_.serviceClient<robot_msgs::Move>(Topic("/robot_driver/move_line"));
+
+    if (!CallMoveLine(client, approach_pose_))
+    {
+        ROS_ERROR("%s: Failed to Reach the Start Pose 1", name_.c_str());
+        return false;
+    }
+    if (!CallMoveLine(client, start_pose_))
+    {
+        ROS_ERROR("%s: Failed to Reach the Start Pose 2", name_.c_str());
+        return false;
+    }
+    ROS_INFO("%s: Reach the Start Pose", name_.c_str());
+
+    admittance_.Reset(start_pose_);
+    if (gain_schedule_)
+    {
+        scheduler_.Reset();
+        admittance_.SetMDK(scheduler_.M(), scheduler_.D(), scheduler_.K());
+    }
+    constraints_.Clear();
+    LoadConstraints(start_pose_);
+    expected_pose_ = start_pose_;
+    return true;
+}
+
+void ArmController::Prepare()
+{
+    pthread_mutex_lock(&mutex_);
+    bool joint_received = joint_received_;
+    pthread_mutex_unlock(&mutex_);
+
+    if (constraints_.HasJointLimits() && !joint_received)
+    {
+        ROS_WARN("%s: no joint_states received, joint limits disabled", name_.c_str());
+        constraints_.ClearJointLimits();
+    }
+    active_ = true;
+}
+
+/**
+ * 期望位姿的约束, 位置与姿态均相对起始位姿
+ * 默认与原先的越界判断一致: 位置盒 5/9/20 mm, 工具 z 轴偏摆 3 度, 自转 5 度
+ * ~sphere_radius (m) 大于 0 时增加球约束; 给出 ~joint_lower/~joint_upper (deg) 时启用关节限位, MDH 见 ~mdh
+ */
+void ArmController::LoadConstraints(const Vector6d &start_pose)
+{
+    Matrix4d start = Pose2HomogeneousTransform(start_pose);
+    Vector3d start_position = start.block<3, 1>(0, 3);
+
+    Vector3d box_half_extent(0.005, 0.009, 0.02);
+    vector<double> list;
+    if (param_n_.getParam("box_half_extent", list) && list.size() == 3)
+        box_half_extent << list[0], list[1], list[2];
+    if (box_half_extent.minCoeff() > 0)
+        constraints_.AddBox(start_position, box_half_extent, "workspace box");
+
+    double sphere_radius;
+    param_n_.param("sphere_radius", sphere_radius, 0.0);
+    if (sphere_radius > 0)
+        constraints_.AddSphere(start_position, sphere_radius, "workspace sphere");
+
+    double cone_half_angle, cone_max_twist;
+    param_n_.param("cone_half_angle", cone_half_angle, 3.0);
+    param_n_.param("cone_max_twist", cone_max_twist, 5.0);
+    if (cone_half_angle > 0 || cone_max_twist > 0)
+        constraints_.AddCone(start.block<3, 3>(0, 0), cone_half_angle / 180 * PI, cone_max_twist / 180 * PI, "orientation cone");
+
+    Vector6d lower, upper;
+    if (LoadVector6d(param_n_, "joint_lower", lower) && LoadVector6d(param_n_, "joint_upper", upper))
+    {
+        Matrix<double, 6, 4> MDH = JakaMDH::MDH();
+        LoadMDH(param_n_, "mdh", MDH);
+        constraints_.SetJointLimits(MDH, lower / 180 * PI, upper / 180 * PI);
+    }
+}
+
+/**
+ * 接触状态调度 (~gain_schedule/enable), 三组对角参数 ~gain_schedule/<free|contact|insertion>/<mass|damping|stiffness>
+ * 任一组不完整时不启用, 仍使用 /MDK; 参考 config/gain_schedule.yaml
+ */
+void ArmController::LoadGainSchedule()
+{
+    bool enable;
+    param_n_.param("gain_schedule/enable", enable, false);
+    if (!enable)
+        return;
+
+    for (int i = 0; i < GainScheduler::kStateNum; i++)
+    {
+        GainScheduler::ContactState state = (GainScheduler::ContactState)i;
+        string prefix = string("gain_schedule/") + GainScheduler::StateName(state) + "/";
+        Vector6d mass, damping, stiffness;
+        if (!LoadVector6d(param_n_, prefix + "mass", mass) || !LoadVector6d(param_n_, prefix + "damping", damping) ||
+            !LoadVector6d(param_n_, prefix + "stiffness", stiffness))
+        {
+            ROS_ERROR("%s: ~%smass/damping/stiffness incomplete, gain schedule disabled", name_.c_str(), prefix.c_str());
+            return;
+        }
+        if (mass.minCoeff() <= 0 || damping.minCoeff() <= 0 || stiffness.minCoeff() < 0)
+        {
+            ROS_ERROR("%s: ~%s gains must be positive, gain schedule disabled", name_.c_str(), prefix.c_str());
+            return;
+        }
+        scheduler_.SetGains(state, mass, damping, stiffness);
+    }
+
+    double contact_force, release_ratio, insertion_velocity, transition_time, tank_initial, tank_max;
+    int dwell_samples;
+    vector<double> axis;
+    Vector3d insertion_axis(0, 0, 1);
+    param_n_.param("gain_schedule/contact_force", contact_force, 3.0);
+    param_n_.param("gain_schedule/release_ratio", release_ratio, 0.5);
+    param_n_.param("gain_schedule/insertion_velocity", insertion_velocity, 0.002);
+    if (param_n_.getParam("gain_schedule/insertion_axis", axis) && axis.size() == 3)
+        insertion_axis << axis[0], axis[1], axis[2];
+    param_n_.param("gain_schedule/dwell_samples", dwell_samples, 3);
+    param_n_.param("gain_schedule/transition_time", transition_time, 0.5);
+    param_n_.param("gain_schedule/tank_initial", tank_initial, 0.05);
+    param_n_.param("gain_schedule/tank_max", tank_max, 0.5);
+
+    scheduler_.SetThresholds(contact_force, release_ratio, insertion_velocity, insertion_axis, dwell_samples);
+    scheduler_.SetTransitionTime(transition_time);
+    scheduler_.SetTank(tank_initial, tank_max);
+    scheduler_.Reset();
+    gain_schedule_ = true;
+    ROS_INFO("%s: gain schedule enabled, /MDK ignored", name_.c_str());
+}
+
+void ArmController::ToolPointRecord(const geometry_msgs::TwistStamped::ConstPtr &msg)
+{
+    Vector6d pose;
+    pose << msg->twist.linear.x, msg->twist.linear.y, msg->twist.linear.z,
+        msg->twist.angular.x, msg->twist.angular.y, msg->twist.angular.z;
+
+    force_recorder_.AddPose(msg->header.stamp.toSec(), pose);
+
+    pthread_mutex_lock(&mutex_);
+    tool_point_ = pose;
+    tool_point_stamp_ = msg->header.stamp;
+    pthread_mutex_unlock(&mutex_);
+}
+
+void ArmController::ForceRecord(const geometry_msgs::WrenchStamped::ConstPtr &msg)
+{
+    double FTdata_raw[6] = {msg->wrench.force.x, msg->wrench.force.y, msg->wrench.force.z,
+                            msg->wrench.torque.x, msg->wrench.torque.y, msg->wrench.torque.z};
+
+    PoseBuffer::Status pose_status = force_recorder_.Record(FTdata_raw, msg->header.stamp.toSec());
+    if (pose_status == PoseBuffer::EMPTY)
+    {
+        ROS_WARN_THROTTLE(5.0, "%s: no tool_point received, force data dropped", name_.c_str());
+        return;
+    }
+    if (pose_status == PoseBuffer::TOO_OLD || pose_status == PoseBuffer::TOO_NEW)
+        ROS_WARN_THROTTLE(5.0, "%s: no tool_point around the force data at %.3f", name_.c_str(), msg->header.stamp.toSec());
+
+    if (force_recorder_.Tripped())
+    {
+        robot_msgs::MotionAbort abort_msg;
+        abort_msg.header.stamp = msg->header.stamp;
+        abort_msg.detect_time = ros::Time::now();
+        for (int i = 0; i < 6; i++)
+            abort_msg.wrench[i] = force_recorder_.Compensated()(i);
+        abort_msg.reason = "admittance_control force/torque limit: " + SafetyMonitor::describe(force_recorder_.Safety().violations());
+        motion_abort_pub_.publish(abort_msg);
+
+        pthread_mutex_lock(&mutex_);
+        safety_tripped_ = true;
+        pthread_mutex_unlock(&mutex_);
+        ROS_WARN("%s: %s", name_.c_str(), abort_msg.reason.c_str());
+    }
+
+    pthread_mutex_lock(&mutex_);
+    FTsensor_data_ = force_recorder_.Average();
+    FTsensor_stamp_ = msg->header.stamp;
+    pthread_mutex_unlock(&mutex_);
+}
+
+void ArmController::MDKRecord(const admittance_control::MDK_msg::ConstPtr &msg)
+{
+    // MDK_msg 为列主序, 与 Eigen 默认存储一致
+    Map<const Matrix6d> M(msg->M.data());
+    Map<const Matrix6d> D(msg->D.data());
+    Map<const Matrix6d> K(msg->K.data());
+
+    // apparent_mass 模式下 MDK_computation 随关节状态发布, 未变化时不重新离散化, 也不再逐条打印
+    if (M == M_received_ && D == D_received_ && K == K_received_)
+        return;
+    M_received_ = M;
+    D_received_ = D;
+    K_received_ = K;
+    PublishMDK();
+}
+
+void ArmController::MDKUpdateRecord(const admittance_control::MDKUpdate::ConstPtr &msg)
+{
+    size_t count = msg->matrix.size();
+    if (msg->row.size() != count || msg->col.size() != count || msg->value.size() != count)
+    {
+        ROS_WARN("%s: malformed MDK update %u", name_.c_str(), msg->sequence);
+        return;
+    }
+
+    /*增量须紧接已应用的序号, 出现缺口时等待下一次完整更新*/
+    if (!msg->full)
+    {
+        if (!MDK_synchronized_)
+            return;
+        if (msg->sequence != MDK_sequence_ + 1)
+        {
+            ROS_WARN("%s: MDK update %u after %u, waiting for a full update", name_.c_str(), msg->sequence, MDK_sequence_);
+            MDK_synchronized_ = false;
+            return;
+        }
+    }
+
+    Matrix6d *matrices[3] = {&M_received_, &D_received_, &K_received_};
+    Matrix6d updated[3] = {M_received_, D_received_, K_received_};
+    for (size_t k = 0; k < count; k++)
+        if (msg->matrix[k] < 3 && msg->row[k] < 6 && msg->col[k] < 6)
+            updated[msg->matrix[k]](msg->row[k], msg->col[k]) = msg->value[k];
+
+    MDK_sequence_ = msg->sequence;
+    MDK_synchronized_ = true;
+    if (!msg->preset.empty())
+        ROS_INFO("%s: MDK preset '%s'", name_.c_str(), msg->preset.c_str());
+
+    bool changed = false;
+    for (int m = 0; m < 3; m++)
+        if (updated[m] != *matrices[m])
+        {
+            *matrices[m] = updated[m];
+            changed = true;
+        }
+    if (changed)
+        PublishMDK();
+}
+
+void ArmController::PublishMDK()
+{
+    /*求逆与离散化在订阅线程完成, 控制周期只做整体替换*/
+    PrepareAdmittanceParameters(M_received_, D_received_, K_received_, control_period_, MDK_channel_.Write());
+    MDK_channel_.Publish();
+}
+
+void ArmController::BiasRecord(const admittance_control::SensorBias::ConstPtr &msg)
+{
+    Vector6d zero_drift_std = Map<const Vector6d>(&(msg->zero_drift_std[0]));
+    if ((zero_drift_std.array() > max_bias_std_.array()).any())
+        return;
+
+    // 与 ForceRecord 同在本臂的订阅线程, 无需加锁
+    WrenchCompensation &payload = force_recorder_.Payload();
+    payload.setCalibration(payload.gravity(), payload.centroid(), &(msg->zero_drift[0]));
+}
+
+void ArmController::JointStateRecord(const sensor_msgs::JointState::ConstPtr &msg)
+{
+    if (msg->position.size() < 6)
+        return;
+
+    pthread_mutex_lock(&mutex_);
+    for (int i = 0; i < 6; i++)
+        joint_position_(i) = msg->position[i];
+    joint_received_ = true;
+    pthread_mutex_unlock(&mutex_);
+}
+
+void ArmController::HybridRecord(const admittance_control::HybridForce::ConstPtr &msg)
+{
+    pthread_mutex_lock(&mutex_);
+    hybrid_enable_ = msg->enable;
+    hybrid_selection_ = Map<const Vector6d>(&(msg->selection[0]));
+    hybrid_expected_wrench_ = Map<const Vector6d>(&(msg->expected_wrench[0]));
+    hybrid_kp_ = Map<const Vector6d>(&(msg->kp[0]));
+    hybrid_ki_ = Map<const Vector6d>(&(msg->ki[0]));
+    hybrid_max_velocity_ = Map<const Vector6d>(&(msg->max_velocity[0]));
+    hybrid_update_ = true;
+    pthread_mutex_unlock(&mutex_);
+}
+
+bool ArmController::Sense()
+{
+    sensed_ = false;
+    has_expected_pose_ = false;
+
+    ros::Time tool_point_stamp;
+    bool hybrid_update, hybrid_enable;
+    Vector6d hybrid_selection, hybrid_expected_wrench, hybrid_kp, hybrid_ki, hybrid_max_velocity;
+
+    pthread_mutex_lock(&mutex_);
+    FTsensor_data_once_ = FTsensor_data_;
+    FTsensor_stamp_once_ = FTsensor_stamp_;
+    current_pose_ = tool_point_;
+    tool_point_stamp = tool_point_stamp_;
+    joint_position_once_ = joint_position_;
+    safety_tripped_once_ = safety_tripped_;
+    hybrid_update = hybrid_update_;
+    if (hybrid_update)
+    {
+        hybrid_enable = hybrid_enable_;
+        hybrid_selection = hybrid_selection_;
+        hybrid_expected_wrench = hybrid_expected_wrench_;
+        hybrid_kp = hybrid_kp_;
+        hybrid_ki = hybrid_ki_;
+        hybrid_max_velocity = hybrid_max_velocity_;
+        hybrid_update_ = false;
+    }
+    pthread_mutex_unlock(&mutex_);
+
+    /*周期边界取最新一版 MDK; 接触状态调度时 MDK 由调度器给出*/
+    const AdmittanceParameters *parameters = MDK_channel_.Acquire();
+    if (parameters && !gain_schedule_)
+        admittance_.SetParameters(*parameters);
+
+    /*关闭混合控制时恢复纯导纳与 ~expected_wrench*/
+    if (hybrid_update)
+    {
+        if (!hybrid_enable)
+            hybrid_selection = Vector6d::Zero();
+        admittance_.SetHybrid(hybrid_selection, hybrid_kp, hybrid_ki, hybrid_max_velocity);
+        admittance_.SetExpectedWrench(hybrid_enable ? hybrid_expected_wrench : expected_wrench_);
+        ROS_INFO("%s: hybrid force control %s", name_.c_str(), hybrid_enable ? "on" : "off");
+    }
+
+    /*当前位姿取自 100 Hz 的 tool_point, 过旧时本周期不下发*/
+    if (tool_point_stamp.isZero() || (ros::Time::now() - tool_point_stamp).toSec() > max_pose_age_)
+    {
+        ROS_WARN_THROTTLE(1.0, "%s: tool_point older than %.3f s, servo skipped", name_.c_str(), max_pose_age_);
+        return false;
+    }
+
+    external_wrench_end_ = jacobian_sensor2end_ * FTsensor_data_once_;
+
+    plot_data_.data_13 = current_pose_(0);
+    plot_data_.data_14 = current_pose_(1);
+    plot_data_.data_15 = current_pose_(2);
+    plot_data_.data_16 = current_pose_(3);
+    plot_data_.data_17 = current_pose_(4);
+    plot_data_.data_18 = current_pose_(5);
+
+    sensed_ = true;
+    return true;
+}
+
+void ArmController::Step(double dt)
+{
+    if (!sensed_)
+        return;
+
+    /*接触状态调度: 以导纳当前的偏移与速度计算参数变化引起的储能变化, MDK 只在插值级数变化时更新*/
+    if (gain_schedule_)
+    {
+        GainScheduler::ContactState state = scheduler_.State();
+        if (scheduler_.Update(external_wrench_end_, admittance_.DeltaPose(), admittance_.DeltaPoseVelocity(), dt))
+            admittance_.SetMDK(scheduler_.M(), scheduler_.D(), scheduler_.K());
+        if (scheduler_.State() != state)
+            ROS_INFO("%s: %s -> %s", name_.c_str(), GainScheduler::StateName(state), GainScheduler::StateName(scheduler_.State()));
+    }
+
+    SetExpectedPose(admittance_.StepWithExternalWrench(current_pose_, FTsensor_data_once_, dt));
+}
+
+void ArmController::Command()
+{
+    if (!active_)
+        return;
+
+    /*接触力限制 (ForceRecord 逐帧检查, 超限时已直接 motion_abort)*/
+    if (safety_tripped_once_)
+    {
+        ROS_INFO("%s: Jog stop", name_.c_str());
+        Stop();
+        return;
+    }
+    if (!sensed_ || !has_expected_pose_)
+        return;
+
+    /*位置与关节限制: 投影到可行域, 继续伺服*/
+    if (!constraints_.Project(expected_pose_, current_pose_, joint_position_once_))
+    {
+        ROS_WARN_THROTTLE(1.0, "%s: expected pose limited by %s", name_.c_str(), constraints_.ActiveNames().c_str());
+        admittance_.Limit(expected_pose_);
+    }
+
+    plot_data_.data_1 = expected_pose_(0);
+    plot_data_.data_2 = expected_pose_(1);
+    plot_data_.data_3 = expected_pose_(2);
+    plot_data_.data_4 = expected_pose_(3);
+    if (expected_pose_(3) > 0)
+        plot_data_.data_4 = plot_data_.data_4 - 2 * PI;
+    plot_data_.data_5 = expected_pose_(4);
+    plot_data_.data_6 = expected_pose_(5);
+    plot_data_.data_7 = FTsensor_data_once_(0);
+    plot_data_.data_8 = FTsensor_data_once_(1);
+    plot_data_.data_9 = FTsensor_data_once_(2);
+    plot_data_.data_10 = FTsensor_data_once_(3);
+    plot_data_.data_11 = FTsensor_data_once_(4);
+    plot_data_.data_12 = FTsensor_data_once_(5);
+    plot_pub_.publish(plot_data_);
+
+    servo_msg_.header.stamp = FTsensor_stamp_once_;
+    servo_msg_.servo_mode = true;
+    for (int i = 0; i < 6; i++)
+        servo_msg_.pose[i] = expected_pose_(i);
+    servo_move_pub_.publish(servo_msg_);
+}
+
+void ArmController::Update(double dt)
+{
+    if (!active_)
+        return;
+
+    if (Sense())
+        Step(dt);
+    Command();
+}
+
+void ArmController::Stop()
+{
+    if (!active_.exchange(false))
+        return;
+
+    robot_msgs::ServoL servo_msg;
+    servo_msg.servo_mode = false;
+    servo_move_pub_.publish(servo_msg);
+}
@@ -0,0 +1,174 @@
+#include "batch_kinematics.h"
+
+#include <condition_variable>
+#include <mutex>
+#include "Eigen/unsupported/CXX11/ThreadPool"
+
+using namespace Eigen;
+
+typedef Array<double, Dynamic, 1, ColMajor, BatchKinematics::kBlockSize, 1> BlockArray;
+
+BatchKinematics::BatchKinematics(const Matrix<double, 6, 4> &MDH, int threads)
+{
+    SetMDH(MDH);
+
+    if (threads > 0)
+        pool_.reset(new NonBlockingThreadPool(threads));
+}
+
+BatchKinematics::~BatchKinematics()
+{
+}
+
+void BatchKinematics::SetMDH(const Matrix<double, 6, 4> &MDH)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        a_[i] = MDH(i, 0);
+        d_[i] = MDH(i, 1);
+        theta_[i] = MDH(i, 2);
+        cos_alpha_[i] = std::cos(MDH(i, 3));
+        sin_alpha_[i] = std::sin(MDH(i, 3));
+    }
+}
+
+void BatchKinematics::Forward(const JointBatch &q, PoseBatch &pose)
+{
+    Run(q, pose, NULL);
+}
+
+void BatchKinematics::Jacobian(const JointBatch &q, PoseBatch &pose, JacobianBatch &jacobian)
+{
+    jacobian.resize(q.rows(), 36);
+    Run(q, pose, &jacobian);
+}
+
+Matrix4d BatchKinematics::PoseAt(const PoseBatch &pose, int k)
+{
+    Matrix4d transform = Matrix4d::Identity();
+    for (int r = 0; r < 3; r++)
+    {
+        for (int c = 0; c < 3; c++)
+            transform(r, c) = pose(k, 3 * r + c);
+        transform(r, 3) = pose(k, 9 + r);
+    }
+
+    return transform;
+}
+
+Matrix<double, 6, 6> BatchKinematics::JacobianAt(const JacobianBatch &jacobian, int k)
+{
+    Matrix<double, 6, 6> J;
+    for (int i = 0; i < 36; i++)
+        J(i % 6, i / 6) = jacobian(k, i);
+
+    return J;
+}
+
+/* 按块分发, 块之间写入输出的不同行段, 无需加锁 */
+void BatchKinematics::Run(const JointBatch &q, PoseBatch &pose, JacobianBatch *jacobian)
+{
+    int rows = q.rows();
+    int block_num = (rows + kBlockSize - 1) / kBlockSize;
+
+    pose.resize(rows, 12);
+
+    if (!pool_ || block_num < 2)
+    {
+        for (int b = 0; b < block_num; b++)
+            Block(q, b * kBlockSize, std::min(kBlockSize, rows - b * kBlockSize), pose, jacobian);
+        return;
+    }
+
+    std::mutex done_mutex;
+    std::condition_variable done_condition;
+    int remaining = block_num;
+
+    for (int b = 0; b < block_num; b++)
+    {
+        pool_->Schedule([&, b]() {
+            Block(q, b * kBlockSize, std::min(kBlockSize, rows - b * kBlockSize), pose, jacobian);
+
+            std::lock_guard<std::mutex> lock(done_mutex);
+            if (--remaining == 0)
+                done_condition.notify_one();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_condition.wait(lock, [&]() { return remaining == 0; });
+}
+
+/**
+ * 逐关节累乘 T = T * A_i, 每个元素为 size 组的数组:
+ *   p += R * (a, -sa * d, ca * d)
+ *   R = R * Rot(alpha) * Rot_z(theta)
+ * 求雅可比时记录各关节坐标系的 z 轴与原点, J_v = z x (p_flange - p_i), J_w = z
+ */
+void BatchKinematics::Block(const JointBatch &q, int begin, int size, PoseBatch &pose, JacobianBatch *jacobian) const
+{
+    BlockArray R[9];
+    BlockArray p[3];
+    BlockArray axis[6][3];
+    BlockArray origin[6][3];
+    BlockArray ct, st, c0, c1, c2;
+
+    for (int i = 0; i < 9; i++)
+        R[i].setConstant(size, i % 4 == 0 ? 1.0 : 0.0);
+    for (int i = 0; i < 3; i++)
+        p[i].setZero(size);
+
+    for (int i = 0; i < 6; i++)
+    {
+        double ca = cos_alpha_[i];
+        double sa = sin_alpha_[i];
+        double ty = -sa * d_[i];
+        double tz = ca * d_[i];
+
+        ct = (q.col(i).segment(begin, size).array() + theta_[i]).cos();
+        st = (q.col(i).segment(begin, size).array() + theta_[i]).sin();
+
+        for (int r = 0; r < 3; r++)
+        {
+            c0 = R[3 * r];
+            c1 = R[3 * r + 1];
+            c2 = R[3 * r + 2];
+
+            p[r] += a_[i] * c0 + ty * c1 + tz * c2;
+            R[3 * r] = ct * c0 + st * (ca * c1 + sa * c2);
+            R[3 * r + 1] = ct * (ca * c1 + sa * c2) - st * c0;
+            R[3 * r + 2] = ca * c2 - sa * c1;
+        }
+
+        if (jacobian)
+        {
+            for (int r = 0; r < 3; r++)
+            {
+                axis[i][r] = R[3 * r + 2];
+                origin[i][r] = p[r];
+            }
+        }
+    }
+
+    for (int i = 0; i < 9; i++)
+        pose.col(i).segment(begin, size) = R[i].matrix();
+    for (int i = 0; i < 3; i++)
+        pose.col(9 + i).segment(begin, size) = p[i].matrix();
+
+    if (!jacobian)
+        return;
+
+    for (int j = 0; j < 6; j++)
+    {
+        const BlockArray *z = axis[j];
+        c0 = p[0] - origin[j][0];
+        c1 = p[1] - origin[j][1];
+        c2 = p[2] - origin[j][2];
+
+        jacobian->col(6 * j).segment(begin, size) = (z[1] * c2 - z[2] * c1).matrix();
+        jacobian->col(6 * j + 1).segment(begin, size) = (z[2] * c0 - z[0] * c2).matrix();
+        jacobian->col(6 * j + 2).segment(begin, size) = (z[0] * c1 - z[1] * c0).matrix();
+        for (int r = 0; r < 3; r++)
+            jacobian->col(6 * j + 3 + r).segment(begin, size) = z[r].matrix();
+    }
+}
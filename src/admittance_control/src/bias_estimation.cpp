@@ -0,0 +1,161 @@
+#include <cmath>
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include "bias_estimator.h"
+#include "geometry_msgs/TwistStamped.h"
+#include "geometry_msgs/WrenchStamped.h"
+#include "sensor_msgs/JointState.h"
+#include "admittance_control/SensorBias.h"
+#include "ros/ros.h"
+#include "ros_param.h"
+
+using namespace std;
+
+/* 所有回调都在 ros::spin 的单线程中执行, 无需加锁 */
+BiasEstimator estimator;
+ros::Publisher bias_pub;
+admittance_control::SensorBias bias_msg;
+
+Eigen::Matrix3d Transform_Basis2End;
+ros::Time tool_point_stamp;
+bool tool_point_ready = false;
+
+Vector6d joint_position;
+ros::Time joint_stamp;
+double joint_velocity = INFINITY; // 相邻两帧关节状态差分的最大关节速度
+bool joint_ready = false;
+
+double max_skew = 0.05;      // 力传感器与机器人状态的最大时间差 (s)
+double joint_timeout = 0.1;  // 关节状态超时后视为运动
+
+void PublishBias(const ros::Time &stamp)
+{
+    bias_msg.header.stamp = stamp;
+    Vector6d zero_drift_std = estimator.ZeroDriftStd();
+    for (int i = 0; i < 6; i++)
+    {
+        bias_msg.zero_drift[i] = estimator.ZeroDrift()(i);
+        bias_msg.zero_drift_std[i] = zero_drift_std(i);
+    }
+    bias_msg.age = estimator.Age();
+    bias_msg.accepted_num = estimator.AcceptedNum();
+    bias_msg.rejected_num = estimator.RejectedNum();
+    bias_msg.window_state = estimator.LastWindow();
+
+    bias_pub.publish(bias_msg);
+}
+
+void ForceRecord(const geometry_msgs::WrenchStamped::ConstPtr &msg)
+{
+    if (!tool_point_ready)
+        return;
+
+    Vector6d wrench;
+    wrench << msg->wrench.force.x, msg->wrench.force.y, msg->wrench.force.z,
+        msg->wrench.torque.x, msg->wrench.torque.y, msg->wrench.torque.z;
+    ros::Time stamp = msg->header.stamp.isZero() ? ros::Time::now() : msg->header.stamp;
+
+    /* 姿态或关节状态过旧时不能判断静止, 按运动处理 */
+    double velocity = joint_velocity;
+    if (!joint_ready || fabs((stamp - joint_stamp).toSec()) > joint_timeout || fabs((stamp - tool_point_stamp).toSec()) > max_skew)
+        velocity = INFINITY;
+
+    if (estimator.AddSample(wrench, Transform_Basis2End, velocity, stamp.toSec()))
+    {
+        ROS_DEBUG("zero drift updated, window std (%f, %f, %f, %f, %f, %f)",
+                  estimator.WindowStd()(0), estimator.WindowStd()(1), estimator.WindowStd()(2),
+                  estimator.WindowStd()(3), estimator.WindowStd()(4), estimator.WindowStd()(5));
+        PublishBias(stamp);
+    }
+}
+
+void ToolPointRecord(const geometry_msgs::TwistStamped::ConstPtr &msg)
+{
+    Transform_Basis2End = Eigen::AngleAxisd(msg->twist.angular.z, Eigen::Vector3d::UnitZ()) * Eigen::AngleAxisd(msg->twist.angular.y, Eigen::Vector3d::UnitY()) * Eigen::AngleAxisd(msg->twist.angular.x, Eigen::Vector3d::UnitX());
+    tool_point_stamp = msg->header.stamp.isZero() ? ros::Time::now() : msg->header.stamp;
+    tool_point_ready = true;
+}
+
+void JointStateRecord(const sensor_msgs::JointState::ConstPtr &msg)
+{
+    if (msg->position.size() < 6)
+        return;
+
+    Vector6d position;
+    for (int i = 0; i < 6; i++)
+        position(i) = msg->position[i];
+    ros::Time stamp = msg->header.stamp.isZero() ? ros::Time::now() : msg->header.stamp;
+
+    double dt = (stamp - joint_stamp).toSec();
+    if (joint_ready && dt > 0 && dt <= joint_timeout)
+        joint_velocity = (position - joint_position).cwiseAbs().maxCoeff() / dt;
+    else
+        joint_velocity = INFINITY;
+
+    joint_position = position;
+    joint_stamp = stamp;
+    joint_ready = true;
+}
+
+void PublishTimer(const ros::TimerEvent &event)
+{
+    PublishBias(ros::Time::now());
+}
+
+/**
+ * @brief 在线估计传感器零漂: 机器人静止、无接触、传感器方差小的窗口内更新, 估计值与置信度发布到 /netft_bias
+ *        接受窗口后立即发布, 另按 ~publish_rate 定时发布, 以便订阅者看到标准差随时间增长
+ */
+int main(int argc, char **argv)
+{
+    ros::init(argc, argv, "bias_estimation");
+    ros::NodeHandle n;
+    ros::NodeHandle private_n("~");
+
+    double window_time, sensor_rate, still_velocity, settle_time, publish_rate;
+    private_n.param("window_time", window_time, 0.5);
+    private_n.param("sensor_rate", sensor_rate, 500.0);
+    private_n.param("still_velocity", still_velocity, 0.005);
+    private_n.param("settle_time", settle_time, 0.5);
+    private_n.param("publish_rate", publish_rate, 1.0);
+    private_n.param("max_skew", max_skew, 0.05);
+    private_n.param("joint_timeout", joint_timeout, 0.1);
+
+    Vector6d noise_std, contact, drift_rate, min_std, initial_std;
+    noise_std << 0.2, 0.2, 0.2, 0.01, 0.01, 0.01;
+    contact << 1.0, 1.0, 1.0, 0.05, 0.05, 0.05;
+    drift_rate << 0.01, 0.01, 0.01, 0.0005, 0.0005, 0.0005;
+    min_std << 0.005, 0.005, 0.005, 0.0002, 0.0002, 0.0002;
+    initial_std << 0.5, 0.5, 0.5, 0.02, 0.02, 0.02;
+    LoadVector6d(private_n, "noise_std", noise_std);
+    LoadVector6d(private_n, "contact", contact);
+    LoadVector6d(private_n, "drift_rate", drift_rate);
+    LoadVector6d(private_n, "min_std", min_std);
+    LoadVector6d(private_n, "initial_std", initial_std);
+
+    /* 负载重力与质心取自标定文件, 其零漂作为初值 */
+    WrenchCompensation payload;
+    if (!payload.loadCalibration(n, "payload"))
+    {
+        ROS_ERROR("payload calibration not found, run gravity_calibration first");
+        return 1;
+    }
+
+    estimator.Reset(payload, initial_std);
+    estimator.SetWindow((int)(window_time * sensor_rate));
+    estimator.SetMotionThreshold(still_velocity, settle_time);
+    estimator.SetThreshold(noise_std, contact);
+    estimator.SetDriftModel(drift_rate, min_std);
+
+    bias_pub = n.advertise<admittance_control::SensorBias>("/netft_bias", 10);
+
+    ros::Subscriber FTsensor_sub = n.subscribe("netft_data", 100, ForceRecord);
+    ros::Subscriber tool_point_sub = n.subscribe("/robot_driver/tool_point", 10, ToolPointRecord);
+    ros::Subscriber joint_state_sub = n.subscribe("/robot_driver/joint_states", 10, JointStateRecord);
+    ros::Timer publish_timer = n.createTimer(ros::Duration(1.0 / publish_rate), PublishTimer);
+
+    ros::spin();
+
+    return 0;
+}
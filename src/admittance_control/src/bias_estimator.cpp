@@ -0,0 +1,152 @@
+#include "bias_estimator.h"
+
+#include <cmath>
+#include "Eigen/Geometry"
+
+using namespace Eigen;
+
+BiasEstimator::BiasEstimator()
+    : window_num_(250), still_velocity_(0.005), settle_time_(0.5)
+{
+    noise_std_ << 0.2, 0.2, 0.2, 0.01, 0.01, 0.01;
+    contact_ << 1.0, 1.0, 1.0, 0.05, 0.05, 0.05;
+    drift_rate_ << 0.01, 0.01, 0.01, 0.0005, 0.0005, 0.0005;
+    min_std_ << 0.005, 0.005, 0.005, 0.0002, 0.0002, 0.0002;
+
+    Reset(WrenchCompensation(), Vector6d::Constant(1.0));
+}
+
+void BiasEstimator::Reset(const WrenchCompensation &compensation, const Vector6d &zero_drift_std)
+{
+    const double no_drift[6] = {0, 0, 0, 0, 0, 0};
+
+    for (int i = 0; i < 3; i++)
+        centroid_[i] = compensation.centroid()[i];
+    gravity_.setCalibration(compensation.gravity(), centroid_, no_drift);
+
+    zero_drift_ = Map<const Vector6d>(compensation.zeroDrift());
+    variance_ = zero_drift_std.cwiseAbs2();
+    time_ = 0;
+    update_time_ = 0;
+    moving_time_ = 0;
+    started_ = false;
+
+    window_mean_.setZero();
+    window_variance_.setZero();
+    last_window_ = COLLECTING;
+    accepted_num_ = 0;
+    rejected_num_ = 0;
+    RestartWindow();
+}
+
+void BiasEstimator::SetMotionThreshold(double still_velocity, double settle_time)
+{
+    still_velocity_ = still_velocity;
+    settle_time_ = settle_time;
+}
+
+void BiasEstimator::SetThreshold(const Vector6d &noise_std, const Vector6d &contact)
+{
+    noise_std_ = noise_std;
+    contact_ = contact;
+}
+
+void BiasEstimator::SetDriftModel(const Vector6d &drift_rate, const Vector6d &min_std)
+{
+    drift_rate_ = drift_rate;
+    min_std_ = min_std;
+}
+
+void BiasEstimator::RestartWindow()
+{
+    sample_num_ = 0;
+    sample_mean_.setZero();
+    sample_square_.setZero();
+}
+
+bool BiasEstimator::AddSample(const Vector6d &wrench, const Matrix3d &rotation, double joint_velocity, double time)
+{
+    /* 首个采样只确定时间起点 */
+    if (!started_)
+    {
+        started_ = true;
+        update_time_ = time;
+        moving_time_ = time;
+    }
+    else if (time > time_)
+        variance_ += drift_rate_.cwiseAbs2() * (time - time_);
+    time_ = time;
+
+    if (!(joint_velocity <= still_velocity_))
+    {
+        moving_time_ = time;
+        if (sample_num_ > 0)
+        {
+            last_window_ = MOVING;
+            rejected_num_++;
+        }
+        RestartWindow();
+        return false;
+    }
+    if (time - moving_time_ < settle_time_)
+        return false;
+
+    /* 零漂观测值 = 读数 - 重力 */
+    Matrix<double, 3, 3, RowMajor> rotation_row_major = rotation;
+    Vector6d gravity_wrench;
+    gravity_.predict(rotation_row_major.data(), gravity_wrench.data());
+    Vector6d observation = wrench - gravity_wrench;
+
+    sample_num_++;
+    Vector6d delta = observation - sample_mean_;
+    sample_mean_ += delta / sample_num_;
+    sample_square_ += delta.cwiseProduct(observation - sample_mean_);
+
+    if (sample_num_ < window_num_)
+        return false;
+
+    CloseWindow();
+    RestartWindow();
+
+    return last_window_ == ACCEPTED;
+}
+
+void BiasEstimator::CloseWindow()
+{
+    window_mean_ = sample_mean_;
+    window_variance_ = sample_square_ / (sample_num_ - 1);
+
+    if ((window_variance_.array() > noise_std_.array().square()).any())
+    {
+        last_window_ = NOISY;
+        rejected_num_++;
+        return;
+    }
+
+    Vector6d innovation = window_mean_ - zero_drift_;
+    if ((innovation.array().abs() > contact_.array() + 3 * variance_.array().sqrt()).any())
+    {
+        last_window_ = CONTACT;
+        rejected_num_++;
+        return;
+    }
+
+    Vector6d measurement_variance = (window_variance_ / sample_num_).cwiseMax(min_std_.cwiseAbs2());
+    for (int i = 0; i < 6; i++)
+    {
+        double gain = variance_(i) / (variance_(i) + measurement_variance(i));
+        zero_drift_(i) += gain * innovation(i);
+        variance_(i) *= 1 - gain;
+    }
+
+    update_time_ = time_;
+    last_window_ = ACCEPTED;
+    accepted_num_++;
+}
+
+WrenchCompensation BiasEstimator::Compensation() const
+{
+    WrenchCompensation compensation;
+    compensation.setCalibration(gravity_.gravity(), centroid_, zero_drift_.data());
+    return compensation;
+}
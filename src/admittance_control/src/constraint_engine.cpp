@@ -0,0 +1,254 @@
+#include "constraint_engine.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Eigen/Cholesky"
+#include "Eigen/LU"
+#include "admittance.h"
+
+using namespace Eigen;
+
+ConstraintEngine::ConstraintEngine()
+    : size_(0), active_mask_(0), has_joint_limits_(false)
+{
+    joint_lower_ = Vector6d::Zero();
+    joint_upper_ = Vector6d::Zero();
+}
+
+void ConstraintEngine::Clear()
+{
+    size_ = 0;
+    active_mask_ = 0;
+    has_joint_limits_ = false;
+}
+
+bool ConstraintEngine::Add(const Constraint &constraint)
+{
+    if (size_ >= kMaxConstraints)
+        return false;
+
+    constraints_[size_++] = constraint;
+    return true;
+}
+
+bool ConstraintEngine::AddBox(const Vector3d &center, const Vector3d &half_extent, const std::string &name)
+{
+    Constraint box;
+    box.type = BOX;
+    box.center = center;
+    box.half_extent = half_extent.cwiseAbs();
+    box.name = name;
+    return Add(box);
+}
+
+bool ConstraintEngine::AddSphere(const Vector3d &center, double radius, const std::string &name)
+{
+    Constraint sphere;
+    sphere.type = SPHERE;
+    sphere.center = center;
+    sphere.radius = std::abs(radius);
+    sphere.name = name;
+    return Add(sphere);
+}
+
+bool ConstraintEngine::AddCone(const Matrix3d &reference_rotation, double swing_half_angle, double max_twist, const std::string &name)
+{
+    Constraint cone;
+    cone.type = CONE;
+    cone.reference_rotation = reference_rotation;
+    cone.swing_half_angle = swing_half_angle;
+    cone.max_twist = max_twist;
+    cone.name = name;
+    return Add(cone);
+}
+
+void ConstraintEngine::SetJointLimits(const Matrix<double, 6, 4> &MDH, const Vector6d &lower, const Vector6d &upper)
+{
+    robot_.SetMDH(MDH);
+    joint_lower_ = lower.cwiseMin(upper);
+    joint_upper_ = lower.cwiseMax(upper);
+    has_joint_limits_ = true;
+}
+
+bool ConstraintEngine::ProjectPosition(const Constraint &constraint, Vector3d &position)
+{
+    if (constraint.type == BOX)
+    {
+        Vector3d projected = position.cwiseMax(constraint.center - constraint.half_extent).cwiseMin(constraint.center + constraint.half_extent);
+        if (projected == position)
+            return false;
+        position = projected;
+        return true;
+    }
+
+    // SPHERE
+    Vector3d offset = position - constraint.center;
+    double distance = offset.norm();
+    if (distance <= constraint.radius)
+        return false;
+    position = constraint.center + offset * (constraint.radius / distance);
+    return true;
+}
+
+bool ConstraintEngine::ProjectOrientation(const Constraint &constraint, Matrix3d &rotation)
+{
+    /*相对参考姿态的转动按工具 z 轴分解为偏摆 (swing) 与自转 (twist), 分别限幅*/
+    Quaterniond relative(constraint.reference_rotation.transpose() * rotation);
+    if (relative.w() < 0)
+        relative.coeffs() = -relative.coeffs();
+
+    double twist_norm = std::sqrt(relative.w() * relative.w() + relative.z() * relative.z());
+    Quaterniond twist = twist_norm > 1e-12 ? Quaterniond(relative.w() / twist_norm, 0, 0, relative.z() / twist_norm)
+                                           : Quaterniond::Identity();
+    Quaterniond swing = relative * twist.conjugate();
+
+    double twist_angle = 2 * std::atan2(twist.z(), twist.w());
+    double swing_sin = swing.vec().norm();
+    double swing_angle = 2 * std::atan2(swing_sin, swing.w()); // swing.w() = twist_norm >= 0
+
+    bool changed = false;
+    if (constraint.max_twist > 0 && std::abs(twist_angle) > constraint.max_twist)
+    {
+        twist_angle = twist_angle > 0 ? constraint.max_twist : -constraint.max_twist;
+        twist = Quaterniond(AngleAxisd(twist_angle, Vector3d::UnitZ()));
+        changed = true;
+    }
+    if (constraint.swing_half_angle > 0 && swing_angle > constraint.swing_half_angle && swing_sin > 1e-12)
+    {
+        swing = Quaterniond(AngleAxisd(constraint.swing_half_angle, swing.vec() / swing_sin));
+        changed = true;
+    }
+
+    if (changed)
+        rotation = constraint.reference_rotation * (swing * twist).toRotationMatrix();
+    return changed;
+}
+
+bool ConstraintEngine::ProjectJoints(Vector3d &position, Matrix3d &rotation, const Vector6d &current_pose, const Vector6d &q)
+{
+    Matrix4d flange;
+    Matrix6d jacobian_flange;
+    robot_.FlangePose(q, flange);
+    robot_.FlangeJacobian(q, jacobian_flange);
+
+    /*基坐标系下的法兰雅可比*/
+    Matrix3d rotation_flange = flange.block<3, 3>(0, 0);
+    Matrix6d jacobian;
+    jacobian.topRows<3>() = rotation_flange * jacobian_flange.topRows<3>();
+    jacobian.bottomRows<3>() = rotation_flange * jacobian_flange.bottomRows<3>();
+
+    PartialPivLU<Matrix6d> lu(jacobian);
+    if (!(lu.rcond() >= 1e-6))
+        return false;
+
+    /*期望增量: TCP 的位移与基坐标系下的转角, 换算到法兰 v_flange = v_tcp - w x r*/
+    Matrix4d current = Pose2HomogeneousTransform(current_pose);
+    Vector3d current_position = current.block<3, 1>(0, 3);
+    Matrix3d current_rotation = current.block<3, 3>(0, 0);
+    Vector3d flange2tcp = current_position - flange.block<3, 1>(0, 3);
+
+    AngleAxisd delta_rotation(rotation * current_rotation.transpose());
+    Vector3d angular = delta_rotation.angle() * delta_rotation.axis();
+    Vector6d twist;
+    twist << position - current_position - angular.cross(flange2tcp), angular;
+
+    /*已在限位外的关节只限制其不再向外运动*/
+    Vector6d lower = joint_lower_.cwiseMin(q) - q;
+    Vector6d upper = joint_upper_.cwiseMax(q) - q;
+    Vector6d dq = lu.solve(twist);
+
+    /*触限的关节固定在限位上, 其余关节按最小二乘重新跟踪期望增量, 至多 6 轮*/
+    unsigned int joint_mask = 0;
+    for (int round = 0; round < 6; round++)
+    {
+        unsigned int hit = 0;
+        for (int i = 0; i < 6; i++)
+            if (!(joint_mask & (1u << i)) && (dq(i) < lower(i) || dq(i) > upper(i)))
+                hit |= 1u << i;
+        if (!hit)
+            break;
+        joint_mask |= hit;
+
+        Vector6d dq_fixed = Vector6d::Zero();
+        Matrix6d jacobian_free = jacobian;
+        for (int i = 0; i < 6; i++)
+            if (joint_mask & (1u << i))
+            {
+                dq_fixed(i) = std::min(std::max(dq(i), lower(i)), upper(i));
+                jacobian_free.col(i).setZero();
+            }
+
+        Matrix6d normal = jacobian_free.transpose() * jacobian_free + 1e-9 * Matrix6d::Identity();
+        dq = normal.ldlt().solve(jacobian_free.transpose() * (twist - jacobian * dq_fixed));
+        for (int i = 0; i < 6; i++)
+            if (joint_mask & (1u << i))
+                dq(i) = dq_fixed(i);
+    }
+    if (!joint_mask)
+        return false;
+    active_mask_ |= joint_mask << kJointLimitBit;
+
+    twist = jacobian * dq;
+    angular = twist.tail<3>();
+    double angle = angular.norm();
+
+    position = current_position + twist.head<3>() + angular.cross(flange2tcp);
+    rotation = angle > 1e-12 ? Matrix3d(AngleAxisd(angle, angular / angle) * current_rotation) : current_rotation;
+    return true;
+}
+
+bool ConstraintEngine::Project(Vector6d &pose, const Vector6d &current_pose, const Vector6d &q)
+{
+    active_mask_ = 0;
+
+    Matrix4d homogeneous_transform = Pose2HomogeneousTransform(pose);
+    Vector3d position = homogeneous_transform.block<3, 1>(0, 3);
+    Matrix3d rotation = homogeneous_transform.block<3, 3>(0, 0);
+
+    /*位置约束 (盒/球均为凸集) 交替投影, 轮数固定*/
+    for (int pass = 0; pass < kPositionPasses; pass++)
+    {
+        bool moved = false;
+        for (int i = 0; i < size_; i++)
+            if (constraints_[i].type != CONE && ProjectPosition(constraints_[i], position))
+            {
+                active_mask_ |= 1u << i;
+                moved = true;
+            }
+        if (!moved)
+            break;
+    }
+
+    for (int i = 0; i < size_; i++)
+        if (constraints_[i].type == CONE && ProjectOrientation(constraints_[i], rotation))
+            active_mask_ |= 1u << i;
+
+    if (has_joint_limits_)
+        ProjectJoints(position, rotation, current_pose, q);
+
+    if (!active_mask_)
+        return true;
+
+    homogeneous_transform.block<3, 1>(0, 3) = position;
+    homogeneous_transform.block<3, 3>(0, 0) = rotation;
+    pose = HomogeneousTransform2Pose(homogeneous_transform);
+    return false;
+}
+
+std::string ConstraintEngine::ActiveNames() const
+{
+    std::string names;
+    for (int i = 0; i < kMaxConstraints + 6; i++)
+    {
+        if (!(active_mask_ & (1u << i)))
+            continue;
+        if (!names.empty())
+            names += ", ";
+        if (i < kJointLimitBit)
+            names += constraints_[i].name;
+        else
+            names += "joint" + std::to_string(i - kJointLimitBit + 1) + " limit";
+    }
+    return names;
+}
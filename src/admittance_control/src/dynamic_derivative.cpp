@@ -0,0 +1,180 @@
+#include "dynamic_derivative.h"
+
+#include "Eigen/LU"
+
+using namespace std;
+using namespace Eigen;
+
+typedef Matrix<JointAutoDiff, 6, 1> JointAutoDiffVector;
+typedef Matrix<JointAutoDiff, 6, 6> JointAutoDiffMatrix;
+
+/* 以 value 为值, 第 k 个分量的导数方向为 e_k */
+JointAutoDiffVector SeedJoint(const Vector6d &value)
+{
+    JointAutoDiffVector seeded;
+    for (int k = 0; k < 6; k++)
+        seeded(k) = JointAutoDiff(value(k), 6, k);
+
+    return seeded;
+}
+
+JointAutoDiffVector ConstantJoint(const Vector6d &value)
+{
+    JointAutoDiffVector constant;
+    for (int k = 0; k < 6; k++)
+        constant(k) = JointAutoDiff(value(k), Vector6d::Zero());
+
+    return constant;
+}
+
+/* 拆出值与各偏导: partial[k](r, c) = d matrix(r, c) / d x_k */
+void SplitPartial(const JointAutoDiffMatrix &matrix, Matrix6d &value, Matrix6d partial[6])
+{
+    for (int r = 0; r < 6; r++)
+        for (int c = 0; c < 6; c++)
+        {
+            value(r, c) = matrix(r, c).value();
+            for (int k = 0; k < 6; k++)
+                partial[k](r, c) = matrix(r, c).derivatives()(k);
+        }
+}
+
+template <class Model>
+DynamicsDerivative<Model>::DynamicsDerivative()
+{
+    SetDynamicParameter(ParameterVector::Zero());
+}
+
+template <class Model>
+DynamicsDerivative<Model>::DynamicsDerivative(const Model &model, const ParameterVector &dynamic_parameter)
+    : joint_dynamics_(model, Matrix<JointAutoDiff, 60, 1>::Zero()),
+      parameter_dynamics_(model, Matrix<ParameterAutoDiff, 60, 1>::Zero())
+{
+    SetDynamicParameter(dynamic_parameter);
+}
+
+template <class Model>
+void DynamicsDerivative<Model>::SetDynamicParameter(const ParameterVector &dynamic_parameter)
+{
+    Matrix<JointAutoDiff, 60, 1> joint_parameter;
+    Matrix<ParameterAutoDiff, 60, 1> seeded_parameter;
+
+    for (int i = 0; i < 60; i++)
+    {
+        joint_parameter(i) = JointAutoDiff(dynamic_parameter(i), Vector6d::Zero());
+        seeded_parameter(i) = ParameterAutoDiff(dynamic_parameter(i), 60, i);
+    }
+
+    joint_dynamics_.SetDynamicParameter(joint_parameter);
+    parameter_dynamics_.SetDynamicParameter(seeded_parameter);
+}
+
+template <class Model>
+void DynamicsDerivative<Model>::SetGravity(const Vector3d &gravity)
+{
+    Matrix<JointAutoDiff, 3, 1> joint_gravity;
+    Matrix<ParameterAutoDiff, 3, 1> parameter_gravity;
+
+    for (int i = 0; i < 3; i++)
+    {
+        joint_gravity(i) = JointAutoDiff(gravity(i), Vector6d::Zero());
+        parameter_gravity(i) = ParameterAutoDiff(gravity(i), ParameterVector::Zero());
+    }
+
+    joint_dynamics_.SetGravity(joint_gravity);
+    parameter_dynamics_.SetGravity(parameter_gravity);
+}
+
+template <class Model>
+void DynamicsDerivative<Model>::JacobianPartial(const Vector6d &q, Matrix6d &jacobian, Matrix6d jacobian_partial[6])
+{
+    JointAutoDiffMatrix jacobian_ad;
+
+    joint_dynamics_.FlangeJacobian(SeedJoint(q), jacobian_ad);
+    SplitPartial(jacobian_ad, jacobian, jacobian_partial);
+}
+
+template <class Model>
+void DynamicsDerivative<Model>::JacobianDerivative(const Vector6d &q, const Vector6d &qd, Matrix6d &jacobian, Matrix6d &jacobian_derivative)
+{
+    Matrix6d jacobian_partial[6];
+
+    JacobianPartial(q, jacobian, jacobian_partial);
+
+    jacobian_derivative.setZero();
+    for (int k = 0; k < 6; k++)
+        jacobian_derivative += jacobian_partial[k] * qd(k);
+}
+
+template <class Model>
+void DynamicsDerivative<Model>::MassMatrixPartial(const Vector6d &q, Matrix6d &mass_matrix, Matrix6d mass_partial[6])
+{
+    JointAutoDiffMatrix mass_matrix_ad;
+
+    joint_dynamics_.MassMatrix(SeedJoint(q), mass_matrix_ad);
+    SplitPartial(mass_matrix_ad, mass_matrix, mass_partial);
+}
+
+template <class Model>
+bool DynamicsDerivative<Model>::TaskMassMatrixPartial(const Vector6d &q, Matrix6d &task_mass_matrix, Matrix6d task_mass_partial[6], double min_rcond)
+{
+    Matrix6d mass_matrix, jacobian;
+    Matrix6d mass_partial[6], jacobian_partial[6];
+
+    MassMatrixPartial(q, mass_matrix, mass_partial);
+    JacobianPartial(q, jacobian, jacobian_partial);
+
+    PartialPivLU<Matrix6d> lu(jacobian);
+    if (!(lu.rcond() >= min_rcond))
+        return false;
+
+    Matrix6d inverse = lu.inverse();
+    task_mass_matrix = inverse.transpose() * mass_matrix * inverse;
+
+    for (int k = 0; k < 6; k++)
+    {
+        Matrix6d coupling = task_mass_matrix * jacobian_partial[k] * inverse;
+        task_mass_partial[k] = inverse.transpose() * mass_partial[k] * inverse - coupling - coupling.transpose();
+    }
+
+    return true;
+}
+
+template <class Model>
+void DynamicsDerivative<Model>::InverseDynamicsPartial(const Vector6d &q, const Vector6d &qd, const Vector6d &qdd,
+                                                       Vector6d &torque, Matrix6d &torque_q, Matrix6d &torque_qd)
+{
+    JointAutoDiffVector torque_ad;
+
+    joint_dynamics_.InverseDynamics(SeedJoint(q), ConstantJoint(qd), ConstantJoint(qdd), torque_ad);
+    for (int i = 0; i < 6; i++)
+    {
+        torque(i) = torque_ad(i).value();
+        torque_q.row(i) = torque_ad(i).derivatives().transpose();
+    }
+
+    joint_dynamics_.InverseDynamics(ConstantJoint(q), SeedJoint(qd), ConstantJoint(qdd), torque_ad);
+    for (int i = 0; i < 6; i++)
+        torque_qd.row(i) = torque_ad(i).derivatives().transpose();
+}
+
+template <class Model>
+void DynamicsDerivative<Model>::Regressor(const Vector6d &q, const Vector6d &qd, const Vector6d &qdd, RegressorMatrix &regressor)
+{
+    typedef Matrix<ParameterAutoDiff, 6, 1> ParameterAutoDiffVector;
+    ParameterAutoDiffVector q_ad, qd_ad, qdd_ad, torque_ad;
+
+    for (int k = 0; k < 6; k++)
+    {
+        q_ad(k) = ParameterAutoDiff(q(k), ParameterVector::Zero());
+        qd_ad(k) = ParameterAutoDiff(qd(k), ParameterVector::Zero());
+        qdd_ad(k) = ParameterAutoDiff(qdd(k), ParameterVector::Zero());
+    }
+
+    parameter_dynamics_.InverseDynamics(q_ad, qd_ad, qdd_ad, torque_ad);
+    for (int i = 0; i < 6; i++)
+        regressor.row(i) = torque_ad(i).derivatives().transpose();
+}
+
+template class DynamicsDerivative<RuntimeMDH<6>>;
+template class DynamicsDerivative<JakaMDH>;
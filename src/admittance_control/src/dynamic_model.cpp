@@ -1,4 +1,7 @@
 #include "dynamic_model.h"
+#include "dynamic_derivative.h"
+
+#include "Eigen/LU"
 
 using namespace std;
 using namespace Eigen;
@@ -9,194 +12,268 @@ const double PI = 3.1415926;
 
 #pragma endregion
 
-Matrix3d SkewSymmetry(MatrixXd vector)
+template <class Scalar>
+Matrix<Scalar, 3, 3> SkewSymmetry(const Matrix<Scalar, 3, 1> &vector)
 {
-    Matrix3d cross_matrix = Matrix3d::Zero();
-    cross_matrix(0, 1) = -vector(2, 0);
-    cross_matrix(0, 2) = vector(1, 0);
-    cross_matrix(1, 0) = vector(2, 0);
-    cross_matrix(1, 2) = -vector(0, 0);
-    cross_matrix(2, 0) = -vector(1, 0);
-    cross_matrix(2, 1) = vector(0, 0);
+    Matrix<Scalar, 3, 3> cross_matrix;
+    cross_matrix << Scalar(0), -vector(2), vector(1),
+        vector(2), Scalar(0), -vector(0),
+        -vector(1), vector(0), Scalar(0);
 
     return cross_matrix;
 }
 
-MatrixXd LTransform(MatrixXd vector)
+template <class Model, class Scalar>
+MDHDynamics<Model, Scalar>::MDHDynamics()
+    : gravity_(0, 0, -9.8)
 {
-    MatrixXd cross_matrix = MatrixXd::Zero(3, 6);
-    cross_matrix(0, 0) = vector(0, 0);
-    cross_matrix(0, 1) = vector(1, 0);
-    cross_matrix(0, 2) = vector(2, 0);
-    cross_matrix(1, 1) = vector(0, 0);
-    cross_matrix(1, 3) = vector(1, 0);
-    cross_matrix(1, 4) = vector(2, 0);
-    cross_matrix(2, 2) = vector(0, 0);
-    cross_matrix(2, 4) = vector(1, 0);
-    cross_matrix(2, 5) = vector(2, 0);
+    SetDynamicParameter(ParameterVector::Zero());
+}
 
-    return cross_matrix;
+template <class Model, class Scalar>
+MDHDynamics<Model, Scalar>::MDHDynamics(const ParameterVector &dynamic_parameter)
+    : gravity_(0, 0, -9.8)
+{
+    SetDynamicParameter(dynamic_parameter);
 }
 
-MatrixXd MassMatrixComputation(MatrixXd MDH, MatrixXd dynamic_parameter)
+template <class Model, class Scalar>
+MDHDynamics<Model, Scalar>::MDHDynamics(const Model &model, const ParameterVector &dynamic_parameter)
+    : model_(model), gravity_(0, 0, -9.8)
+{
+    SetDynamicParameter(dynamic_parameter);
+}
+
+template <class Model, class Scalar>
+void MDHDynamics<Model, Scalar>::SetDynamicParameter(const ParameterVector &dynamic_parameter)
 {
-    MatrixXd acceleration_joint(3, 7);
-    MatrixXd angular_acceleration_joint(3, 7);
-    MatrixXd angular_acceleration(3, 6);
-    MatrixXd homogeneous_transform_element(4, 4);
-    Matrix<MatrixXd, 6, 6> homogeneous_transform;
-    MatrixXd rotation_element(3, 3);
-    Matrix<MatrixXd, 6, 6> rotation_joint;
-    MatrixXd translation_element(3, 1);
-    Matrix<MatrixXd, 6, 6> translation_joint;
-    MatrixXd U_element(3, 3);
-    Matrix<MatrixXd, 1, 6> U_temp;
-    MatrixXd V_element(3, 6);
-    Matrix<MatrixXd, 1, 6> V_temp;
-    MatrixXd Y(6, 60);
-    MatrixXd torque_G(6, 1);
-    MatrixXd mass_matrix(6, 6);
-    MatrixXd jacobi_joint2tool(6, 6);
-    Matrix3d temp1;
-    Matrix3d temp2;
-    MatrixXd temp3(3, 1);
-
-    /*forward kinematic*/
-    for (int i = 0; i < 6; i++)
+    for (int i = 0; i < kJointNum; i++)
     {
-        for (int j = 0; j < 6; j++)
-            homogeneous_transform(i, j) = MatrixXd::Identity(4, 4);
+        const Scalar *I = dynamic_parameter.data() + 6 * i;
+        inertia_[i] << I[0], I[1], I[2],
+            I[1], I[3], I[4],
+            I[2], I[4], I[5];
+        first_moment_[i] = dynamic_parameter.template segment<3>(6 * kJointNum + 4 * i);
+        mass_[i] = dynamic_parameter(6 * kJointNum + 3 + 4 * i);
     }
+}
+
+/* 逐关节模板展开, StaticMDH 的连杆常量在此折叠 */
+template <class Model, class Scalar>
+template <int I>
+void MDHDynamics<Model, Scalar>::Kinematics(const JointVector &q, integral_constant<int, I>)
+{
+    model_.template LinkTransform<I>(q(I), rotation_[I], translation_[I]);
+    Kinematics(q, integral_constant<int, I + 1>());
+}
+
+/* 前向递推速度/加速度, 反向递推力/力矩, 连杆量均在各自 MDH 坐标系下 */
+template <class Model, class Scalar>
+void MDHDynamics<Model, Scalar>::Rnea(const JointVector &qd, const JointVector &qdd, const Vector3 &base_acceleration, JointVector &torque) const
+{
+    Vector3 angular_velocity[kJointNum + 1];
+    Vector3 angular_acceleration[kJointNum + 1];
+    Vector3 acceleration[kJointNum + 1];
+    Vector3 force[kJointNum];
+    Vector3 moment[kJointNum];
 
-    for (int i = 0; i < 6; i++)
+    angular_velocity[0].setZero();
+    angular_acceleration[0].setZero();
+    acceleration[0] = base_acceleration;
+
+    for (int i = 0; i < kJointNum; i++)
     {
-        homogeneous_transform_element << cos(MDH(i, 2)), -sin(MDH(i, 2)), 0, MDH(i, 0),
-            sin(MDH(i, 2)) * cos(MDH(i, 3)), cos(MDH(i, 2)) * cos(MDH(i, 3)), -sin(MDH(i, 3)), -sin(MDH(i, 3)) * MDH(i, 1),
-            sin(MDH(i, 2)) * sin(MDH(i, 3)), cos(MDH(i, 2)) * sin(MDH(i, 3)), cos(MDH(i, 3)), cos(MDH(i, 3)) * MDH(i, 1),
-            0, 0, 0, 1;
-        for (int j = 0; j < i + 1; j++)
-        {
-            for (int k = i; k < 6; k++)
-                homogeneous_transform(k, j) = homogeneous_transform(k, j) * homogeneous_transform_element;
-        }
+        const Matrix3 &R = rotation_[i];
+        const Vector3 &p = translation_[i];
+        const Vector3 &w = angular_velocity[i];
+        const Vector3 &dw = angular_acceleration[i];
+
+        Vector3 w_local = R.transpose() * w;
+        angular_velocity[i + 1] = w_local + Vector3(0, 0, qd(i));
+        angular_acceleration[i + 1] = R.transpose() * dw + w_local.cross(Vector3(0, 0, qd(i))) + Vector3(0, 0, qdd(i));
+        acceleration[i + 1] = R.transpose() * (dw.cross(p) + w.cross(w.cross(p)) + acceleration[i]);
+
+        const Vector3 &w1 = angular_velocity[i + 1];
+        const Vector3 &dw1 = angular_acceleration[i + 1];
+        const Vector3 &mc = first_moment_[i];
+
+        force[i] = mass_[i] * acceleration[i + 1] + dw1.cross(mc) + w1.cross(w1.cross(mc));
+        moment[i] = inertia_[i] * dw1 + w1.cross(inertia_[i] * w1) + mc.cross(acceleration[i + 1]);
     }
 
-    for (int i = 0; i < 6; i++)
+    for (int i = kJointNum - 1; i >= 0; i--)
     {
-        for (int j = 0; j < 6; j++)
+        if (i < kJointNum - 1)
         {
-            homogeneous_transform_element = homogeneous_transform(i, j);
-            rotation_element << homogeneous_transform_element.block<3, 3>(0, 0);
-            translation_element << homogeneous_transform_element.block<3, 1>(0, 3);
-            rotation_joint(i, j) = rotation_element;
-            translation_joint(i, j) = translation_element;
+            Vector3 child_force = rotation_[i + 1] * force[i + 1];
+            force[i] += child_force;
+            moment[i] += rotation_[i + 1] * moment[i + 1] + translation_[i + 1].cross(child_force);
         }
+        torque(i) = moment[i](2);
     }
+}
+
+template <class Model, class Scalar>
+void MDHDynamics<Model, Scalar>::InverseDynamics(const JointVector &q, const JointVector &qd, const JointVector &qdd, JointVector &torque)
+{
+    Kinematics(q);
+    Rnea(qd, qdd, -gravity_, torque);
+}
 
-    angular_acceleration_joint.col(0) << 0, 0, 0;
-    acceleration_joint.col(0) << 0, 0, -9.8;
+template <class Model, class Scalar>
+void MDHDynamics<Model, Scalar>::GravityTorque(const JointVector &q, JointVector &torque)
+{
+    Kinematics(q);
+    Rnea(JointVector::Zero(), JointVector::Zero(), -gravity_, torque);
+}
 
-    angular_acceleration = MatrixXd::Zero(3, 6);
+template <class Model, class Scalar>
+void MDHDynamics<Model, Scalar>::CoriolisTorque(const JointVector &q, const JointVector &qd, JointVector &torque)
+{
+    Kinematics(q);
+    Rnea(qd, JointVector::Zero(), Vector3::Zero(), torque);
+}
 
-    for (int i = 1; i < 7; i++)
-    {
-        rotation_element = rotation_joint(i - 1, i - 1);
-        angular_acceleration_joint.col(i) = rotation_element.transpose() * angular_acceleration_joint.col(i - 1) + angular_acceleration.col(i - 1);
-        acceleration_joint.col(i) = rotation_element.transpose() *
-                                    (acceleration_joint.col(i - 1) +
-                                     SkewSymmetry(angular_acceleration_joint.col(i - 1)) * translation_joint(i - 1, i - 1));
-        U_element = SkewSymmetry(angular_acceleration_joint.col(i));
-        U_temp(0, i - 1) = U_element;
-        V_element = LTransform(angular_acceleration_joint.col(i));
-        V_temp(0, i - 1) = V_element;
-    }
+/**
+ * 由末端向基座合并连杆惯性参数 (质量, 一阶矩, 对原点的惯量), 合并体 i 绕关节 i 单位角加速度
+ * 所需的力/力矩投影到关节 i 及其之前各关节轴上即为质量矩阵第 i 列
+ */
+template <class Model, class Scalar>
+void MDHDynamics<Model, Scalar>::MassMatrix(const JointVector &q, JointMatrix &mass_matrix)
+{
+    Scalar composite_mass[kJointNum];
+    Vector3 composite_moment[kJointNum];
+    Matrix3 composite_inertia[kJointNum];
 
-    /*Coefficient Comput*/
-    Y = MatrixXd::Zero(6, 60);
+    Kinematics(q);
 
-    for (int i = 0; i < 6; i++)
+    for (int i = kJointNum - 1; i >= 0; i--)
     {
-        V_element = V_temp(0, i);
-        U_element = U_temp(0, i);
-        Y.block<1, 6>(i, 6 * i) << V_element.row(2);
-        Y.block<1, 3>(i, 4 * i + 36) << temp1.row(2);
-        if (i != 0)
+        composite_mass[i] = mass_[i];
+        composite_moment[i] = first_moment_[i];
+        composite_inertia[i] = inertia_[i];
+
+        if (i < kJointNum - 1)
         {
-            temp3 = acceleration_joint.col(i + 1);
-            temp1 = -SkewSymmetry(temp3);
-            for (int j = 0; j < i; j++)
-            {
-                temp2 = SkewSymmetry(translation_joint(i - 1, j + 1));
-                rotation_element = rotation_joint(i, j + 1);
-                Y.block<1, 6>(j, 6 * i) << (rotation_element * V_element).row(2);
-                Y.block<1, 3>(j, 4 * i + 32) << (rotation_element * temp1 + temp2 * rotation_element * U_element).row(2);
-                Y.block<1, 1>(j, 4 * i + 35) = (temp2 * rotation_element * temp3).row(2);
-            }
+            const Matrix3 &R = rotation_[i + 1];
+            Matrix3 P = SkewSymmetry(translation_[i + 1]);
+            Vector3 moment = R * composite_moment[i + 1];
+            Matrix3 C = SkewSymmetry(moment);
+            Scalar mass = composite_mass[i + 1];
+
+            composite_mass[i] += mass;
+            composite_moment[i] += moment + mass * translation_[i + 1];
+            composite_inertia[i] += R * composite_inertia[i + 1] * R.transpose() - mass * P * P - P * C - C * P;
         }
     }
 
-    torque_G = Y * dynamic_parameter;
-
-    for (int q = 0; q < 6; q++)
+    for (int i = 0; i < kJointNum; i++)
     {
-        angular_acceleration = MatrixXd::Zero(3, 6);
-        angular_acceleration.col(q) << 0, 0, 1;
+        Vector3 force = Vector3::UnitZ().cross(composite_moment[i]);
+        Vector3 moment = composite_inertia[i].col(2);
 
-        for (int i = 1; i < 7; i++)
+        mass_matrix(i, i) = moment(2);
+        for (int j = i - 1; j >= 0; j--)
         {
-            rotation_element = rotation_joint(i - 1, i - 1);
-            angular_acceleration_joint.col(i) = rotation_element.transpose() * angular_acceleration_joint.col(i - 1) + angular_acceleration.col(i - 1);
-            acceleration_joint.col(i) = rotation_element.transpose() *
-                                        (acceleration_joint.col(i - 1) +
-                                         SkewSymmetry(angular_acceleration_joint.col(i - 1)) * translation_joint(i - 1, i - 1));
-            U_element = SkewSymmetry(angular_acceleration_joint.col(i));
-            U_temp(i - 1) = U_element;
-            V_element = LTransform(angular_acceleration_joint.col(i));
-            V_temp(i - 1) = V_element;
+            force = rotation_[j + 1] * force;
+            moment = rotation_[j + 1] * moment + translation_[j + 1].cross(force);
+            mass_matrix(i, j) = moment(2);
+            mass_matrix(j, i) = moment(2);
         }
+    }
+}
 
-        /*Coefficient Comput*/
-        Y = MatrixXd::Zero(6, 60);
+template <class Model, class Scalar>
+void MDHDynamics<Model, Scalar>::FlangePose(const JointVector &q, Matrix4 &pose)
+{
+    Matrix3 rotation = Matrix3::Identity();
+    Vector3 translation = Vector3::Zero();
 
-        for (int i = 0; i < 6; i++)
-        {
-            V_element = V_temp(0, i);
-            U_element = U_temp(0, i);
-            Y.block<1, 6>(i, 6 * i) << V_element.row(2);
-            Y.block<1, 3>(i, 4 * i + 36) << temp1.row(2);
-            if (i != 0)
-            {
-                temp3 = acceleration_joint.col(i + 1);
-                temp1 = -SkewSymmetry(temp3);
-                for (int j = 0; j < i; j++)
-                {
-                    temp2 = SkewSymmetry(translation_joint(i - 1, j + 1));
-                    rotation_element = rotation_joint(i, j + 1);
-                    Y.block<1, 6>(j, 6 * i) << (rotation_element * V_element).row(2);
-                    Y.block<1, 3>(j, 4 * i + 32) << (rotation_element * temp1 + temp2 * rotation_element * U_element).row(2);
-                    Y.block<1, 1>(j, 4 * i + 35) = (temp2 * rotation_element * temp3).row(2);
-                }
-            }
-        }
+    Kinematics(q);
 
-        mass_matrix.col(q) = Y * dynamic_parameter - torque_G;
+    for (int i = 0; i < kJointNum; i++)
+    {
+        translation += rotation * translation_[i];
+        rotation = rotation * rotation_[i];
     }
 
-    jacobi_joint2tool = MatrixXd::Zero(6, 6);
-    for (int i = 1; i < 6; i++)
+    pose.setIdentity();
+    pose.template block<3, 3>(0, 0) = rotation;
+    pose.template block<3, 1>(0, 3) = translation;
+}
+
+template <class Model, class Scalar>
+void MDHDynamics<Model, Scalar>::FlangeJacobian(const JointVector &q, JacobianMatrix &jacobian)
+{
+    Matrix3 rotation = Matrix3::Identity(); // 法兰在关节 i 坐标系下的姿态
+    Vector3 translation = Vector3::Zero();
+
+    Kinematics(q);
+
+    for (int i = kJointNum - 1; i >= 0; i--)
     {
-        homogeneous_transform_element = homogeneous_transform(5, i);
-        jacobi_joint2tool(0, i - 1) = -homogeneous_transform_element(0, 0) * homogeneous_transform_element(1, 3) + homogeneous_transform_element(1, 0) * homogeneous_transform_element(0, 3);
-        jacobi_joint2tool(1, i - 1) = -homogeneous_transform_element(0, 1) * homogeneous_transform_element(1, 3) + homogeneous_transform_element(1, 1) * homogeneous_transform_element(0, 3);
-        jacobi_joint2tool(2, i - 1) = -homogeneous_transform_element(0, 2) * homogeneous_transform_element(1, 3) + homogeneous_transform_element(1, 2) * homogeneous_transform_element(0, 3);
-        jacobi_joint2tool(3, i - 1) = homogeneous_transform_element(2, 0);
-        jacobi_joint2tool(4, i - 1) = homogeneous_transform_element(2, 1);
-        jacobi_joint2tool(5, i - 1) = homogeneous_transform_element(2, 2);
+        jacobian.template block<3, 1>(0, i) = rotation.transpose() * Vector3(-translation(1), translation(0), 0);
+        jacobian.template block<3, 1>(3, i) = rotation.row(2).transpose();
+
+        translation = rotation_[i] * translation + translation_[i];
+        rotation = rotation_[i] * rotation;
     }
-    jacobi_joint2tool(5, 5) = 1;
+}
+
+template <class Model, class Scalar>
+bool MDHDynamics<Model, Scalar>::TaskMassMatrix(const JointVector &q, Matrix6d &task_mass_matrix, double min_rcond)
+{
+    static_assert(kJointNum == 6, "task mass matrix needs a square jacobian");
+
+    JointMatrix mass_matrix;
+    JacobianMatrix jacobian;
+
+    MassMatrix(q, mass_matrix);
+    FlangeJacobian(q, jacobian);
+
+    PartialPivLU<Matrix6d> lu(jacobian);
+    if (!(lu.rcond() >= min_rcond))
+        return false;
+
+    // J^-T * M * J^-1 = (J^-T * (J^-T * M)^T)
+    Matrix6d left = lu.transpose().solve(mass_matrix);
+    task_mass_matrix = lu.transpose().solve(left.transpose());
+
+    return true;
+}
+
+constexpr double JakaMDHTable::kA[6];
+constexpr double JakaMDHTable::kD[6];
+constexpr double JakaMDHTable::kTheta[6];
+constexpr double JakaMDHTable::kAlphaDegree[6];
+
+template class MDHDynamics<RuntimeMDH<6>>;
+template class MDHDynamics<JakaMDH>;
+
+/* 自动微分只实例化动力学与运动学接口, TaskMassMatrix 的导数见 dynamic_derivative.cpp */
+#define INSTANTIATE_AUTODIFF_DYNAMICS(MODEL, SCALAR)                                                                                                   \
+    template MDHDynamics<MODEL, SCALAR>::MDHDynamics();                                                                                                \
+    template MDHDynamics<MODEL, SCALAR>::MDHDynamics(const ParameterVector &);                                                                         \
+    template MDHDynamics<MODEL, SCALAR>::MDHDynamics(const MODEL &, const ParameterVector &);                                                          \
+    template void MDHDynamics<MODEL, SCALAR>::SetDynamicParameter(const ParameterVector &);                                                            \
+    template void MDHDynamics<MODEL, SCALAR>::InverseDynamics(const JointVector &, const JointVector &, const JointVector &, JointVector &);            \
+    template void MDHDynamics<MODEL, SCALAR>::GravityTorque(const JointVector &, JointVector &);                                                       \
+    template void MDHDynamics<MODEL, SCALAR>::CoriolisTorque(const JointVector &, const JointVector &, JointVector &);                                  \
+    template void MDHDynamics<MODEL, SCALAR>::MassMatrix(const JointVector &, JointMatrix &);                                                          \
+    template void MDHDynamics<MODEL, SCALAR>::FlangePose(const JointVector &, Matrix4 &);                                                              \
+    template void MDHDynamics<MODEL, SCALAR>::FlangeJacobian(const JointVector &, JacobianMatrix &);
+
+INSTANTIATE_AUTODIFF_DYNAMICS(RuntimeMDH<6>, JointAutoDiff)
+INSTANTIATE_AUTODIFF_DYNAMICS(JakaMDH, JointAutoDiff)
+INSTANTIATE_AUTODIFF_DYNAMICS(RuntimeMDH<6>, ParameterAutoDiff)
+INSTANTIATE_AUTODIFF_DYNAMICS(JakaMDH, ParameterAutoDiff)
+
+MatrixXd MassMatrixComputation(MatrixXd MDH, MatrixXd dynamic_parameter)
+{
+    RobotDynamics dynamics(MDH, dynamic_parameter);
+    Matrix6d mass_matrix = Matrix6d::Zero();
 
-    jacobi_joint2tool = jacobi_joint2tool.inverse();
-    mass_matrix = jacobi_joint2tool.transpose() * mass_matrix * jacobi_joint2tool;
+    dynamics.TaskMassMatrix(Vector6d::Zero(), mass_matrix, 0);
 
     return mass_matrix;
 }
@@ -0,0 +1,571 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <ctime>
+#include "Eigen/Eigenvalues"
+#include "dynamic_model.h"
+#include "admittance.h"
+#include "dynamic_derivative.h"
+
+using namespace std;
+using namespace Eigen;
+
+/**
+ * RobotDynamics 校验与计时:
+ *   1. 与解析/数值结果互相校验: CRBA 与 RNEA 单位加速度列, 重力矩与势能梯度, 科氏力与能量关系,
+ *      法兰雅可比与数值微分, 质量矩阵对称正定
+ *   2. 与原 MassMatrixComputation 实现 (此处保留为 LegacyMassMatrixComputation) 对比
+ *   3. 末端质量矩阵与显式求逆结果对比, 阻尼矩阵各模态阻尼比
+ *   4. 编译期 MDH (JakaDynamics) 与运行期 MDH (RobotDynamics) 结果一致
+ *   5. 自动微分 (DynamicsDerivative) 与中心差分对比: dJ/dt, dΛ/dq, 逆动力学对 q/qd 的偏导, 回归矩阵, 位姿转换
+ *   6. 各接口单次调用耗时 (us), 包括 MDK_computation 每周期的计算量, 编译期/运行期 MDH 对比
+ * 用法: dynamics_benchmark [iterations]
+ */
+
+const double PI = 3.1415926;
+
+#pragma region /*Previous MassMatrixComputation, kept for comparison*/
+
+MatrixXd LegacySkewSymmetry(MatrixXd vector)
+{
+    Matrix3d cross_matrix = Matrix3d::Zero();
+    cross_matrix(0, 1) = -vector(2, 0);
+    cross_matrix(0, 2) = vector(1, 0);
+    cross_matrix(1, 0) = vector(2, 0);
+    cross_matrix(1, 2) = -vector(0, 0);
+    cross_matrix(2, 0) = -vector(1, 0);
+    cross_matrix(2, 1) = vector(0, 0);
+
+    return cross_matrix;
+}
+
+MatrixXd LegacyLTransform(MatrixXd vector)
+{
+    MatrixXd cross_matrix = MatrixXd::Zero(3, 6);
+    cross_matrix(0, 0) = vector(0, 0);
+    cross_matrix(0, 1) = vector(1, 0);
+    cross_matrix(0, 2) = vector(2, 0);
+    cross_matrix(1, 1) = vector(0, 0);
+    cross_matrix(1, 3) = vector(1, 0);
+    cross_matrix(1, 4) = vector(2, 0);
+    cross_matrix(2, 2) = vector(0, 0);
+    cross_matrix(2, 4) = vector(1, 0);
+    cross_matrix(2, 5) = vector(2, 0);
+
+    return cross_matrix;
+}
+
+MatrixXd LegacyMassMatrixComputation(MatrixXd MDH, MatrixXd dynamic_parameter)
+{
+    MatrixXd acceleration_joint(3, 7);
+    MatrixXd angular_acceleration_joint(3, 7);
+    MatrixXd angular_acceleration(3, 6);
+    MatrixXd homogeneous_transform_element(4, 4);
+    Matrix<MatrixXd, 6, 6> homogeneous_transform;
+    MatrixXd rotation_element(3, 3);
+    Matrix<MatrixXd, 6, 6> rotation_joint;
+    MatrixXd translation_element(3, 1);
+    Matrix<MatrixXd, 6, 6> translation_joint;
+    MatrixXd U_element(3, 3);
+    Matrix<MatrixXd, 1, 6> U_temp;
+    MatrixXd V_element(3, 6);
+    Matrix<MatrixXd, 1, 6> V_temp;
+    MatrixXd Y(6, 60);
+    MatrixXd torque_G(6, 1);
+    MatrixXd mass_matrix(6, 6);
+    MatrixXd jacobi_joint2tool(6, 6);
+    Matrix3d temp1 = Matrix3d::Zero();
+    Matrix3d temp2;
+    MatrixXd temp3(3, 1);
+
+    for (int i = 0; i < 6; i++)
+    {
+        for (int j = 0; j < 6; j++)
+            homogeneous_transform(i, j) = MatrixXd::Identity(4, 4);
+    }
+
+    for (int i = 0; i < 6; i++)
+    {
+        homogeneous_transform_element << cos(MDH(i, 2)), -sin(MDH(i, 2)), 0, MDH(i, 0),
+            sin(MDH(i, 2)) * cos(MDH(i, 3)), cos(MDH(i, 2)) * cos(MDH(i, 3)), -sin(MDH(i, 3)), -sin(MDH(i, 3)) * MDH(i, 1),
+            sin(MDH(i, 2)) * sin(MDH(i, 3)), cos(MDH(i, 2)) * sin(MDH(i, 3)), cos(MDH(i, 3)), cos(MDH(i, 3)) * MDH(i, 1),
+            0, 0, 0, 1;
+        for (int j = 0; j < i + 1; j++)
+        {
+            for (int k = i; k < 6; k++)
+                homogeneous_transform(k, j) = homogeneous_transform(k, j) * homogeneous_transform_element;
+        }
+    }
+
+    for (int i = 0; i < 6; i++)
+    {
+        for (int j = 0; j < 6; j++)
+        {
+            homogeneous_transform_element = homogeneous_transform(i, j);
+            rotation_element << homogeneous_transform_element.block<3, 3>(0, 0);
+            translation_element << homogeneous_transform_element.block<3, 1>(0, 3);
+            rotation_joint(i, j) = rotation_element;
+            translation_joint(i, j) = translation_element;
+        }
+    }
+
+    angular_acceleration_joint.col(0) << 0, 0, 0;
+    acceleration_joint.col(0) << 0, 0, -9.8;
+
+    for (int q = -1; q < 6; q++)
+    {
+        angular_acceleration = MatrixXd::Zero(3, 6);
+        if (q >= 0)
+            angular_acceleration.col(q) << 0, 0, 1;
+
+        for (int i = 1; i < 7; i++)
+        {
+            rotation_element = rotation_joint(i - 1, i - 1);
+            angular_acceleration_joint.col(i) = rotation_element.transpose() * angular_acceleration_joint.col(i - 1) + angular_acceleration.col(i - 1);
+            acceleration_joint.col(i) = rotation_element.transpose() *
+                                        (acceleration_joint.col(i - 1) +
+                                         LegacySkewSymmetry(angular_acceleration_joint.col(i - 1)) * translation_joint(i - 1, i - 1));
+            U_temp(0, i - 1) = LegacySkewSymmetry(angular_acceleration_joint.col(i));
+            V_temp(0, i - 1) = LegacyLTransform(angular_acceleration_joint.col(i));
+        }
+
+        Y = MatrixXd::Zero(6, 60);
+
+        for (int i = 0; i < 6; i++)
+        {
+            V_element = V_temp(0, i);
+            U_element = U_temp(0, i);
+            Y.block<1, 6>(i, 6 * i) << V_element.row(2);
+            Y.block<1, 3>(i, 4 * i + 36) << temp1.row(2);
+            if (i != 0)
+            {
+                temp3 = acceleration_joint.col(i + 1);
+                temp1 = -LegacySkewSymmetry(temp3);
+                for (int j = 0; j < i; j++)
+                {
+                    temp2 = LegacySkewSymmetry(translation_joint(i - 1, j + 1));
+                    rotation_element = rotation_joint(i, j + 1);
+                    Y.block<1, 6>(j, 6 * i) << (rotation_element * V_element).row(2);
+                    Y.block<1, 3>(j, 4 * i + 32) << (rotation_element * temp1 + temp2 * rotation_element * U_element).row(2);
+                    Y.block<1, 1>(j, 4 * i + 35) = (temp2 * rotation_element * temp3).row(2);
+                }
+            }
+        }
+
+        if (q < 0)
+            torque_G = Y * dynamic_parameter;
+        else
+            mass_matrix.col(q) = Y * dynamic_parameter - torque_G;
+    }
+
+    jacobi_joint2tool = MatrixXd::Zero(6, 6);
+    for (int i = 1; i < 6; i++)
+    {
+        homogeneous_transform_element = homogeneous_transform(5, i);
+        jacobi_joint2tool(0, i - 1) = -homogeneous_transform_element(0, 0) * homogeneous_transform_element(1, 3) + homogeneous_transform_element(1, 0) * homogeneous_transform_element(0, 3);
+        jacobi_joint2tool(1, i - 1) = -homogeneous_transform_element(0, 1) * homogeneous_transform_element(1, 3) + homogeneous_transform_element(1, 1) * homogeneous_transform_element(0, 3);
+        jacobi_joint2tool(2, i - 1) = -homogeneous_transform_element(0, 2) * homogeneous_transform_element(1, 3) + homogeneous_transform_element(1, 2) * homogeneous_transform_element(0, 3);
+        jacobi_joint2tool(3, i - 1) = homogeneous_transform_element(2, 0);
+        jacobi_joint2tool(4, i - 1) = homogeneous_transform_element(2, 1);
+        jacobi_joint2tool(5, i - 1) = homogeneous_transform_element(2, 2);
+    }
+    jacobi_joint2tool(5, 5) = 1;
+
+    jacobi_joint2tool = jacobi_joint2tool.inverse();
+    mass_matrix = jacobi_joint2tool.transpose() * mass_matrix * jacobi_joint2tool;
+
+    return mass_matrix;
+}
+
+#pragma endregion
+
+/* 各连杆坐标系在基坐标系下的位姿, 校验用 */
+void ForwardFrames(const Matrix<double, 6, 4> &MDH, const Vector6d &q, Matrix4d frames[6])
+{
+    Matrix4d transform = Matrix4d::Identity();
+
+    for (int i = 0; i < 6; i++)
+    {
+        double theta = MDH(i, 2) + q(i);
+        double alpha = MDH(i, 3);
+        Matrix4d element;
+        element << cos(theta), -sin(theta), 0, MDH(i, 0),
+            sin(theta) * cos(alpha), cos(theta) * cos(alpha), -sin(alpha), -sin(alpha) * MDH(i, 1),
+            sin(theta) * sin(alpha), cos(theta) * sin(alpha), cos(alpha), cos(alpha) * MDH(i, 1),
+            0, 0, 0, 1;
+        transform = transform * element;
+        frames[i] = transform;
+    }
+}
+
+double PotentialEnergy(const Matrix<double, 6, 4> &MDH, const Matrix<double, 60, 1> &dynamic_parameter, const Vector6d &q)
+{
+    Matrix4d frames[6];
+    Vector3d gravity(0, 0, -9.8);
+    double energy = 0;
+
+    ForwardFrames(MDH, q, frames);
+    for (int i = 0; i < 6; i++)
+    {
+        double mass = dynamic_parameter(39 + 4 * i);
+        Vector3d first_moment = dynamic_parameter.segment<3>(36 + 4 * i);
+        energy -= gravity.dot(mass * frames[i].block<3, 1>(0, 3) + frames[i].block<3, 3>(0, 0) * first_moment);
+    }
+
+    return energy;
+}
+
+template <class Function>
+double MicrosecondsPerCall(int iterations, Function function)
+{
+    timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < iterations; i++)
+        function(i);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return ((end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) * 1e-3) / iterations;
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 100000;
+    const int sample_num = 64;
+    const double h = 1e-6;
+    const double tolerance = 1e-6;
+
+    Matrix<double, 6, 4> MDH;
+    Matrix<double, 60, 1> dynamic_parameter;
+    Vector6d expected_joint;
+
+    // a d theta alpha, 与 MDK_computation 相同
+    expected_joint << 0.16522547684382893, 2.026115249482023, 1.9502954394352305, 0.7277293271572154, -1.5764709940311654, 1.7271638412619614;
+    MDH << 0.0, 119.87 / 1000, 0, -0.13 / 180 * PI,
+        0.0, 0.0, 0, 90.00 / 180 * PI,
+        555.24 / 1000, 0.0, 0, 0.28 / 180 * PI,
+        482.28 / 1000, -115.33 / 1000, 0, 0.08 / 180 * PI,
+        0.0, 113.23 / 1000, 0, 90.01 / 180 * PI,
+        0.0, 107.17 / 1000, 0, -89.83 / 180 * PI;
+
+    dynamic_parameter << 0, 0, 0, 0, 0, 9.7748, -3.4619, 0.0707, 0.3706, 0,
+        0.2326, 7.9749, -1.6275, -0.0187, 0.2293, 0, -0.0997, 1.4314, 0.0172, 0.0085,
+        0.0193, 0, 0.0333, 0.0301, 0.0081, 0.0051, 1.0000e-04, 0, -0.0127, 0.0154,
+        0.0040, -1.0000e-03, -3.0000e-04, 0, 0.0026, 0.0066, -0.0295, 1.5549, 0, 0,
+        5.8022, 0.0472, 0, 0, 2.4664, 0.0436, 0, 0, 0.0039, -0.2274,
+        0, 0, 0.0027, 0.0486, 0, 0, 0.0016, 2.0000e-04, 0, 0;
+
+    // 辨识得到的基参数中质量与 mz 已归并为 0, 校验时另加一组完整的质量参数
+    Matrix<double, 60, 1> full_parameter = dynamic_parameter;
+    for (int i = 0; i < 6; i++)
+    {
+        full_parameter.segment<4>(36 + 4 * i) += Vector4d(0.02, -0.01, 0.03, 1.5);
+        full_parameter(6 * i) += 0.05;
+        full_parameter(6 * i + 3) += 0.05;
+        full_parameter(6 * i + 5) += 0.05;
+    }
+
+    srand(1);
+
+    double error_crba = 0, error_gravity = 0, error_coriolis = 0, error_jacobian = 0, error_symmetry = 0, error_task = 0, error_pose = 0;
+    double min_eigenvalue = 1e9;
+
+    for (int s = 0; s < sample_num; s++)
+    {
+        Vector6d q = s == 0 ? expected_joint : Vector6d(Vector6d::Random() * PI);
+        Vector6d qd = Vector6d::Random() * 2;
+        RobotDynamics dynamics(MDH, full_parameter);
+        Matrix6d M, J;
+        Vector6d gravity, coriolis, torque;
+
+        dynamics.MassMatrix(q, M);
+        dynamics.GravityTorque(q, gravity);
+        dynamics.CoriolisTorque(q, qd, coriolis);
+        dynamics.FlangeJacobian(q, J);
+
+        error_symmetry = fmax(error_symmetry, (M - M.transpose()).cwiseAbs().maxCoeff());
+        min_eigenvalue = fmin(min_eigenvalue, SelfAdjointEigenSolver<Matrix6d>(M).eigenvalues().minCoeff());
+
+        // CRBA 与 RNEA(q, 0, e_k) - G
+        for (int k = 0; k < 6; k++)
+        {
+            dynamics.InverseDynamics(q, Vector6d::Zero(), Vector6d::Unit(k), torque);
+            error_crba = fmax(error_crba, (torque - gravity - M.col(k)).cwiseAbs().maxCoeff());
+        }
+
+        // G = dV/dq
+        Vector6d gradient;
+        for (int k = 0; k < 6; k++)
+        {
+            Vector6d dq = Vector6d::Unit(k) * h;
+            gradient(k) = (PotentialEnergy(MDH, full_parameter, q + dq) - PotentialEnergy(MDH, full_parameter, q - dq)) / (2 * h);
+        }
+        error_gravity = fmax(error_gravity, (gradient - gravity).cwiseAbs().maxCoeff());
+
+        // C(q, qd) qd = dM/dt qd - 1/2 d(qd^T M qd)/dq
+        Matrix6d M_plus, M_minus, M_dot = Matrix6d::Zero();
+        Vector6d kinetic_gradient;
+        for (int k = 0; k < 6; k++)
+        {
+            Vector6d dq = Vector6d::Unit(k) * h;
+            dynamics.MassMatrix(q + dq, M_plus);
+            dynamics.MassMatrix(q - dq, M_minus);
+            M_dot += (M_plus - M_minus) / (2 * h) * qd(k);
+            kinetic_gradient(k) = 0.5 * qd.dot((M_plus - M_minus) / (2 * h) * qd);
+        }
+        error_coriolis = fmax(error_coriolis, (M_dot * qd - kinetic_gradient - coriolis).cwiseAbs().maxCoeff());
+
+        // 法兰雅可比: 线速度 R^T dp/dq, 角速度 R^T dR/dq R^T 的反对称部分
+        Matrix4d frames[6], frames_plus[6], frames_minus[6];
+        ForwardFrames(MDH, q, frames);
+        Matrix3d R = frames[5].block<3, 3>(0, 0);
+        Matrix4d pose;
+        dynamics.FlangePose(q, pose);
+        error_pose = fmax(error_pose, (pose - frames[5]).cwiseAbs().maxCoeff());
+        for (int k = 0; k < 6; k++)
+        {
+            Vector6d dq = Vector6d::Unit(k) * h;
+            ForwardFrames(MDH, q + dq, frames_plus);
+            ForwardFrames(MDH, q - dq, frames_minus);
+            Vector3d velocity = R.transpose() * (frames_plus[5].block<3, 1>(0, 3) - frames_minus[5].block<3, 1>(0, 3)) / (2 * h);
+            Matrix3d omega = R.transpose() * (frames_plus[5].block<3, 3>(0, 0) - frames_minus[5].block<3, 3>(0, 0)) / (2 * h);
+            Vector6d column;
+            column << velocity, omega(2, 1), omega(0, 2), omega(1, 0);
+            error_jacobian = fmax(error_jacobian, (column - J.col(k)).cwiseAbs().maxCoeff());
+        }
+
+        // 末端质量矩阵 J^-T M J^-1, 按量级取相对误差
+        Matrix6d task_mass_matrix;
+        if (dynamics.TaskMassMatrix(q, task_mass_matrix, 1e-3))
+        {
+            Matrix6d explicit_task = J.inverse().transpose() * M * J.inverse();
+            error_task = fmax(error_task, (task_mass_matrix - explicit_task).cwiseAbs().maxCoeff() / explicit_task.cwiseAbs().maxCoeff());
+        }
+    }
+
+    // 编译期 MDH 与同一组参数的运行期 MDH
+    RobotDynamics runtime_dynamics(JakaMDH::MDH(), full_parameter);
+    JakaDynamics static_dynamics(full_parameter);
+    double error_static = 0;
+    for (int s = 0; s < sample_num; s++)
+    {
+        Vector6d q = Vector6d::Random() * PI;
+        Vector6d qd = Vector6d::Random() * 2;
+        Vector6d qdd = Vector6d::Random() * 2;
+        Vector6d runtime_torque, static_torque;
+        Matrix6d runtime_M, static_M;
+        Matrix4d runtime_pose, static_pose;
+
+        runtime_dynamics.InverseDynamics(q, qd, qdd, runtime_torque);
+        static_dynamics.InverseDynamics(q, qd, qdd, static_torque);
+        runtime_dynamics.MassMatrix(q, runtime_M);
+        static_dynamics.MassMatrix(q, static_M);
+        runtime_dynamics.FlangePose(q, runtime_pose);
+        static_dynamics.FlangePose(q, static_pose);
+
+        error_static = fmax(error_static, (runtime_torque - static_torque).cwiseAbs().maxCoeff());
+        error_static = fmax(error_static, (runtime_M - static_M).cwiseAbs().maxCoeff());
+        error_static = fmax(error_static, (runtime_pose - static_pose).cwiseAbs().maxCoeff());
+    }
+
+    // D 按阻尼比 zeta 计算时, M^-1/2 D M^-1/2 / (2 zeta) 的平方应为 M^-1/2 K M^-1/2
+    const double damping_ratio = 0.7;
+    Matrix6d stiffness = Matrix6d::Zero();
+    stiffness.diagonal() << 80, 100, 200, 10, 10, 50;
+    Matrix6d virtual_mass = Matrix6d::Zero();
+    virtual_mass.diagonal() << 100, 100, 150, 1, 1, 20;
+    Matrix6d apparent_mass;
+    RobotDynamics(MDH, full_parameter).TaskMassMatrix(expected_joint, apparent_mass);
+    apparent_mass += virtual_mass;
+    Matrix6d damping = DampingFromMassStiffness(apparent_mass, stiffness, damping_ratio);
+    Matrix6d mass_inverse_sqrt = SelfAdjointEigenSolver<Matrix6d>(apparent_mass).operatorInverseSqrt();
+    Matrix6d normalized_damping = mass_inverse_sqrt * damping * mass_inverse_sqrt / (2 * damping_ratio);
+    Matrix6d normalized_stiffness = mass_inverse_sqrt * stiffness * mass_inverse_sqrt;
+    double error_damping = (normalized_damping * normalized_damping - normalized_stiffness).cwiseAbs().maxCoeff();
+
+    // 自动微分与中心差分, 差分误差 O(h^2), 按量级取相对误差
+    const double dh = 1e-5;
+    JakaDynamicsDerivative derivative(JakaMDH(), full_parameter);
+    double error_jacobian_derivative = 0, error_task_partial = 0, error_torque_partial = 0, error_regressor = 0, error_pose_partial = 0;
+    for (int s = 0; s < sample_num; s++)
+    {
+        Vector6d q = Vector6d::Random() * PI;
+        Vector6d qd = Vector6d::Random() * 2;
+        Vector6d qdd = Vector6d::Random() * 2;
+        Matrix6d J, J_plus, J_minus, J_dot;
+
+        derivative.JacobianDerivative(q, qd, J, J_dot);
+        static_dynamics.FlangeJacobian(q + qd * dh, J_plus);
+        static_dynamics.FlangeJacobian(q - qd * dh, J_minus);
+        error_jacobian_derivative = fmax(error_jacobian_derivative, ((J_plus - J_minus) / (2 * dh) - J_dot).cwiseAbs().maxCoeff());
+
+        Matrix6d task, task_plus, task_minus, task_partial[6];
+        if (derivative.TaskMassMatrixPartial(q, task, task_partial, 1e-2))
+        {
+            for (int k = 0; k < 6; k++)
+            {
+                static_dynamics.TaskMassMatrix(q + Vector6d::Unit(k) * dh, task_plus, 0);
+                static_dynamics.TaskMassMatrix(q - Vector6d::Unit(k) * dh, task_minus, 0);
+                Matrix6d numeric = (task_plus - task_minus) / (2 * dh);
+                error_task_partial = fmax(error_task_partial, (numeric - task_partial[k]).cwiseAbs().maxCoeff() / fmax(1.0, numeric.cwiseAbs().maxCoeff()));
+            }
+        }
+
+        Vector6d torque, torque_plus, torque_minus;
+        Matrix6d torque_q, torque_qd;
+        derivative.InverseDynamicsPartial(q, qd, qdd, torque, torque_q, torque_qd);
+        for (int k = 0; k < 6; k++)
+        {
+            Vector6d dq = Vector6d::Unit(k) * dh;
+            static_dynamics.InverseDynamics(q + dq, qd, qdd, torque_plus);
+            static_dynamics.InverseDynamics(q - dq, qd, qdd, torque_minus);
+            error_torque_partial = fmax(error_torque_partial, ((torque_plus - torque_minus) / (2 * dh) - torque_q.col(k)).cwiseAbs().maxCoeff());
+            static_dynamics.InverseDynamics(q, qd + dq, qdd, torque_plus);
+            static_dynamics.InverseDynamics(q, qd - dq, qdd, torque_minus);
+            error_torque_partial = fmax(error_torque_partial, ((torque_plus - torque_minus) / (2 * dh) - torque_qd.col(k)).cwiseAbs().maxCoeff());
+        }
+
+        Matrix<double, 6, 60> regressor;
+        derivative.Regressor(q, qd, qdd, regressor);
+        error_regressor = fmax(error_regressor, (regressor * full_parameter - torque).cwiseAbs().maxCoeff());
+
+        // 法兰位姿 (x, y, z, rx, ry, rz) 对关节角的导数, 经 HomogeneousTransform2Pose
+        MDHDynamics<JakaMDH, JointAutoDiff> pose_dynamics;
+        Matrix<JointAutoDiff, 6, 1> q_ad;
+        Matrix<JointAutoDiff, 4, 4> pose_ad;
+        Matrix4d pose_plus, pose_minus;
+        for (int k = 0; k < 6; k++)
+            q_ad(k) = JointAutoDiff(q(k), 6, k);
+        pose_dynamics.FlangePose(q_ad, pose_ad);
+        Matrix<JointAutoDiff, 6, 1> xyzrpy = HomogeneousTransform2Pose(pose_ad);
+        for (int k = 0; k < 6; k++)
+        {
+            Vector6d dq = Vector6d::Unit(k) * dh;
+            static_dynamics.FlangePose(q + dq, pose_plus);
+            static_dynamics.FlangePose(q - dq, pose_minus);
+            Vector6d numeric = (HomogeneousTransform2Pose(pose_plus) - HomogeneousTransform2Pose(pose_minus)) / (2 * dh);
+            for (int r = 0; r < 6; r++)
+                if (fabs(numeric(r)) < 1e3) // 跳过 +-PI 处回绕
+                    error_pose_partial = fmax(error_pose_partial, fabs(numeric(r) - xyzrpy(r).derivatives()(k)));
+        }
+    }
+
+    // 与原实现对比 (辨识参数, 期望关节角, 法兰坐标系下的末端质量矩阵)
+    MatrixXd legacy_MDH = MDH;
+    legacy_MDH.col(2) = expected_joint;
+    MatrixXd legacy = LegacyMassMatrixComputation(legacy_MDH, dynamic_parameter);
+    MatrixXd current = MassMatrixComputation(legacy_MDH, dynamic_parameter);
+
+    cout << setprecision(3) << scientific;
+    cout << "samples: " << sample_num << endl;
+    cout << "CRBA vs RNEA columns     max error: " << error_crba << endl;
+    cout << "gravity vs dV/dq         max error: " << error_gravity << endl;
+    cout << "coriolis vs energy       max error: " << error_coriolis << endl;
+    cout << "flange jacobian vs numeric max error: " << error_jacobian << endl;
+    cout << "flange pose vs MDH product max error: " << error_pose << endl;
+    cout << "mass matrix asymmetry    max: " << error_symmetry << ", min eigenvalue: " << min_eigenvalue << endl;
+    cout << "static vs runtime MDH     max diff: " << error_static << endl;
+    cout << "task mass matrix vs explicit inverse max relative error: " << error_task << endl;
+    cout << "damping ratio " << damping_ratio << " modal check max error: " << error_damping << endl;
+    cout << "autodiff dJ/dt vs numeric       max error: " << error_jacobian_derivative << endl;
+    cout << "autodiff dLambda/dq vs numeric  max relative error: " << error_task_partial << endl;
+    cout << "autodiff dtau/dq, dtau/dqd vs numeric max error: " << error_torque_partial << endl;
+    cout << "regressor * parameter vs torque max error: " << error_regressor << endl;
+    cout << "autodiff d pose/dq vs numeric   max error: " << error_pose_partial << endl;
+    cout << "legacy MassMatrixComputation vs RobotDynamics max diff: " << (legacy - current).cwiseAbs().maxCoeff()
+         << ", legacy asymmetry: " << (legacy - legacy.transpose()).cwiseAbs().maxCoeff() << endl;
+
+    RobotDynamics dynamics(MDH, dynamic_parameter);
+    Vector6d samples[16];
+    Vector6d qd = Vector6d::Constant(0.5);
+    Vector6d qdd = Vector6d::Constant(1.0);
+    Vector6d torque;
+    Matrix6d M, task_M;
+    Matrix4d pose;
+    double sink = 0;
+
+    for (int i = 0; i < 16; i++)
+        samples[i] = expected_joint + Vector6d::Random() * 0.1;
+
+    cout << fixed << setprecision(3);
+    cout << "iterations: " << iterations << endl;
+    cout << "runtime MDH (RobotDynamics):" << endl;
+    cout << "InverseDynamics (us): " << MicrosecondsPerCall(iterations, [&](int i) { dynamics.InverseDynamics(samples[i & 15], qd, qdd, torque); sink += torque(0); }) << endl;
+    cout << "GravityTorque   (us): " << MicrosecondsPerCall(iterations, [&](int i) { dynamics.GravityTorque(samples[i & 15], torque); sink += torque(0); }) << endl;
+    cout << "CoriolisTorque  (us): " << MicrosecondsPerCall(iterations, [&](int i) { dynamics.CoriolisTorque(samples[i & 15], qd, torque); sink += torque(0); }) << endl;
+    cout << "MassMatrix      (us): " << MicrosecondsPerCall(iterations, [&](int i) { dynamics.MassMatrix(samples[i & 15], M); sink += M(0, 0); }) << endl;
+    cout << "FlangePose      (us): " << MicrosecondsPerCall(iterations, [&](int i) { dynamics.FlangePose(samples[i & 15], pose); sink += pose(0, 3); }) << endl;
+    cout << "FlangeJacobian  (us): " << MicrosecondsPerCall(iterations, [&](int i) { dynamics.FlangeJacobian(samples[i & 15], M); sink += M(0, 0); }) << endl;
+    cout << "TaskMassMatrix  (us): " << MicrosecondsPerCall(iterations, [&](int i) { dynamics.TaskMassMatrix(samples[i & 15], M); sink += M(0, 0); }) << endl;
+    cout << "MDK cycle       (us): " << MicrosecondsPerCall(iterations, [&](int i) {
+        dynamics.TaskMassMatrix(samples[i & 15], task_M);
+        M = DampingFromMassStiffness(task_M + virtual_mass, stiffness, damping_ratio);
+        sink += M(0, 0);
+    }) << endl;
+    cout << "static MDH (JakaDynamics):" << endl;
+    JakaDynamics jaka_dynamics(dynamic_parameter);
+    cout << "InverseDynamics (us): " << MicrosecondsPerCall(iterations, [&](int i) { jaka_dynamics.InverseDynamics(samples[i & 15], qd, qdd, torque); sink += torque(0); }) << endl;
+    cout << "MassMatrix      (us): " << MicrosecondsPerCall(iterations, [&](int i) { jaka_dynamics.MassMatrix(samples[i & 15], M); sink += M(0, 0); }) << endl;
+    cout << "FlangePose      (us): " << MicrosecondsPerCall(iterations, [&](int i) { jaka_dynamics.FlangePose(samples[i & 15], pose); sink += pose(0, 3); }) << endl;
+    cout << "FlangeJacobian  (us): " << MicrosecondsPerCall(iterations, [&](int i) { jaka_dynamics.FlangeJacobian(samples[i & 15], M); sink += M(0, 0); }) << endl;
+    cout << "TaskMassMatrix  (us): " << MicrosecondsPerCall(iterations, [&](int i) { jaka_dynamics.TaskMassMatrix(samples[i & 15], M); sink += M(0, 0); }) << endl;
+    cout << "autodiff vs numeric differencing:" << endl;
+    JakaDynamicsDerivative jaka_derivative(JakaMDH(), dynamic_parameter);
+    Matrix6d partial[6], task_plus, task_minus;
+    Matrix<double, 6, 60> regressor;
+    Matrix<double, 60, 1> unit_parameter;
+    cout << "dJ/dt          autodiff (us): " << MicrosecondsPerCall(iterations / 10, [&](int i) { jaka_derivative.JacobianDerivative(samples[i & 15], qd, task_M, M); sink += M(0, 0); }) << endl;
+    cout << "dJ/dt          numeric  (us): " << MicrosecondsPerCall(iterations / 10, [&](int i) {
+        jaka_dynamics.FlangeJacobian(samples[i & 15] + qd * 1e-5, task_plus);
+        jaka_dynamics.FlangeJacobian(samples[i & 15] - qd * 1e-5, task_minus);
+        M = (task_plus - task_minus) / 2e-5;
+        sink += M(0, 0);
+    }) << endl;
+    cout << "dLambda/dq     autodiff (us): " << MicrosecondsPerCall(iterations / 10, [&](int i) { jaka_derivative.TaskMassMatrixPartial(samples[i & 15], M, partial); sink += partial[0](0, 0); }) << endl;
+    cout << "dLambda/dq     numeric  (us): " << MicrosecondsPerCall(iterations / 10, [&](int i) {
+        for (int k = 0; k < 6; k++)
+        {
+            jaka_dynamics.TaskMassMatrix(samples[i & 15] + Vector6d::Unit(k) * 1e-5, task_plus);
+            jaka_dynamics.TaskMassMatrix(samples[i & 15] - Vector6d::Unit(k) * 1e-5, task_minus);
+            partial[k] = (task_plus - task_minus) / 2e-5;
+        }
+        sink += partial[0](0, 0);
+    }) << endl;
+    cout << "dtau/dq,dqd    autodiff (us): " << MicrosecondsPerCall(iterations / 10, [&](int i) { jaka_derivative.InverseDynamicsPartial(samples[i & 15], qd, qdd, torque, M, task_M); sink += M(0, 0); }) << endl;
+    cout << "dtau/dq,dqd    numeric  (us): " << MicrosecondsPerCall(iterations / 10, [&](int i) {
+        Vector6d plus, minus;
+        for (int k = 0; k < 6; k++)
+        {
+            jaka_dynamics.InverseDynamics(samples[i & 15] + Vector6d::Unit(k) * 1e-5, qd, qdd, plus);
+            jaka_dynamics.InverseDynamics(samples[i & 15] - Vector6d::Unit(k) * 1e-5, qd, qdd, minus);
+            M.col(k) = (plus - minus) / 2e-5;
+            jaka_dynamics.InverseDynamics(samples[i & 15], qd + Vector6d::Unit(k) * 1e-5, qdd, plus);
+            jaka_dynamics.InverseDynamics(samples[i & 15], qd - Vector6d::Unit(k) * 1e-5, qdd, minus);
+            task_M.col(k) = (plus - minus) / 2e-5;
+        }
+        sink += M(0, 0) + task_M(0, 0);
+    }) << endl;
+    cout << "regressor      autodiff (us): " << MicrosecondsPerCall(iterations / 100 + 1, [&](int i) { jaka_derivative.Regressor(samples[i & 15], qd, qdd, regressor); sink += regressor(0, 5); }) << endl;
+    cout << "regressor      by columns (us): " << MicrosecondsPerCall(iterations / 100 + 1, [&](int i) {
+        JakaDynamics column_dynamics;
+        for (int k = 0; k < 60; k++)
+        {
+            column_dynamics.SetDynamicParameter(Matrix<double, 60, 1>::Unit(k));
+            column_dynamics.InverseDynamics(samples[i & 15], qd, qdd, torque);
+            regressor.col(k) = torque;
+        }
+        sink += regressor(0, 5);
+    }) << endl;
+    cout << "legacy MassMatrixComputation (us): "
+         << MicrosecondsPerCall(iterations / 100 + 1, [&](int i) { sink += LegacyMassMatrixComputation(legacy_MDH, dynamic_parameter)(0, 0); }) << endl;
+    cout << "(" << sink << ")" << endl;
+
+    bool pass = error_crba < tolerance && error_gravity < tolerance && error_coriolis < 1e-4 &&
+                error_jacobian < tolerance && error_symmetry < 1e-12 && min_eigenvalue > 0 &&
+                error_task < 1e-9 && error_damping < 1e-9 && error_pose < 1e-12 && error_static < 1e-9 &&
+                error_jacobian_derivative < 1e-7 && error_task_partial < 1e-5 && error_torque_partial < 1e-6 &&
+                error_regressor < 1e-9 && error_pose_partial < 1e-5;
+    cout << (pass ? "PASS" : "FAIL") << endl;
+
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include "excitation_trajectory.h"
+#include "dynamic_model.h"
+#include "ros_param.h"
+#include "ros/ros.h"
+
+using namespace std;
+
+/**
+ * @brief 离线生成负载标定的激励轨迹: 优化傅里叶系数, 在机器人运动前给出条件数与预测标准差,
+ *        并把一个周期等时间间隔的路径点写入 YAML, 由 gravity_calibration 的 ~poses 加载后经 move_path 执行
+ */
+int main(int argc, char **argv)
+{
+    ros::init(argc, argv, "excitation_generator");
+    ros::NodeHandle private_n("~");
+
+    Matrix<double, 6, 4> MDH = JakaMDH::MDH();
+    LoadMDH(private_n, "mdh", MDH);
+
+    double period, blend_radius, force_noise, torque_noise, sensor_rate, gravity;
+    int harmonic_num, sample_num, evaluation_num, restart_num, seed, waypoint_num;
+    string output;
+    private_n.param("period", period, 20.0);
+    private_n.param("harmonic_num", harmonic_num, 3);
+    private_n.param("sample_num", sample_num, 200);
+    private_n.param("evaluation_num", evaluation_num, 20000);
+    private_n.param("restart_num", restart_num, 6);
+    private_n.param("seed", seed, 0);
+    private_n.param("waypoint_num", waypoint_num, 40);
+    private_n.param("blend_radius", blend_radius, 0.05);
+    private_n.param("force_noise", force_noise, 0.05);
+    private_n.param("torque_noise", torque_noise, 0.002);
+    private_n.param("sensor_rate", sensor_rate, 500.0);
+    private_n.param("gravity", gravity, -18.9807);
+    private_n.param("output", output, string("excitation_trajectory.yaml"));
+
+    /* 默认以原标定姿态为中心, 关节 2, 3 小范围, 腕部关节大范围 */
+    Vector6d center, half_range, velocity_limit, acceleration_limit;
+    center << 0.1652374610684933, 1.854585041861113, 1.898176046369952, 0.9835086341685395, -1.5764230571325082, 1.7271518570372968;
+    half_range << 0, 0.2, 0.2, 1.2, 1.2, 2.5;
+    velocity_limit.setConstant(0.5);
+    acceleration_limit.setConstant(0.5);
+    LoadVector6d(private_n, "center", center);
+    LoadVector6d(private_n, "half_range", half_range);
+    LoadVector6d(private_n, "velocity_limit", velocity_limit);
+    LoadVector6d(private_n, "acceleration_limit", acceleration_limit);
+
+    /* 名义质心, 仅用于质心标准差的误差传播 */
+    Vector3d centroid(0.000226404, -4.35079e-05, 0.00441495);
+    vector<double> centroid_list;
+    if (private_n.getParam("centroid", centroid_list) && centroid_list.size() == 3)
+        centroid << centroid_list[0], centroid_list[1], centroid_list[2];
+
+    Matrix<bool, 6, 1> active;
+    for (int j = 0; j < 6; j++)
+        active(j) = half_range(j) > 0;
+
+    ExcitationTrajectory trajectory(MDH, period, harmonic_num, sample_num);
+    trajectory.SetCenter(center);
+    trajectory.SetLimit(center - half_range, center + half_range, velocity_limit, acceleration_limit);
+    trajectory.SetActiveJoint(active);
+
+    ros::WallTime start = ros::WallTime::now();
+    bool feasible = trajectory.Optimize(evaluation_num, restart_num, seed);
+    ROS_INFO("optimized in %.1f s", (ros::WallTime::now() - start).toSec());
+    if (!feasible)
+        ROS_WARN("excitation trajectory exceeds the limits by %.1f%%", trajectory.Violation() * 100);
+
+    /* 实际下发的路径点只覆盖周期内的离散姿态, 单独给出其条件数 */
+    BatchKinematics::JointBatch poses;
+    trajectory.Sample(waypoint_num, poses);
+    double force_condition, torque_condition;
+    trajectory.PoseCondition(poses, force_condition, torque_condition);
+
+    double gravity_std;
+    Vector3d centroid_std;
+    Vector6d zero_drift_std;
+    trajectory.PredictStd(force_noise, torque_noise, period * sensor_rate, gravity, centroid, gravity_std, centroid_std, zero_drift_std);
+
+    cout << "Regressor condition number : force " << trajectory.ForceCondition() << ", torque " << trajectory.TorqueCondition()
+         << " (" << waypoint_num << " waypoints: " << force_condition << ", " << torque_condition << ")" << endl;
+    cout << "Predicted std of gravity is : " << gravity_std << endl;
+    cout << "Predicted std of centroid is : ( " << centroid_std.transpose() << ")" << endl;
+    cout << "Predicted std of zero drift is : ( " << zero_drift_std.transpose() << ")" << endl;
+    cout << "Fourier coefficient (a_1..a_K, b_1..b_K per joint) :" << endl
+         << trajectory.Coefficient() << endl;
+
+    ofstream file(output.c_str());
+    if (!file)
+    {
+        ROS_ERROR("failed to open %s", output.c_str());
+        return 1;
+    }
+
+    file << setprecision(10);
+    file << "# excitation trajectory for gravity_calibration, period " << period << " s, " << harmonic_num << " harmonics" << endl;
+    file << "# regressor condition number: force " << trajectory.ForceCondition() << ", torque " << trajectory.TorqueCondition() << endl;
+    file << "# joint positions (rad), " << waypoint_num << " waypoints over one period" << endl;
+    file << "poses: [";
+    for (int i = 0; i < poses.rows(); i++)
+    {
+        file << (i == 0 ? "" : ",\n        ");
+        for (int j = 0; j < 6; j++)
+            file << (j == 0 ? "" : ", ") << poses(i, j);
+    }
+    file << "]" << endl;
+    file << "velocity: " << velocity_limit.maxCoeff() << endl;
+    file << "acceleration: " << acceleration_limit.maxCoeff() << endl;
+    file << "blend_radius: " << blend_radius << endl;
+
+    ROS_INFO("written to %s", output.c_str());
+
+    return 0;
+}
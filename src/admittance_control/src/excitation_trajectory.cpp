@@ -0,0 +1,299 @@
+#include "excitation_trajectory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "Eigen/Cholesky"
+#include "Eigen/Eigenvalues"
+
+using namespace Eigen;
+
+const double PI = 3.14159265358979323846;
+/* 超限罚函数权重, 超限量按各自上限归一化 */
+const double kViolationWeight = 1e3;
+/* 信息矩阵奇异时的条件数 */
+const double kSingularCondition = 1e6;
+
+/* 回归矩阵条件数 = sqrt(信息矩阵条件数) */
+template <int N>
+double RegressorCondition(const Matrix<double, N, N> &information)
+{
+    SelfAdjointEigenSolver<Matrix<double, N, N>> solver(information, EigenvaluesOnly);
+    double min_eigenvalue = solver.eigenvalues()(0);
+    double max_eigenvalue = solver.eigenvalues()(N - 1);
+
+    if (!(min_eigenvalue > max_eigenvalue / (kSingularCondition * kSingularCondition)))
+        return kSingularCondition;
+
+    return std::sqrt(max_eigenvalue / min_eigenvalue);
+}
+
+ExcitationTrajectory::ExcitationTrajectory(const Matrix<double, 6, 4> &MDH, double period, int harmonic_num, int sample_num)
+    : kinematics_(MDH), period_(period), harmonic_num_(harmonic_num), sample_num_(sample_num),
+      coefficient_(MatrixXd::Zero(6, 2 * harmonic_num)),
+      force_condition_(kSingularCondition), torque_condition_(kSingularCondition), violation_(0)
+{
+    center_.setZero();
+    lower_.setConstant(-2 * PI);
+    upper_.setConstant(2 * PI);
+    velocity_limit_.setConstant(0.5);
+    acceleration_limit_.setConstant(0.5);
+
+    Matrix<bool, 6, 1> active;
+    active << false, true, true, true, true, true;
+    SetActiveJoint(active);
+
+    force_information_.setZero();
+    torque_information_.setZero();
+}
+
+void ExcitationTrajectory::SetLimit(const Vector6d &lower, const Vector6d &upper, const Vector6d &velocity, const Vector6d &acceleration)
+{
+    lower_ = lower;
+    upper_ = upper;
+    velocity_limit_ = velocity;
+    acceleration_limit_ = acceleration;
+}
+
+void ExcitationTrajectory::SetActiveJoint(const Matrix<bool, 6, 1> &active)
+{
+    active_joint_.clear();
+    for (int j = 0; j < 6; j++)
+        if (active(j))
+            active_joint_.push_back(j);
+}
+
+void ExcitationTrajectory::Evaluate(double t, Vector6d &q, Vector6d &qd, Vector6d &qdd) const
+{
+    double w = 2 * PI / period_;
+
+    q = center_;
+    qd.setZero();
+    qdd.setZero();
+    for (int k = 1; k <= harmonic_num_; k++)
+    {
+        double wk = w * k;
+        double s = std::sin(wk * t);
+        double c = std::cos(wk * t);
+        for (int j = 0; j < 6; j++)
+        {
+            double a = coefficient_(j, k - 1);
+            double b = coefficient_(j, harmonic_num_ + k - 1);
+            q(j) += a / wk * s - b / wk * (c - 1);
+            qd(j) += a * c + b * s;
+            qdd(j) += -a * wk * s + b * wk * c;
+        }
+    }
+}
+
+void ExcitationTrajectory::Sample(int point_num, BatchKinematics::JointBatch &q) const
+{
+    Vector6d q_once, qd_once, qdd_once;
+
+    q.resize(point_num, 6);
+    for (int i = 0; i < point_num; i++)
+    {
+        Evaluate(i * period_ / point_num, q_once, qd_once, qdd_once);
+        q.row(i) = q_once.transpose();
+    }
+}
+
+void ExcitationTrajectory::Information(const BatchKinematics::JointBatch &q, Matrix4d &force_information, Matrix<double, 6, 6> &torque_information,
+                                       double &force_condition, double &torque_condition)
+{
+    Matrix<double, 3, 4> force_regressor;
+    Matrix<double, 3, 6> torque_regressor;
+
+    kinematics_.Forward(q, sample_pose_);
+
+    force_information.setZero();
+    torque_information.setZero();
+    for (int i = 0; i < q.rows(); i++)
+    {
+        Vector3d g(sample_pose_(i, 6), sample_pose_(i, 7), sample_pose_(i, 8));
+        PayloadIdentification::Regressor(g, force_regressor, torque_regressor);
+        force_information.noalias() += force_regressor.transpose() * force_regressor;
+        torque_information.noalias() += torque_regressor.transpose() * torque_regressor;
+    }
+    force_information /= q.rows();
+    torque_information /= q.rows();
+
+    force_condition = RegressorCondition<4>(force_information);
+    torque_condition = RegressorCondition<6>(torque_information);
+}
+
+void ExcitationTrajectory::Unpack(const VectorXd &x)
+{
+    int n = 0;
+    coefficient_.setZero();
+    for (size_t i = 0; i < active_joint_.size(); i++)
+        for (int k = 0; k < 2 * harmonic_num_; k++)
+            coefficient_(active_joint_[i], k) = x(n++);
+}
+
+double ExcitationTrajectory::Cost(const VectorXd &x)
+{
+    Vector6d q, qd, qdd;
+    Vector6d violation = Vector6d::Zero();
+
+    Unpack(x);
+
+    sample_q_.resize(sample_num_, 6);
+    for (int i = 0; i < sample_num_; i++)
+    {
+        Evaluate(i * period_ / sample_num_, q, qd, qdd);
+        sample_q_.row(i) = q.transpose();
+
+        for (size_t l = 0; l < active_joint_.size(); l++)
+        {
+            int j = active_joint_[l];
+            double excess = std::max(q(j) - upper_(j), lower_(j) - q(j));
+            excess = std::max(excess / (upper_(j) - lower_(j)), std::fabs(qd(j)) / velocity_limit_(j) - 1);
+            excess = std::max(excess, std::fabs(qdd(j)) / acceleration_limit_(j) - 1);
+            violation(j) = std::max(violation(j), excess);
+        }
+    }
+    violation_ = violation.maxCoeff();
+
+    Information(sample_q_, force_information_, torque_information_, force_condition_, torque_condition_);
+
+    return force_condition_ + torque_condition_ + kViolationWeight * violation.sum();
+}
+
+bool ExcitationTrajectory::Optimize(int evaluation_num, int restart_num, unsigned int seed)
+{
+    const int n = active_joint_.size() * 2 * harmonic_num_;
+    if (n == 0)
+        return false;
+
+    /* 初值系数使各关节速度约为上限的一半 */
+    VectorXd scale(n);
+    for (size_t i = 0; i < active_joint_.size(); i++)
+        scale.segment(i * 2 * harmonic_num_, 2 * harmonic_num_).setConstant(velocity_limit_(active_joint_[i]) / (4 * harmonic_num_));
+
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+
+    VectorXd best = VectorXd::Zero(n);
+    double best_cost = INFINITY;
+
+    std::vector<VectorXd> simplex(n + 1, VectorXd(n));
+    std::vector<double> cost(n + 1);
+    std::vector<int> order(n + 1);
+
+    for (int restart = 0; restart < restart_num; restart++)
+    {
+        /* 第一次之后从当前最优附近重新张开单纯形 */
+        VectorXd start(n);
+        for (int i = 0; i < n; i++)
+            start(i) = (restart > 0 && restart % 2 == 0) ? best(i) : uniform(generator) * scale(i);
+
+        simplex[0] = start;
+        for (int i = 0; i < n; i++)
+        {
+            simplex[i + 1] = start;
+            simplex[i + 1](i) += 0.5 * scale(i);
+        }
+        for (int i = 0; i <= n; i++)
+            cost[i] = Cost(simplex[i]);
+
+        int evaluation = n + 1;
+        while (evaluation < evaluation_num)
+        {
+            for (int i = 0; i <= n; i++)
+                order[i] = i;
+            std::sort(order.begin(), order.end(), [&cost](int l, int r) { return cost[l] < cost[r]; });
+
+            int worst = order[n];
+            int second_worst = order[n - 1];
+            int first = order[0];
+
+            VectorXd centroid = VectorXd::Zero(n);
+            for (int i = 0; i < n; i++)
+                centroid += simplex[order[i]];
+            centroid /= n;
+
+            VectorXd reflection = centroid + (centroid - simplex[worst]);
+            double reflection_cost = Cost(reflection);
+            evaluation++;
+
+            if (reflection_cost < cost[first])
+            {
+                VectorXd expansion = centroid + 2 * (centroid - simplex[worst]);
+                double expansion_cost = Cost(expansion);
+                evaluation++;
+                if (expansion_cost < reflection_cost)
+                {
+                    simplex[worst] = expansion;
+                    cost[worst] = expansion_cost;
+                }
+                else
+                {
+                    simplex[worst] = reflection;
+                    cost[worst] = reflection_cost;
+                }
+            }
+            else if (reflection_cost < cost[second_worst])
+            {
+                simplex[worst] = reflection;
+                cost[worst] = reflection_cost;
+            }
+            else
+            {
+                VectorXd contraction = centroid + 0.5 * (simplex[worst] - centroid);
+                double contraction_cost = Cost(contraction);
+                evaluation++;
+                if (contraction_cost < cost[worst])
+                {
+                    simplex[worst] = contraction;
+                    cost[worst] = contraction_cost;
+                }
+                else
+                {
+                    /* 向最优点收缩 */
+                    for (int i = 0; i <= n; i++)
+                        if (i != first)
+                        {
+                            simplex[i] = simplex[first] + 0.5 * (simplex[i] - simplex[first]);
+                            cost[i] = Cost(simplex[i]);
+                        }
+                    evaluation += n;
+                }
+            }
+        }
+
+        for (int i = 0; i <= n; i++)
+            if (cost[i] < best_cost)
+            {
+                best_cost = cost[i];
+                best = simplex[i];
+            }
+    }
+
+    Cost(best);
+
+    return violation_ <= 0;
+}
+
+void ExcitationTrajectory::PredictStd(double force_noise, double torque_noise, double sample_num, double gravity, const Vector3d &centroid,
+                                      double &gravity_std, Vector3d &centroid_std, Vector6d &zero_drift_std) const
+{
+    LDLT<Matrix4d> force_solver(force_information_ * sample_num);
+    LDLT<Matrix<double, 6, 6>> torque_solver(torque_information_ * sample_num);
+    Vector4d force_covariance = force_noise * force_noise * force_solver.solve(Matrix4d::Identity()).diagonal();
+    Vector6d torque_covariance = torque_noise * torque_noise * torque_solver.solve(Matrix<double, 6, 6>::Identity()).diagonal();
+
+    gravity_std = std::sqrt(force_covariance(0));
+    zero_drift_std << force_covariance.tail<3>().cwiseSqrt(), torque_covariance.tail<3>().cwiseSqrt();
+    for (int i = 0; i < 3; i++)
+        centroid_std(i) = std::sqrt(torque_covariance(i) + centroid(i) * centroid(i) * force_covariance(0)) / std::fabs(gravity);
+}
+
+void ExcitationTrajectory::PoseCondition(const BatchKinematics::JointBatch &q, double &force_condition, double &torque_condition)
+{
+    Matrix4d force_information;
+    Matrix<double, 6, 6> torque_information;
+
+    Information(q, force_information, torque_information, force_condition, torque_condition);
+}
@@ -0,0 +1,47 @@
+#include "force_recorder.h"
+
+#include "admittance.h"
+
+using namespace Eigen;
+
+ForceRecorder::ForceRecorder()
+    : count_(0), index_(0), tripped_(false)
+{
+    sum_ = Vector6d::Zero();
+    compensated_ = Vector6d::Zero();
+    average_ = Vector6d::Zero();
+}
+
+void ForceRecorder::AddPose(double stamp, const Vector6d &pose)
+{
+    Matrix<double, 3, 3, RowMajor> rotation_basis2end = Pose2HomogeneousTransform(pose).block<3, 3>(0, 0);
+    poses_.push(stamp, pose.data(), rotation_basis2end.data());
+}
+
+PoseBuffer::Status ForceRecorder::Record(const double raw[6], double stamp)
+{
+    tripped_ = false;
+
+    /*按本帧采样时刻的末端姿态补偿负载重力与零漂*/
+    double rotation_basis2end[9];
+    PoseBuffer::Status pose_status = poses_.lookup(stamp, NULL, rotation_basis2end);
+    if (pose_status == PoseBuffer::EMPTY)
+        return pose_status;
+
+    payload_.compensate(rotation_basis2end, raw, compensated_.data());
+
+    /*逐帧限幅, 不等待控制周期*/
+    tripped_ = safety_.update(compensated_.data()) == SafetyMonitor::TRIPPED;
+
+    /*滑动平均, 定长环形缓冲*/
+    if (count_ == kWindow)
+        sum_ -= window_[index_];
+    else
+        count_++;
+    window_[index_] = compensated_;
+    sum_ += compensated_;
+    index_ = (index_ + 1) % kWindow;
+    average_ = sum_ / count_;
+
+    return pose_status;
+}
@@ -0,0 +1,162 @@
+#include "gain_scheduler.h"
+
+#include <algorithm>
+
+using namespace Eigen;
+
+GainScheduler::GainScheduler()
+    : contact_force_(3.0), release_ratio_(0.5), insertion_velocity_(0), insertion_axis_(0, 0, 1), dwell_samples_(3),
+      transition_time_(0.5), initial_energy_(0.05), max_energy_(0.5)
+{
+    for (int i = 0; i < kStateNum; i++)
+    {
+        mass_[i] = Vector6d::Ones();
+        damping_[i] = Vector6d::Ones();
+        stiffness_[i] = Vector6d::Ones();
+    }
+    Reset();
+}
+
+void GainScheduler::SetGains(ContactState state, const Vector6d &mass, const Vector6d &damping, const Vector6d &stiffness)
+{
+    mass_[state] = mass;
+    damping_[state] = damping;
+    stiffness_[state] = stiffness;
+}
+
+void GainScheduler::SetThresholds(double contact_force, double release_ratio, double insertion_velocity,
+                                  const Vector3d &insertion_axis, int dwell_samples)
+{
+    contact_force_ = contact_force;
+    release_ratio_ = release_ratio;
+    insertion_velocity_ = insertion_velocity;
+    insertion_axis_ = insertion_axis.normalized();
+    dwell_samples_ = dwell_samples > 1 ? dwell_samples : 1;
+}
+
+void GainScheduler::SetTank(double initial_energy, double max_energy)
+{
+    initial_energy_ = initial_energy;
+    max_energy_ = max_energy > initial_energy ? max_energy : initial_energy;
+    tank_energy_ = initial_energy_;
+}
+
+void GainScheduler::Reset()
+{
+    state_ = FREE;
+    candidate_ = FREE;
+    candidate_count_ = 0;
+    progress_ = 1;
+    applied_step_ = kBlendSteps;
+    tank_energy_ = initial_energy_;
+    held_cycles_ = 0;
+
+    from_mass_ = mass_applied_ = mass_[FREE];
+    from_damping_ = damping_applied_ = damping_[FREE];
+    from_stiffness_ = stiffness_applied_ = stiffness_[FREE];
+    M_ = mass_applied_.asDiagonal();
+    D_ = damping_applied_.asDiagonal();
+    K_ = stiffness_applied_.asDiagonal();
+}
+
+const char *GainScheduler::StateName(ContactState state)
+{
+    switch (state)
+    {
+    case FREE:
+        return "free";
+    case CONTACT:
+        return "contact";
+    case INSERTION:
+        return "insertion";
+    default:
+        return "unknown";
+    }
+}
+
+GainScheduler::ContactState GainScheduler::Classify(const Vector6d &wrench_end, const Vector6d &velocity) const
+{
+    /*接触: 合外力带滞回*/
+    double force = wrench_end.head<3>().norm();
+    bool contact = state_ == FREE ? force > contact_force_ : force > contact_force_ * release_ratio_;
+    if (!contact)
+        return FREE;
+
+    /*插入: 接触中沿插入方向的速度带滞回, insertion_velocity 不大于 0 时不区分*/
+    if (insertion_velocity_ <= 0)
+        return CONTACT;
+    double axis_velocity = insertion_axis_.dot(velocity.head<3>());
+    if (state_ == INSERTION)
+        return axis_velocity > insertion_velocity_ * release_ratio_ ? INSERTION : CONTACT;
+    return axis_velocity > insertion_velocity_ ? INSERTION : CONTACT;
+}
+
+void GainScheduler::Interpolate(int step, Vector6d &mass, Vector6d &damping, Vector6d &stiffness) const
+{
+    double w = (double)step / kBlendSteps;
+    mass = from_mass_ + w * (mass_[state_] - from_mass_);
+    damping = from_damping_ + w * (damping_[state_] - from_damping_);
+    stiffness = from_stiffness_ + w * (stiffness_[state_] - from_stiffness_);
+}
+
+bool GainScheduler::Update(const Vector6d &wrench_end, const Vector6d &deviation, const Vector6d &velocity, double dt)
+{
+    /*能量箱由阻尼耗散的功率充能*/
+    tank_energy_ = std::min(max_energy_, tank_energy_ + velocity.cwiseAbs2().dot(damping_applied_) * dt);
+
+    /*状态切换: 新状态连续 dwell_samples 帧成立, 以当前使用的参数为起点重新插值*/
+    ContactState target = Classify(wrench_end, velocity);
+    if (target == state_)
+    {
+        candidate_ = state_;
+        candidate_count_ = 0;
+    }
+    else
+    {
+        candidate_count_ = target == candidate_ ? candidate_count_ + 1 : 1;
+        candidate_ = target;
+        if (candidate_count_ >= dwell_samples_)
+        {
+            from_mass_ = mass_applied_;
+            from_damping_ = damping_applied_;
+            from_stiffness_ = stiffness_applied_;
+            state_ = target;
+            candidate_count_ = 0;
+            progress_ = 0;
+            applied_step_ = 0;
+        }
+    }
+
+    if (applied_step_ >= kBlendSteps)
+        return false;
+
+    progress_ = transition_time_ > 0 ? std::min(1.0, progress_ + dt / transition_time_) : 1.0;
+    double smooth = progress_ * progress_ * (3 - 2 * progress_);
+    int desired_step = (int)(smooth * kBlendSteps + 1e-9);
+
+    /*由远及近取能量箱负担得起的级数*/
+    Vector6d deviation2 = deviation.cwiseAbs2();
+    Vector6d velocity2 = velocity.cwiseAbs2();
+    for (int step = desired_step; step > applied_step_; step--)
+    {
+        Vector6d mass, damping, stiffness;
+        Interpolate(step, mass, damping, stiffness);
+        double energy = 0.5 * deviation2.dot(stiffness - stiffness_applied_) + 0.5 * velocity2.dot(mass - mass_applied_);
+        if (energy > tank_energy_)
+            continue;
+
+        tank_energy_ = std::min(max_energy_, tank_energy_ - energy);
+        mass_applied_ = mass;
+        damping_applied_ = damping;
+        stiffness_applied_ = stiffness;
+        applied_step_ = step;
+        M_ = mass_applied_.asDiagonal();
+        D_ = damping_applied_.asDiagonal();
+        K_ = stiffness_applied_.asDiagonal();
+        return true;
+    }
+
+    if (desired_step > applied_step_)
+        held_cycles_++;
+    return false;
+}
@@ -1,155 +1,231 @@
-#include <sstream>
-#include <vector>
-#include <Eigen/Core>
-#include <Eigen/Geometry>
-#include "geometry_msgs/TwistStamped.h"
-#include "geometry_msgs/WrenchStamped.h"
-#include "robot_msgs/Move.h"
-#include "ros/ros.h"
-#include "std_msgs/String.h"
-#include "time.h"
-
-using namespace std;
-
-const double PI = 3.1415926;
-
-Eigen::Matrix3d Transform_Basis2End;
-Eigen::MatrixXd F_A(10 * 3, 4);
-Eigen::MatrixXd M_A(10 * 3, 6);
-Eigen::MatrixXd FT_Record(6, 1);
-Eigen::MatrixXd FT_Sum(6, 1);
-Eigen::MatrixXd F_measure(10 * 3, 1);
-Eigen::MatrixXd M_measure(10 * 3, 1);
-Eigen::MatrixXd F_parameter(4, 1);
-Eigen::MatrixXd M_parameter(6, 1);
-Eigen::MatrixXd Test_Joint_Angle(10, 6);
-robot_msgs::Move srv;
-
-void ForceRecord(const geometry_msgs::WrenchStamped::ConstPtr &msg)
-{
-    FT_Record(0, 0) = msg->wrench.force.x;
-    FT_Record(1, 0) = msg->wrench.force.y;
-    FT_Record(2, 0) = msg->wrench.force.z;
-    FT_Record(3, 0) = msg->wrench.torque.x;
-    FT_Record(4, 0) = msg->wrench.torque.y;
-    FT_Record(5, 0) = msg->wrench.torque.z;
-    ROS_INFO("I heard: force[%f, %f, %f] torque[%f, %f, %f]",
-             msg->wrench.force.x, msg->wrench.force.y, msg->wrench.force.z,
-             msg->wrench.torque.x, msg->wrench.torque.y, msg->wrench.torque.z);
-}
-void ToolPointRecord(const geometry_msgs::TwistStamped &msg)
-{
-    Transform_Basis2End = Eigen::AngleAxisd(msg.twist.angular.z, Eigen::Vector3d::UnitZ()) * Eigen::AngleAxisd(msg.twist.angular.y, Eigen::Vector3d::UnitY()) * Eigen::AngleAxisd(msg.twist.angular.x, Eigen::Vector3d::UnitX());
-    ROS_INFO("I heard: linear[%f, %f, %f] angular[%f, %f, %f]",
-             msg.twist.linear.x, msg.twist.linear.y, msg.twist.linear.z,
-             msg.twist.angular.x, msg.twist.angular.y, msg.twist.angular.z);
-    // cout << Transform_Basis2End << endl;
-}
-
-int main(int argc, char **argv)
-{
-    ros::init(argc, argv, "admittance_control");
-
-    ros::NodeHandle n;
-
-    ros::ServiceClient client = n.serviceClient<robot_msgs::Move>("/robot_driver/move_joint");
-
-    ros::Subscriber FTsensor_sub = n.subscribe("netft_data", 1, ForceRecord);
-    ros::Subscriber servo_line_sub = n.subscribe("/robot_driver/tool_point", 1, ToolPointRecord);
-
-    F_A = Eigen::MatrixXd::Zero(10 * 3, 4);
-    M_A = Eigen::MatrixXd::Zero(10 * 3, 6);
-    Test_Joint_Angle << 0.1652374610684933, 1.854585041861113, 1.898176046369952, 0.9835086341685395, -1.5764230571325082, 1.7271518570372968,
-        0.16542920866312294, 1.8091168934845507, 1.706895836502185, 1.914838685509543, -1.5775016373523, 1.7271518570372968,
-        0.1629604583822659, 1.810063647233035, 1.8530314720593273, 0.9035019503093071, -1.6826032876586914, 2.1433639796303385,
-        0.24077402912792148, 1.7577764750224547, 1.8510061380910512, 1.09290063690477, -1.8478777300048084, 1.883006698797231,
-        0.24075006067859278, 1.7577644907977907, 1.8510061380910512, 1.0930084949267491, -1.4051924551282067, 1.883006698797231,
-        0.2247151680776861, 1.7581360017623855, 1.8515454282009471, 1.2406541427916002, -1.5903367419678238, 1.883006698797231,
-        0.22596152744277898, 1.7586633076476172, 1.8516892388969193, 0.8232196292827942, -1.6298846833601948, 1.8828389196519297,
-        0.23514144353567473, 1.758519496951645, 1.8520847183108429, 1.1363913882117134, -1.5420642850198027, 1.8154755928135917,
-        0.23729860397525857, 1.7584595758283228, 1.8520008287381926, 1.2343264721688207, -1.6071146564979206, 1.7954739218487836,
-        0.23517739620966782, 1.8432000284299759, 1.8521925763328224, 1.1010618939011956, -1.5350295451418268, 1.7621937299558703;
-
-    for (int i = 0; i < 10; i++)
-    {
-        FT_Sum = Eigen::MatrixXd::Zero(6, 1);
-
-        srv.request.pose.clear();
-        srv.request.is_block = true;
-        srv.request.mvvelo = 0.5;
-        srv.request.mvacc = 0.05;
-        srv.request.pose.push_back(Test_Joint_Angle(i, 0));
-        srv.request.pose.push_back(Test_Joint_Angle(i, 1));
-        srv.request.pose.push_back(Test_Joint_Angle(i, 2));
-        srv.request.pose.push_back(Test_Joint_Angle(i, 3));
-        srv.request.pose.push_back(Test_Joint_Angle(i, 4));
-        srv.request.pose.push_back(Test_Joint_Angle(i, 5));
-
-        if (client.call(srv))
-        {
-            ROS_INFO("Response from server message: %s",
-                     srv.response.message.c_str());
-            sleep(3);
-            for (int j = 0; j < 10; j++)
-            {
-                ros::spinOnce();
-                FT_Sum = FT_Sum + FT_Record;
-                // cout << FT_Sum << endl;
-                sleep(1);
-            }
-            F_measure(3 * i, 0) = FT_Sum(0, 0) / 10.0;
-            F_measure(3 * i + 1, 0) = FT_Sum(1, 0) / 10.0;
-            F_measure(3 * i + 2, 0) = FT_Sum(2, 0) / 10.0;
-            M_measure(3 * i, 0) = FT_Sum(3, 0) / 10.0;
-            M_measure(3 * i + 1, 0) = FT_Sum(4, 0) / 10.0;
-            M_measure(3 * i + 2, 0) = FT_Sum(5, 0) / 10.0;
-            F_A(3 * i, 0) = Transform_Basis2End(2, 0);
-            F_A(3 * i + 1, 0) = Transform_Basis2End(2, 1);
-            F_A(3 * i + 2, 0) = Transform_Basis2End(2, 2);
-            F_A(3 * i, 1) = 1;
-            F_A(3 * i + 1, 2) = 1;
-            F_A(3 * i + 2, 3) = 1;
-        }
-        else
-        {
-            ROS_ERROR("failed to call /robot_driver/move_line");
-            return 1;
-        }
-    }
-
-    // cout << F_A << endl;
-    // cout << F_measure << endl;
-
-    F_parameter = F_A.transpose() * F_A;
-    F_parameter = F_parameter.inverse() * F_A.transpose() * F_measure;
-
-    cout << "Measured gravity is : " << F_parameter(0, 0) << endl;
-    cout << "Zero drift of force is : ( " << F_parameter(1, 0) << ", "
-         << F_parameter(2, 0) << ", " << F_parameter(3, 0) << ")" << endl;
-
-    for (int i = 0; i < 10; i++)
-    {
-        M_A(3 * i, 1) = F_parameter(0, 0) * F_A(3 * i + 2, 0);
-        M_A(3 * i, 2) = -F_parameter(0, 0) * F_A(3 * i + 1, 0);
-        M_A(3 * i + 1, 0) = -F_parameter(0, 0) * F_A(3 * i + 2, 0);
-        M_A(3 * i + 1, 2) = F_parameter(0, 0) * F_A(3 * i, 0);
-        M_A(3 * i + 2, 0) = F_parameter(0, 0) * F_A(3 * i + 1, 0);
-        M_A(3 * i + 2, 1) = -F_parameter(0, 0) * F_A(3 * i, 0);
-        M_A(3 * i, 3) = 1;
-        M_A(3 * i + 1, 4) = 1;
-        M_A(3 * i + 2, 5) = 1;
-    }
-
-    // cout << M_A << endl;
-    // cout << M_measure << endl;
-
-    M_parameter = M_A.transpose() * M_A;
-    M_parameter = M_parameter.inverse() * M_A.transpose() * M_measure;
-
-    cout << "Coordinate of centroid is : ( " << M_parameter(0, 0) << ", "
-         << M_parameter(1, 0) << ", " << M_parameter(2, 0) << ")" << endl;
-    cout << "Zero drift of torque is : ( " << M_parameter(3, 0) << ", "
-         << M_parameter(4, 0) << ", " << M_parameter(5, 0) << ")" << endl;
-
-    return 0;
-}
\ No newline at end of file
+#include <pthread.h>
+#include <sstream>
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include "geometry_msgs/TwistStamped.h"
+#include "geometry_msgs/WrenchStamped.h"
+#include "payload_identification.h"
+#include "wrench_compensation.h"
+#include "robot_msgs/CancelMove.h"
+#include "robot_msgs/MoveFeedback.h"
+#include "robot_msgs/MovePath.h"
+#include "ros/ros.h"
+#include "std_msgs/String.h"
+#include "time.h"
+
+using namespace std;
+
+pthread_mutex_t mutex;
+
+/* 以下变量由回调线程写入, 均受 mutex 保护 */
+PayloadIdentification identification;
+Eigen::Matrix3d Transform_Basis2End;
+ros::Time tool_point_stamp;
+bool tool_point_ready = false;
+double max_skew = 0.02; // 力传感器与末端姿态的最大时间差 (s)
+int skipped_sample_num = 0;
+uint32_t goal_id = 0;
+int goal_state = -1;
+
+Eigen::MatrixXd Test_Joint_Angle(10, 6);
+
+/* 每个传感器采样都与最近的末端姿态配对后送入递推最小二乘, 时间差过大的采样丢弃 */
+void ForceRecord(const geometry_msgs::WrenchStamped::ConstPtr &msg)
+{
+    Vector6d wrench;
+    wrench << msg->wrench.force.x, msg->wrench.force.y, msg->wrench.force.z,
+        msg->wrench.torque.x, msg->wrench.torque.y, msg->wrench.torque.z;
+    ros::Time stamp = msg->header.stamp.isZero() ? ros::Time::now() : msg->header.stamp;
+
+    pthread_mutex_lock(&mutex);
+    if (tool_point_ready && fabs((stamp - tool_point_stamp).toSec()) <= max_skew)
+        identification.AddSample(wrench, Transform_Basis2End);
+    else
+        skipped_sample_num++;
+    pthread_mutex_unlock(&mutex);
+}
+
+void ToolPointRecord(const geometry_msgs::TwistStamped::ConstPtr &msg)
+{
+    Eigen::Matrix3d rotation;
+    rotation = Eigen::AngleAxisd(msg->twist.angular.z, Eigen::Vector3d::UnitZ()) * Eigen::AngleAxisd(msg->twist.angular.y, Eigen::Vector3d::UnitY()) * Eigen::AngleAxisd(msg->twist.angular.x, Eigen::Vector3d::UnitX());
+
+    pthread_mutex_lock(&mutex);
+    Transform_Basis2End = rotation;
+    tool_point_stamp = msg->header.stamp.isZero() ? ros::Time::now() : msg->header.stamp;
+    tool_point_ready = true;
+    pthread_mutex_unlock(&mutex);
+}
+
+void MoveFeedbackRecord(const robot_msgs::MoveFeedback::ConstPtr &msg)
+{
+    pthread_mutex_lock(&mutex);
+    if (msg->goal_id == goal_id)
+        goal_state = msg->state;
+    pthread_mutex_unlock(&mutex);
+}
+
+int main(int argc, char **argv)
+{
+    ros::init(argc, argv, "gravity_calibration");
+
+    ros::NodeHandle n;
+    ros::NodeHandle private_n("~");
+
+    pthread_mutex_init(&mutex, NULL);
+
+    /* 标定参数 */
+    double velocity, acceleration, blend_radius;
+    double gravity_std, centroid_std;
+    int min_sample_num;
+    string output;
+    private_n.param("velocity", velocity, 0.5);
+    private_n.param("acceleration", acceleration, 0.05);
+    private_n.param("blend_radius", blend_radius, 0.0);
+    private_n.param("max_skew", max_skew, 0.02);
+    private_n.param("gravity_std", gravity_std, 0.02);
+    private_n.param("centroid_std", centroid_std, 0.0002);
+    private_n.param("min_sample_num", min_sample_num, 1000);
+    private_n.param("output", output, string("payload_calibration.yaml"));
+
+    ros::ServiceClient client = n.serviceClient<robot_msgs::MovePath>("/robot_driver/move_path");
+    ros::ServiceClient cancel_client = n.serviceClient<robot_msgs::CancelMove>("/robot_driver/cancel_move");
+
+    ros::Subscriber FTsensor_sub = n.subscribe("netft_data", 100, ForceRecord);
+    ros::Subscriber servo_line_sub = n.subscribe("/robot_driver/tool_point", 10, ToolPointRecord);
+    ros::Subscriber feedback_sub = n.subscribe("/robot_driver/move_feedback", 10, MoveFeedbackRecord);
+
+    ros::AsyncSpinner spinner(1);
+    spinner.start();
+
+    Test_Joint_Angle << 0.1652374610684933, 1.854585041861113, 1.898176046369952, 0.9835086341685395, -1.5764230571325082, 1.7271518570372968,
+        0.16542920866312294, 1.8091168934845507, 1.706895836502185, 1.914838685509543, -1.5775016373523, 1.7271518570372968,
+        0.1629604583822659, 1.810063647233035, 1.8530314720593273, 0.9035019503093071, -1.6826032876586914, 2.1433639796303385,
+        0.24077402912792148, 1.7577764750224547, 1.8510061380910512, 1.09290063690477, -1.8478777300048084, 1.883006698797231,
+        0.24075006067859278, 1.7577644907977907, 1.8510061380910512, 1.0930084949267491, -1.4051924551282067, 1.883006698797231,
+        0.2247151680776861, 1.7581360017623855, 1.8515454282009471, 1.2406541427916002, -1.5903367419678238, 1.883006698797231,
+        0.22596152744277898, 1.7586633076476172, 1.8516892388969193, 0.8232196292827942, -1.6298846833601948, 1.8828389196519297,
+        0.23514144353567473, 1.758519496951645, 1.8520847183108429, 1.1363913882117134, -1.5420642850198027, 1.8154755928135917,
+        0.23729860397525857, 1.7584595758283228, 1.8520008287381926, 1.2343264721688207, -1.6071146564979206, 1.7954739218487836,
+        0.23517739620966782, 1.8432000284299759, 1.8521925763328224, 1.1010618939011956, -1.5350295451418268, 1.7621937299558703;
+
+    /* ~poses 为 excitation_generator 生成的路径点 (rad, 每 6 个一组), 未设置时使用上面的 10 个姿态 */
+    vector<double> pose_list;
+    if (private_n.getParam("poses", pose_list) && !pose_list.empty() && pose_list.size() % 6 == 0)
+    {
+        Test_Joint_Angle.resize(pose_list.size() / 6, 6);
+        for (int i = 0; i < Test_Joint_Angle.rows(); i++)
+            for (int j = 0; j < 6; j++)
+                Test_Joint_Angle(i, j) = pose_list[6 * i + j];
+        ROS_INFO("%d calibration poses loaded", (int)Test_Joint_Angle.rows());
+    }
+
+    /* 所有姿态作为一条连续路径下发, 运动过程中持续采样, 不再逐点停留平均 */
+    robot_msgs::MovePath srv;
+    srv.request.type = robot_msgs::MovePath::Request::JOINT;
+    srv.request.is_block = false;
+    srv.request.preempt = false;
+    for (int i = 0; i < Test_Joint_Angle.rows(); i++)
+    {
+        robot_msgs::PathPoint point;
+        for (int j = 0; j < 6; j++)
+            point.pose[j] = Test_Joint_Angle(i, j);
+        point.mvvelo = velocity;
+        point.mvacc = acceleration;
+        point.mvradii = i + 1 < Test_Joint_Angle.rows() ? blend_radius : 0;
+        srv.request.points.push_back(point);
+    }
+
+    if (!client.call(srv) || srv.response.ret != 1)
+    {
+        ROS_ERROR("failed to call /robot_driver/move_path: %s", srv.response.message.c_str());
+        return 1;
+    }
+    ROS_INFO("Response from server message: %s", srv.response.message.c_str());
+
+    pthread_mutex_lock(&mutex);
+    goal_id = srv.response.goal_id;
+    pthread_mutex_unlock(&mutex);
+
+    ros::WallTime start_time = ros::WallTime::now();
+    bool converged = false;
+    ros::Rate rate(10);
+    while (ros::ok())
+    {
+        pthread_mutex_lock(&mutex);
+        bool solved = identification.Solve();
+        PayloadIdentification result = identification;
+        int state = goal_state;
+        pthread_mutex_unlock(&mutex);
+
+        if (solved)
+        {
+            ROS_INFO("samples %d, gravity %f (std %f), centroid std (%f, %f, %f)",
+                     result.SampleNum(), result.Gravity(), result.GravityStd(),
+                     result.CentroidStd()(0), result.CentroidStd()(1), result.CentroidStd()(2));
+            if (result.SampleNum() >= min_sample_num && result.Converged(gravity_std, centroid_std))
+            {
+                converged = true;
+                break;
+            }
+        }
+
+        if (state >= robot_msgs::MoveFeedback::SUCCEEDED)
+        {
+            if (state != robot_msgs::MoveFeedback::SUCCEEDED)
+                ROS_WARN("calibration path ended with state %d", state);
+            break;
+        }
+
+        rate.sleep();
+    }
+
+    if (converged)
+    {
+        robot_msgs::CancelMove cancel;
+        cancel.request.goal_id = srv.response.goal_id;
+        cancel_client.call(cancel);
+    }
+
+    spinner.stop();
+
+    pthread_mutex_lock(&mutex);
+    bool solved = identification.Solve();
+    PayloadIdentification result = identification;
+    int skipped = skipped_sample_num;
+    pthread_mutex_unlock(&mutex);
+
+    if (!solved)
+    {
+        ROS_ERROR("not enough orientation change for calibration, %d samples used, %d skipped", result.SampleNum(), skipped);
+        return 1;
+    }
+
+    const Eigen::Vector3d &centroid = result.Centroid();
+    const Vector6d &zero_drift = result.ZeroDrift();
+    const Vector6d &zero_drift_std = result.ZeroDriftStd();
+
+    cout << "Measured gravity is : " << result.Gravity() << " (std " << result.GravityStd() << ")" << endl;
+    cout << "Zero drift of force is : ( " << zero_drift(0) << ", "
+         << zero_drift(1) << ", " << zero_drift(2) << ") (std " << zero_drift_std.head<3>().transpose() << ")" << endl;
+    cout << "Coordinate of centroid is : ( " << centroid(0) << ", "
+         << centroid(1) << ", " << centroid(2) << ") (std " << result.CentroidStd().transpose() << ")" << endl;
+    cout << "Zero drift of torque is : ( " << zero_drift(3) << ", "
+         << zero_drift(4) << ", " << zero_drift(5) << ") (std " << zero_drift_std.tail<3>().transpose() << ")" << endl;
+    cout << "Residual rms is : force " << result.ForceResidual() << ", torque " << result.TorqueResidual() << endl;
+    cout << result.SampleNum() << " samples used, " << skipped << " skipped, "
+         << (ros::WallTime::now() - start_time).toSec() << " s" << (converged ? ", converged" : "") << endl;
+
+    /* 写成 netft_utils/config/payload_calibration.yaml 的格式, 供 netft_utils 与 admittance_control 加载 */
+    WrenchCompensation payload;
+    payload.setCalibration(result.Gravity(), centroid.data(), zero_drift.data());
+    if (payload.saveCalibration(output))
+        ROS_INFO("calibration written to %s", output.c_str());
+    else
+        ROS_ERROR("failed to write %s", output.c_str());
+
+    pthread_mutex_destroy(&mutex);
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include "dynamic_model.h"
+#include "batch_kinematics.h"
+
+using namespace std;
+using namespace Eigen;
+
+/**
+ * BatchKinematics 校验与计时:
+ *   1. 与逐组的 JakaDynamics::FlangePose / FlangeJacobian 对比 (法兰雅可比 = diag(R^T, R^T) * 基坐标系雅可比)
+ *   2. 逐组计算、批量单线程、批量线程池的耗时 (us/组)
+ * 用法: kinematics_benchmark [configurations] [threads]
+ */
+
+double Seconds(const chrono::steady_clock::time_point &start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    int configurations = argc > 1 ? atoi(argv[1]) : 100000;
+    int threads = argc > 2 ? atoi(argv[2]) : (int)thread::hardware_concurrency();
+    const int repeat = 5;
+
+    JakaDynamics dynamics;
+    BatchKinematics batch(JakaMDH::MDH());
+    BatchKinematics parallel_batch(JakaMDH::MDH(), threads);
+
+    srand(1);
+    BatchKinematics::JointBatch q = BatchKinematics::JointBatch::Random(configurations, 6) * 3.14;
+    BatchKinematics::PoseBatch pose, parallel_pose;
+    BatchKinematics::JacobianBatch jacobian, parallel_jacobian;
+
+    batch.Jacobian(q, pose, jacobian);
+    parallel_batch.Jacobian(q, parallel_pose, parallel_jacobian);
+
+    double error_pose = 0, error_jacobian = 0, error_parallel = 0;
+    for (int k = 0; k < configurations; k++)
+    {
+        Vector6d q_once = q.row(k).transpose();
+        Matrix4d flange_pose;
+        Matrix6d flange_jacobian;
+        dynamics.FlangePose(q_once, flange_pose);
+        dynamics.FlangeJacobian(q_once, flange_jacobian);
+
+        Matrix4d batch_pose = BatchKinematics::PoseAt(pose, k);
+        Matrix6d batch_jacobian = BatchKinematics::JacobianAt(jacobian, k);
+        Matrix3d R = batch_pose.block<3, 3>(0, 0);
+        batch_jacobian.block<3, 6>(0, 0) = R.transpose() * batch_jacobian.block<3, 6>(0, 0);
+        batch_jacobian.block<3, 6>(3, 0) = R.transpose() * batch_jacobian.block<3, 6>(3, 0);
+
+        error_pose = fmax(error_pose, (batch_pose - flange_pose).cwiseAbs().maxCoeff());
+        error_jacobian = fmax(error_jacobian, (batch_jacobian - flange_jacobian).cwiseAbs().maxCoeff());
+    }
+    error_parallel = fmax((pose - parallel_pose).cwiseAbs().maxCoeff(), (jacobian - parallel_jacobian).cwiseAbs().maxCoeff());
+
+    cout << setprecision(3) << scientific;
+    cout << "configurations: " << configurations << ", threads: " << threads << endl;
+    cout << "batch pose vs FlangePose         max error: " << error_pose << endl;
+    cout << "batch jacobian vs FlangeJacobian max error: " << error_jacobian << endl;
+    cout << "thread pool vs single thread     max diff: " << error_parallel << endl;
+
+    double sink = 0;
+    Matrix4d flange_pose;
+    Matrix6d flange_jacobian;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++)
+        for (int k = 0; k < configurations; k++)
+        {
+            Vector6d q_once = q.row(k).transpose();
+            dynamics.FlangePose(q_once, flange_pose);
+            dynamics.FlangeJacobian(q_once, flange_jacobian);
+            sink += flange_pose(0, 3) + flange_jacobian(0, 0);
+        }
+    double per_config = Seconds(start) / repeat / configurations * 1e6;
+
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++)
+    {
+        batch.Jacobian(q, pose, jacobian);
+        sink += pose(0, 9);
+    }
+    double single_thread = Seconds(start) / repeat / configurations * 1e6;
+
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++)
+    {
+        parallel_batch.Jacobian(q, pose, jacobian);
+        sink += pose(0, 9);
+    }
+    double thread_pool = Seconds(start) / repeat / configurations * 1e6;
+
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++)
+    {
+        batch.Forward(q, pose);
+        sink += pose(0, 9);
+    }
+    double forward_only = Seconds(start) / repeat / configurations * 1e6;
+
+    cout << fixed << setprecision(4);
+    cout << "pose + jacobian, per configuration (us/config): " << per_config << endl;
+    cout << "pose + jacobian, batch single thread (us/config): " << single_thread << endl;
+    cout << "pose + jacobian, batch thread pool   (us/config): " << thread_pool << endl;
+    cout << "pose only,       batch single thread (us/config): " << forward_only << endl;
+    cout << "(" << sink << ")" << endl;
+
+    bool pass = error_pose < 1e-12 && error_jacobian < 1e-12 && error_parallel == 0;
+    cout << (pass ? "PASS" : "FAIL") << endl;
+
+    return pass ? 0 : 1;
+}
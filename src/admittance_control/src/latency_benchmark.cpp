@@ -0,0 +1,606 @@
+/**
+ * 端到端延迟基准: 力传感器 UDP 包 -> servo_j
+ *
+ * 整条链路在一个进程内运行 (需要 roscore), 硬件由本地替身代替:
+ *   RdtSender       RDT 协议发送端, 代替 NetFT 盒子, 监听 127.0.0.1:49152
+ *   NetFTRDTDriver  真实驱动, 同 netft_node 发布 ~netft_data
+ *   ForceRecorder   ArmController::ForceRecord 所用的补偿、限幅与滑动平均
+ *   Admittance      导纳单步 (同 ArmController::Step), 发布 ~servo_move (robot_msgs/ServoL)
+ *   ServoSession    connect_robot 的伺服线程: 进入伺服, IK, servo_j, 连接 jaka_mock 机器人;
+ *                   其 PollState 即 connect_robot 的状态轮询
+ *
+ * 每个采样以 RDT 序号为 id, 在各阶段用 CLOCK_MONOTONIC 打点, ServoL.header.stamp
+ * 携带采样时间戳穿过话题. 被更新采样覆盖 (导纳周期内未被使用) 的采样不计入统计.
+ * 结束时输出各阶段与总延迟的 p50/p99/p999, ~max_total_p99_ms > 0 时超出则返回 1.
+ */
+
+#include "ros/ros.h"
+#include "ros/callback_queue.h"
+#include "geometry_msgs/WrenchStamped.h"
+#include "robot_msgs/ServoL.h"
+#include "netft_rdt_driver.h"
+#include "diagnostic_updater/DiagnosticStatusWrapper.h"
+#include "servo_pipeline.h"
+#include "servo_session.h"
+#include "jaka_mock.h"
+#include "admittance.h"
+#include "force_recorder.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using namespace Eigen;
+
+enum Stage
+{
+    STAGE_SEND,             // UDP 包发出
+    STAGE_RDT,              // NetFTRDTDriver 接收, getData 返回
+    STAGE_FORCE_RECORD_IN,  // netft_data 到达 ForceRecord
+    STAGE_FORCE_RECORD,     // 滑动平均更新完成
+    STAGE_ADMITTANCE_IN,    // 导纳周期取到该采样
+    STAGE_ADMITTANCE,       // 导纳单步完成, 发布 servo_move
+    STAGE_SERVO_ACCEPTED,   // ServoSession::Accept
+    STAGE_IK,               // SetTarget (servo_j 流水线含 kine_inverse)
+    STAGE_SERVO_J,          // 第一个插补点 servo_j / servo_p 返回
+    STAGE_NUM
+};
+
+const char *kStageName[STAGE_NUM] = {"send", "NetFTRDTDriver", "netft_data", "ForceRecord", "admittance wait",
+                                     "admittance step", "servo_move", "IK", "servo_j"};
+
+const int kTraceSize = 8192;
+const int kRdtPort = 49152;
+
+struct Trace
+{
+    uint32_t id;
+    ros::Time stamp; // NetFTRDTDriver 打的时间戳, 话题上的采样标识
+    double t[STAGE_NUM];
+};
+
+Trace traces[kTraceSize];
+uint32_t latest_id = 0;
+pthread_mutex_t trace_mutex;
+
+vector<double> stage_latency[STAGE_NUM]; // [0] 为总延迟
+size_t samples = 500;
+volatile bool running = true;
+
+JAKAZuRobot robot;
+pthread_mutex_t robot_mutex; // 同 connect_robot 的 mutex, 保护 robot
+ServoPipeline servo_pipeline(robot, robot_mutex);
+ServoSession servo_session(robot, robot_mutex, servo_pipeline);
+
+pthread_mutex_t state_mutex;
+Vector6d current_tcp = Vector6d::Zero(); // m, rad
+
+ForceRecorder force_recorder;
+pthread_mutex_t FTsensor_mutex;
+Vector6d FTsensor_data = Vector6d::Zero();
+ros::Time FTsensor_stamp;
+
+Vector6d sensor_wrench = Vector6d::Zero(); // RdtSender 发送的基准读数
+
+double Now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* 首次到达该阶段时打点 */
+void Mark(uint32_t id, Stage stage)
+{
+    double now = Now();
+
+    pthread_mutex_lock(&trace_mutex);
+    Trace &trace = traces[id % kTraceSize];
+    if (trace.id == id && trace.t[stage] == 0)
+        trace.t[stage] = now;
+    pthread_mutex_unlock(&trace_mutex);
+}
+
+/* 由话题上的时间戳找回采样 id */
+bool FindId(const ros::Time &stamp, uint32_t &id)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&trace_mutex);
+    for (uint32_t k = 0; k < kTraceSize && k < latest_id; k++)
+    {
+        const Trace &trace = traces[(latest_id - k) % kTraceSize];
+        if (trace.stamp == stamp)
+        {
+            id = trace.id;
+            found = true;
+            break;
+        }
+        if (!trace.stamp.isZero() && trace.stamp < stamp)
+            break;
+    }
+    pthread_mutex_unlock(&trace_mutex);
+
+    return found;
+}
+
+/* 采样到达 servo_j, 记录各阶段延迟 */
+void Complete(uint32_t id)
+{
+    pthread_mutex_lock(&trace_mutex);
+
+    const Trace &trace = traces[id % kTraceSize];
+    bool complete = trace.id == id;
+    for (int s = 0; s < STAGE_NUM && complete; s++)
+        complete = trace.t[s] != 0;
+
+    if (complete && stage_latency[0].size() < samples)
+    {
+        stage_latency[0].push_back(trace.t[STAGE_NUM - 1] - trace.t[0]);
+        for (int s = 1; s < STAGE_NUM; s++)
+            stage_latency[s].push_back(trace.t[s] - trace.t[s - 1]);
+    }
+    if (stage_latency[0].size() >= samples)
+        running = false;
+
+    pthread_mutex_unlock(&trace_mutex);
+}
+
+static void Pack32(uint8_t *buffer, uint32_t value)
+{
+    buffer[0] = (value >> 24) & 0xFF;
+    buffer[1] = (value >> 16) & 0xFF;
+    buffer[2] = (value >> 8) & 0xFF;
+    buffer[3] = (value >> 0) & 0xFF;
+}
+
+struct SenderArgs
+{
+    int sock;
+    double rate;
+};
+
+/* RDT 发送端: 收到 start streaming 后按 rate 持续发包, 载荷为基准读数 + 0.5 Hz 的 z 向接触力 */
+void *RdtSender(void *args)
+{
+    SenderArgs *sender = (SenderArgs *)args;
+    uint8_t buffer[36];
+    sockaddr_in peer;
+    socklen_t peer_len = sizeof(peer);
+
+    if (recvfrom(sender->sock, buffer, sizeof(buffer), 0, (sockaddr *)&peer, &peer_len) < 0)
+    {
+        ROS_ERROR("RdtSender: no start command");
+        return NULL;
+    }
+
+    timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    long period_ns = static_cast<long>(1e9 / sender->rate);
+    double start = Now();
+
+    for (uint32_t id = 1; running; id++)
+    {
+        Vector6d wrench = sensor_wrench;
+        wrench(2) += -2.0 * sin(2 * M_PI * 0.5 * (Now() - start));
+
+        Pack32(buffer + 0, id);
+        Pack32(buffer + 4, id);
+        Pack32(buffer + 8, 0);
+        for (int i = 0; i < 6; i++)
+            Pack32(buffer + 12 + 4 * i, static_cast<uint32_t>(static_cast<int32_t>(lround(wrench(i) * 1000000))));
+
+        pthread_mutex_lock(&trace_mutex);
+        Trace &trace = traces[id % kTraceSize];
+        trace.id = id;
+        trace.stamp = ros::Time();
+        memset(trace.t, 0, sizeof(trace.t));
+        trace.t[STAGE_SEND] = Now();
+        latest_id = id;
+        pthread_mutex_unlock(&trace_mutex);
+
+        sendto(sender->sock, buffer, sizeof(buffer), 0, (sockaddr *)&peer, peer_len);
+
+        next.tv_nsec += period_ns;
+        while (next.tv_nsec >= 1000000000)
+        {
+            next.tv_nsec -= 1000000000;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+
+    return NULL;
+}
+
+/* 同 netft_node: 等待新数据并发布 */
+void *NetftPublish(void *args)
+{
+    netft_rdt_driver::NetFTRDTDriver *netft = (netft_rdt_driver::NetFTRDTDriver *)args;
+    ros::NodeHandle n("~");
+    ros::Publisher pub = n.advertise<geometry_msgs::WrenchStamped>("netft_data", 100);
+    geometry_msgs::WrenchStamped data;
+
+    while (running && ros::ok())
+    {
+        if (!netft->waitForNewData())
+            continue;
+
+        netft->getData(data);
+
+        // 回环上无丢包时第 seq 个有效包即 RDT 序号 seq + 1, 丢包数见结果中的 Lost packets
+        uint32_t id = data.header.seq + 1;
+        pthread_mutex_lock(&trace_mutex);
+        if (traces[id % kTraceSize].id == id)
+            traces[id % kTraceSize].stamp = data.header.stamp;
+        pthread_mutex_unlock(&trace_mutex);
+        Mark(id, STAGE_RDT);
+
+        pub.publish(data);
+    }
+
+    return NULL;
+}
+
+/* ArmController::ForceRecord 的处理, 前后打点 */
+void ForceRecord(const geometry_msgs::WrenchStamped::ConstPtr &msg)
+{
+    uint32_t id = 0;
+    bool traced = FindId(msg->header.stamp, id);
+    if (traced)
+        Mark(id, STAGE_FORCE_RECORD_IN);
+
+    double FTdata_raw[6] = {msg->wrench.force.x, msg->wrench.force.y, msg->wrench.force.z,
+                            msg->wrench.torque.x, msg->wrench.torque.y, msg->wrench.torque.z};
+    if (force_recorder.Record(FTdata_raw, msg->header.stamp.toSec()) == PoseBuffer::EMPTY)
+        return;
+
+    pthread_mutex_lock(&FTsensor_mutex);
+    FTsensor_data = force_recorder.Average();
+    FTsensor_stamp = msg->header.stamp;
+    pthread_mutex_unlock(&FTsensor_mutex);
+
+    if (traced)
+        Mark(id, STAGE_FORCE_RECORD);
+}
+
+void *FTsensorFilter(void *args)
+{
+    ros::NodeHandle n("~");
+    ros::Subscriber FTsensor_sub = n.subscribe<geometry_msgs::WrenchStamped>("netft_data", 1, &ForceRecord);
+
+    while (running && ros::ok())
+        ros::getGlobalCallbackQueue()->callAvailable(ros::WallDuration(0.1));
+
+    return NULL;
+}
+
+/* connect_robot::RobotStatePublish 的状态轮询, 与伺服线程竞争 robot 锁; 末端位姿同 tool_point 交给 ForceRecorder */
+void *RobotStatePoll(void *args)
+{
+    ros::Rate rate(*(double *)args);
+
+    while (running && ros::ok())
+    {
+        RobotStatus robot_status;
+        if (servo_session.PollState(robot_status))
+        {
+            Vector6d tcp;
+            for (int i = 0; i < 6; i++)
+                tcp(i) = i < 3 ? robot_status.cartesiantran_position[i] / 1000 : robot_status.cartesiantran_position[i];
+            force_recorder.AddPose(ros::Time::now().toSec(), tcp);
+
+            pthread_mutex_lock(&state_mutex);
+            current_tcp = tcp;
+            pthread_mutex_unlock(&state_mutex);
+        }
+
+        rate.sleep();
+    }
+
+    return NULL;
+}
+
+/* 伺服各阶段打点, 第一个插补点下发即该采样完成 */
+void ServoTrace(ServoSession::Stage stage, const ros::Time &stamp)
+{
+    uint32_t id = 0;
+    if (!FindId(stamp, id))
+        return;
+
+    switch (stage)
+    {
+    case ServoSession::STAGE_ACCEPTED:
+        Mark(id, STAGE_SERVO_ACCEPTED);
+        break;
+    case ServoSession::STAGE_TARGET:
+        Mark(id, STAGE_IK);
+        break;
+    case ServoSession::STAGE_STEP:
+        Mark(id, STAGE_SERVO_J);
+        Complete(id);
+        break;
+    }
+}
+
+/* connect_robot 的伺服线程, 订阅 ~servo_move */
+void *ServoMove(void *args)
+{
+    servo_session.SetTraceCallback(ServoTrace);
+    servo_session.Run(ros::NodeHandle("~"), "servo_move");
+
+    return NULL;
+}
+
+double Percentile(const vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+
+    size_t index = static_cast<size_t>(ceil(p * sorted.size()));
+
+    return sorted[min(sorted.size() - 1, index > 0 ? index - 1 : 0)];
+}
+
+int main(int argc, char **argv)
+{
+    ros::init(argc, argv, "latency_benchmark");
+    ros::NodeHandle n;
+
+    pthread_mutex_init(&trace_mutex, NULL);
+    pthread_mutex_init(&robot_mutex, NULL);
+    pthread_mutex_init(&state_mutex, NULL);
+    pthread_mutex_init(&FTsensor_mutex, NULL);
+
+#pragma region /*基准参数*/
+    int sample_num = 500;
+    double sensor_rate = 1000;
+    double control_rate = 10; // 同 admittance_control
+    double state_rate = 100;  // 同 RobotStatePublish
+    double max_total_p99_ms = 0;
+
+    ros::param::param<int>("~samples", sample_num, sample_num);
+    ros::param::param<double>("~sensor_rate", sensor_rate, sensor_rate);
+    ros::param::param<double>("~control_rate", control_rate, control_rate);
+    ros::param::param<double>("~state_rate", state_rate, state_rate);
+    ros::param::param<double>("~max_total_p99_ms", max_total_p99_ms, max_total_p99_ms);
+    samples = sample_num > 0 ? sample_num : 1;
+
+    jaka_mock::Config mock_config;
+    ros::param::param<double>("~sdk_latency_us", mock_config.latency_us, mock_config.latency_us);
+    ros::param::param<double>("~sdk_jitter_us", mock_config.jitter_us, mock_config.jitter_us);
+    jaka_mock::SetConfig(mock_config);
+
+    ServoConfig servo_config;
+    int servo_mode = servo_config.mode;
+    int servo_filter = servo_config.filter;
+    std::vector<double> servo_filter_params(servo_config.filter_params, servo_config.filter_params + servo_config.filter_param_num);
+    std::string servo_error;
+
+    ros::param::param<int>("~servo_pipeline", servo_mode, servo_mode);
+    ros::param::param<int>("~servo_filter", servo_filter, servo_filter);
+    ros::param::param<std::vector<double>>("~servo_filter_params", servo_filter_params, servo_filter_params);
+    ros::param::param<double>("~servo_interp_time", servo_config.interp_time, servo_config.interp_time);
+
+    servo_config.mode = static_cast<ServoPipelineMode>(servo_mode);
+    servo_config.filter = static_cast<ServoFilterType>(servo_filter);
+    servo_config.filter_param_num = servo_filter_params.size();
+    for (int i = 0; i < servo_config.filter_param_num && i < 6; i++)
+        servo_config.filter_params[i] = servo_filter_params[i];
+
+    if (!servo_pipeline.SetConfig(servo_config, servo_error))
+    {
+        ROS_ERROR("invalid servo config: %s", servo_error.c_str());
+        return 1;
+    }
+
+    for (int s = 0; s < STAGE_NUM; s++)
+        stage_latency[s].reserve(samples);
+#pragma endregion
+
+#pragma region /*机器人替身*/
+    robot.login_in("127.0.0.1");
+    robot.power_on();
+    robot.enable_robot();
+
+    RobotStatus robot_status;
+    servo_session.PollState(robot_status);
+    Vector6d start_pose;
+    for (int i = 0; i < 6; i++)
+        start_pose(i) = i < 3 ? robot_status.cartesiantran_position[i] / 1000 : robot_status.cartesiantran_position[i];
+    current_tcp = start_pose;
+    force_recorder.AddPose(ros::Time::now().toSec(), start_pose);
+
+    // 同 connect_robot 收到第一个 servo_mode 位姿时, 在计时开始前进入伺服
+    if (servo_session.Open() != 0)
+    {
+        ROS_ERROR("servo enable failed");
+        return 1;
+    }
+#pragma endregion
+
+#pragma region /*导纳参数, 同 admittance_control*/
+    Admittance admittance;
+    admittance.SetIntegration(Admittance::EULER);
+    Matrix6d M = Matrix6d::Identity();
+    Matrix6d D = Matrix6d::Identity();
+    Matrix6d K = Matrix6d::Identity();
+    double M_array[6] = {100, 100, 150, 1, 1, 20};
+    double D_array[6] = {500, 500, 500, 20, 20, 50};
+    double K_array[6] = {80, 100, 200, 10, 10, 50};
+    for (int i = 0; i < 6; i++)
+    {
+        M(i, i) = M_array[i];
+        D(i, i) = D_array[i];
+        K(i, i) = K_array[i];
+    }
+
+    const double zero_drift_compensation[6] = {-5.49, -2.99, -0.21, -0.393, 0.172, -0.157};
+    const double centroid_sensor[3] = {0.000226404, -4.35079e-05, 0.00441495};
+    WrenchCompensation &payload = force_recorder.Payload();
+    Vector6d expected_wrench;
+    Matrix6d jacobian_sensor2end = Matrix6d::Identity();
+    payload.setCalibration(-18.9807, centroid_sensor, zero_drift_compensation);
+    expected_wrench << 0, 0, -5, 0, 0, 0;
+    jacobian_sensor2end(3, 1) = -28.6 / 1000.0;
+    jacobian_sensor2end(4, 0) = 28.6 / 1000.0;
+
+    admittance.SetMDK(M, D, K);
+    admittance.SetSensor(payload, jacobian_sensor2end);
+    admittance.SetExpectedWrench(expected_wrench);
+    admittance.Reset(start_pose);
+
+    // 传感器读数 = 零漂 + 起始姿态下的负载重力 + 期望接触力
+    Matrix<double, 3, 3, RowMajor> start_rotation = Pose2HomogeneousTransform(start_pose).block<3, 3>(0, 0);
+    payload.predict(start_rotation.data(), sensor_wrench.data());
+    sensor_wrench += expected_wrench;
+#pragma endregion
+
+#pragma region /*传感器替身与驱动*/
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    int reuse = 1;
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kRdtPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (sock < 0 || bind(sock, (sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        ROS_ERROR("cannot bind 127.0.0.1:%d", kRdtPort);
+        return 1;
+    }
+
+    SenderArgs sender_args = {sock, sensor_rate};
+    pthread_t tids_sender;
+    pthread_create(&tids_sender, NULL, RdtSender, &sender_args);
+
+    netft_rdt_driver::NetFTRDTDriver *netft;
+    try
+    {
+        netft = new netft_rdt_driver::NetFTRDTDriver("127.0.0.1");
+    }
+    catch (std::runtime_error &e)
+    {
+        ROS_ERROR("%s", e.what());
+        return 1;
+    }
+
+    pthread_t tids_netft, tids_filter, tids_state, tids_servo;
+    pthread_create(&tids_netft, NULL, NetftPublish, netft);
+    pthread_create(&tids_filter, NULL, FTsensorFilter, NULL);
+    pthread_create(&tids_state, NULL, RobotStatePoll, &state_rate);
+    pthread_create(&tids_servo, NULL, ServoMove, NULL);
+#pragma endregion
+
+    ros::NodeHandle n_private("~");
+    ros::Publisher servo_move_pub = n_private.advertise<robot_msgs::ServoL>("servo_move", 1);
+    robot_msgs::ServoL servo_msg;
+    ros::Rate rate(control_rate);
+
+    ROS_INFO("latency benchmark: %zu samples, sensor %.0f Hz, control %.0f Hz, pipeline %d, filter %d",
+             samples, sensor_rate, control_rate, servo_mode, servo_filter);
+
+    while (running && ros::ok())
+    {
+        Vector6d FTsensor_data_once;
+        ros::Time FTsensor_stamp_once;
+        Vector6d current_pose;
+        uint32_t id = 0;
+
+        pthread_mutex_lock(&FTsensor_mutex);
+        FTsensor_data_once = FTsensor_data;
+        FTsensor_stamp_once = FTsensor_stamp;
+        pthread_mutex_unlock(&FTsensor_mutex);
+
+        if (FTsensor_stamp_once.isZero())
+        {
+            rate.sleep();
+            continue;
+        }
+
+        bool traced = FindId(FTsensor_stamp_once, id);
+        if (traced)
+            Mark(id, STAGE_ADMITTANCE_IN);
+
+        pthread_mutex_lock(&state_mutex);
+        current_pose = current_tcp;
+        pthread_mutex_unlock(&state_mutex);
+
+        // FTsensor_data 已由 ForceRecorder 补偿, 同 ArmController::Step
+        Vector6d expected_pose = admittance.StepWithExternalWrench(current_pose, FTsensor_data_once, 1.0 / control_rate);
+
+        servo_msg.header.stamp = FTsensor_stamp_once;
+        servo_msg.servo_mode = true;
+        for (int i = 0; i < 6; i++)
+            servo_msg.pose[i] = expected_pose(i);
+
+        if (traced)
+            Mark(id, STAGE_ADMITTANCE);
+        servo_move_pub.publish(servo_msg);
+
+        rate.sleep();
+    }
+
+    running = false;
+    servo_session.Stop();
+    pthread_join(tids_servo, NULL);
+    pthread_join(tids_state, NULL);
+    pthread_join(tids_filter, NULL);
+    pthread_join(tids_netft, NULL);
+    pthread_join(tids_sender, NULL);
+
+    servo_session.Close();
+
+#pragma region /*结果*/
+    diagnostic_updater::DiagnosticStatusWrapper diag_status;
+    netft->diagnostics(diag_status);
+    for (size_t i = 0; i < diag_status.values.size(); i++)
+    {
+        if (diag_status.values[i].key.find("packets") != std::string::npos)
+            printf("%-24s %s\n", diag_status.values[i].key.c_str(), diag_status.values[i].value.c_str());
+    }
+
+    jaka_mock::Stats stats = jaka_mock::GetStats();
+    printf("%-24s %lu\n", "SDK calls", stats.calls);
+    printf("%-24s %lu\n", "servo underruns", stats.servo_underruns);
+    printf("%-24s %lu\n", "servo overruns", stats.servo_overruns);
+    printf("%-24s %lu\n", "controller overruns", stats.cycle_overruns);
+    printf("%-24s %zu of %u sent\n", "traced samples", stage_latency[0].size(), latest_id);
+
+    printf("\n%-24s %10s %10s %10s %10s\n", "stage", "p50 ms", "p99 ms", "p999 ms", "max ms");
+    for (int s = 1; s <= STAGE_NUM; s++)
+    {
+        vector<double> &latency = stage_latency[s % STAGE_NUM];
+        sort(latency.begin(), latency.end());
+
+        printf("%-24s %10.3f %10.3f %10.3f %10.3f\n", s == STAGE_NUM ? "total" : kStageName[s],
+               Percentile(latency, 0.5) * 1000, Percentile(latency, 0.99) * 1000,
+               Percentile(latency, 0.999) * 1000, latency.empty() ? 0 : latency.back() * 1000);
+    }
+    double total_p99 = Percentile(stage_latency[0], 0.99) * 1000;
+#pragma endregion
+
+    delete netft;
+    close(sock);
+    robot.login_out();
+
+    if (max_total_p99_ms > 0 && total_p99 > max_total_p99_ms)
+    {
+        ROS_ERROR("total p99 %.3f ms exceeds %.3f ms", total_p99, max_total_p99_ms);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "object_impedance.h"
+
+using namespace Eigen;
+
+ObjectImpedance::ObjectImpedance()
+{
+    for (int i = 0; i < kArmNum; i++)
+    {
+        object2tcp_[i] = Matrix4d::Identity();
+        world2base_[i] = Matrix4d::Identity();
+    }
+    object_pose_ = Vector6d::Zero();
+    object_wrench_ = Vector6d::Zero();
+}
+
+void ObjectImpedance::SetBase(int arm, const Vector6d &base_pose)
+{
+    world2base_[arm] = Pose2HomogeneousTransform(base_pose);
+}
+
+Matrix4d ObjectImpedance::ObjectTransform(const Vector6d pose[kArmNum]) const
+{
+    /*各臂按抓持关系给出的物体位姿取中间, 抓持不是完全刚性时两者不完全一致*/
+    Matrix4d estimate[kArmNum];
+    for (int i = 0; i < kArmNum; i++)
+        estimate[i] = world2base_[i] * Pose2HomogeneousTransform(pose[i]) * object2tcp_[i].inverse();
+
+    Quaterniond rotation_0(Matrix3d(estimate[0].block<3, 3>(0, 0)));
+    Quaterniond rotation_1(Matrix3d(estimate[1].block<3, 3>(0, 0)));
+
+    Matrix4d object = Matrix4d::Identity();
+    object.block<3, 3>(0, 0) = rotation_0.slerp(0.5, rotation_1).toRotationMatrix();
+    object.block<3, 1>(0, 3) = 0.5 * (estimate[0].block<3, 1>(0, 3) + estimate[1].block<3, 1>(0, 3));
+    return object;
+}
+
+void ObjectImpedance::Grasp(const Vector6d pose[kArmNum])
+{
+    /*抓持前物体坐标系即两 TCP 的中间位姿*/
+    for (int i = 0; i < kArmNum; i++)
+        object2tcp_[i] = Matrix4d::Identity();
+    Matrix4d object = ObjectTransform(pose);
+    for (int i = 0; i < kArmNum; i++)
+        object2tcp_[i] = object.inverse() * world2base_[i] * Pose2HomogeneousTransform(pose[i]);
+
+    object_pose_ = HomogeneousTransform2Pose(object);
+    object_wrench_ = Vector6d::Zero();
+    admittance_.Reset(object_pose_);
+}
+
+void ObjectImpedance::Step(const Vector6d pose[kArmNum], const Vector6d wrench_end[kArmNum], double dt, Vector6d expected_pose[kArmNum])
+{
+    object_pose_ = HomogeneousTransform2Pose(ObjectTransform(pose));
+
+    /*各抓持点的外力换算到物体坐标系原点后求和; object2tcp_ 为世界坐标系下确定的相对位姿, 与基座无关*/
+    object_wrench_ = Vector6d::Zero();
+    for (int i = 0; i < kArmNum; i++)
+    {
+        Matrix3d rotation = object2tcp_[i].block<3, 3>(0, 0);
+        Vector3d position = object2tcp_[i].block<3, 1>(0, 3);
+        Vector3d force = rotation * wrench_end[i].head<3>();
+        object_wrench_.head<3>() += force;
+        object_wrench_.tail<3>() += rotation * wrench_end[i].tail<3>() + position.cross(force);
+    }
+
+    Matrix4d expected_object = Pose2HomogeneousTransform(admittance_.StepWithExternalWrench(object_pose_, object_wrench_, dt));
+    for (int i = 0; i < kArmNum; i++)
+        expected_pose[i] = HomogeneousTransform2Pose(Matrix4d(world2base_[i].inverse() * expected_object * object2tcp_[i]));
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include "object_impedance.h"
+
+using namespace std;
+using namespace Eigen;
+
+/**
+ * 物体层导纳在两臂基座不重合时的检查: 两臂基座分别在世界坐标系 y = +-0.6 m, 右臂基座绕 z 转 180 deg (面对面安装),
+ * 两 TCP 在世界坐标系下夹持同一物体 (相距 0.2 m), 各臂位姿按自己的基坐标系给出
+ *   1. Grasp 后物体位姿为两 TCP 在世界坐标系下的中点
+ *   2. 无外力时期望位姿即当前位姿
+ *   3. 两臂各受世界坐标系下 (5, 0, -10) N 的外力 (在各自末端坐标系下给出), 机器人理想跟踪期望位姿:
+ *      两 TCP 在世界坐标系下的位移同为物体坐标系下 K^-1 * 合力, 相对位姿不变;
+ *      未设置基座时右臂 (基座转 180 deg) 的水平外力方向被算反, 两臂相互抵消, 检查不通过
+ * 用法: object_impedance_check, 不需要 ROS
+ */
+
+int main(int argc, char **argv)
+{
+    const int kArmNum = ObjectImpedance::kArmNum;
+    const double tolerance = 1e-6;
+
+    Vector6d base_pose[kArmNum];
+    base_pose[0] << 0, 0.6, 0, 0, 0, 0;
+    base_pose[1] << 0, -0.6, 0, 0, 0, M_PI;
+
+    /*世界坐标系下的物体与两 TCP: TCP z 轴朝下*/
+    Vector6d object_world;
+    object_world << 0.5, 0.05, 0.3, M_PI, 0, 0;
+    Matrix4d object_world_transform = Pose2HomogeneousTransform(object_world);
+    Vector6d object2tcp_pose[kArmNum];
+    object2tcp_pose[0] << 0, -0.1, 0, 0, 0, 0.2;
+    object2tcp_pose[1] << 0, 0.1, 0, 0, 0, -0.2;
+
+    Vector6d pose[kArmNum];
+    for (int i = 0; i < kArmNum; i++)
+        pose[i] = HomogeneousTransform2Pose(Matrix4d(Pose2HomogeneousTransform(base_pose[i]).inverse() * object_world_transform * Pose2HomogeneousTransform(object2tcp_pose[i])));
+
+    Matrix6d M = Matrix6d::Zero(), D = Matrix6d::Zero(), K = Matrix6d::Zero();
+    M.diagonal() << 200, 200, 300, 2, 2, 40;
+    K.diagonal() << 160, 200, 400, 20, 20, 100;
+    D = DampingFromMassStiffness(M, K, 1.0);
+
+    ObjectImpedance object;
+    object.SetMDK(M, D, K);
+    for (int i = 0; i < kArmNum; i++)
+        object.SetBase(i, base_pose[i]);
+    object.Grasp(pose);
+
+    bool pass = true;
+    cout << setprecision(6) << fixed;
+
+    /*1. 物体位姿*/
+    double object_error = (object.ObjectPose().head<3>() - object_world.head<3>()).norm();
+    cout << "grasp object position error   " << object_error << " m" << endl;
+    pass = pass && object_error < tolerance;
+
+    /*2. 无外力*/
+    Vector6d wrench_end[kArmNum] = {Vector6d::Zero(), Vector6d::Zero()};
+    Vector6d expected_pose[kArmNum];
+    object.Step(pose, wrench_end, 0.01, expected_pose);
+    double still_error = 0;
+    for (int i = 0; i < kArmNum; i++)
+        still_error = fmax(still_error, (expected_pose[i] - pose[i]).cwiseAbs().maxCoeff());
+    cout << "no wrench pose change         " << still_error << endl;
+    pass = pass && still_error < tolerance;
+
+    /*3. 世界坐标系下的外力, 换算到各臂末端坐标系*/
+    Vector3d force_world(5, 0, -10);
+    Vector3d start_world[kArmNum];
+    for (int i = 0; i < kArmNum; i++)
+    {
+        Matrix4d tcp_world = Pose2HomogeneousTransform(base_pose[i]) * Pose2HomogeneousTransform(pose[i]);
+        start_world[i] = tcp_world.block<3, 1>(0, 3);
+        wrench_end[i] = Vector6d::Zero();
+        wrench_end[i].head<3>() = tcp_world.block<3, 3>(0, 0).transpose() * force_world;
+    }
+
+    for (int k = 0; k < 3000; k++)
+    {
+        object.Step(pose, wrench_end, 0.01, expected_pose);
+        for (int i = 0; i < kArmNum; i++)
+            pose[i] = expected_pose[i];
+    }
+
+    Vector3d end_world[kArmNum];
+    for (int i = 0; i < kArmNum; i++)
+        end_world[i] = (Pose2HomogeneousTransform(base_pose[i]) * Pose2HomogeneousTransform(pose[i])).block<3, 1>(0, 3);
+
+    /*物体坐标系下的合力与稳态位移, 力过两 TCP 且对称, 合力矩为零*/
+    Matrix3d object_rotation = object_world_transform.block<3, 3>(0, 0);
+    Vector3d force_object = object_rotation.transpose() * (kArmNum * force_world);
+    Vector3d expected_shift = object_rotation * force_object.cwiseQuotient(K.diagonal().head<3>());
+    double shift_error = fmax((end_world[0] - start_world[0] - expected_shift).norm(), (end_world[1] - start_world[1] - expected_shift).norm());
+    double distance_error = fabs((end_world[0] - end_world[1]).norm() - (start_world[0] - start_world[1]).norm());
+    cout << "expected world shift          " << expected_shift.transpose() << endl;
+    cout << "left arm world shift          " << (end_world[0] - start_world[0]).transpose() << endl;
+    cout << "right arm world shift         " << (end_world[1] - start_world[1]).transpose() << endl;
+    cout << "shift error                   " << shift_error << " m" << endl;
+    cout << "grasp distance change         " << distance_error << " m" << endl;
+    pass = pass && shift_error < 1e-4 && distance_error < tolerance;
+
+    cout << (pass ? "PASS" : "FAIL") << endl;
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#include "payload_identification.h"
+
+#include <cmath>
+
+#include "Eigen/Cholesky"
+
+using namespace Eigen;
+
+PayloadIdentification::PayloadIdentification(double forgetting_factor)
+    : forgetting_factor_(forgetting_factor)
+{
+    Reset();
+}
+
+void PayloadIdentification::Reset()
+{
+    sample_num_ = 0;
+    weight_ = 0;
+
+    force_information_.setZero();
+    force_vector_.setZero();
+    force_square_ = 0;
+    torque_information_.setZero();
+    torque_vector_.setZero();
+    torque_square_ = 0;
+
+    solved_ = false;
+    gravity_ = 0;
+    centroid_.setZero();
+    zero_drift_.setZero();
+    gravity_std_ = INFINITY;
+    centroid_std_.setConstant(INFINITY);
+    zero_drift_std_.setConstant(INFINITY);
+    force_residual_ = 0;
+    torque_residual_ = 0;
+}
+
+void PayloadIdentification::AddSample(const Vector6d &wrench, const Matrix3d &rotation)
+{
+    Matrix<double, 3, 4> force_regressor;
+    Matrix<double, 3, 6> torque_regressor;
+    Regressor(rotation.row(2).transpose(), force_regressor, torque_regressor);
+
+    double lambda = forgetting_factor_;
+    Vector3d force = wrench.head<3>();
+    Vector3d torque = wrench.tail<3>();
+
+    force_information_ = lambda * force_information_ + force_regressor.transpose() * force_regressor;
+    force_vector_ = lambda * force_vector_ + force_regressor.transpose() * force;
+    force_square_ = lambda * force_square_ + force.squaredNorm();
+    torque_information_ = lambda * torque_information_ + torque_regressor.transpose() * torque_regressor;
+    torque_vector_ = lambda * torque_vector_ + torque_regressor.transpose() * torque;
+    torque_square_ = lambda * torque_square_ + torque.squaredNorm();
+
+    weight_ = lambda * weight_ + 1;
+    sample_num_++;
+}
+
+bool PayloadIdentification::Solve()
+{
+    // 每个采样 3 个方程, 参数 4 / 6 个
+    if (weight_ * 3 <= 6)
+        return false;
+
+    LDLT<Matrix4d> force_solver(force_information_);
+    LDLT<Matrix<double, 6, 6>> torque_solver(torque_information_);
+    if (force_solver.info() != Success || torque_solver.info() != Success ||
+        force_solver.vectorD().minCoeff() <= 1e-9 * force_solver.vectorD().maxCoeff() ||
+        torque_solver.vectorD().minCoeff() <= 1e-9 * torque_solver.vectorD().maxCoeff())
+        return false;
+
+    Vector4d force_parameter = force_solver.solve(force_vector_);
+    Vector6d torque_parameter = torque_solver.solve(torque_vector_);
+
+    // 残差平方和 = y^T y - theta^T A^T y
+    double force_variance = std::fmax(force_square_ - force_parameter.dot(force_vector_), 0.0) / (weight_ * 3 - 4);
+    double torque_variance = std::fmax(torque_square_ - torque_parameter.dot(torque_vector_), 0.0) / (weight_ * 3 - 6);
+    Vector4d force_covariance = force_variance * force_solver.solve(Matrix4d::Identity()).diagonal();
+    Vector6d torque_covariance = torque_variance * torque_solver.solve(Matrix<double, 6, 6>::Identity()).diagonal();
+
+    gravity_ = force_parameter(0);
+    zero_drift_ << force_parameter.tail<3>(), torque_parameter.tail<3>();
+    centroid_ = torque_parameter.head<3>() / gravity_;
+
+    gravity_std_ = std::sqrt(force_covariance(0));
+    zero_drift_std_ << force_covariance.tail<3>().cwiseSqrt(), torque_covariance.tail<3>().cwiseSqrt();
+    // c = (G * c) / G, 一阶误差传播
+    for (int i = 0; i < 3; i++)
+        centroid_std_(i) = std::sqrt(torque_covariance(i) + centroid_(i) * centroid_(i) * force_covariance(0)) / std::fabs(gravity_);
+
+    force_residual_ = std::sqrt(force_variance);
+    torque_residual_ = std::sqrt(torque_variance);
+    solved_ = true;
+
+    return true;
+}
+
+bool PayloadIdentification::Converged(double gravity_std, double centroid_std) const
+{
+    return solved_ && gravity_std_ < gravity_std && centroid_std_.maxCoeff() < centroid_std;
+}
@@ -0,0 +1,221 @@
+#include "realtime_executor.h"
+
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+namespace
+{
+double Seconds(const timespec &time)
+{
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+void AddNanoseconds(timespec &time, long nanoseconds)
+{
+    time.tv_nsec += nanoseconds;
+    while (time.tv_nsec >= 1000000000L)
+    {
+        time.tv_nsec -= 1000000000L;
+        time.tv_sec++;
+    }
+}
+} // namespace
+
+RealtimeExecutor::RealtimeExecutor(double rate)
+    : period_(1.0 / rate), task_num_(0), started_(false), stop_(false), running_(false), reset_requested_(false)
+{
+    for (int i = 0; i < kMaxTasks; i++)
+        shared_task_statistics_[i].seq.store(0, std::memory_order_relaxed);
+    shared_cycle_statistics_.seq.store(0, std::memory_order_relaxed);
+    ClearStatistics();
+}
+
+RealtimeExecutor::~RealtimeExecutor()
+{
+    Stop();
+}
+
+int RealtimeExecutor::AddTask(const std::function<bool()> &task, const std::string &name)
+{
+    if (started_ || task_num_ >= kMaxTasks)
+        return -1;
+
+    tasks_[task_num_] = task;
+    names_[task_num_] = name;
+    return task_num_++;
+}
+
+bool RealtimeExecutor::Start(int cpu, int priority)
+{
+    if (started_)
+        return false;
+
+    stop_ = false;
+    running_ = true;
+    if (pthread_create(&thread_, NULL, Run, this))
+    {
+        running_ = false;
+        return false;
+    }
+    started_ = true;
+
+    /*绑定与实时调度分别设置, 其一失败 (如无 CAP_SYS_NICE) 不影响另一项, 线程照常运行*/
+    warning_.clear();
+    if (cpu >= 0)
+    {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu, &cpu_set);
+        int error = pthread_setaffinity_np(thread_, sizeof(cpu_set), &cpu_set);
+        if (error)
+            warning_ += std::string("cpu affinity not set: ") + strerror(error) + "; ";
+    }
+    if (priority > 0)
+    {
+        sched_param param;
+        param.sched_priority = priority;
+        int error = pthread_setschedparam(thread_, SCHED_FIFO, &param);
+        if (error)
+            warning_ += std::string("SCHED_FIFO not set: ") + strerror(error) + "; ";
+    }
+
+    return true;
+}
+
+void RealtimeExecutor::Stop()
+{
+    if (!started_)
+        return;
+
+    stop_ = true;
+    pthread_join(thread_, NULL);
+    started_ = false;
+}
+
+bool RealtimeExecutor::Running() const
+{
+    return running_;
+}
+
+void *RealtimeExecutor::Run(void *args)
+{
+    static_cast<RealtimeExecutor *>(args)->Loop();
+    return NULL;
+}
+
+void RealtimeExecutor::Loop()
+{
+    long period = static_cast<long>(period_ * 1e9);
+    timespec wakeup;
+    clock_gettime(CLOCK_MONOTONIC, &wakeup);
+
+    while (!stop_)
+    {
+        if (reset_requested_.exchange(false))
+            ClearStatistics();
+
+        timespec cycle_start, task_start, task_end;
+        clock_gettime(CLOCK_MONOTONIC, &cycle_start);
+        task_end = cycle_start;
+
+        bool keep_running = true;
+        for (int i = 0; i < task_num_ && keep_running; i++)
+        {
+            task_start = task_end;
+            keep_running = tasks_[i]();
+            clock_gettime(CLOCK_MONOTONIC, &task_end);
+
+            Update(task_statistics_[i], Seconds(task_end) - Seconds(task_start));
+            Store(shared_task_statistics_[i], task_statistics_[i]);
+        }
+
+        double cycle_time = Seconds(task_end) - Seconds(cycle_start);
+        Update(cycle_statistics_, cycle_time);
+        if (cycle_time > period_)
+            cycle_statistics_.overruns++;
+        Store(shared_cycle_statistics_, cycle_statistics_);
+
+        if (!keep_running)
+            break;
+
+        /*按绝对时刻等待下一周期; 已落后一个周期以上时从当前时刻重新计时, 不连续补跑*/
+        AddNanoseconds(wakeup, period);
+        if (Seconds(task_end) > Seconds(wakeup))
+            wakeup = task_end;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeup, NULL);
+    }
+
+    running_ = false;
+}
+
+void RealtimeExecutor::Update(Statistics &statistics, double time)
+{
+    statistics.count++;
+    statistics.last = time;
+    statistics.mean += (time - statistics.mean) / statistics.count;
+    if (time > statistics.max)
+        statistics.max = time;
+}
+
+void RealtimeExecutor::Store(SharedStatistics &shared, const Statistics &statistics)
+{
+    unsigned long seq = shared.seq.load(std::memory_order_relaxed);
+    shared.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    shared.count.store(statistics.count, std::memory_order_relaxed);
+    shared.last.store(statistics.last, std::memory_order_relaxed);
+    shared.mean.store(statistics.mean, std::memory_order_relaxed);
+    shared.max.store(statistics.max, std::memory_order_relaxed);
+    shared.overruns.store(statistics.overruns, std::memory_order_relaxed);
+    shared.seq.store(seq + 2, std::memory_order_release);
+}
+
+RealtimeExecutor::Statistics RealtimeExecutor::Load(const SharedStatistics &shared)
+{
+    Statistics statistics;
+    while (true)
+    {
+        unsigned long before = shared.seq.load(std::memory_order_acquire);
+        if (before & 1)
+            continue;
+        statistics.count = shared.count.load(std::memory_order_relaxed);
+        statistics.last = shared.last.load(std::memory_order_relaxed);
+        statistics.mean = shared.mean.load(std::memory_order_relaxed);
+        statistics.max = shared.max.load(std::memory_order_relaxed);
+        statistics.overruns = shared.overruns.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (shared.seq.load(std::memory_order_relaxed) == before)
+            return statistics;
+    }
+}
+
+RealtimeExecutor::Statistics RealtimeExecutor::TaskStatistics(int i) const
+{
+    return Load(shared_task_statistics_[i]);
+}
+
+RealtimeExecutor::Statistics RealtimeExecutor::CycleStatistics() const
+{
+    return Load(shared_cycle_statistics_);
+}
+
+void RealtimeExecutor::ResetStatistics()
+{
+    if (started_)
+        reset_requested_ = true;
+    else
+        ClearStatistics();
+}
+
+void RealtimeExecutor::ClearStatistics()
+{
+    Statistics zero = {0, 0.0, 0.0, 0.0, 0};
+    for (int i = 0; i < kMaxTasks; i++)
+    {
+        task_statistics_[i] = zero;
+        Store(shared_task_statistics_[i], zero);
+    }
+    cycle_statistics_ = zero;
+    Store(shared_cycle_statistics_, zero);
+}
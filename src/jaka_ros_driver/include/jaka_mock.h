@@ -0,0 +1,51 @@
+#ifndef JAKA_MOCK_H
+#define JAKA_MOCK_H
+
+/**
+ * In-process replacement of libjakaAPI.so.
+ *
+ * Linking jaka_mock_robot instead of libjakaAPI.so gives a JAKAZuRobot that simulates
+ * the controller's 8 ms cycle (servo buffer, SDK servo filters, joint/linear move queue,
+ * kine_inverse/kine_forward over the arm's MDH table) without hardware.
+ * Every API call is delayed by latency + uniform(0, jitter) to mimic the TCP round trip.
+ *
+ * The defaults can be overridden from the environment:
+ *   JAKA_MOCK_LATENCY_US, JAKA_MOCK_JITTER_US, JAKA_MOCK_CYCLE_US, JAKA_MOCK_SEED
+ */
+
+namespace jaka_mock
+{
+
+struct Config
+{
+    double latency_us; // fixed delay of every API call
+    double jitter_us;  // additional uniform random delay of every API call
+    double cycle_us;   // controller cycle
+    unsigned int seed;
+    double initial_joint[6];
+
+    Config();
+};
+
+struct Stats
+{
+    unsigned long calls;           // API calls of all kinds
+    unsigned long status_polls;    // get_robot_status / get_joint_position / get_tcp_position
+    unsigned long servo_commands;  // servo_j / servo_p
+    unsigned long servo_underruns; // cycles in servo mode with an empty servo buffer
+    unsigned long servo_overruns;  // servo commands dropped because the buffer was full, the call returns ERR_MOTION_ABNORMAL
+    unsigned long cycles;          // simulated controller cycles
+    unsigned long cycle_overruns;  // cycles that started later than one cycle time
+};
+
+/* read by login_in(), i.e. applies to robots logged in afterwards */
+void SetConfig(const Config &config);
+Config GetConfig();
+
+/* counters summed over all mock robots of the process */
+Stats GetStats();
+void ResetStats();
+
+} // namespace jaka_mock
+
+#endif
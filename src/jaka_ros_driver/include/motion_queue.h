@@ -0,0 +1,125 @@
+#ifndef MOTION_QUEUE_H
+#define MOTION_QUEUE_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "libs/robot.h"
+
+enum MotionType
+{
+    MOTION_LINE = 0, // linear_move, target x, y, z (mm), rx, ry, rz (rad)
+    MOTION_JOINT = 1 // joint_move, target joints (rad)
+};
+
+/* 与 robot_msgs/MoveFeedback.msg 的 state 一致 */
+enum MotionState
+{
+    MOTION_PENDING = 0,
+    MOTION_ACTIVE = 1,
+    MOTION_SUCCEEDED = 2,
+    MOTION_PREEMPTED = 3,
+    MOTION_CANCELED = 4,
+    MOTION_ABORTED = 5
+};
+
+struct MotionWaypoint
+{
+    double target[6];
+    double speed; // mm/s or rad/s
+    double accel; // mm/s^2 or rad/s^2
+    double tol;   // mm or rad, blend radius handed to the SDK, 0 stops at the waypoint
+
+    MotionWaypoint();
+};
+
+/* 单点运动为只有一个路点的路径 */
+struct MotionGoal
+{
+    MotionType type;
+    std::vector<MotionWaypoint> waypoints;
+
+    MotionGoal();
+};
+
+struct MotionFeedback
+{
+    uint32_t goal_id;
+    MotionType type;
+    MotionState state;
+    double progress;    // 0..1 along the path length from the start to the last waypoint
+    uint32_t waypoint;  // index of the waypoint currently approached
+    int error_code;     // sdk error code when ABORTED
+    double position[6]; // current tcp (mm, rad) for MOTION_LINE, joints (rad) for MOTION_JOINT
+
+    MotionFeedback();
+};
+
+/**
+ * @brief 异步运动队列: 运动指令带 goal id 排队, 由运动线程以非阻塞方式下发
+ *        运动线程只在单次 sdk 调用期间持有 robot 锁, 通过 inpos 轮询判断到位
+ *        路径目标的路点提前 kLookahead 个下发, 控制器按 tol 在路点间过渡而不停顿
+ */
+class MotionQueue
+{
+public:
+    static const double kPollPeriod;   // s, inpos polling period while a goal is active
+    static const double kStartTimeout; // s, inpos right after the command counts as done only after this
+    static const size_t kHistorySize;  // finished goals kept for Wait() / GetFeedback()
+    static const size_t kLookahead;    // waypoints handed to the controller ahead of the one approached
+
+    MotionQueue(JAKAZuRobot &robot, pthread_mutex_t &robot_mutex);
+    ~MotionQueue();
+
+    void Start();
+    void Stop();
+
+    /* called from the motion thread on every state change and poll of the active goal */
+    void SetFeedbackCallback(const std::function<void(const MotionFeedback &)> &callback);
+
+    /**
+     * @brief 提交运动目标
+     * @param preempt true 时中止当前运动并丢弃所有排队目标
+     * @return goal id, 从 1 开始
+     */
+    uint32_t Submit(const MotionGoal &goal, bool preempt);
+
+    /* 取消排队中或执行中的目标, goal_id 为 0 时取消全部, 返回是否找到 */
+    bool Cancel(uint32_t goal_id);
+
+    /* 阻塞直到目标结束, 目标未知时返回 false */
+    bool Wait(uint32_t goal_id, MotionFeedback &result);
+
+    bool GetFeedback(uint32_t goal_id, MotionFeedback &feedback);
+
+private:
+    static void *ThreadFunc(void *args);
+    void Run();
+    int Execute(const MotionGoal &goal, MotionFeedback &feedback);
+    int Send(MotionType type, const MotionWaypoint &waypoint);
+    void Notify(const MotionFeedback &feedback);
+    bool Final(MotionState state) const { return state >= MOTION_SUCCEEDED; }
+
+    JAKAZuRobot &robot_;
+    pthread_mutex_t &robot_mutex_;
+
+    pthread_mutex_t queue_mutex_;
+    pthread_cond_t queue_cond_; // new goal, cancel or stop
+    pthread_cond_t done_cond_;  // a goal finished
+    pthread_t thread_;
+    bool running_;
+
+    std::deque<std::pair<uint32_t, MotionGoal> > pending_;
+    std::map<uint32_t, MotionFeedback> feedback_; // pending, active and recently finished goals
+    uint32_t next_id_;
+    uint32_t active_id_; // 0 when idle
+    MotionState abort_state_; // PREEMPTED / CANCELED requested for the active goal, PENDING otherwise
+
+    std::function<void(const MotionFeedback &)> feedback_callback_;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef SERVO_PIPELINE_H
+#define SERVO_PIPELINE_H
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+#include "libs/robot.h"
+
+/* how a Cartesian servo target is streamed to the controller */
+enum ServoPipelineMode
+{
+    SERVO_PIPELINE_JOINT = 0,    // kine_inverse on the driver side, then servo_j
+    SERVO_PIPELINE_CARTESIAN = 1 // servo_p, IK is done by the controller
+};
+
+/* SDK filter applied to the servo stream, see JAKAZuRobot::servo_move_use_* */
+enum ServoFilterType
+{
+    SERVO_FILTER_NONE = 0,
+    SERVO_FILTER_JOINT_LPF = 1, // params: cutoff_freq
+    SERVO_FILTER_JOINT_NLF = 2, // params: max_vr, max_ar, max_jr
+    SERVO_FILTER_CARTE_NLF = 3, // params: max_vp, max_ap, max_jp, max_vr, max_ar, max_jr
+    SERVO_FILTER_JOINT_MMF = 4  // params: max_buf, kp, kv, ka
+};
+
+struct ServoConfig
+{
+    ServoPipelineMode mode;
+    ServoFilterType filter;
+    double filter_params[6];
+    int filter_param_num;
+    double interp_time; // s, interpolation horizon of every new target, 0 streams the target as received
+
+    ServoConfig();
+};
+
+/**
+ * @brief 伺服流水线: 接收笛卡尔期望位姿, 按会话配置选择 servo_j 或 servo_p 下发
+ *        配置在下一次 Enable() 时生效, 一次伺服会话内保持不变
+ */
+class ServoPipeline
+{
+public:
+    static const double kCycleTime; // controller servo cycle, s
+    static const double kMaxInterpTime;
+
+    ServoPipeline(JAKAZuRobot &robot, pthread_mutex_t &robot_mutex);
+    ~ServoPipeline();
+
+    bool SetConfig(const ServoConfig &config, std::string &error);
+    ServoConfig GetConfig();
+
+    int Enable();
+    int Disable();
+    bool IsEnabled() const { return enabled_; }
+    const ServoConfig &SessionConfig() const { return session_; }
+
+    /**
+     * @brief 设置新的期望位姿并生成插补序列
+     * @param target_pose   期望位姿 (m, rad)
+     * @param current_joint 当前关节位置 (rad), 用作逆解参考
+     * @param current_tcp   当前末端位姿 (m, rad), 笛卡尔插补起点
+     * @return sdk 返回值, 0 为成功
+     */
+    int SetTarget(const double target_pose[6], const double current_joint[6], const double current_tcp[6]);
+
+    bool HasPending() const { return next_ < count_; }
+
+    /* 下发下一个插补点, 返回 sdk 返回值 */
+    int Step();
+
+    const JointValue &LastJoint() const { return last_joint_; }
+    const CartesianPose &LastPose() const { return last_pose_; }
+
+private:
+    int ApplyFilter(const ServoConfig &config);
+    int PointNum() const;
+
+    JAKAZuRobot &robot_;
+    pthread_mutex_t &robot_mutex_;
+    pthread_mutex_t config_mutex_;
+
+    ServoConfig pending_; // written by the config service
+    ServoConfig session_; // latched at Enable()
+    bool enabled_;
+
+    std::vector<JointValue> joint_series_;
+    std::vector<CartesianPose> pose_series_;
+    size_t count_;
+    size_t next_;
+
+    JointValue last_joint_;
+    CartesianPose last_pose_;
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef SERVO_SESSION_H
+#define SERVO_SESSION_H
+
+#include <pthread.h>
+#include <atomic>
+#include <functional>
+#include <string>
+
+#include "ros/ros.h"
+#include "robot_msgs/ServoL.h"
+#include "libs/robot.h"
+#include "servo_pipeline.h"
+
+/**
+ * @brief servo_move 话题的伺服会话: 按 servo_mode 进入/退出 SDK 伺服模式, 期望位姿经 ServoPipeline 逆解、插补后逐点下发
+ *        Run 为伺服线程, Accept 在其回调队列中执行; 状态线程周期调用 PollState 更新逆解参考与插补起点
+ *        connect_robot 与 latency_benchmark 共用, 后者通过 SetTraceCallback 在各阶段打点
+ */
+class ServoSession
+{
+public:
+    /* 一个期望位姿依次经过的阶段, 随 ServoL.header.stamp 报告 */
+    enum Stage
+    {
+        STAGE_ACCEPTED, // Accept 收到
+        STAGE_TARGET,   // SetTarget 完成 (servo_j 流水线含 kine_inverse)
+        STAGE_STEP      // 该目标的第一个插补点下发
+    };
+
+    static const double kSettleTime; // s, 进入/退出伺服模式后的等待
+
+    ServoSession(JAKAZuRobot &robot, pthread_mutex_t &robot_mutex, ServoPipeline &pipeline);
+    ~ServoSession();
+
+    /* 在伺服线程中调用 */
+    void SetTraceCallback(const std::function<void(Stage, const ros::Time &)> &callback);
+
+    /* servo_move 回调 */
+    void Accept(const robot_msgs::ServoL::ConstPtr &msg);
+
+    /**
+     * @brief 进入伺服模式; SDK 仍在伺服模式 (如上次未正常退出) 时滤波器设置被拒绝, 先退出再重试一次
+     * @return sdk 返回值, 0 为成功
+     */
+    int Open();
+    /* 停止下发插补点, 不调用 SDK; 中止运动时先于 motion_abort 调用 */
+    void Hold() { open_ = false; }
+    /* Hold 并退出 SDK 伺服模式, 返回 sdk 返回值 */
+    int Close();
+    bool IsOpen() const { return open_; }
+
+    /* 读取机器人状态, 连接正常时更新当前关节与末端位姿; 返回 is_socket_connect */
+    bool PollState(RobotStatus &status);
+
+    /* 伺服线程: 在自己的回调队列中订阅 n 下的 topic, 直到 Stop 或 ros 关闭 */
+    void Run(const ros::NodeHandle &n, const std::string &topic);
+    void Stop() { running_ = false; }
+
+    /* 最近一次收到的期望位姿 (m, rad), 仅伺服线程使用 */
+    const double *ExpectedPose() const { return expected_pose_; }
+
+private:
+    void Trace(Stage stage, const ros::Time &stamp);
+
+    JAKAZuRobot &robot_;
+    pthread_mutex_t &robot_mutex_;
+    ServoPipeline &pipeline_;
+
+    std::atomic<bool> open_;
+    std::atomic<bool> running_;
+
+    /* 状态线程写入, state_mutex_ 保护 */
+    pthread_mutex_t state_mutex_;
+    double current_joint_[6]; // rad
+    double current_tcp_[6];   // m, rad
+
+    /* 仅伺服线程使用 */
+    double expected_pose_[6];
+    ros::Time expected_stamp_;
+    bool pose_change_;
+    bool step_traced_;
+    std::function<void(Stage, const ros::Time &)> trace_callback_;
+};
+
+#endif
@@ -20,6 +20,11 @@
 #include "robot_msgs/SetCollision.h"
 #include "robot_msgs/SetAxis.h"
 #include "robot_msgs/GetPosition.h"
+#include "robot_msgs/SetServoMode.h"
+#include "robot_msgs/CancelMove.h"
+#include "robot_msgs/MoveFeedback.h"
+#include "robot_msgs/MovePath.h"
+#include "robot_msgs/MotionAbort.h"
 
 #include "admittance_control/Plot.h"
 
@@ -35,6 +40,9 @@
 
 #include "libs/robot.h"
 #include "libs/conversion.h"
+#include "servo_pipeline.h"
+#include "servo_session.h"
+#include "motion_queue.h"
 #include "time.h"
 #include <map>
 #include <string>
@@ -72,11 +80,10 @@ JAKAZuRobot robot;
 
 pthread_mutex_t mutex;
 
-VectorXd expected_pose_servo(6);
-VectorXd current_joint_servo(6);
-
-bool servo_mode_open_flag = false;
-bool servo_pose_change_flag = false;
+ServoPipeline servo_pipeline(robot, mutex);
+ServoSession servo_session(robot, mutex, servo_pipeline);
+MotionQueue motion_queue(robot, mutex);
+ros::Publisher move_feedback_pub;
 
 admittance_control::Plot plot_data;
 
@@ -84,78 +91,137 @@ struct timeval tv;
 // gettimeofday(&tv, NULL);
 // std::cout << "begin" << tv.tv_sec << "s," << tv.tv_usec << "微秒" << endl;
 
-// 1.1 service move line -
-bool movel_callback(robot_msgs::Move::Request &req,
-                    robot_msgs::Move::Response &res)
+/* move_line / move_joint / move_path 的公共部分: 排队, is_block 时等待目标结束 */
+template <class Request, class Response>
+void SubmitMotion(const MotionGoal &goal, Request &req, Response &res)
 {
-    CartesianPose cart;
-    cart.tran.x = req.pose[0] * 1000;
-    cart.tran.y = req.pose[1] * 1000;
-    cart.tran.z = req.pose[2] * 1000;
+    uint32_t goal_id = motion_queue.Submit(goal, req.preempt);
+    res.goal_id = goal_id;
 
-    cart.rpy.rx = req.pose[3];
-    cart.rpy.ry = req.pose[4];
-    cart.rpy.rz = req.pose[5];
-
-    double speed = (double)req.mvvelo * 1000;
-    double accel = (double)req.mvacc * 1000;
-
-    OptionalCond *p = nullptr;
-
-    pthread_mutex_lock(&mutex);
-
-    int sdk_res = robot.linear_move(&cart, MoveMode::ABS, req.is_block, speed, accel, 0.3, p);
+    if (!req.is_block)
+    {
+        res.ret = 1;
+        res.message = "cmd has been queued!";
+        return;
+    }
 
-    pthread_mutex_unlock(&mutex);
-    switch (sdk_res)
+    MotionFeedback result;
+    if (!motion_queue.Wait(goal_id, result))
     {
-    case 0:
+        // 目标未知 (如已被挤出结束目标的历史), 结果不可用, 不能当作成功
+        res.ret = ERR_MOTION_ABNORMAL;
+        res.message = "cmd result unknown: goal " + std::to_string(goal_id) + " not found in the motion queue\n";
+        return;
+    }
+    switch (result.state)
+    {
+    case MOTION_SUCCEEDED:
         res.ret = 1;
         res.message = "cmd has been executed!";
         break;
+    case MOTION_PREEMPTED:
+        res.ret = ERR_MOTION_ABNORMAL;
+        res.message = "cmd has been preempted!\n";
+        break;
+    case MOTION_CANCELED:
+        res.ret = ERR_MOTION_ABNORMAL;
+        res.message = "cmd has been canceled!\n";
+        break;
     default:
-        res.ret = sdk_res;
-        res.message = mapErr[sdk_res] + "\n";
+        res.ret = result.error_code;
+        res.message = mapErr[result.error_code] + "\n";
         break;
     }
+}
 
-    return true;
+void PublishMoveFeedback(const MotionFeedback &feedback)
+{
+    robot_msgs::MoveFeedback msg;
+
+    msg.header.stamp = ros::Time::now();
+    msg.goal_id = feedback.goal_id;
+    msg.state = feedback.state;
+    msg.progress = feedback.progress;
+    msg.waypoint = feedback.waypoint;
+    msg.error_code = feedback.error_code;
+    for (int i = 0; i < 6; i++)
+        msg.position[i] = feedback.position[i];
+
+    if (feedback.type == MOTION_LINE)
+    {
+        msg.position[0] = feedback.position[0] / 1000;
+        msg.position[1] = feedback.position[1] / 1000;
+        msg.position[2] = feedback.position[2] / 1000;
+    }
+
+    move_feedback_pub.publish(msg);
 }
 
-// 1.2 service move joint -
-bool movej_callback(robot_msgs::Move::Request &req,
+/* 服务中的位置 m, 速度 m/s, 过渡半径 m 转为 sdk 的 mm; 关节为 rad 不需转换 */
+MotionWaypoint MakeWaypoint(MotionType type, const float pose[6], float mvvelo, float mvacc, float mvradii)
+{
+    MotionWaypoint waypoint;
+    double scale = type == MOTION_LINE ? 1000 : 1;
+
+    for (int i = 0; i < 6; i++)
+        waypoint.target[i] = pose[i];
+    for (int i = 0; i < 3; i++)
+        waypoint.target[i] *= scale;
+
+    waypoint.speed = (double)mvvelo * scale;
+    waypoint.accel = (double)mvacc * scale;
+    waypoint.tol = (double)mvradii * scale;
+
+    return waypoint;
+}
+
+/* move_line/move_joint 未给出 mvradii (<= 0) 时沿用原先 linear_move/joint_move 的 tol, sdk 单位 */
+const double kMoveLineTol = 0.3;  // mm
+const double kMoveJointTol = 0.2; // rad
+
+/* move_line/move_joint 的 pose 须为 6 维, 否则回复参数错误 */
+bool CheckPose(const robot_msgs::Move::Request &req, robot_msgs::Move::Response &res)
+{
+    if (req.pose.size() == 6)
+        return true;
+
+    res.ret = ERR_INVALID_PARAMETER;
+    res.message = mapErr[ERR_INVALID_PARAMETER] + ": pose needs 6 values, got " + std::to_string(req.pose.size()) + "\n";
+    return false;
+}
+
+// 1.1 service move line -
+bool movel_callback(robot_msgs::Move::Request &req,
                     robot_msgs::Move::Response &res)
 {
-    JointValue joint_pose;
-    joint_pose.jVal[0] = (req.pose[0]);
-    joint_pose.jVal[1] = (req.pose[1]);
-    joint_pose.jVal[2] = (req.pose[2]);
-    joint_pose.jVal[3] = (req.pose[3]);
-    joint_pose.jVal[4] = (req.pose[4]);
-    joint_pose.jVal[5] = (req.pose[5]);
+    if (!CheckPose(req, res))
+        return true;
 
-    double speed = (double)req.mvvelo;
-    double accel = (double)req.mvacc;
+    MotionGoal goal;
+    goal.type = MOTION_LINE;
+    goal.waypoints.push_back(MakeWaypoint(MOTION_LINE, &req.pose[0], req.mvvelo, req.mvacc, req.mvradii));
+    if (req.mvradii <= 0)
+        goal.waypoints[0].tol = kMoveLineTol;
 
-    OptionalCond *p = nullptr;
+    SubmitMotion(goal, req, res);
 
-    pthread_mutex_lock(&mutex);
+    return true;
+}
 
-    int sdk_res = robot.joint_move(&joint_pose, MoveMode::ABS, req.is_block, speed, accel, 0.2, p);
+// 1.2 service move joint -
+bool movej_callback(robot_msgs::Move::Request &req,
+                    robot_msgs::Move::Response &res)
+{
+    if (!CheckPose(req, res))
+        return true;
 
-    pthread_mutex_unlock(&mutex);
+    MotionGoal goal;
+    goal.type = MOTION_JOINT;
+    goal.waypoints.push_back(MakeWaypoint(MOTION_JOINT, &req.pose[0], req.mvvelo, req.mvacc, req.mvradii));
+    if (req.mvradii <= 0)
+        goal.waypoints[0].tol = kMoveJointTol;
 
-    switch (sdk_res)
-    {
-    case 0:
-        res.ret = 1;
-        res.message = "cmd has been executed!";
-        break;
-    default:
-        res.ret = sdk_res;
-        res.message = mapErr[sdk_res] + "\n";
-        break;
-    }
+    SubmitMotion(goal, req, res);
 
     return true;
 }
@@ -328,11 +394,14 @@ bool move_jog_callback(robot_msgs::Move::Request &req,
 bool stop_callback(std_srvs::Empty::Request &req,
                    std_srvs::Empty::Response &res)
 {
-    servo_mode_open_flag = false;
+    servo_session.Hold();
+    motion_queue.Cancel(0);
     // robot.disable_robot();
     pthread_mutex_lock(&mutex);
     int sdk_res = robot.motion_abort();
     pthread_mutex_unlock(&mutex);
+    // 退出 SDK 伺服模式, 否则下次进入伺服时滤波器设置被拒绝
+    servo_session.Close();
     switch (sdk_res)
     {
     case 0:
@@ -346,48 +415,118 @@ bool stop_callback(std_srvs::Empty::Request &req,
     return true;
 }
 
-// 1.5 service servo move -
-void ServoMovePoseAccepted(const robot_msgs::ServoL::ConstPtr &msg)
+// 1.9 topic motion abort - 力/力矩安全监测触发, 在独立线程中立即 motion_abort
+void MotionAbortAccepted(const robot_msgs::MotionAbort::ConstPtr &msg)
 {
-    // memcpy(expected_pose_servo.data(), &(msg->pose[0]), 6 * 8);
-    for (int i = 0; i < 6; i++)
-        expected_pose_servo[i] = msg->pose[i];
+    ros::Time receive_time = ros::Time::now();
 
-    if (msg->servo_mode)
-        servo_pose_change_flag = true;
-
-    if (!servo_mode_open_flag && msg->servo_mode)
-    {
-        pthread_mutex_lock(&mutex);
+    servo_session.Hold();
+    motion_queue.Cancel(0);
+    pthread_mutex_lock(&mutex);
+    int sdk_res = robot.motion_abort();
+    pthread_mutex_unlock(&mutex);
 
-        robot.servo_move_use_joint_LPF(4); // 300 ms
-        int tmp = robot.servo_move_enable(true);
+    ros::Time abort_time = ros::Time::now();
+
+    // motion_abort 之后再退出 SDK 伺服模式, 不计入停止延迟; 否则下次进入伺服时滤波器设置被拒绝, 伺服目标全部被丢弃
+    int disable_res = servo_session.Close();
+    if (disable_res != 0)
+        cout << "servo disable error:" << mapErr[disable_res] << endl;
+
+    // 采样 -> 检测 -> 本节点收到 -> motion_abort 返回, 各段延迟 (ms)
+    ROS_ERROR("motion abort: %s, sdk %d | sample->detect %.3f ms, detect->receive %.3f ms, receive->abort %.3f ms, sample->abort %.3f ms",
+              msg->reason.c_str(), sdk_res,
+              (msg->detect_time - msg->header.stamp).toSec() * 1000.0,
+              (receive_time - msg->detect_time).toSec() * 1000.0,
+              (abort_time - receive_time).toSec() * 1000.0,
+              (abort_time - msg->header.stamp).toSec() * 1000.0);
+    if (sdk_res != 0)
+        cout << "stop error:" << mapErr[sdk_res] << endl;
+}
 
-        pthread_mutex_unlock(&mutex);
+// 1.5 topic servo move - 期望位姿由 ServoSession 处理, 此处只记录绘图数据
+void ServoTrace(ServoSession::Stage stage, const ros::Time &stamp)
+{
+    if (stage == ServoSession::STAGE_ACCEPTED)
+        plot_data.data_1 = servo_session.ExpectedPose()[2];
+    else if (stage == ServoSession::STAGE_STEP && servo_pipeline.SessionConfig().mode == SERVO_PIPELINE_JOINT)
+    {
+        plot_data.data_6 = servo_pipeline.LastJoint().jVal[1];
+        plot_data.data_7 = servo_pipeline.LastJoint().jVal[2];
+    }
+}
 
-        std::cout << "Servo enable!" << tmp << std::endl;
+// 1.6 service servo config -
+bool servo_config_callback(robot_msgs::SetServoMode::Request &req,
+                           robot_msgs::SetServoMode::Response &res)
+{
+    ServoConfig config;
+    std::string error;
 
-        sleep(1);
+    config.mode = static_cast<ServoPipelineMode>(req.pipeline);
+    config.filter = static_cast<ServoFilterType>(req.filter);
+    config.filter_param_num = req.filter_params.size();
+    for (int i = 0; i < config.filter_param_num && i < 6; i++)
+        config.filter_params[i] = req.filter_params[i];
+    config.interp_time = req.interp_time;
 
-        servo_mode_open_flag = true;
+    if (servo_pipeline.SetConfig(config, error))
+    {
+        res.ret = 1;
+        if (servo_session.IsOpen())
+            res.message = "servo config is set, applied at the next servo session";
+        else
+            res.message = "servo config is set";
     }
-    else if (servo_mode_open_flag && !msg->servo_mode)
+    else
     {
-        servo_mode_open_flag = false;
+        res.ret = -2;
+        res.message = mapErr[-2] + ": " + error;
+    }
 
-        pthread_mutex_lock(&mutex);
+    return true;
+}
 
-        int tmp = robot.servo_move_enable(false);
+// 1.7 service cancel move -
+bool cancel_move_callback(robot_msgs::CancelMove::Request &req,
+                          robot_msgs::CancelMove::Response &res)
+{
+    if (motion_queue.Cancel(req.goal_id))
+    {
+        res.ret = 1;
+        res.message = "cmd has been canceled!";
+    }
+    else
+    {
+        res.ret = 0;
+        res.message = "goal is not queued or running";
+    }
 
-        pthread_mutex_unlock(&mutex);
+    return true;
+}
 
-        std::cout << "Servo disable!" << tmp << std::endl;
+// 1.8 service move path -
+bool move_path_callback(robot_msgs::MovePath::Request &req,
+                        robot_msgs::MovePath::Response &res)
+{
+    if (req.points.empty() || (req.type != MOTION_LINE && req.type != MOTION_JOINT))
+    {
+        res.ret = ERR_INVALID_PARAMETER;
+        res.message = mapErr[ERR_INVALID_PARAMETER] + "\n";
+        return true;
+    }
 
-        sleep(1);
+    MotionGoal goal;
+    goal.type = static_cast<MotionType>(req.type);
+    for (size_t i = 0; i < req.points.size(); i++)
+    {
+        const robot_msgs::PathPoint &point = req.points[i];
+        goal.waypoints.push_back(MakeWaypoint(goal.type, &point.pose[0], point.mvvelo, point.mvacc, point.mvradii));
     }
 
-    cout << "expected pose:" << expected_pose_servo.transpose() << endl;
-    plot_data.data_1 = expected_pose_servo(2);
+    SubmitMotion(goal, req, res);
+
+    return true;
 }
 
 /**
@@ -948,6 +1087,8 @@ void *PlotData(void *args)
 
         rate.sleep();
     }
+
+    return NULL;
 }
 
 bool GetPositionCallback(robot_msgs::GetPosition::Request &req,
@@ -1008,18 +1149,14 @@ void *RobotStatePublish(void *args)
 
         RobotStatus robot_status;
 
-        pthread_mutex_lock(&mutex);
-
-        robot.get_robot_status(&robot_status);
-
-        pthread_mutex_unlock(&mutex);
-
-        if (!robot_status.is_socket_connect)
+        // 同时更新伺服会话的逆解参考与插补起点
+        if (!servo_session.PollState(robot_status))
         {
             ROS_ERROR("connect error!!!");
             continue;
         }
 
+        tool_point.header.stamp = ros::Time::now();
         tool_point.twist.linear.x = robot_status.cartesiantran_position[0] / 1000;
         tool_point.twist.linear.y = robot_status.cartesiantran_position[1] / 1000;
         tool_point.twist.linear.z = robot_status.cartesiantran_position[2] / 1000;
@@ -1038,8 +1175,6 @@ void *RobotStatePublish(void *args)
         tool_point_pub.publish(tool_point);
         joint_states_pub.publish(joint_states); // publish data
 
-        memcpy(current_joint_servo.data(), robot_status.joint_position, 6 * 8);
-
         plot_data.data_2 = tool_point.twist.linear.z;
         plot_data.data_4 = robot_status.joint_position[1];
         plot_data.data_5 = robot_status.joint_position[2];
@@ -1165,108 +1300,35 @@ void *RobotStatePublish(void *args)
 // robot_state_pub.publish(robot_state);
 #pragma endregion /* Robot State Publisher */
     }
+
+    return NULL;
 }
 
 void *ServoMove(void *args)
 {
-    ros::NodeHandle n_servo;
+    // 1.5 topic servo move -
+    servo_session.SetTraceCallback(ServoTrace);
+    servo_session.Run(ros::NodeHandle(), "/robot_driver/servo_move");
 
-    ros::CallbackQueue servo_queue;
-    n_servo.setCallbackQueue(&servo_queue);
-
-    // 1.5 service servo move -
-    ros::Subscriber servo_move_sub = n_servo.subscribe("/robot_driver/servo_move", 1, &ServoMovePoseAccepted);
-
-    while (ros::ok())
-    {
-        servo_queue.callOne(ros::WallDuration(1.0));
-        if (servo_mode_open_flag && servo_pose_change_flag)
-        {
-            vector<VectorXd> tra;
-            VectorXd expected_joint_servo(6);
-            JointValue tmp_expected_joint_servo;
-            JointValue tmp_current_joint_servo;
-            CartesianPose tmp_expected_pose_servo;
-
-            expected_joint_servo = VectorXd::Zero(6);
-
-            expected_pose_servo.block<3, 1>(0, 0) = expected_pose_servo.block<3, 1>(0, 0) * 1000;
-
-            memcpy(tmp_expected_joint_servo.jVal, expected_joint_servo.data(), 6 * 8);
-            memcpy(tmp_current_joint_servo.jVal, current_joint_servo.data(), 6 * 8);
-            memcpy(&(tmp_expected_pose_servo.tran.x), expected_pose_servo.data(), 6 * 8);
-
-            pthread_mutex_lock(&mutex);
-
-            robot.kine_inverse(&tmp_current_joint_servo, &tmp_expected_pose_servo, &tmp_expected_joint_servo);
-
-            pthread_mutex_unlock(&mutex);
-
-            memcpy(expected_joint_servo.data(), tmp_expected_joint_servo.jVal, 6 * 8);
-
-            Average_Series(current_joint_servo, expected_joint_servo, 0.1, tra);
-
-            // Trapezoid_Velocity_Series(expected_joint_servo, tra, vel_lim, acc_lim, start_vel, end_vel);
-
-            servo_pose_change_flag = false;
-
-            for (int t = 0; t < tra.size(); t++)
-            {
-                servo_queue.callOne(ros::WallDuration(0));
-                if (servo_pose_change_flag)
-                {
-                    expected_pose_servo.block<3, 1>(0, 0) = expected_pose_servo.block<3, 1>(0, 0) * 1000;
-
-                    memcpy(tmp_expected_joint_servo.jVal, expected_joint_servo.data(), 6 * 8);
-                    memcpy(tmp_current_joint_servo.jVal, current_joint_servo.data(), 6 * 8);
-                    memcpy(&(tmp_expected_pose_servo.tran.x), expected_pose_servo.data(), 6 * 8);
-
-                    pthread_mutex_lock(&mutex);
-
-                    robot.kine_inverse(&tmp_current_joint_servo, &tmp_expected_pose_servo, &tmp_expected_joint_servo);
-
-                    pthread_mutex_unlock(&mutex);
-
-                    memcpy(expected_joint_servo.data(), tmp_expected_joint_servo.jVal, 6 * 8);
-
-                    Average_Series(current_joint_servo, expected_joint_servo, 0.1, tra);
-
-                    // Trapezoid_Velocity_Series(expected_joint_servo, tra, vel_lim, acc_lim, start_vel, end_vel);
-
-                    servo_pose_change_flag = false;
-                    t = 0;
-                    cout << "change expected pose" << expected_pose_servo.transpose() << endl;
-                }
+    return NULL;
+}
 
-                memcpy(tmp_expected_joint_servo.jVal, tra[t].data(), 6 * 8);
-                cout << "路径点" << t << ": " << tra[t].transpose() << endl;
-                plot_data.data_6 = tmp_expected_joint_servo.jVal[1];
-                plot_data.data_7 = tmp_expected_joint_servo.jVal[2];
+void *MotionAbortListen(void *args)
+{
+    ros::NodeHandle n_abort;
 
-                pthread_mutex_lock(&mutex);
+    // 独立的回调队列与线程, 不排在伺服、运动或状态发布之后; TCP_NODELAY 避免 Nagle 延迟
+    ros::CallbackQueue abort_queue;
+    n_abort.setCallbackQueue(&abort_queue);
 
-                int sdk_res = robot.servo_j(&tmp_expected_joint_servo, ABS, 1);
+    // 1.9 topic motion abort -
+    ros::Subscriber motion_abort_sub = n_abort.subscribe("/robot_driver/motion_abort", 10, &MotionAbortAccepted,
+                                                         ros::TransportHints().tcpNoDelay());
 
-                pthread_mutex_unlock(&mutex);
+    while (ros::ok())
+        abort_queue.callAvailable(ros::WallDuration(0.1));
 
-                if (sdk_res != 0)
-                {
-                    cout << "servo error:" << mapErr[sdk_res] << endl;
-                    int res = robot.motion_abort();
-                    switch (res)
-                    {
-                    case 0:
-                        ROS_INFO("stop sucess");
-                        break;
-                    default:
-                        cout << "stop error:" << mapErr[res] << endl;
-                        break;
-                    }
-                }
-            }
-            usleep(8 * 1000);
-        }
-    }
+    return NULL;
 }
 
 int main(int argc, char **argv)
@@ -1279,20 +1341,47 @@ int main(int argc, char **argv)
 
     // init params
     string ip = "192.168.50.170";
-    expected_pose_servo = VectorXd::Zero(6);
     pthread_mutex_init(&mutex, NULL);
 
+    // servo session defaults, can be changed by /robot_driver/servo_config
+    ServoConfig servo_config;
+    std::vector<double> servo_filter_params;
+    std::string servo_error;
+    int servo_mode = servo_config.mode;
+    int servo_filter = servo_config.filter;
+    ros::param::param<int>("~servo_pipeline", servo_mode, servo_mode);
+    ros::param::param<int>("~servo_filter", servo_filter, servo_filter);
+    ros::param::param<double>("~servo_interp_time", servo_config.interp_time, servo_config.interp_time);
+    if (ros::param::get("~servo_filter_params", servo_filter_params))
+    {
+        servo_config.filter_param_num = servo_filter_params.size();
+        for (int i = 0; i < servo_config.filter_param_num && i < 6; i++)
+            servo_config.filter_params[i] = servo_filter_params[i];
+    }
+    servo_config.mode = static_cast<ServoPipelineMode>(servo_mode);
+    servo_config.filter = static_cast<ServoFilterType>(servo_filter);
+    if (!servo_pipeline.SetConfig(servo_config, servo_error))
+        ROS_ERROR("servo config: %s, using defaults", servo_error.c_str());
+
     ros::param::set("/enable_robot", false);
     ros::param::set("/disable_robot", false);
     ros::param::set("robot_ip", ip);
 
     /* services and topics */
 
+    // move_line / move_joint / move_path 在独立的回调队列中阻塞等待, 不占用 stop_move / cancel_move 所在的主队列
+    ros::NodeHandle motion_n;
+    ros::CallbackQueue motion_callback_queue;
+    motion_n.setCallbackQueue(&motion_callback_queue);
+
     // 1.1 service move line -
-    ros::ServiceServer service_movel = n.advertiseService("/robot_driver/move_line", movel_callback);
+    ros::ServiceServer service_movel = motion_n.advertiseService("/robot_driver/move_line", movel_callback);
 
     // 1.2 service move joint -
-    ros::ServiceServer service_movej = n.advertiseService("/robot_driver/move_joint", movej_callback);
+    ros::ServiceServer service_movej = motion_n.advertiseService("/robot_driver/move_joint", movej_callback);
+
+    // 1.8 service move path -
+    ros::ServiceServer service_move_path = motion_n.advertiseService("/robot_driver/move_path", move_path_callback);
 
     // 1.3 service jog move -
     // ros::ServiceServer move_jog = n.advertiseService("/robot_driver/move_jog", move_jog_callback);
@@ -1300,6 +1389,13 @@ int main(int argc, char **argv)
     // 1.4 service stop move -
     ros::ServiceServer service_stop = n.advertiseService("/robot_driver/stop_move", stop_callback);
 
+    // 1.6 service servo config -
+    ros::ServiceServer service_servo_config = n.advertiseService("/robot_driver/servo_config", servo_config_callback);
+
+    // 1.7 service cancel move -
+    ros::ServiceServer service_cancel_move = n.advertiseService("/robot_driver/cancel_move", cancel_move_callback);
+    move_feedback_pub = n.advertise<robot_msgs::MoveFeedback>("/robot_driver/move_feedback", 10);
+
     // 2.4 service get robot position -
     ros::ServiceServer service_position = n.advertiseService("/robot_driver/update_position", GetPositionCallback);
 
@@ -1350,12 +1446,25 @@ int main(int argc, char **argv)
     pthread_t tids_3;
     pthread_create(&tids_3, NULL, ServoMove, &n);
 
+    pthread_t tids_4;
+    pthread_create(&tids_4, NULL, MotionAbortListen, &n);
+
+    motion_queue.SetFeedbackCallback(PublishMoveFeedback);
+    motion_queue.Start();
+
+    ros::AsyncSpinner motion_spinner(4, &motion_callback_queue);
+    motion_spinner.start();
+
     // ros::MultiThreadedSpinner s(4);S
     ros::spin();
 
+    motion_spinner.stop();
+    motion_queue.Stop();
+
     // pthread_join(tids_1, NULL);
     pthread_join(tids_2, NULL);
     pthread_join(tids_3, NULL);
+    pthread_join(tids_4, NULL);
     std::cout << "shut down" << std::endl;
 
     pthread_mutex_lock(&mutex);
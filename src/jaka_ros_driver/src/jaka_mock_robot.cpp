@@ -0,0 +1,1512 @@
+/**
+ * In-process mock of libjakaAPI.so, see jaka_mock.h.
+ *
+ * Only the part of JAKAZuRobot the driver uses is implemented; calling anything else
+ * fails at link time, which is the point of a drop-in backend.
+ */
+
+#include "libs/robot.h"
+#include "jaka_mock.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+#include "Eigen/LU"
+
+using namespace Eigen;
+
+namespace
+{
+
+const double kPI = 3.14159265358979323846;
+
+// a (mm), d (mm), alpha (deg) of the arm, same MDH table as admittance_control/MDK_computation
+const double kMDH[6][3] = {{0.0, 119.87, -0.13},
+                           {0.0, 0.0, 90.00},
+                           {555.24, 0.0, 0.28},
+                           {482.28, -115.33, 0.08},
+                           {0.0, 113.23, 90.01},
+                           {0.0, 107.17, -89.83}};
+
+const int kServoBufferSize = 512;   // servo commands the controller buffers
+const double kRotSpeed = kPI / 2;   // orientation speed of linear_move (rad/s)
+const double kRotAccel = kPI;       // orientation acceleration of linear_move (rad/s^2)
+
+std::mutex config_mutex;
+jaka_mock::Config mock_config;
+
+std::atomic<unsigned long> stat_calls(0);
+std::atomic<unsigned long> stat_status_polls(0);
+std::atomic<unsigned long> stat_servo_commands(0);
+std::atomic<unsigned long> stat_servo_underruns(0);
+std::atomic<unsigned long> stat_servo_overruns(0);
+std::atomic<unsigned long> stat_cycles(0);
+std::atomic<unsigned long> stat_cycle_overruns(0);
+
+double EnvDouble(const char *name, double value)
+{
+    const char *env = getenv(name);
+
+    return env ? atof(env) : value;
+}
+
+/* ---------------------------------------------------------------- kinematics */
+
+Matrix4d MdhTransform(int i, double theta)
+{
+    double a = kMDH[i][0];
+    double d = kMDH[i][1];
+    double alpha = kMDH[i][2] / 180 * kPI;
+    double ct = cos(theta), st = sin(theta), ca = cos(alpha), sa = sin(alpha);
+    Matrix4d t;
+
+    t << ct, -st, 0, a,
+        st * ca, ct * ca, -sa, -sa * d,
+        st * sa, ct * sa, ca, ca * d,
+        0, 0, 0, 1;
+
+    return t;
+}
+
+/* frames[i] = T_0(i+1), tcp = T_06 * tool */
+Matrix4d ForwardFrames(const double q[6], const Matrix4d &tool, Matrix4d frames[6])
+{
+    Matrix4d t = Matrix4d::Identity();
+
+    for (int i = 0; i < 6; i++)
+    {
+        t = t * MdhTransform(i, q[i]);
+        frames[i] = t;
+    }
+
+    return t * tool;
+}
+
+Matrix4d SolveForward(const double q[6], const Matrix4d &tool)
+{
+    Matrix4d frames[6];
+
+    return ForwardFrames(q, tool, frames);
+}
+
+Matrix3d RpyToRotation(double rx, double ry, double rz)
+{
+    return (AngleAxisd(rz, Vector3d::UnitZ()) *
+            AngleAxisd(ry, Vector3d::UnitY()) *
+            AngleAxisd(rx, Vector3d::UnitX()))
+        .toRotationMatrix();
+}
+
+void RotationToRpy(const Matrix3d &r, double rpy[3])
+{
+    Vector3d n = r.col(0);
+    Vector3d o = r.col(1);
+    Vector3d a = r.col(2);
+
+    rpy[2] = atan2(n(1), n(0));
+    rpy[1] = atan2(-n(2), n(0) * cos(rpy[2]) + n(1) * sin(rpy[2]));
+    rpy[0] = atan2(a(0) * sin(rpy[2]) - a(1) * cos(rpy[2]), -o(0) * sin(rpy[2]) + o(1) * cos(rpy[2]));
+}
+
+/* pose: x, y, z (mm), rx, ry, rz (rad) */
+Matrix4d PoseToTransform(const double pose[6])
+{
+    Matrix4d t = Matrix4d::Identity();
+
+    t.block<3, 3>(0, 0) = RpyToRotation(pose[3], pose[4], pose[5]);
+    t.block<3, 1>(0, 3) << pose[0], pose[1], pose[2];
+
+    return t;
+}
+
+void TransformToPose(const Matrix4d &t, double pose[6])
+{
+    pose[0] = t(0, 3);
+    pose[1] = t(1, 3);
+    pose[2] = t(2, 3);
+    RotationToRpy(t.block<3, 3>(0, 0), pose + 3);
+}
+
+/* damped least squares from the reference joints, position error in m */
+bool SolveInverse(const double ref[6], const Matrix4d &target, const Matrix4d &tool, double q[6])
+{
+    Matrix4d frames[6];
+    Matrix<double, 6, 6> jacobian;
+    Matrix<double, 6, 1> error;
+    const double lambda2 = 1e-4;
+
+    memcpy(q, ref, 6 * 8);
+
+    for (int iter = 0; iter < 100; iter++)
+    {
+        Matrix4d tcp = ForwardFrames(q, tool, frames);
+        AngleAxisd rot_error(target.block<3, 3>(0, 0) * tcp.block<3, 3>(0, 0).transpose());
+
+        error.head<3>() = (target.block<3, 1>(0, 3) - tcp.block<3, 1>(0, 3)) / 1000;
+        error.tail<3>() = rot_error.angle() * rot_error.axis();
+
+        if (error.norm() < 1e-10)
+            return true;
+
+        for (int i = 0; i < 6; i++)
+        {
+            Vector3d z = frames[i].block<3, 1>(0, 2);
+            Vector3d p = (tcp.block<3, 1>(0, 3) - frames[i].block<3, 1>(0, 3)) / 1000;
+            jacobian.block<3, 1>(0, i) = z.cross(p);
+            jacobian.block<3, 1>(3, i) = z;
+        }
+
+        Matrix<double, 6, 6> jjt = jacobian * jacobian.transpose();
+        jjt.diagonal().array() += lambda2;
+        Matrix<double, 6, 1> dq = jacobian.transpose() * jjt.partialPivLu().solve(error);
+
+        for (int i = 0; i < 6; i++)
+            q[i] += dq(i);
+    }
+
+    return false;
+}
+
+/* ---------------------------------------------------------------- profiles */
+
+double TrapezoidDuration(double length, double vel, double acc)
+{
+    if (length <= 0)
+        return 0;
+
+    double ta = vel / acc;
+    if (acc * ta * ta >= length)
+        return 2 * sqrt(length / acc);
+
+    return 2 * ta + (length - acc * ta * ta) / vel;
+}
+
+double TrapezoidDistance(double t, double length, double vel, double acc)
+{
+    double total = TrapezoidDuration(length, vel, acc);
+
+    if (t >= total)
+        return length;
+
+    double ta = vel / acc;
+    if (acc * ta * ta >= length)
+    {
+        ta = total / 2;
+        vel = acc * ta;
+    }
+
+    if (t < ta)
+        return 0.5 * acc * t * t;
+    if (t < total - ta)
+        return 0.5 * acc * ta * ta + vel * (t - ta);
+
+    double td = total - t;
+    return length - 0.5 * acc * td * td;
+}
+
+/* limit the rate of x towards target, velocity v (in/out) bounded by vmax and its change by amax*dt */
+double RateLimit(double x, double target, double &v, double vmax, double amax, double dt)
+{
+    double v_des = (target - x) / dt;
+
+    v_des = std::max(-vmax, std::min(vmax, v_des));
+    v_des = std::max(v - amax * dt, std::min(v + amax * dt, v_des));
+    v = v_des;
+
+    return x + v * dt;
+}
+
+struct Segment
+{
+    bool linear;
+    double goal[6]; // joint (rad) or pose (mm, rad)
+    double speed;
+    double accel;
+    double tol;
+    unsigned long id;
+
+    bool started;
+    double t;
+    double start[6];
+    Quaterniond start_rot;
+    Quaterniond goal_rot;
+    double length;     // of the dominant dimension
+    double vel;        // of the dominant dimension
+    double acc;        // of the dominant dimension
+    bool rot_dominant; // linear only
+};
+
+struct ServoTarget
+{
+    bool cartesian;
+    bool incremental;
+    double value[6];
+    unsigned int step_num;
+};
+
+enum ServoFilter
+{
+    FILTER_NONE,
+    FILTER_JOINT_LPF,
+    FILTER_JOINT_NLF,
+    FILTER_CARTE_NLF,
+    FILTER_JOINT_MMF
+};
+
+} // namespace
+
+/* ---------------------------------------------------------------- controller */
+
+class JAKAZuRobot::BIFClass
+{
+public:
+    BIFClass();
+    ~BIFClass();
+
+    void Delay();
+    void Start();
+    void Stop();
+    void CycleLoop();
+    void Cycle();
+
+    void StepServo();
+    void StepSegment();
+    void StepJog();
+    void AbortLocked();
+    bool IdleLocked() const;
+    errno_t QueueSegment(const Segment &segment, BOOL is_block);
+    errno_t MotionAllowed() const;
+    errno_t QueueServo(const ServoTarget &target);
+    errno_t SetServoFilter(ServoFilter servo_filter, const double *params, int num);
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::thread cycle_thread;
+    bool running;
+
+    jaka_mock::Config config;
+    std::mutex rng_mutex;
+    std::mt19937 rng;
+    double dt;
+
+    bool logged_in;
+    bool powered;
+    bool enabled;
+    bool servo_enabled;
+    bool drag;
+    int errcode;
+    int collision_level;
+    int tool_id;
+    int user_id;
+    Matrix4d tools[16];
+    PayLoad payload;
+
+    double q_act[6];
+    double q_cmd[6];
+
+    // joint_move / linear_move queue
+    std::deque<Segment> segments;
+    unsigned long next_id;
+    unsigned long finished_id; // every segment with id <= finished_id is done
+    unsigned long aborted_id;  // every segment with id <= aborted_id was aborted
+
+    // jog
+    bool jogging;
+    int jog_axis;
+    CoordType jog_coord;
+    double jog_vel;
+
+    // servo
+    std::deque<ServoTarget> servo_buf;
+    double servo_from[6];
+    double servo_goal[6];
+    unsigned int servo_steps;
+    unsigned int servo_step;
+    ServoFilter filter;
+    double filter_params[6];
+    double filter_state[6];
+    double filter_vel[6];
+    std::deque<Matrix<double, 6, 1>> mmf_buf;
+    Vector3d carte_pos;
+    Vector3d carte_vel;
+    Quaterniond carte_rot;
+    double carte_rot_vel;
+};
+
+JAKAZuRobot::BIFClass::BIFClass()
+    : running(false),
+      dt(0.008),
+      logged_in(false),
+      powered(false),
+      enabled(false),
+      servo_enabled(false),
+      drag(false),
+      errcode(0),
+      collision_level(3),
+      tool_id(0),
+      user_id(0),
+      next_id(0),
+      finished_id(0),
+      aborted_id(0),
+      jogging(false),
+      jog_axis(0),
+      jog_coord(COORD_JOINT),
+      jog_vel(0),
+      servo_steps(0),
+      servo_step(0),
+      filter(FILTER_NONE),
+      carte_rot_vel(0)
+{
+    for (int i = 0; i < 16; i++)
+        tools[i] = Matrix4d::Identity();
+    memset(&payload, 0, sizeof(payload));
+    memset(q_act, 0, sizeof(q_act));
+    memset(q_cmd, 0, sizeof(q_cmd));
+    memset(filter_params, 0, sizeof(filter_params));
+}
+
+JAKAZuRobot::BIFClass::~BIFClass()
+{
+    Stop();
+}
+
+void JAKAZuRobot::BIFClass::Delay()
+{
+    stat_calls++;
+
+    double delay_us;
+    {
+        std::lock_guard<std::mutex> lock(rng_mutex);
+        delay_us = config.latency_us;
+        if (config.jitter_us > 0)
+            delay_us += std::uniform_real_distribution<double>(0, config.jitter_us)(rng);
+    }
+
+    if (delay_us > 0)
+        std::this_thread::sleep_for(std::chrono::nanoseconds(static_cast<long>(delay_us * 1000)));
+}
+
+void JAKAZuRobot::BIFClass::Start()
+{
+    // config, rng and dt are read by the cycle thread and by Delay(), only replace them while stopped
+    std::lock_guard<std::mutex> lock(m);
+    if (running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> rng_lock(rng_mutex);
+        config = jaka_mock::GetConfig();
+        rng.seed(config.seed);
+    }
+    dt = config.cycle_us / 1e6;
+
+    memcpy(q_act, config.initial_joint, sizeof(q_act));
+    memcpy(q_cmd, config.initial_joint, sizeof(q_cmd));
+    running = true;
+    cycle_thread = std::thread(&BIFClass::CycleLoop, this);
+}
+
+void JAKAZuRobot::BIFClass::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if (!running)
+            return;
+        running = false;
+        AbortLocked();
+    }
+    cv.notify_all();
+    cycle_thread.join();
+}
+
+void JAKAZuRobot::BIFClass::CycleLoop()
+{
+    std::chrono::steady_clock::duration cycle = std::chrono::nanoseconds(static_cast<long>(config.cycle_us * 1000));
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now() + cycle;
+
+    while (true)
+    {
+        std::this_thread::sleep_until(next);
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now - next > cycle)
+        {
+            stat_cycle_overruns++;
+            next = now;
+        }
+        next += cycle;
+
+        {
+            std::lock_guard<std::mutex> lock(m);
+            if (!running)
+                break;
+            Cycle();
+        }
+        cv.notify_all();
+        stat_cycles++;
+    }
+}
+
+void JAKAZuRobot::BIFClass::Cycle()
+{
+    // the joints follow the command of the previous cycle
+    memcpy(q_act, q_cmd, sizeof(q_act));
+
+    if (!enabled || errcode != 0)
+        return;
+
+    if (servo_enabled)
+        StepServo();
+    else if (jogging)
+        StepJog();
+    else
+        StepSegment();
+}
+
+void JAKAZuRobot::BIFClass::StepServo()
+{
+    if (servo_step >= servo_steps)
+    {
+        if (servo_buf.empty())
+        {
+            stat_servo_underruns++;
+            return;
+        }
+
+        ServoTarget target = servo_buf.front();
+        servo_buf.pop_front();
+
+        memcpy(servo_from, servo_goal, sizeof(servo_from));
+        if (target.cartesian)
+        {
+            double pose[6];
+            memcpy(pose, target.value, sizeof(pose));
+            if (target.incremental)
+            {
+                double from[6];
+                TransformToPose(SolveForward(servo_from, tools[tool_id]), from);
+                for (int i = 0; i < 6; i++)
+                    pose[i] += from[i];
+            }
+            if (!SolveInverse(servo_from, PoseToTransform(pose), tools[tool_id], servo_goal))
+            {
+                errcode = ERR_KINE_INVERSE_ERR;
+                AbortLocked();
+                return;
+            }
+        }
+        else
+        {
+            for (int i = 0; i < 6; i++)
+                servo_goal[i] = target.incremental ? servo_from[i] + target.value[i] : target.value[i];
+        }
+        servo_steps = std::max(1u, target.step_num);
+        servo_step = 0;
+    }
+
+    servo_step++;
+
+    Matrix<double, 6, 1> raw;
+    for (int i = 0; i < 6; i++)
+        raw(i) = servo_from[i] + (servo_goal[i] - servo_from[i]) * servo_step / servo_steps;
+
+    switch (filter)
+    {
+    case FILTER_JOINT_LPF:
+    {
+        double alpha = 1 - exp(-2 * kPI * filter_params[0] * dt);
+        for (int i = 0; i < 6; i++)
+        {
+            filter_state[i] += alpha * (raw(i) - filter_state[i]);
+            q_cmd[i] = filter_state[i];
+        }
+        break;
+    }
+    case FILTER_JOINT_NLF:
+    {
+        double vmax = filter_params[0] / 180 * kPI;
+        double amax = filter_params[1] / 180 * kPI;
+        for (int i = 0; i < 6; i++)
+        {
+            filter_state[i] = RateLimit(filter_state[i], raw(i), filter_vel[i], vmax, amax, dt);
+            q_cmd[i] = filter_state[i];
+        }
+        break;
+    }
+    case FILTER_CARTE_NLF:
+    {
+        Matrix4d t = SolveForward(raw.data(), tools[tool_id]);
+        Vector3d pos = t.block<3, 1>(0, 3);
+        Quaterniond rot(Matrix3d(t.block<3, 3>(0, 0)));
+        double q[6];
+
+        // translation along the straight line to the target, speed/acceleration limited
+        Vector3d diff = pos - carte_pos;
+        double dist = diff.norm();
+        double v = carte_vel.norm();
+        double step = dist > 1e-9 ? RateLimit(0, dist, v, filter_params[0], filter_params[1], dt) : 0;
+        if (dist > 1e-9)
+            carte_pos += diff / dist * std::min(step, dist);
+        carte_vel = dist > 1e-9 ? Vector3d(diff / dist * v) : Vector3d::Zero();
+
+        // orientation along the geodesic, angular speed/acceleration limited
+        double angle = carte_rot.angularDistance(rot);
+        double rot_step = RateLimit(0, angle, carte_rot_vel, filter_params[3] / 180 * kPI, filter_params[4] / 180 * kPI, dt);
+        if (angle > 1e-9)
+            carte_rot = carte_rot.slerp(std::min(1.0, rot_step / angle), rot);
+
+        t.block<3, 3>(0, 0) = carte_rot.toRotationMatrix();
+        t.block<3, 1>(0, 3) = carte_pos;
+        if (!SolveInverse(q_cmd, t, tools[tool_id], q))
+        {
+            errcode = ERR_KINE_INVERSE_ERR;
+            AbortLocked();
+            return;
+        }
+        memcpy(q_cmd, q, sizeof(q));
+        break;
+    }
+    case FILTER_JOINT_MMF:
+    {
+        mmf_buf.push_back(raw);
+        while (mmf_buf.size() > std::max(1.0, filter_params[0]))
+            mmf_buf.pop_front();
+
+        Matrix<double, 6, 1> mean = Matrix<double, 6, 1>::Zero();
+        for (size_t k = 0; k < mmf_buf.size(); k++)
+            mean += mmf_buf[k];
+        mean /= mmf_buf.size();
+        memcpy(q_cmd, mean.data(), sizeof(q_cmd));
+        break;
+    }
+    default:
+        memcpy(q_cmd, raw.data(), sizeof(q_cmd));
+        break;
+    }
+}
+
+void JAKAZuRobot::BIFClass::StepSegment()
+{
+    if (segments.empty())
+        return;
+
+    Segment &sg = segments.front();
+
+    if (!sg.started)
+    {
+        sg.started = true;
+        sg.t = 0;
+        sg.rot_dominant = false;
+
+        if (sg.linear)
+        {
+            Matrix4d t = SolveForward(q_cmd, tools[tool_id]);
+            TransformToPose(t, sg.start);
+            sg.start_rot = Quaterniond(Matrix3d(t.block<3, 3>(0, 0)));
+            sg.goal_rot = Quaterniond(RpyToRotation(sg.goal[3], sg.goal[4], sg.goal[5]));
+
+            double trans = Vector3d(sg.goal[0] - sg.start[0], sg.goal[1] - sg.start[1], sg.goal[2] - sg.start[2]).norm();
+            double rot = sg.start_rot.angularDistance(sg.goal_rot);
+
+            sg.length = trans;
+            sg.vel = sg.speed;
+            sg.acc = sg.accel;
+            if (TrapezoidDuration(rot, kRotSpeed, kRotAccel) > TrapezoidDuration(trans, sg.speed, sg.accel))
+            {
+                sg.rot_dominant = true;
+                sg.length = rot;
+                sg.vel = kRotSpeed;
+                sg.acc = kRotAccel;
+            }
+        }
+        else
+        {
+            memcpy(sg.start, q_cmd, sizeof(sg.start));
+            sg.length = 0;
+            for (int i = 0; i < 6; i++)
+                sg.length = std::max(sg.length, fabs(sg.goal[i] - sg.start[i]));
+            sg.vel = sg.speed;
+            sg.acc = sg.accel;
+        }
+    }
+
+    sg.t += dt;
+
+    double s = 1;
+    if (sg.length > 1e-12)
+        s = TrapezoidDistance(sg.t, sg.length, sg.vel, sg.acc) / sg.length;
+
+    if (sg.linear)
+    {
+        Matrix4d t = Matrix4d::Identity();
+        double q[6];
+
+        for (int i = 0; i < 3; i++)
+            t(i, 3) = sg.start[i] + s * (sg.goal[i] - sg.start[i]);
+        t.block<3, 3>(0, 0) = sg.start_rot.slerp(s, sg.goal_rot).toRotationMatrix();
+
+        if (!SolveInverse(q_cmd, t, tools[tool_id], q))
+        {
+            errcode = ERR_KINE_INVERSE_ERR;
+            AbortLocked();
+            return;
+        }
+        memcpy(q_cmd, q, sizeof(q));
+    }
+    else
+    {
+        for (int i = 0; i < 6; i++)
+            q_cmd[i] = sg.start[i] + s * (sg.goal[i] - sg.start[i]);
+    }
+
+    // blend into the next segment once inside the tolerance of this one
+    bool blend = sg.tol > 0 && segments.size() > 1 && !sg.rot_dominant && (1 - s) * sg.length <= sg.tol;
+    if (s >= 1 || blend)
+    {
+        finished_id = sg.id;
+        segments.pop_front();
+    }
+}
+
+void JAKAZuRobot::BIFClass::StepJog()
+{
+    if (jog_coord == COORD_JOINT)
+    {
+        q_cmd[jog_axis] += jog_vel * dt;
+        return;
+    }
+
+    Matrix4d t = SolveForward(q_cmd, tools[tool_id]);
+    Matrix4d delta = Matrix4d::Identity();
+    double q[6];
+
+    if (jog_axis < 3)
+        delta(jog_axis, 3) = jog_vel * dt;
+    else
+        delta.block<3, 3>(0, 0) = AngleAxisd(jog_vel * dt, Vector3d::Unit(jog_axis - 3)).toRotationMatrix();
+
+    if (jog_coord == COORD_TOOL)
+        t = t * delta;
+    else
+    {
+        t.block<3, 1>(0, 3) += delta.block<3, 1>(0, 3);
+        t.block<3, 3>(0, 0) = delta.block<3, 3>(0, 0) * t.block<3, 3>(0, 0);
+    }
+
+    if (!SolveInverse(q_cmd, t, tools[tool_id], q))
+    {
+        jogging = false;
+        return;
+    }
+    memcpy(q_cmd, q, sizeof(q));
+}
+
+void JAKAZuRobot::BIFClass::AbortLocked()
+{
+    segments.clear();
+    servo_buf.clear();
+    mmf_buf.clear();
+    servo_step = servo_steps;
+    memcpy(servo_goal, q_cmd, sizeof(servo_goal));
+    jogging = false;
+    aborted_id = next_id;
+    finished_id = next_id;
+}
+
+bool JAKAZuRobot::BIFClass::IdleLocked() const
+{
+    if (!segments.empty() || jogging || !servo_buf.empty() || servo_step < servo_steps)
+        return false;
+
+    for (int i = 0; i < 6; i++)
+    {
+        if (fabs(q_cmd[i] - q_act[i]) > 1e-6)
+            return false;
+    }
+
+    return true;
+}
+
+errno_t JAKAZuRobot::BIFClass::MotionAllowed() const
+{
+    if (!logged_in)
+        return ERR_INVALID_HANDLER;
+    if (!powered)
+        return ERR_NOT_POWERED;
+    if (!enabled)
+        return ERR_NOT_ENABLED;
+    if (errcode != 0)
+        return ERR_MOTION_ABNORMAL;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::BIFClass::QueueSegment(const Segment &segment, BOOL is_block)
+{
+    std::unique_lock<std::mutex> lock(m);
+
+    errno_t res = MotionAllowed();
+    if (res != ERR_SUCC)
+        return res;
+    if (servo_enabled)
+        return ERR_FUCTION_CALL_ERROR;
+    if (segment.speed <= 0 || segment.accel <= 0)
+        return ERR_INVALID_PARAMETER;
+
+    Segment sg = segment;
+    sg.id = ++next_id;
+    sg.started = false;
+    segments.push_back(sg);
+
+    if (!is_block)
+        return ERR_SUCC;
+
+    cv.wait(lock, [&] { return finished_id >= sg.id || !running; });
+
+    return (aborted_id >= sg.id || errcode != 0) ? ERR_MOTION_ABNORMAL : ERR_SUCC;
+}
+
+/* ---------------------------------------------------------------- jaka_mock */
+
+jaka_mock::Config::Config()
+    : latency_us(EnvDouble("JAKA_MOCK_LATENCY_US", 200)),
+      jitter_us(EnvDouble("JAKA_MOCK_JITTER_US", 100)),
+      cycle_us(EnvDouble("JAKA_MOCK_CYCLE_US", 8000)),
+      seed(static_cast<unsigned int>(EnvDouble("JAKA_MOCK_SEED", 1)))
+{
+    const double joint[6] = {0.16522547684382893, 2.026115249482023, 1.9502954394352305,
+                             0.7277293271572154, -1.5764709940311654, 1.7271638412619614};
+
+    memcpy(initial_joint, joint, sizeof(initial_joint));
+}
+
+void jaka_mock::SetConfig(const Config &config)
+{
+    std::lock_guard<std::mutex> lock(config_mutex);
+    mock_config = config;
+}
+
+jaka_mock::Config jaka_mock::GetConfig()
+{
+    std::lock_guard<std::mutex> lock(config_mutex);
+    return mock_config;
+}
+
+jaka_mock::Stats jaka_mock::GetStats()
+{
+    Stats stats;
+
+    stats.calls = stat_calls;
+    stats.status_polls = stat_status_polls;
+    stats.servo_commands = stat_servo_commands;
+    stats.servo_underruns = stat_servo_underruns;
+    stats.servo_overruns = stat_servo_overruns;
+    stats.cycles = stat_cycles;
+    stats.cycle_overruns = stat_cycle_overruns;
+
+    return stats;
+}
+
+void jaka_mock::ResetStats()
+{
+    stat_calls = 0;
+    stat_status_polls = 0;
+    stat_servo_commands = 0;
+    stat_servo_underruns = 0;
+    stat_servo_overruns = 0;
+    stat_cycles = 0;
+    stat_cycle_overruns = 0;
+}
+
+/* ---------------------------------------------------------------- JAKAZuRobot */
+
+JAKAZuRobot::JAKAZuRobot() : ptr(new BIFClass())
+{
+}
+
+JAKAZuRobot::~JAKAZuRobot()
+{
+    delete ptr;
+}
+
+errno_t JAKAZuRobot::login_in(const char *ip)
+{
+    ptr->Start();
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    ptr->logged_in = true;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::login_out()
+{
+    ptr->Delay();
+    ptr->Stop();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    ptr->logged_in = false;
+    ptr->servo_enabled = false;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::power_on()
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    if (!ptr->logged_in)
+        return ERR_INVALID_HANDLER;
+    ptr->powered = true;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::power_off()
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    if (!ptr->logged_in)
+        return ERR_INVALID_HANDLER;
+    ptr->AbortLocked();
+    ptr->powered = false;
+    ptr->enabled = false;
+    ptr->servo_enabled = false;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::enable_robot()
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    if (!ptr->logged_in)
+        return ERR_INVALID_HANDLER;
+    if (!ptr->powered)
+        return ERR_NOT_POWERED;
+    ptr->enabled = true;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::disable_robot()
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    if (!ptr->logged_in)
+        return ERR_INVALID_HANDLER;
+    ptr->AbortLocked();
+    ptr->enabled = false;
+    ptr->servo_enabled = false;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::jog(int aj_num, MoveMode move_mode, CoordType coord_type, double vel_cmd, double pos_cmd)
+{
+    ptr->Delay();
+
+    if (aj_num < 0 || aj_num > 5)
+        return ERR_INVALID_PARAMETER;
+
+    if (move_mode != CONTINUE)
+    {
+        Segment sg = Segment();
+
+        std::unique_lock<std::mutex> lock(ptr->m);
+        if (coord_type == COORD_JOINT)
+        {
+            memcpy(sg.goal, ptr->q_cmd, sizeof(sg.goal));
+            sg.goal[aj_num] = move_mode == INCR ? sg.goal[aj_num] + pos_cmd : pos_cmd;
+        }
+        else
+        {
+            TransformToPose(SolveForward(ptr->q_cmd, ptr->tools[ptr->tool_id]), sg.goal);
+            sg.goal[aj_num] = move_mode == INCR ? sg.goal[aj_num] + pos_cmd : pos_cmd;
+            sg.linear = true;
+        }
+        lock.unlock();
+
+        sg.speed = fabs(vel_cmd);
+        sg.accel = sg.linear ? 1000 : kPI;
+
+        return ptr->QueueSegment(sg, FALSE);
+    }
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    errno_t res = ptr->MotionAllowed();
+    if (res != ERR_SUCC)
+        return res;
+    if (ptr->servo_enabled || !ptr->segments.empty())
+        return ERR_FUCTION_CALL_ERROR;
+
+    ptr->jogging = true;
+    ptr->jog_axis = aj_num;
+    ptr->jog_coord = coord_type;
+    ptr->jog_vel = vel_cmd;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::jog_stop(int num)
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    if (!ptr->logged_in)
+        return ERR_INVALID_HANDLER;
+    if (num < 0 || num == ptr->jog_axis)
+        ptr->jogging = false;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::joint_move(const JointValue *joint_pos, MoveMode move_mode, BOOL is_block, double speed)
+{
+    return joint_move(joint_pos, move_mode, is_block, speed, 90.0 / 180 * kPI, 0, NULL);
+}
+
+errno_t JAKAZuRobot::joint_move(const JointValue *joint_pos, MoveMode move_mode, BOOL is_block, double speed, double acc, double tol, const OptionalCond *option_cond)
+{
+    ptr->Delay();
+
+    Segment sg = Segment();
+    memcpy(sg.goal, joint_pos->jVal, sizeof(sg.goal));
+    sg.linear = false;
+    sg.speed = speed;
+    sg.accel = acc;
+    sg.tol = tol;
+
+    if (move_mode == INCR)
+    {
+        std::lock_guard<std::mutex> lock(ptr->m);
+        const double *base = ptr->segments.empty() ? ptr->q_cmd : ptr->segments.back().goal;
+        for (int i = 0; i < 6; i++)
+            sg.goal[i] += base[i];
+    }
+
+    return ptr->QueueSegment(sg, is_block);
+}
+
+errno_t JAKAZuRobot::linear_move(const CartesianPose *end_pos, MoveMode move_mode, BOOL is_block, double speed)
+{
+    return linear_move(end_pos, move_mode, is_block, speed, 500, 0, NULL);
+}
+
+errno_t JAKAZuRobot::linear_move(const CartesianPose *end_pos, MoveMode move_mode, BOOL is_block, double speed, double accel, double tol, const OptionalCond *option_cond)
+{
+    ptr->Delay();
+
+    Segment sg = Segment();
+    memcpy(sg.goal, &(end_pos->tran.x), sizeof(sg.goal));
+    sg.linear = true;
+    sg.speed = speed;
+    sg.accel = accel;
+    sg.tol = tol;
+
+    if (move_mode == INCR)
+    {
+        std::lock_guard<std::mutex> lock(ptr->m);
+        double base[6];
+        if (ptr->segments.empty() || !ptr->segments.back().linear)
+            TransformToPose(SolveForward(ptr->q_cmd, ptr->tools[ptr->tool_id]), base);
+        else
+            memcpy(base, ptr->segments.back().goal, sizeof(base));
+        for (int i = 0; i < 6; i++)
+            sg.goal[i] += base[i];
+    }
+
+    return ptr->QueueSegment(sg, is_block);
+}
+
+errno_t JAKAZuRobot::motion_abort()
+{
+    ptr->Delay();
+
+    {
+        std::lock_guard<std::mutex> lock(ptr->m);
+        if (!ptr->logged_in)
+            return ERR_INVALID_HANDLER;
+        ptr->AbortLocked();
+    }
+    ptr->cv.notify_all();
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::is_in_pos(BOOL *in_pos)
+{
+    ptr->Delay();
+    stat_status_polls++;
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    if (!ptr->logged_in)
+        return ERR_INVALID_HANDLER;
+    *in_pos = ptr->IdleLocked();
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::servo_move_enable(BOOL enable)
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    errno_t res = ptr->MotionAllowed();
+    if (res != ERR_SUCC)
+        return res;
+
+    if (enable && !ptr->servo_enabled)
+    {
+        if (!ptr->segments.empty() || ptr->jogging)
+            return ERR_FUCTION_CALL_ERROR;
+
+        Matrix4d t = SolveForward(ptr->q_cmd, ptr->tools[ptr->tool_id]);
+        memcpy(ptr->servo_goal, ptr->q_cmd, sizeof(ptr->servo_goal));
+        memcpy(ptr->filter_state, ptr->q_cmd, sizeof(ptr->filter_state));
+        memset(ptr->filter_vel, 0, sizeof(ptr->filter_vel));
+        ptr->servo_steps = ptr->servo_step = 0;
+        // the moving mean starts from rest at the current command, not from the first target alone
+        ptr->mmf_buf.assign(static_cast<size_t>(std::max(1.0, ptr->filter_params[0])), Matrix<double, 6, 1>(Map<const Matrix<double, 6, 1>>(ptr->q_cmd)));
+        ptr->carte_pos = t.block<3, 1>(0, 3);
+        ptr->carte_vel = Vector3d::Zero();
+        ptr->carte_rot = Quaterniond(Matrix3d(t.block<3, 3>(0, 0)));
+        ptr->carte_rot_vel = 0;
+    }
+    else if (!enable)
+        ptr->servo_buf.clear();
+
+    ptr->servo_enabled = enable;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::BIFClass::QueueServo(const ServoTarget &target)
+{
+    Delay();
+    stat_servo_commands++;
+
+    std::lock_guard<std::mutex> lock(m);
+    errno_t res = MotionAllowed();
+    if (res != ERR_SUCC)
+        return res;
+    if (!servo_enabled)
+        return ERR_DISABLE_SERVOMODE;
+    if (servo_buf.size() >= static_cast<size_t>(kServoBufferSize))
+    {
+        // the command is lost, report it so the caller (and the benchmarks) see the overrun
+        stat_servo_overruns++;
+        return ERR_MOTION_ABNORMAL;
+    }
+    servo_buf.push_back(target);
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::servo_j(const JointValue *joint_pos, MoveMode move_mode)
+{
+    return servo_j(joint_pos, move_mode, 1);
+}
+
+errno_t JAKAZuRobot::servo_j(const JointValue *joint_pos, MoveMode move_mode, unsigned int step_num)
+{
+    ServoTarget target;
+
+    target.cartesian = false;
+    target.incremental = move_mode == INCR;
+    target.step_num = step_num;
+    memcpy(target.value, joint_pos->jVal, sizeof(target.value));
+
+    return ptr->QueueServo(target);
+}
+
+errno_t JAKAZuRobot::servo_p(const CartesianPose *cartesian_pose, MoveMode move_mode)
+{
+    return servo_p(cartesian_pose, move_mode, 1);
+}
+
+errno_t JAKAZuRobot::servo_p(const CartesianPose *cartesian_pose, MoveMode move_mode, unsigned int step_num)
+{
+    ServoTarget target;
+
+    target.cartesian = true;
+    target.incremental = move_mode == INCR;
+    target.step_num = step_num;
+    memcpy(target.value, &(cartesian_pose->tran.x), sizeof(target.value));
+
+    return ptr->QueueServo(target);
+}
+
+errno_t JAKAZuRobot::BIFClass::SetServoFilter(ServoFilter servo_filter, const double *params, int num)
+{
+    Delay();
+
+    std::lock_guard<std::mutex> lock(m);
+    if (!logged_in)
+        return ERR_INVALID_HANDLER;
+    if (servo_enabled) // 该指令在SERVO模式下不可设置
+        return ERR_FUCTION_CALL_ERROR;
+
+    filter = servo_filter;
+    memset(filter_params, 0, sizeof(filter_params));
+    memcpy(filter_params, params, num * sizeof(double));
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::servo_move_use_none_filter()
+{
+    return ptr->SetServoFilter(FILTER_NONE, NULL, 0);
+}
+
+errno_t JAKAZuRobot::servo_move_use_joint_LPF(double cutoffFreq)
+{
+    double params[1] = {cutoffFreq};
+
+    return ptr->SetServoFilter(FILTER_JOINT_LPF, params, 1);
+}
+
+errno_t JAKAZuRobot::servo_move_use_joint_NLF(double max_vr, double max_ar, double max_jr)
+{
+    double params[3] = {max_vr, max_ar, max_jr};
+
+    return ptr->SetServoFilter(FILTER_JOINT_NLF, params, 3);
+}
+
+errno_t JAKAZuRobot::servo_move_use_carte_NLF(double max_vp, double max_ap, double max_jp, double max_vr, double max_ar, double max_jr)
+{
+    double params[6] = {max_vp, max_ap, max_jp, max_vr, max_ar, max_jr};
+
+    return ptr->SetServoFilter(FILTER_CARTE_NLF, params, 6);
+}
+
+errno_t JAKAZuRobot::servo_move_use_joint_MMF(int max_buf, double kp, double kv, double ka)
+{
+    double params[4] = {static_cast<double>(max_buf), kp, kv, ka};
+
+    return ptr->SetServoFilter(FILTER_JOINT_MMF, params, 4);
+}
+
+errno_t JAKAZuRobot::get_robot_status(RobotStatus *status)
+{
+    ptr->Delay();
+    stat_status_polls++;
+
+    memset(status, 0, sizeof(RobotStatus));
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    double pose[6];
+    TransformToPose(SolveForward(ptr->q_act, ptr->tools[ptr->tool_id]), pose);
+
+    status->errcode = ptr->errcode;
+    status->inpos = ptr->IdleLocked();
+    status->powered_on = ptr->powered;
+    status->enabled = ptr->enabled;
+    status->rapidrate = 1.0;
+    status->current_tool_id = ptr->tool_id;
+    status->current_user_id = ptr->user_id;
+    status->drag_status = ptr->drag;
+    status->is_socket_connect = ptr->logged_in;
+    memcpy(status->cartesiantran_position, pose, sizeof(pose));
+    memcpy(status->joint_position, ptr->q_act, sizeof(ptr->q_act));
+
+    return ptr->logged_in ? ERR_SUCC : ERR_INVALID_HANDLER;
+}
+
+errno_t JAKAZuRobot::get_robot_state(RobotState *state)
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    state->estoped = FALSE;
+    state->poweredOn = ptr->powered;
+    state->servoEnabled = ptr->enabled;
+
+    return ptr->logged_in ? ERR_SUCC : ERR_INVALID_HANDLER;
+}
+
+errno_t JAKAZuRobot::get_tcp_position(CartesianPose *tcp_position)
+{
+    ptr->Delay();
+    stat_status_polls++;
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    TransformToPose(SolveForward(ptr->q_act, ptr->tools[ptr->tool_id]), &(tcp_position->tran.x));
+
+    return ptr->logged_in ? ERR_SUCC : ERR_INVALID_HANDLER;
+}
+
+errno_t JAKAZuRobot::get_joint_position(JointValue *joint_position)
+{
+    ptr->Delay();
+    stat_status_polls++;
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    memcpy(joint_position->jVal, ptr->q_act, sizeof(ptr->q_act));
+
+    return ptr->logged_in ? ERR_SUCC : ERR_INVALID_HANDLER;
+}
+
+errno_t JAKAZuRobot::kine_inverse(const JointValue *ref_pos, const CartesianPose *cartesian_pose, JointValue *joint_pos)
+{
+    ptr->Delay();
+
+    Matrix4d tool;
+    {
+        std::lock_guard<std::mutex> lock(ptr->m);
+        tool = ptr->tools[ptr->tool_id];
+    }
+
+    if (!SolveInverse(ref_pos->jVal, PoseToTransform(&(cartesian_pose->tran.x)), tool, joint_pos->jVal))
+        return ERR_KINE_INVERSE_ERR;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::kine_forward(const JointValue *joint_pos, CartesianPose *cartesian_pose)
+{
+    ptr->Delay();
+
+    Matrix4d tool;
+    {
+        std::lock_guard<std::mutex> lock(ptr->m);
+        tool = ptr->tools[ptr->tool_id];
+    }
+
+    TransformToPose(SolveForward(joint_pos->jVal, tool), &(cartesian_pose->tran.x));
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::rpy_to_rot_matrix(const Rpy *rpy, RotMatrix *rot_matrix)
+{
+    Matrix3d r = RpyToRotation(rpy->rx, rpy->ry, rpy->rz);
+
+    rot_matrix->x.x = r(0, 0);
+    rot_matrix->x.y = r(1, 0);
+    rot_matrix->x.z = r(2, 0);
+    rot_matrix->y.x = r(0, 1);
+    rot_matrix->y.y = r(1, 1);
+    rot_matrix->y.z = r(2, 1);
+    rot_matrix->z.x = r(0, 2);
+    rot_matrix->z.y = r(1, 2);
+    rot_matrix->z.z = r(2, 2);
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::rot_matrix_to_rpy(const RotMatrix *rot_matrix, Rpy *rpy)
+{
+    Matrix3d r;
+    double angles[3];
+
+    r << rot_matrix->x.x, rot_matrix->y.x, rot_matrix->z.x,
+        rot_matrix->x.y, rot_matrix->y.y, rot_matrix->z.y,
+        rot_matrix->x.z, rot_matrix->y.z, rot_matrix->z.z;
+    RotationToRpy(r, angles);
+    rpy->rx = angles[0];
+    rpy->ry = angles[1];
+    rpy->rz = angles[2];
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::set_tool_data(int id, const CartesianPose *tcp, const char *name)
+{
+    ptr->Delay();
+
+    if (id < 0 || id >= 16)
+        return ERR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    ptr->tools[id] = PoseToTransform(&(tcp->tran.x));
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::set_tool_id(const int id)
+{
+    ptr->Delay();
+
+    if (id < 0 || id >= 16)
+        return ERR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    if (!ptr->IdleLocked())
+        return ERR_PROGRAM_IS_RUNNING;
+    ptr->tool_id = id;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::get_tool_id(int *id)
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    *id = ptr->tool_id;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::set_user_frame_data(int id, const CartesianPose *user_frame, const char *name)
+{
+    ptr->Delay();
+
+    // user frames are accepted but moves are always interpreted in the base frame
+    return (id < 0 || id >= 16) ? ERR_INVALID_PARAMETER : ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::set_user_frame_id(const int id)
+{
+    ptr->Delay();
+
+    if (id < 0 || id >= 16)
+        return ERR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    ptr->user_id = id;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::drag_mode_enable(BOOL enable)
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    errno_t res = ptr->MotionAllowed();
+    if (res != ERR_SUCC)
+        return res;
+    ptr->drag = enable;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::is_in_drag_mode(BOOL *in_drag)
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    *in_drag = ptr->drag;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::set_payload(const PayLoad *payload)
+{
+    ptr->Delay();
+
+    if (payload->mass < 0)
+        return ERR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    ptr->payload = *payload;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::get_payload(PayLoad *payload)
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    *payload = ptr->payload;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::is_in_collision(BOOL *in_collision)
+{
+    ptr->Delay();
+
+    *in_collision = FALSE;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::collision_recover()
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    ptr->errcode = 0;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::clear_error()
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    ptr->errcode = 0;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::set_collision_level(const int level)
+{
+    ptr->Delay();
+
+    if (level < 0 || level > 5)
+        return ERR_INVALID_PARAMETER;
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    ptr->collision_level = level;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::get_collision_level(int *level)
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    *level = ptr->collision_level;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::get_program_state(ProgramState *status)
+{
+    ptr->Delay();
+
+    std::lock_guard<std::mutex> lock(ptr->m);
+    *status = ptr->segments.empty() ? PROGRAM_IDLE : PROGRAM_RUNNING;
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::get_sdk_version(char *version)
+{
+    strcpy(version, "jaka_mock");
+
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::set_error_handler(CallBackFuncType func)
+{
+    return ERR_SUCC;
+}
+
+errno_t JAKAZuRobot::set_network_exception_handle(float millisecond, ProcessType mnt)
+{
+    return ERR_SUCC;
+}
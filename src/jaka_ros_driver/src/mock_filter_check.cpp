@@ -0,0 +1,105 @@
+#include <cmath>
+#include <cstdio>
+#include <unistd.h>
+#include "JAKAZuRobot.h"
+#include "jaka_mock.h"
+
+/**
+ * jaka_mock_robot 的 SDK 滤波器自检: 每种滤波器下, 每个周期以 servo_j 下发关节 1 移动 0.1 rad 后的绝对位置,
+ * 记录各周期的关节位置; 无滤波时很快到位, 各滤波器的响应须与无滤波明显不同
+ * 用法: mock_filter_check, 不需要机器人与 ROS
+ */
+
+const double kStep = 0.1;   // rad
+const int kSamples = 12;    // 采样的控制周期数
+
+/* 设置滤波器后进入伺服, 返回各周期关节 1 相对起点的位移; 失败时返回 false */
+bool StepResponse(const char *name, errno_t (*set_filter)(JAKAZuRobot &), double response[kSamples])
+{
+    JAKAZuRobot robot;
+    robot.login_in("mock");
+    robot.power_on();
+    robot.enable_robot();
+
+    errno_t ret = set_filter(robot);
+    if (ret != ERR_SUCC)
+    {
+        printf("%-10s set filter failed: %d\n", name, ret);
+        return false;
+    }
+    robot.servo_move_enable(TRUE);
+
+    JointValue start, joint;
+    robot.get_joint_position(&start);
+
+    JointValue target = start;
+    target.jVal[0] += kStep;
+
+    unsigned int cycle_us = static_cast<unsigned int>(jaka_mock::GetConfig().cycle_us);
+    for (int k = 0; k < kSamples; k++)
+    {
+        robot.servo_j(&target, ABS, 1);
+        usleep(cycle_us);
+        robot.get_joint_position(&joint);
+        response[k] = joint.jVal[0] - start.jVal[0];
+    }
+
+    robot.servo_move_enable(FALSE);
+    robot.login_out();
+    return true;
+}
+
+errno_t UseNone(JAKAZuRobot &robot) { return robot.servo_move_use_none_filter(); }
+errno_t UseJointLPF(JAKAZuRobot &robot) { return robot.servo_move_use_joint_LPF(2); }
+errno_t UseJointNLF(JAKAZuRobot &robot) { return robot.servo_move_use_joint_NLF(30, 100, 500); }
+errno_t UseCarteNLF(JAKAZuRobot &robot) { return robot.servo_move_use_carte_NLF(200, 1000, 5000, 30, 100, 500); }
+errno_t UseJointMMF(JAKAZuRobot &robot) { return robot.servo_move_use_joint_MMF(8, 0.1, 0.1, 0.1); }
+
+int main()
+{
+    // 去掉通信延迟与抖动, 只比较滤波器本身
+    jaka_mock::Config config = jaka_mock::GetConfig();
+    config.latency_us = 0;
+    config.jitter_us = 0;
+    jaka_mock::SetConfig(config);
+
+    const char *names[5] = {"none", "joint_LPF", "joint_NLF", "carte_NLF", "joint_MMF"};
+    errno_t (*filters[5])(JAKAZuRobot &) = {UseNone, UseJointLPF, UseJointNLF, UseCarteNLF, UseJointMMF};
+    double response[5][kSamples];
+
+    bool pass = true;
+    for (int f = 0; f < 5; f++)
+    {
+        if (!StepResponse(names[f], filters[f], response[f]))
+        {
+            pass = false;
+            continue;
+        }
+
+        printf("%-10s", names[f]);
+        for (int k = 0; k < kSamples; k++)
+            printf(" %7.4f", response[f][k]);
+        printf("\n");
+    }
+
+    /*无滤波: 最后到位; 有滤波: 至少某一周期与无滤波相差 10% 以上*/
+    if (pass && fabs(response[0][kSamples - 1] - kStep) > 1e-6)
+    {
+        printf("none: not at the target\n");
+        pass = false;
+    }
+    for (int f = 1; pass && f < 5; f++)
+    {
+        double difference = 0;
+        for (int k = 0; k < kSamples; k++)
+            difference = fmax(difference, fabs(response[f][k] - response[0][k]));
+        if (difference < 0.1 * kStep)
+        {
+            printf("%s: same response as no filter\n", names[f]);
+            pass = false;
+        }
+    }
+
+    printf(pass ? "PASS\n" : "FAIL\n");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,479 @@
+#include "motion_queue.h"
+
+#include <cmath>
+#include <cstring>
+#include <time.h>
+#include <vector>
+
+const double MotionQueue::kPollPeriod = 0.008;
+const double MotionQueue::kStartTimeout = 0.2;
+const size_t MotionQueue::kHistorySize = 256;
+const size_t MotionQueue::kLookahead = 4;
+
+// 到位时与目标允许的偏差, 在 tol 之外另加
+static const double kLineReachTolerance = 1.0;    // mm
+static const double kJointReachTolerance = 0.01;  // rad
+
+static double MonotonicNow()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double Distance(MotionType type, const double *a, const double *b)
+{
+    double distance = 0;
+
+    if (type == MOTION_LINE)
+    {
+        for (int i = 0; i < 3; i++)
+            distance += (a[i] - b[i]) * (a[i] - b[i]);
+        return sqrt(distance);
+    }
+
+    for (int i = 0; i < 6; i++)
+        distance = fmax(distance, fabs(a[i] - b[i]));
+
+    return distance;
+}
+
+MotionWaypoint::MotionWaypoint()
+    : speed(0),
+      accel(0),
+      tol(0)
+{
+    memset(target, 0, sizeof(target));
+}
+
+MotionGoal::MotionGoal()
+    : type(MOTION_LINE)
+{
+}
+
+MotionFeedback::MotionFeedback()
+    : goal_id(0),
+      type(MOTION_LINE),
+      state(MOTION_PENDING),
+      progress(0),
+      waypoint(0),
+      error_code(0)
+{
+    memset(position, 0, sizeof(position));
+}
+
+MotionQueue::MotionQueue(JAKAZuRobot &robot, pthread_mutex_t &robot_mutex)
+    : robot_(robot),
+      robot_mutex_(robot_mutex),
+      running_(false),
+      next_id_(1),
+      active_id_(0),
+      abort_state_(MOTION_PENDING)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_mutex_init(&queue_mutex_, NULL);
+    pthread_cond_init(&queue_cond_, &attr);
+    pthread_cond_init(&done_cond_, NULL);
+    pthread_condattr_destroy(&attr);
+}
+
+MotionQueue::~MotionQueue()
+{
+    Stop();
+
+    pthread_cond_destroy(&done_cond_);
+    pthread_cond_destroy(&queue_cond_);
+    pthread_mutex_destroy(&queue_mutex_);
+}
+
+void MotionQueue::Start()
+{
+    pthread_mutex_lock(&queue_mutex_);
+
+    bool started = running_;
+    running_ = true;
+
+    pthread_mutex_unlock(&queue_mutex_);
+
+    if (!started)
+        pthread_create(&thread_, NULL, ThreadFunc, this);
+}
+
+void MotionQueue::Stop()
+{
+    pthread_mutex_lock(&queue_mutex_);
+
+    bool started = running_;
+    running_ = false;
+    pthread_cond_broadcast(&queue_cond_);
+
+    pthread_mutex_unlock(&queue_mutex_);
+
+    if (started)
+        pthread_join(thread_, NULL);
+
+    Cancel(0);
+}
+
+void MotionQueue::SetFeedbackCallback(const std::function<void(const MotionFeedback &)> &callback)
+{
+    pthread_mutex_lock(&queue_mutex_);
+    feedback_callback_ = callback;
+    pthread_mutex_unlock(&queue_mutex_);
+}
+
+void MotionQueue::Notify(const MotionFeedback &feedback)
+{
+    pthread_mutex_lock(&queue_mutex_);
+    std::function<void(const MotionFeedback &)> callback = feedback_callback_;
+    pthread_mutex_unlock(&queue_mutex_);
+
+    if (callback)
+        callback(feedback);
+}
+
+uint32_t MotionQueue::Submit(const MotionGoal &goal, bool preempt)
+{
+    std::vector<MotionFeedback> changed;
+
+    pthread_mutex_lock(&queue_mutex_);
+
+    uint32_t goal_id = next_id_++;
+
+    if (preempt)
+    {
+        for (size_t i = 0; i < pending_.size(); i++)
+        {
+            MotionFeedback &feedback = feedback_[pending_[i].first];
+            feedback.state = MOTION_PREEMPTED;
+            changed.push_back(feedback);
+        }
+        pending_.clear();
+
+        if (active_id_ != 0)
+            abort_state_ = MOTION_PREEMPTED;
+    }
+
+    MotionFeedback feedback;
+    feedback.goal_id = goal_id;
+    feedback.type = goal.type;
+    feedback_[goal_id] = feedback;
+    changed.push_back(feedback);
+    pending_.push_back(std::make_pair(goal_id, goal));
+
+    // 只清理已结束的目标
+    for (std::map<uint32_t, MotionFeedback>::iterator it = feedback_.begin(); it != feedback_.end() && feedback_.size() > kHistorySize;)
+    {
+        if (Final(it->second.state))
+            feedback_.erase(it++);
+        else
+            ++it;
+    }
+
+    pthread_cond_broadcast(&queue_cond_);
+    pthread_cond_broadcast(&done_cond_);
+
+    pthread_mutex_unlock(&queue_mutex_);
+
+    for (size_t i = 0; i < changed.size(); i++)
+        Notify(changed[i]);
+
+    return goal_id;
+}
+
+bool MotionQueue::Cancel(uint32_t goal_id)
+{
+    std::vector<MotionFeedback> changed;
+    bool found = false;
+
+    pthread_mutex_lock(&queue_mutex_);
+
+    for (std::deque<std::pair<uint32_t, MotionGoal> >::iterator it = pending_.begin(); it != pending_.end();)
+    {
+        if (goal_id == 0 || it->first == goal_id)
+        {
+            MotionFeedback &feedback = feedback_[it->first];
+            feedback.state = MOTION_CANCELED;
+            changed.push_back(feedback);
+            it = pending_.erase(it);
+            found = true;
+        }
+        else
+            ++it;
+    }
+
+    if (active_id_ != 0 && (goal_id == 0 || goal_id == active_id_))
+    {
+        abort_state_ = MOTION_CANCELED;
+        found = true;
+    }
+
+    pthread_cond_broadcast(&queue_cond_);
+    pthread_cond_broadcast(&done_cond_);
+
+    pthread_mutex_unlock(&queue_mutex_);
+
+    for (size_t i = 0; i < changed.size(); i++)
+        Notify(changed[i]);
+
+    return found || goal_id == 0;
+}
+
+bool MotionQueue::Wait(uint32_t goal_id, MotionFeedback &result)
+{
+    bool known = true;
+
+    pthread_mutex_lock(&queue_mutex_);
+
+    while (true)
+    {
+        std::map<uint32_t, MotionFeedback>::iterator it = feedback_.find(goal_id);
+        if (it == feedback_.end())
+        {
+            known = false;
+            break;
+        }
+        if (Final(it->second.state))
+        {
+            result = it->second;
+            break;
+        }
+        pthread_cond_wait(&done_cond_, &queue_mutex_);
+    }
+
+    pthread_mutex_unlock(&queue_mutex_);
+
+    return known;
+}
+
+bool MotionQueue::GetFeedback(uint32_t goal_id, MotionFeedback &feedback)
+{
+    pthread_mutex_lock(&queue_mutex_);
+
+    std::map<uint32_t, MotionFeedback>::iterator it = feedback_.find(goal_id);
+    bool known = it != feedback_.end();
+    if (known)
+        feedback = it->second;
+
+    pthread_mutex_unlock(&queue_mutex_);
+
+    return known;
+}
+
+void *MotionQueue::ThreadFunc(void *args)
+{
+    ((MotionQueue *)args)->Run();
+
+    return NULL;
+}
+
+void MotionQueue::Run()
+{
+    pthread_mutex_lock(&queue_mutex_);
+
+    while (running_)
+    {
+        if (pending_.empty())
+        {
+            pthread_cond_wait(&queue_cond_, &queue_mutex_);
+            continue;
+        }
+
+        uint32_t goal_id = pending_.front().first;
+        MotionGoal goal = pending_.front().second;
+        pending_.pop_front();
+
+        active_id_ = goal_id;
+        abort_state_ = MOTION_PENDING;
+
+        MotionFeedback feedback = feedback_[goal_id];
+        feedback.state = MOTION_ACTIVE;
+        feedback_[goal_id] = feedback;
+
+        pthread_mutex_unlock(&queue_mutex_);
+
+        Notify(feedback);
+        feedback.state = static_cast<MotionState>(Execute(goal, feedback));
+
+        pthread_mutex_lock(&queue_mutex_);
+
+        feedback_[goal_id] = feedback;
+        active_id_ = 0;
+        pthread_cond_broadcast(&done_cond_);
+
+        pthread_mutex_unlock(&queue_mutex_);
+
+        Notify(feedback);
+
+        pthread_mutex_lock(&queue_mutex_);
+    }
+
+    pthread_mutex_unlock(&queue_mutex_);
+}
+
+int MotionQueue::Send(MotionType type, const MotionWaypoint &waypoint)
+{
+    OptionalCond *p = nullptr;
+    int sdk_res;
+
+    pthread_mutex_lock(&robot_mutex_);
+
+    if (type == MOTION_LINE)
+    {
+        CartesianPose cart;
+        memcpy(&(cart.tran.x), waypoint.target, 6 * 8);
+        sdk_res = robot_.linear_move(&cart, MoveMode::ABS, FALSE, waypoint.speed, waypoint.accel, waypoint.tol, p);
+    }
+    else
+    {
+        JointValue joint_pose;
+        memcpy(joint_pose.jVal, waypoint.target, 6 * 8);
+        sdk_res = robot_.joint_move(&joint_pose, MoveMode::ABS, FALSE, waypoint.speed, waypoint.accel, waypoint.tol, p);
+    }
+
+    pthread_mutex_unlock(&robot_mutex_);
+
+    return sdk_res;
+}
+
+/**
+ * @brief 下发一个目标并轮询到位, 返回结束状态
+ *        路点逐个非阻塞下发, 控制器中始终保持 kLookahead 个未走完的路点;
+ *        进入路点 tol 范围即视为经过, 控制器停下 (inpos) 时已下发的路点全部视为经过
+ */
+int MotionQueue::Execute(const MotionGoal &goal, MotionFeedback &feedback)
+{
+    const std::vector<MotionWaypoint> &waypoints = goal.waypoints;
+    const size_t count = waypoints.size();
+    double reach = goal.type == MOTION_LINE ? kLineReachTolerance : kJointReachTolerance;
+
+    if (count == 0)
+    {
+        feedback.error_code = ERR_INVALID_PARAMETER;
+        return MOTION_ABORTED;
+    }
+
+    // lengths[i]: 路点 i-1 到路点 i 的距离, lengths[0] 在第一次轮询时由起点确定
+    std::vector<double> lengths(count, 0);
+    for (size_t i = 1; i < count; i++)
+        lengths[i] = Distance(goal.type, waypoints[i - 1].target, waypoints[i].target);
+
+    double start = MonotonicNow();
+    double path_length = -1;
+    bool seen_motion = false;
+    size_t issued = 0;
+    size_t passed = 0;
+    long poll_ns = static_cast<long>(kPollPeriod * 1e9);
+    int sdk_res;
+
+    while (true)
+    {
+        for (; issued < count && issued < passed + kLookahead; issued++)
+        {
+            sdk_res = Send(goal.type, waypoints[issued]);
+            if (sdk_res != 0)
+            {
+                if (issued > 0)
+                {
+                    pthread_mutex_lock(&robot_mutex_);
+                    robot_.motion_abort();
+                    pthread_mutex_unlock(&robot_mutex_);
+                }
+                feedback.error_code = sdk_res;
+                return MOTION_ABORTED;
+            }
+            start = MonotonicNow();
+        }
+
+        timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += poll_ns;
+        if (deadline.tv_nsec >= 1000000000)
+        {
+            deadline.tv_nsec -= 1000000000;
+            deadline.tv_sec++;
+        }
+
+        pthread_mutex_lock(&queue_mutex_);
+
+        if (abort_state_ == MOTION_PENDING && running_)
+            pthread_cond_timedwait(&queue_cond_, &queue_mutex_, &deadline);
+        MotionState abort_state = running_ ? abort_state_ : MOTION_CANCELED;
+
+        pthread_mutex_unlock(&queue_mutex_);
+
+        if (abort_state != MOTION_PENDING)
+        {
+            pthread_mutex_lock(&robot_mutex_);
+            robot_.motion_abort();
+            pthread_mutex_unlock(&robot_mutex_);
+
+            return abort_state;
+        }
+
+        RobotStatus status;
+
+        pthread_mutex_lock(&robot_mutex_);
+        sdk_res = robot_.get_robot_status(&status);
+        pthread_mutex_unlock(&robot_mutex_);
+
+        if (sdk_res != 0 || status.errcode != 0)
+        {
+            feedback.error_code = sdk_res != 0 ? sdk_res : ERR_MOTION_ABNORMAL;
+            return MOTION_ABORTED;
+        }
+
+        if (goal.type == MOTION_LINE)
+            memcpy(feedback.position, status.cartesiantran_position, 6 * 8);
+        else
+            memcpy(feedback.position, status.joint_position, 6 * 8);
+
+        if (path_length < 0)
+        {
+            lengths[0] = Distance(goal.type, feedback.position, waypoints[0].target);
+            path_length = 0;
+            for (size_t i = 0; i < count; i++)
+                path_length += lengths[i];
+        }
+
+        while (passed + 1 < issued && Distance(goal.type, feedback.position, waypoints[passed].target) <= waypoints[passed].tol + reach)
+            passed++;
+
+        if (!status.inpos)
+            seen_motion = true;
+        else if (seen_motion || MonotonicNow() - start >= kStartTimeout)
+        {
+            // 控制器已停下, 已下发的路点都已走完
+            passed = issued - 1;
+            seen_motion = false;
+
+            if (issued == count)
+            {
+                feedback.waypoint = passed;
+                if (Distance(goal.type, feedback.position, waypoints[passed].target) <= waypoints[passed].tol + reach)
+                {
+                    feedback.progress = 1.0;
+                    return MOTION_SUCCEEDED;
+                }
+
+                feedback.error_code = ERR_MOTION_ABNORMAL;
+                return MOTION_ABORTED;
+            }
+
+            passed++;
+        }
+
+        double remaining = Distance(goal.type, feedback.position, waypoints[passed].target);
+        for (size_t i = passed + 1; i < count; i++)
+            remaining += lengths[i];
+
+        feedback.waypoint = passed;
+        feedback.progress = path_length > 0 ? fmin(1.0, fmax(0.0, 1 - remaining / path_length)) : 1.0;
+
+        Notify(feedback);
+    }
+}
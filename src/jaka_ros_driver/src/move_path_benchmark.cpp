@@ -0,0 +1,125 @@
+#include <cstdio>
+#include <cstdlib>
+#include <pthread.h>
+#include <time.h>
+#include "JAKAZuRobot.h"
+#include "jaka_mock.h"
+#include "motion_queue.h"
+
+/**
+ * move_path 在 jaka_mock_robot 上的耗时对比, 同一组直线路点 (默认 5 个, 共 80 mm 的接近, 100 mm/s):
+ *   1. 每个路点一次阻塞的 move_line: 逐个 Submit 单路点目标并 Wait, 同 movel_callback 的 is_block
+ *   2. 一次 move_path, mvradii = 0: 路点提前下发, 控制器在每个路点停下
+ *   3. 一次 move_path, mvradii = blend: 控制器在路点间过渡而不停顿
+ * 用法: move_path_benchmark [waypoints] [length_mm] [speed_mm_s] [blend_mm], 不需要机器人与 ROS
+ * 不含 ROS 服务往返, 所以 1 与 2 的差别只来自运动队列; 2 与 3 的差别来自过渡
+ */
+
+const double kAccel = 500; // mm/s^2, 同 linear_move 的默认值
+
+double Now()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* 从 start 沿 -z 等分 length 的 n 个路点 */
+MotionGoal Approach(const CartesianPose &start, int n, double length, double speed, double tol)
+{
+    MotionGoal goal;
+    goal.type = MOTION_LINE;
+
+    for (int k = 1; k <= n; k++)
+    {
+        MotionWaypoint waypoint;
+        waypoint.target[0] = start.tran.x;
+        waypoint.target[1] = start.tran.y;
+        waypoint.target[2] = start.tran.z - length * k / n;
+        waypoint.target[3] = start.rpy.rx;
+        waypoint.target[4] = start.rpy.ry;
+        waypoint.target[5] = start.rpy.rz;
+        waypoint.speed = speed;
+        waypoint.accel = kAccel;
+        waypoint.tol = tol;
+        goal.waypoints.push_back(waypoint);
+    }
+
+    return goal;
+}
+
+/* 回到起点 (不计时) */
+bool Return(MotionQueue &queue, const CartesianPose &start, double speed)
+{
+    MotionGoal goal = Approach(start, 1, 0, speed, 0);
+    MotionFeedback result;
+
+    return queue.Wait(queue.Submit(goal, false), result) && result.state == MOTION_SUCCEEDED;
+}
+
+/* 执行并计时, 失败时返回负数 */
+double Run(MotionQueue &queue, const MotionGoal &path, bool per_point)
+{
+    double start = Now();
+    MotionFeedback result;
+
+    if (per_point)
+    {
+        for (size_t k = 0; k < path.waypoints.size(); k++)
+        {
+            MotionGoal point;
+            point.type = path.type;
+            point.waypoints.push_back(path.waypoints[k]);
+            if (!queue.Wait(queue.Submit(point, false), result) || result.state != MOTION_SUCCEEDED)
+                return -1;
+        }
+    }
+    else if (!queue.Wait(queue.Submit(path, false), result) || result.state != MOTION_SUCCEEDED)
+    {
+        return -1;
+    }
+
+    return Now() - start;
+}
+
+int main(int argc, char **argv)
+{
+    int waypoints = argc > 1 ? atoi(argv[1]) : 5;
+    double length = argc > 2 ? atof(argv[2]) : 80;
+    double speed = argc > 3 ? atof(argv[3]) : 100;
+    double blend = argc > 4 ? atof(argv[4]) : 5;
+
+    JAKAZuRobot robot;
+    pthread_mutex_t robot_mutex;
+    pthread_mutex_init(&robot_mutex, NULL);
+    robot.login_in("mock");
+    robot.power_on();
+    robot.enable_robot();
+
+    CartesianPose start;
+    robot.get_tcp_position(&start);
+
+    MotionQueue queue(robot, robot_mutex);
+    queue.Start();
+
+    const char *names[3] = {"move_line per point", "move_path, no blend", "move_path, blend"};
+    double seconds[3];
+    bool pass = true;
+    for (int m = 0; m < 3; m++)
+    {
+        MotionGoal path = Approach(start, waypoints, length, speed, m == 2 ? blend : 0);
+        seconds[m] = Run(queue, path, m == 0);
+        pass = pass && seconds[m] > 0 && Return(queue, start, speed);
+        printf("%-22s %6.3f s\n", names[m], seconds[m]);
+    }
+
+    queue.Stop();
+    robot.login_out();
+
+    /*过渡须快于在每个路点停下*/
+    pass = pass && seconds[2] < seconds[1];
+    printf("%d waypoints, %.0f mm, %.0f mm/s, %.0f mm/s^2, blend %.1f mm\n", waypoints, length, speed, kAccel, blend);
+    printf(pass ? "PASS\n" : "FAIL\n");
+    return pass ? 0 : 1;
+}
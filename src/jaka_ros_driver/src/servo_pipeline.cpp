@@ -0,0 +1,283 @@
+#include "servo_pipeline.h"
+
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+#include "Eigen/Core"
+#include "Eigen/Geometry"
+
+using namespace Eigen;
+
+const double ServoPipeline::kCycleTime = 0.008;
+const double ServoPipeline::kMaxInterpTime = 2.0;
+
+ServoConfig::ServoConfig()
+    : mode(SERVO_PIPELINE_JOINT),
+      filter(SERVO_FILTER_JOINT_LPF),
+      filter_param_num(1),
+      interp_time(0.1)
+{
+    memset(filter_params, 0, sizeof(filter_params));
+    filter_params[0] = 4; // 与原先 servo_move_use_joint_LPF(4) 一致
+}
+
+static int FilterParamNum(ServoFilterType filter)
+{
+    switch (filter)
+    {
+    case SERVO_FILTER_NONE:
+        return 0;
+    case SERVO_FILTER_JOINT_LPF:
+        return 1;
+    case SERVO_FILTER_JOINT_NLF:
+        return 3;
+    case SERVO_FILTER_CARTE_NLF:
+        return 6;
+    case SERVO_FILTER_JOINT_MMF:
+        return 4;
+    }
+    return -1;
+}
+
+/* R = Rz(rz) * Ry(ry) * Rx(rx), 与控制器 rpy 定义一致 */
+static Quaterniond RpyToQuaternion(double rx, double ry, double rz)
+{
+    return Quaterniond(AngleAxisd(rz, Vector3d::UnitZ()) *
+                       AngleAxisd(ry, Vector3d::UnitY()) *
+                       AngleAxisd(rx, Vector3d::UnitX()));
+}
+
+static void QuaternionToRpy(const Quaterniond &q, Rpy &rpy)
+{
+    Matrix3d r = q.toRotationMatrix();
+    Vector3d n = r.col(0);
+    Vector3d o = r.col(1);
+    Vector3d a = r.col(2);
+
+    rpy.rz = atan2(n(1), n(0));
+    rpy.ry = atan2(-n(2), n(0) * cos(rpy.rz) + n(1) * sin(rpy.rz));
+    rpy.rx = atan2(a(0) * sin(rpy.rz) - a(1) * cos(rpy.rz), -o(0) * sin(rpy.rz) + o(1) * cos(rpy.rz));
+}
+
+ServoPipeline::ServoPipeline(JAKAZuRobot &robot, pthread_mutex_t &robot_mutex)
+    : robot_(robot),
+      robot_mutex_(robot_mutex),
+      enabled_(false),
+      count_(0),
+      next_(0)
+{
+    pthread_mutex_init(&config_mutex_, NULL);
+
+    size_t max_points = static_cast<size_t>(round(kMaxInterpTime / kCycleTime));
+    joint_series_.resize(max_points);
+    pose_series_.resize(max_points);
+    memset(&last_joint_, 0, sizeof(last_joint_));
+    memset(&last_pose_, 0, sizeof(last_pose_));
+}
+
+ServoPipeline::~ServoPipeline()
+{
+    pthread_mutex_destroy(&config_mutex_);
+}
+
+bool ServoPipeline::SetConfig(const ServoConfig &config, std::string &error)
+{
+    std::ostringstream ss;
+    int param_num = FilterParamNum(config.filter);
+
+    if (config.mode != SERVO_PIPELINE_JOINT && config.mode != SERVO_PIPELINE_CARTESIAN)
+        ss << "unknown servo pipeline " << config.mode;
+    else if (param_num < 0)
+        ss << "unknown servo filter " << config.filter;
+    else if (config.filter_param_num != param_num)
+        ss << "servo filter " << config.filter << " expects " << param_num << " parameters, got " << config.filter_param_num;
+    else if (config.interp_time < 0 || config.interp_time > kMaxInterpTime)
+        ss << "interp_time must be within [0, " << kMaxInterpTime << "] s";
+    else
+    {
+        for (int i = 0; i < param_num; i++)
+        {
+            if (config.filter_params[i] <= 0)
+            {
+                ss << "servo filter parameter " << i << " must be positive";
+                break;
+            }
+        }
+    }
+
+    error = ss.str();
+    if (!error.empty())
+        return false;
+
+    pthread_mutex_lock(&config_mutex_);
+    pending_ = config;
+    pthread_mutex_unlock(&config_mutex_);
+
+    return true;
+}
+
+ServoConfig ServoPipeline::GetConfig()
+{
+    pthread_mutex_lock(&config_mutex_);
+    ServoConfig config = pending_;
+    pthread_mutex_unlock(&config_mutex_);
+
+    return config;
+}
+
+int ServoPipeline::ApplyFilter(const ServoConfig &config)
+{
+    const double *p = config.filter_params;
+
+    switch (config.filter)
+    {
+    case SERVO_FILTER_JOINT_LPF:
+        return robot_.servo_move_use_joint_LPF(p[0]);
+    case SERVO_FILTER_JOINT_NLF:
+        return robot_.servo_move_use_joint_NLF(p[0], p[1], p[2]);
+    case SERVO_FILTER_CARTE_NLF:
+        return robot_.servo_move_use_carte_NLF(p[0], p[1], p[2], p[3], p[4], p[5]);
+    case SERVO_FILTER_JOINT_MMF:
+        return robot_.servo_move_use_joint_MMF(static_cast<int>(p[0]), p[1], p[2], p[3]);
+    default:
+        return robot_.servo_move_use_none_filter();
+    }
+}
+
+int ServoPipeline::Enable()
+{
+    session_ = GetConfig();
+    count_ = 0;
+    next_ = 0;
+
+    pthread_mutex_lock(&robot_mutex_);
+
+    int sdk_res = ApplyFilter(session_); // filter must be chosen before servo mode is entered
+    if (sdk_res == 0)
+        sdk_res = robot_.servo_move_enable(true);
+
+    pthread_mutex_unlock(&robot_mutex_);
+
+    enabled_ = (sdk_res == 0);
+
+    return sdk_res;
+}
+
+int ServoPipeline::Disable()
+{
+    enabled_ = false;
+    count_ = 0;
+    next_ = 0;
+
+    pthread_mutex_lock(&robot_mutex_);
+
+    int sdk_res = robot_.servo_move_enable(false);
+
+    pthread_mutex_unlock(&robot_mutex_);
+
+    return sdk_res;
+}
+
+int ServoPipeline::PointNum() const
+{
+    int num = static_cast<int>(round(session_.interp_time / kCycleTime));
+
+    return num < 1 ? 1 : num;
+}
+
+int ServoPipeline::SetTarget(const double target_pose[6], const double current_joint[6], const double current_tcp[6])
+{
+    int num = PointNum();
+
+    count_ = 0;
+    next_ = 0;
+
+    if (session_.mode == SERVO_PIPELINE_CARTESIAN)
+    {
+        Vector3d p0(current_tcp[0], current_tcp[1], current_tcp[2]);
+        Vector3d p1(target_pose[0], target_pose[1], target_pose[2]);
+        Quaterniond q0 = RpyToQuaternion(current_tcp[3], current_tcp[4], current_tcp[5]);
+        Quaterniond q1 = RpyToQuaternion(target_pose[3], target_pose[4], target_pose[5]);
+
+        for (int t = 1; t <= num; t++)
+        {
+            double s = static_cast<double>(t) / num;
+            Vector3d p = (p0 + s * (p1 - p0)) * 1000;
+            CartesianPose &pose = pose_series_[t - 1];
+
+            pose.tran.x = p(0);
+            pose.tran.y = p(1);
+            pose.tran.z = p(2);
+            if (t == num)
+            {
+                pose.rpy.rx = target_pose[3];
+                pose.rpy.ry = target_pose[4];
+                pose.rpy.rz = target_pose[5];
+            }
+            else
+                QuaternionToRpy(q0.slerp(s, q1), pose.rpy);
+        }
+    }
+    else
+    {
+        JointValue ref_joint;
+        JointValue target_joint;
+        CartesianPose target_cart;
+
+        memcpy(ref_joint.jVal, current_joint, 6 * 8);
+        target_cart.tran.x = target_pose[0] * 1000;
+        target_cart.tran.y = target_pose[1] * 1000;
+        target_cart.tran.z = target_pose[2] * 1000;
+        target_cart.rpy.rx = target_pose[3];
+        target_cart.rpy.ry = target_pose[4];
+        target_cart.rpy.rz = target_pose[5];
+
+        pthread_mutex_lock(&robot_mutex_);
+
+        int sdk_res = robot_.kine_inverse(&ref_joint, &target_cart, &target_joint);
+
+        pthread_mutex_unlock(&robot_mutex_);
+
+        if (sdk_res != 0)
+            return sdk_res;
+
+        // 均分规划, 同 Average_Series
+        for (int t = 1; t <= num; t++)
+        {
+            for (int i = 0; i < 6; i++)
+                joint_series_[t - 1].jVal[i] = current_joint[i] + (target_joint.jVal[i] - current_joint[i]) * t / num;
+        }
+    }
+
+    count_ = num;
+
+    return 0;
+}
+
+int ServoPipeline::Step()
+{
+    if (!HasPending())
+        return 0;
+
+    int sdk_res;
+
+    pthread_mutex_lock(&robot_mutex_);
+
+    if (session_.mode == SERVO_PIPELINE_CARTESIAN)
+    {
+        last_pose_ = pose_series_[next_];
+        sdk_res = robot_.servo_p(&last_pose_, ABS, 1);
+    }
+    else
+    {
+        last_joint_ = joint_series_[next_];
+        sdk_res = robot_.servo_j(&last_joint_, ABS, 1);
+    }
+
+    pthread_mutex_unlock(&robot_mutex_);
+
+    next_++;
+
+    return sdk_res;
+}
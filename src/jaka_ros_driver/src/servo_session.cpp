@@ -0,0 +1,177 @@
+#include "servo_session.h"
+
+#include <cstring>
+#include <unistd.h>
+
+#include "ros/callback_queue.h"
+
+const double ServoSession::kSettleTime = 1.0;
+
+ServoSession::ServoSession(JAKAZuRobot &robot, pthread_mutex_t &robot_mutex, ServoPipeline &pipeline)
+    : robot_(robot),
+      robot_mutex_(robot_mutex),
+      pipeline_(pipeline),
+      open_(false),
+      running_(true),
+      pose_change_(false),
+      step_traced_(true)
+{
+    pthread_mutex_init(&state_mutex_, NULL);
+
+    memset(current_joint_, 0, sizeof(current_joint_));
+    memset(current_tcp_, 0, sizeof(current_tcp_));
+    memset(expected_pose_, 0, sizeof(expected_pose_));
+}
+
+ServoSession::~ServoSession()
+{
+    pthread_mutex_destroy(&state_mutex_);
+}
+
+void ServoSession::SetTraceCallback(const std::function<void(Stage, const ros::Time &)> &callback)
+{
+    trace_callback_ = callback;
+}
+
+void ServoSession::Trace(Stage stage, const ros::Time &stamp)
+{
+    if (trace_callback_)
+        trace_callback_(stage, stamp);
+}
+
+void ServoSession::Accept(const robot_msgs::ServoL::ConstPtr &msg)
+{
+    for (int i = 0; i < 6; i++)
+        expected_pose_[i] = msg->pose[i];
+    expected_stamp_ = msg->header.stamp;
+
+    if (msg->servo_mode)
+        pose_change_ = true;
+
+    if (!open_ && msg->servo_mode)
+    {
+        int sdk_res = Open();
+        if (sdk_res != 0)
+        {
+            pose_change_ = false;
+            ROS_ERROR("servo enable failed: %d", sdk_res);
+        }
+    }
+    else if (open_ && !msg->servo_mode)
+    {
+        int sdk_res = Close();
+        ROS_INFO("Servo disable! %d", sdk_res);
+        usleep(static_cast<useconds_t>(kSettleTime * 1e6));
+    }
+
+    ROS_DEBUG("expected pose: %f %f %f %f %f %f", expected_pose_[0], expected_pose_[1], expected_pose_[2],
+              expected_pose_[3], expected_pose_[4], expected_pose_[5]);
+    Trace(STAGE_ACCEPTED, expected_stamp_);
+}
+
+int ServoSession::Open()
+{
+    int sdk_res = pipeline_.Enable();
+    if (sdk_res != 0)
+    {
+        // 滤波器只能在伺服模式外设置
+        ROS_WARN("servo enable error: %d, leave servo mode and retry", sdk_res);
+        pipeline_.Disable();
+        sdk_res = pipeline_.Enable();
+    }
+    if (sdk_res != 0)
+        return sdk_res;
+
+    ROS_INFO("Servo enable! pipeline:%d filter:%d", pipeline_.SessionConfig().mode, pipeline_.SessionConfig().filter);
+    usleep(static_cast<useconds_t>(kSettleTime * 1e6));
+
+    open_ = true;
+    return 0;
+}
+
+int ServoSession::Close()
+{
+    Hold();
+    return pipeline_.Disable();
+}
+
+bool ServoSession::PollState(RobotStatus &status)
+{
+    pthread_mutex_lock(&robot_mutex_);
+    robot_.get_robot_status(&status);
+    pthread_mutex_unlock(&robot_mutex_);
+
+    if (!status.is_socket_connect)
+        return false;
+
+    pthread_mutex_lock(&state_mutex_);
+    for (int i = 0; i < 6; i++)
+    {
+        current_joint_[i] = status.joint_position[i];
+        current_tcp_[i] = i < 3 ? status.cartesiantran_position[i] / 1000 : status.cartesiantran_position[i];
+    }
+    pthread_mutex_unlock(&state_mutex_);
+
+    return true;
+}
+
+void ServoSession::Run(const ros::NodeHandle &n, const std::string &topic)
+{
+    ros::NodeHandle n_servo(n);
+    ros::CallbackQueue servo_queue;
+    n_servo.setCallbackQueue(&servo_queue);
+
+    ros::Subscriber servo_move_sub = n_servo.subscribe(topic, 1, &ServoSession::Accept, this);
+
+    while (running_ && ros::ok())
+    {
+        // 插补点未下发完时不阻塞等待新的期望位姿
+        servo_queue.callOne(pipeline_.HasPending() ? ros::WallDuration(0) : ros::WallDuration(0.1));
+
+        if (!open_ || !pipeline_.IsEnabled())
+            continue;
+
+        if (pose_change_)
+        {
+            pose_change_ = false;
+
+            double joint[6], tcp[6];
+            pthread_mutex_lock(&state_mutex_);
+            memcpy(joint, current_joint_, sizeof(joint));
+            memcpy(tcp, current_tcp_, sizeof(tcp));
+            pthread_mutex_unlock(&state_mutex_);
+
+            int ik_res = pipeline_.SetTarget(expected_pose_, joint, tcp);
+            if (ik_res != 0)
+            {
+                ROS_WARN("servo error: %d", ik_res);
+                continue;
+            }
+            Trace(STAGE_TARGET, expected_stamp_);
+            step_traced_ = false;
+        }
+
+        if (!pipeline_.HasPending())
+            continue;
+
+        int sdk_res = pipeline_.Step();
+        if (!step_traced_)
+        {
+            Trace(STAGE_STEP, expected_stamp_);
+            step_traced_ = true;
+        }
+
+        if (sdk_res != 0)
+        {
+            ROS_ERROR("servo error: %d", sdk_res);
+            pthread_mutex_lock(&robot_mutex_);
+            int abort_res = robot_.motion_abort();
+            pthread_mutex_unlock(&robot_mutex_);
+            if (abort_res != 0)
+                ROS_ERROR("stop error: %d", abort_res);
+        }
+
+        if (!pipeline_.HasPending())
+            usleep(8 * 1000);
+    }
+}
@@ -10,6 +10,8 @@ class LPFilter
 public:
   LPFilter(double deltaT, double cutoffFrequency, int numElements);
   bool update(std::vector<double> input, std::vector<double>& output);
+  // numElements values each, input and output may alias. Does not allocate.
+  bool update(const double* input, double* output);
 
 private:
   bool initialized;
@@ -3,7 +3,7 @@
 
 #include "ros/ros.h"
 #include "std_msgs/String.h"
-#include "tf/transform_listener.h"
+#include "diagnostic_msgs/DiagnosticArray.h"
 #include "geometry_msgs/WrenchStamped.h"
 #include "netft_utils/SetBias.h"
 #include "netft_utils/SetMax.h"
@@ -12,7 +12,12 @@
 #include "netft_utils/SetFilter.h"
 #include "netft_utils/GetDouble.h"
 #include "netft_utils/Cancel.h"
+#include "robot_msgs/MotionAbort.h"
 #include "lpfilter.h"
+#include "wrench_compensation.h"
+#include "wrench_pipeline.h"
+#include "transform_monitor.h"
+#include "safety_monitor.h"
 #include <math.h>
 
 /**
@@ -40,9 +45,9 @@ private:
   double cutoffFrequency;
   bool newFilter;
 
-  // Transform listener
-  tf::TransformListener* listener;
-  tf::StampedTransform ft_to_world;                // Transform from ft frame to world frame
+  // Rotation from ft frame to world frame, kept up to date by the monitor's tf or joint state source
+  TransformMonitor monitor;
+  double ft_to_world_rotation[9];                  // Rotation at the time of the last sample, row-major
   std::string world_frame;
   std::string ft_frame;
  
@@ -56,20 +61,16 @@ private:
   geometry_msgs::WrenchStamped zero_wrench;        // Wrench of all zeros for convenience
   geometry_msgs::WrenchStamped threshold;          // Wrench containing thresholds
   
-  double payloadWeight;				   // Used in gravity compensation
-  double payloadLeverArm;			   // Used in gravity compensation. The z-coordinate to payload CoM (in sensor's raw frame)
+  WrenchCompensation payload;                      // Payload gravity, 3-D CoM and sensor offset used in gravity compensation
+  WrenchPipeline pipeline;                         // Per-sample offset, transform and threshold, rotation cached per TF update
   
   bool isBiased;                                   // True if sensor is biased
-  bool isNewBias;                                  // True if sensor was biased this pass
   bool isNewGravityBias;			   // True if gravity compensation was applied this pass
   bool isGravityBiased;				   // True if gravity is compensated
   
   // Variables used to monitor FT violation and send a cancel move message
-  netft_utils::Cancel cancel_msg;
-  static const int MAX_CANCEL = 5;                 // Number of times to send cancel message when max force is exceeded
-  static const int MAX_WAIT = 100;                 // Number of cycles to wait after cancel message before sending again
-  int cancel_count;                                // Counter for times to send cancel message when max force is exceeded
-  int cancel_wait;                                 // Counter of cycles to wait after cancel message before sending again
+  netft_utils::Cancel cancel_msg;                  // toCancel while the safety monitor is tripped
+  SafetyMonitor safety;                            // Limits checked on every sample in netftCallback
   double forceMaxB;                                // Default max force limit to send cancel when FT is biased
   double torqueMaxB;                               // Default max torque limit to send cancel when FT is biased
   double forceMaxU;                                // Default max force limit to send cancel when FT is unbiased
@@ -83,6 +84,9 @@ private:
   ros::Publisher netft_world_data_pub;
   ros::Publisher netft_tool_data_pub;
   ros::Publisher netft_cancel_pub;
+  ros::Publisher motion_abort_pub;                 // Straight to the robot driver on a trip, see robot_msgs/MotionAbort
+  ros::Publisher diag_pub;
+  ros::Time last_diag_pub_time;
   
   ////////////////
   // ROS services
@@ -107,10 +111,10 @@ private:
   // Run this method when the sensor is stationary to avoid inertial effects.
   bool fixedOrientationBias(netft_utils::SetBias::Request &req, netft_utils::SetBias::Response &res);
   
-  // Set the readings from the sensor to zero at this instant.
-  // Calculate the payload's mass and center of mass so gravity can be compensated for, even as the sensor changes orientation.
-  // It's assumed that the payload's center of mass is located on the sensor's central access.
-  // Run this method when the sensor is stationary to avoid inertial effects.
+  // Compensate for the payload's gravity and the sensor offset, even as the sensor changes orientation.
+  // Uses the calibration loaded from the "payload" parameters (config/payload_calibration.yaml) if present.
+  // Otherwise the payload's weight and lever arm are measured at this instant, assuming the payload's
+  // center of mass is located on the sensor's central axis; run it while stationary to avoid inertial effects.
   // It assumes the Z-axis of the World tf frame is up.
   bool compensateForGravity(netft_utils::SetBias::Request &req, netft_utils::SetBias::Response &res);
   
@@ -122,9 +126,10 @@ private:
 
   // Convenience methods
   void copyWrench(geometry_msgs::WrenchStamped &in, geometry_msgs::WrenchStamped &out, geometry_msgs::WrenchStamped &bias);
-  void applyThreshold(double &value, double thresh);
-  void transformFrame(geometry_msgs::WrenchStamped in_data, geometry_msgs::WrenchStamped &out_data, char target_frame);
-  void checkMaxForce();
+  void setWrench(const double data[6], const ros::Time &stamp, const std::string &frame, geometry_msgs::WrenchStamped &out);
+  // Magnitude limits of the safety monitor, the biased ones once the sensor is biased
+  void updateLimits();
+  void safetyEvent(SafetyMonitor::Event event, const ros::Time &stamp, const double wrench[6]);
 };
 
 #endif
\ No newline at end of file
@@ -3,10 +3,15 @@
 
 #include "ros/ros.h"
 #include "std_msgs/String.h"
-#include "tf/transform_listener.h"
+#include "tf/transform_datatypes.h"
+#include "diagnostic_msgs/DiagnosticArray.h"
 #include "geometry_msgs/WrenchStamped.h"
 #include "netft_utils/Cancel.h"
+#include "robot_msgs/MotionAbort.h"
 #include "lpfilter.h"
+#include "wrench_compensation.h"
+#include "transform_monitor.h"
+#include "safety_monitor.h"
 #include <math.h>
 #include "netft_rdt_driver.h"
 #include <memory>
@@ -29,7 +34,16 @@ public:
 
   // Access methods
   bool biasSensor(bool toBias);
+  // Compensate for the payload's gravity and the sensor offset with the calibration in the "payload"
+  // parameters (config/payload_calibration.yaml), as the sensor changes orientation. Replaces the bias while on.
+  bool compensateForGravity(bool toCompensate);
+  // Take the sensor rotation from joint states and the MDH table instead of tf, see transform_monitor.h
+  bool setJointStateSource(const std::string &topic, const std::vector<double> &mdh, const std::vector<double> &sensorRpy);
   bool setMax(double fMaxU, double tMaxU, double fMaxB, double tMaxB);
+  // Per axis limits (0 disables one) and hysteresis of the safety monitor, see safety_monitor.h
+  void setSafetyLimits(const double axisLimits[6], double releaseRatio, int tripSamples, int releaseSamples);
+  // Send robot_msgs/MotionAbort on this topic when the safety monitor trips, e.g. "/robot_driver/motion_abort"
+  void setMotionAbortTopic(const std::string &topic);
   bool setThreshold(double fThresh, double tThresh);
   bool setFilter(bool toFilter, double deltaT, double cutoffFreq);
   bool isReady();
@@ -65,9 +79,10 @@ private:
   bool newFilter;
   bool lpExists;
 
-  // Transform listener
-  tf::TransformListener* listener;
-  tf::StampedTransform ft_to_world;                // Transform from ft frame to world frame
+  // Rotation from ft frame to world frame, kept up to date by the monitor's tf or joint state source
+  TransformMonitor monitor;
+  tf::Transform ft_to_world;                       // Transform from ft frame to world frame, rotation only
+  double ft_to_world_rotation[9];                  // Rotation of ft_to_world at the time of the last sample, row-major
   std::string world_frame;
   std::string ft_frame;
 
@@ -80,17 +95,16 @@ private:
   geometry_msgs::WrenchStamped threshold;          // Wrench containing thresholds
   geometry_msgs::WrenchStamped raw_topic_data;     // Wrench containing raw topic data
 
+  WrenchCompensation payload;                      // Payload gravity, 3-D CoM and sensor offset
+  bool isGravityCompensated;                       // True if gravity is compensated
+
   bool isBiased;                                   // True if sensor is biased
-  bool isNewBias;                                  // True if sensor was biased this pass
   bool waitingForTransform;                        // False after initial transform is supplied
   bool isActive;                                   // True if run function has been called
 
   // Variables used to monitor FT violation and send a cancel move message
   netft_utils::Cancel cancel_msg;
-  static const int MAX_CANCEL = 5;                 // Number of times to send cancel message when max force is exceeded
-  static const int MAX_WAIT = 100;                 // Number of cycles to wait after cancel message before sending again
-  int cancel_count;                                // Counter for times to send cancel message when max force is exceeded
-  int cancel_wait;                                 // Counter of cycles to wait after cancel message before sending again
+  SafetyMonitor safety;                            // Limits checked on every sample in netftCallback
   double forceMaxB;                                // Default max force limit to send cancel when FT is biased
   double torqueMaxB;                               // Default max torque limit to send cancel when FT is biased
   double forceMaxU;                                // Default max force limit to send cancel when FT is unbiased
@@ -101,7 +115,9 @@ private:
 
   // ROS publishers
   ros::Publisher netft_cancel_pub;
+  ros::Publisher motion_abort_pub;
   ros::Publisher data_pub;
+  ros::Publisher diag_pub;
 
   // Callback methods
   void netftCallback(const geometry_msgs::WrenchStamped& data);
@@ -119,7 +135,8 @@ private:
   void copyWrench(geometry_msgs::WrenchStamped &in, geometry_msgs::WrenchStamped &out, geometry_msgs::WrenchStamped &bias);
   void applyThreshold(double &value, double thresh);
   void transformFrame(geometry_msgs::WrenchStamped in_data, geometry_msgs::WrenchStamped &out_data, char target_frame);
-  void checkMaxForce();
+  // Magnitude limits of the safety monitor, the biased ones once the sensor is biased and they are set
+  void updateLimits();
   bool monitorData();
 
   static const bool DEBUG_DATA = true;
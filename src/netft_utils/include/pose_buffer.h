@@ -0,0 +1,79 @@
+#ifndef POSE_BUFFER_H
+#define POSE_BUFFER_H
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * One pose of the robot state stream: time stamp (s), position (m) and orientation as a unit
+ * quaternion (w, x, y, z). Rotations elsewhere are row-major 3x3 arrays with v_world = R * v_local.
+ */
+struct PoseSample
+{
+  double stamp;
+  double position[3];
+  double orientation[4];
+};
+
+/**
+ * Time-indexed history of the robot pose, so every force/torque sample can be paired with the pose
+ * at its own acquisition time instead of the latest one. lookup() interpolates between the two poses
+ * around the requested time, linearly for the position and by SLERP for the orientation.
+ *
+ * The robot state (100 Hz) lags the wrench stream (500 Hz), so the newest wrench samples are usually
+ * a little newer than the newest pose. Up to maxExtrapolation past the newest pose, lookup() continues
+ * the motion of the last two poses; further out it holds the newest pose and reports TOO_NEW.
+ *
+ * One writer (push) and any number of readers (lookup, latest) without locks: a ring of CAPACITY
+ * entries, each guarded by its own sequence counter. Readers retry an entry that was being written
+ * and restart if the writer overtook them. Stamps must increase, older or repeated ones are dropped.
+ */
+class PoseBuffer
+{
+public:
+  enum Status
+  {
+    EMPTY,          // nothing pushed yet, outputs untouched
+    INTERPOLATED,   // between two poses, or exactly on one
+    EXTRAPOLATED,   // within maxExtrapolation after the newest pose
+    TOO_OLD,        // before the oldest pose still kept, outputs are the oldest pose
+    TOO_NEW         // later than maxExtrapolation after the newest pose, outputs are the newest pose
+  };
+
+  static const int CAPACITY = 256;
+
+  PoseBuffer();
+
+  void setMaxExtrapolation(double seconds) { maxExtrapolation = seconds; }
+
+  void push(double stamp, const double position[3], const double rotation[9]);
+  // position and rotation may be null if not needed
+  Status lookup(double stamp, double position[3], double rotation[9]) const;
+  // Returns false if nothing was pushed yet
+  bool latest(PoseSample &sample) const;
+  // Number of poses pushed so far, changes with every push
+  uint64_t count() const { return pushed.load(std::memory_order_acquire); }
+
+  // Shortest arc interpolation from q0 (t = 0) to q1 (t = 1); t outside [0, 1] continues the same rotation
+  static void slerp(const double q0[4], const double q1[4], double t, double q[4]);
+  static void rotationToQuaternion(const double rotation[9], double q[4]);
+  static void quaternionToRotation(const double q[4], double rotation[9]);
+
+private:
+  struct Entry
+  {
+    std::atomic<uint64_t> seq;
+    std::atomic<double> data[8]; // stamp, position, orientation
+  };
+
+  void write(Entry &entry, const PoseSample &sample);
+  void read(const Entry &entry, PoseSample &sample) const;
+  static void interpolate(const PoseSample &p0, const PoseSample &p1, double stamp, double position[3], double rotation[9]);
+
+  Entry entries[CAPACITY];
+  std::atomic<uint64_t> pushed;
+  PoseSample newest;            // writer side copy, used for ordering and hemisphere checks
+  double maxExtrapolation;
+};
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef SAFETY_MONITOR_H
+#define SAFETY_MONITOR_H
+
+#include <string>
+
+/**
+ * Force/torque limit check run on every sample in the receive path, before anything is published.
+ *
+ * Limits are per axis on |fx| .. |tz| and on the force and torque magnitudes; 0 disables a limit.
+ * The monitor trips after tripSamples samples in a row exceed any limit and releases only after
+ * releaseSamples samples in a row stay below releaseRatio times every limit, so a wrench hovering
+ * around a limit trips once instead of toggling. Requiring DEFAULT_TRIP_SAMPLES samples (6 ms at 500 Hz)
+ * keeps a single spike in the sensor stream from aborting motion. Magnitudes are compared squared, the limits are
+ * scaled and squared in the setters. Wrenches are (fx, fy, fz, tx, ty, tz). No method allocates.
+ */
+class SafetyMonitor
+{
+public:
+  enum Event
+  {
+    NONE,
+    TRIPPED,    // this sample tripped the monitor
+    RELEASED    // this sample released it
+  };
+
+  // Bits of violations(), one per limit
+  enum Violation
+  {
+    FX = 1, FY = 2, FZ = 4, TX = 8, TY = 16, TZ = 32,
+    FORCE = 64,
+    TORQUE = 128
+  };
+
+  // Consecutive violating samples before a trip, unless setHysteresis() says otherwise
+  static const int DEFAULT_TRIP_SAMPLES = 3;
+
+  SafetyMonitor();
+
+  void setAxisLimits(const double limits[6]);
+  void setMagnitudeLimits(double force, double torque);
+  void setHysteresis(double releaseRatio, int tripSamples, int releaseSamples);
+  // Back to not tripped, e.g. after the robot was recovered
+  void reset();
+
+  Event update(const double wrench[6]);
+
+  bool tripped() const { return isTripped; }
+  // Limits exceeded by the sample that tripped the monitor
+  unsigned int violations() const { return tripViolations; }
+  // e.g. "force magnitude, tz"
+  static std::string describe(unsigned int violations);
+
+private:
+  void updateThresholds();
+  static unsigned int check(const double wrench[6], const double axis[6], double forceSq, double torqueSq);
+
+  double axisLimit[6];
+  double forceLimit;
+  double torqueLimit;
+  double releaseRatio;
+  int tripSamples;
+  int releaseSamples;
+
+  // Precomputed by updateThresholds, disabled limits are infinite
+  double tripAxis[6];
+  double releaseAxis[6];
+  double tripForceSq, tripTorqueSq;
+  double releaseForceSq, releaseTorqueSq;
+
+  bool isTripped;
+  int count;                  // consecutive samples towards the next trip or release
+  unsigned int tripViolations;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef TRANSFORM_MONITOR_H
+#define TRANSFORM_MONITOR_H
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ros/ros.h"
+#include "sensor_msgs/JointState.h"
+#include "diagnostic_updater/DiagnosticStatusWrapper.h"
+#include "pose_buffer.h"
+
+/**
+ * Records the sensor pose in world_frame off the wrench path, from one of two sources:
+ *  - startTf: a thread polling tf for world_frame <- ft_frame. waitForTransform blocks only this thread.
+ *  - startJointState: joint states from the robot driver and forward kinematics of an MDH table
+ *    (a d theta alpha per joint, mm mm deg deg, the format of admittance_control/config/jaka_mdh.yaml),
+ *    times a fixed flange-to-sensor rotation. The world frame is then the robot base and the position
+ *    is the flange's.
+ * Poses go into a PoseBuffer stamped with their source time, so the wrench callbacks look up the
+ * rotation at each sample's own stamp. Staleness is reported through diagnostics(), like
+ * NetFTRDTDriver::diagnostics.
+ */
+class TransformMonitor
+{
+public:
+  explicit TransformMonitor(ros::NodeHandle &nh);
+  ~TransformMonitor();
+
+  // Frames for the tf source and the diagnostic name, set before starting a source
+  void setFrames(const std::string &world, const std::string &ft);
+  void startTf(double rate);
+  // mdh has 24 values, sensorRpy is the flange-to-sensor rotation (roll, pitch, yaw in rad, R = Rz*Ry*Rx)
+  bool startJointState(const std::string &topic, const std::vector<double> &mdh, const std::vector<double> &sensorRpy);
+  void stop();
+
+  const PoseBuffer &poses() const { return poseBuffer; }
+  // Age of the latest pose (s), infinite before the first one
+  double age() const;
+  // Rotation older than warn/error seconds is reported as WARN/ERROR
+  void setStaleness(double warn, double error);
+  // How far past the newest pose lookups may extrapolate, see PoseBuffer
+  void setMaxExtrapolation(double seconds) { poseBuffer.setMaxExtrapolation(seconds); }
+
+  void diagnostics(diagnostic_updater::DiagnosticStatusWrapper &d);
+
+  // Flange pose of the MDH chain for joint positions q, rotation row-major. mdh in m/rad, see above for the order.
+  static void forwardKinematics(const double mdh[24], const double q[6], double rotation[9], double position[3]);
+
+private:
+  void tfLoop(double rate);
+  void jointStateCallback(const sensor_msgs::JointState::ConstPtr &msg);
+
+  ros::NodeHandle n;
+  std::string world_frame;
+  std::string ft_frame;
+  std::string source;
+
+  PoseBuffer poseBuffer;
+  std::thread tfThread;
+  std::atomic<bool> running;
+  std::atomic<uint32_t> failures;             // tf lookups that failed since the last success
+
+  ros::Subscriber joint_state_sub;
+  double mdhTable[24];                        // m, rad
+  double sensorRotation[9];                   // flange to sensor
+
+  double warnAge;
+  double errorAge;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef WRENCH_COMPENSATION_H
+#define WRENCH_COMPENSATION_H
+
+#include <string>
+
+namespace ros
+{
+class NodeHandle;
+}
+
+/**
+ * Payload gravity and sensor offset compensation shared by netft_utils, netft_utils_lean and admittance_control.
+ *
+ * Model, all in the sensor frame, with g the world/base Z axis expressed in the sensor frame (third row of R):
+ *   measured force  = gravity * g + zero_drift[0..2]
+ *   measured torque = centroid x (gravity * g) + zero_drift[3..5]
+ * gravity is the world Z component of the payload weight (negative when the world Z axis is up), the same
+ * "Measured gravity" that gravity_calibration reports. The centroid is a full 3-D vector in meters.
+ *
+ * Rotations are passed as a row-major 3x3 array R with v_world = R * v_sensor, computed once per sample
+ * by the caller. No method allocates.
+ *
+ * The calibration is identified in the sensor's own axes, i.e. on netft_data as the driver publishes it
+ * (gravity_calibration, admittance_control). A caller whose tool frame differs from those axes by component
+ * signs, like netft_utils which negates force.x and torque.x, sets them with setToolSigns: predict and
+ * compensate then take the tool frame rotation and tool frame wrenches, and the calibration file stays shared.
+ */
+class WrenchCompensation
+{
+public:
+  WrenchCompensation();
+
+  void setCalibration(double gravity, const double centroid[3], const double zeroDrift[6]);
+  void clear();
+  // tool = signs * sensor, per component; all +1 by default. Not changed by clear or loadCalibration.
+  void setToolSigns(const double signs[6]);
+
+  // Reads <ns>/gravity, <ns>/centroid and <ns>/zero_drift, e.g. loaded from config/payload_calibration.yaml.
+  // Returns false and leaves the calibration unchanged if any of them is missing or has the wrong size.
+  bool loadCalibration(const ros::NodeHandle& n, const std::string& ns = "payload");
+  // Writes the calibration in the format loadCalibration expects.
+  bool saveCalibration(const std::string& file) const;
+
+  // Wrench the sensor reads with no external load: gravity wrench plus zero drift, in the sensor frame.
+  void predict(const double rotation[9], double wrench[6]) const;
+  // out = in - predict(rotation). in and out may alias.
+  void compensate(const double rotation[9], const double in[6], double out[6]) const;
+
+  bool isCalibrated() const { return calibrated; }
+  double gravity() const { return payloadGravity; }
+  const double* centroid() const { return payloadCentroid; }
+  const double* zeroDrift() const { return sensorZeroDrift; }
+
+private:
+  bool calibrated;
+  double payloadGravity;
+  double payloadCentroid[3];
+  double sensorZeroDrift[6];
+  double toolSigns[6];
+};
+
+#endif
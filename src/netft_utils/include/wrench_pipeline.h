@@ -0,0 +1,93 @@
+#ifndef WRENCH_PIPELINE_H
+#define WRENCH_PIPELINE_H
+
+#include <cmath>
+#include "wrench_compensation.h"
+
+/**
+ * Per-sample force/torque processing of NetftUtils on plain 6-element arrays: offset removal
+ * (bias or payload gravity compensation), rotation into the world frame and threshold, in one pass.
+ *
+ * Everything that only depends on the transform is computed in setRotation, once per TF update:
+ * the inverse (transposed) rotation and the tool frame offset, which for gravity compensation is the
+ * predicted gravity wrench at that orientation. Per sample that leaves two 3x3 products per output
+ * frame and a subtraction. Wrenches are (fx, fy, fz, tx, ty, tz); rotations are row-major with
+ * v_world = R * v_tool. No method allocates.
+ */
+class WrenchPipeline
+{
+public:
+  enum Mode
+  {
+    RAW,                  // no offset
+    BIASED,               // constant tool frame bias, e.g. a snapshot taken at a fixed orientation
+    GRAVITY_COMPENSATED   // payload gravity and sensor offset from WrenchCompensation, follows the rotation
+  };
+
+  WrenchPipeline();
+
+  void setRotation(const double rotation[9]);
+  void setBias(const double bias[6]);
+  void setCompensation(const WrenchCompensation& compensation);
+  void clearOffset();
+  // Components with |value| <= threshold are set to zero in the tool and world outputs
+  void setThreshold(const double threshold[6]);
+
+  Mode mode() const { return offsetMode; }
+  const double* rotation() const { return toWorld; }
+  const double* inverseRotation() const { return toTool; }
+  // Tool frame wrench currently subtracted from every sample
+  const double* offset() const { return toolOffset; }
+
+  // raw is in the tool frame. rawWorld = R * raw, tool = threshold(raw - offset), world = threshold(R * (raw - offset))
+  inline void process(const double raw[6], double rawWorld[6], double tool[6], double world[6]) const;
+  // count samples stored back to back, 6 values each
+  void processBlock(const double* raw, int count, double* rawWorld, double* tool, double* world) const;
+
+  // World frame wrench to the tool frame with the precomputed inverse
+  void worldToTool(const double world[6], double tool[6]) const;
+
+private:
+  void updateOffset();
+
+  static inline void rotate(const double R[9], const double in[3], double out[3])
+  {
+    out[0] = R[0] * in[0] + R[1] * in[1] + R[2] * in[2];
+    out[1] = R[3] * in[0] + R[4] * in[1] + R[5] * in[2];
+    out[2] = R[6] * in[0] + R[7] * in[1] + R[8] * in[2];
+  }
+
+  // Single comparison on |value| so it compiles to a select instead of two data dependent branches
+  static inline double applyThreshold(double value, double threshold)
+  {
+    return std::fabs(value) <= threshold ? 0.0 : value;
+  }
+
+  Mode offsetMode;
+  double toWorld[9];
+  double toTool[9];
+  double bias[6];
+  WrenchCompensation compensation;
+  double toolOffset[6];
+  double threshold[6];
+};
+
+inline void WrenchPipeline::process(const double raw[6], double rawWorld[6], double tool[6], double world[6]) const
+{
+  double unbiased[6];
+  for(int i = 0; i < 6; i++)
+    unbiased[i] = raw[i] - toolOffset[i];
+
+  rotate(toWorld, raw, rawWorld);
+  rotate(toWorld, raw + 3, rawWorld + 3);
+  rotate(toWorld, unbiased, world);
+  rotate(toWorld, unbiased + 3, world + 3);
+
+  for(int i = 0; i < 6; i++)
+  {
+    tool[i] = applyThreshold(unbiased[i], threshold[i]);
+    world[i] = applyThreshold(world[i], threshold[i]);
+  }
+}
+
+#endif
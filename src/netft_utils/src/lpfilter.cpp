@@ -75,13 +75,24 @@ bool LPFilter::update(std::vector<double> input, std::vector<double>& output)
     ROS_ERROR_STREAM("LPFilter incorrect input or output size");
     return false;
   }
+  return update(input.data(), output.data());
+}
+
+bool LPFilter::update(const double* input, double* output)
+{
+  if(!initialized)
+  {
+    ROS_ERROR_STREAM("LPFilter was not initialized correctly. Not filtering data.");
+    return false;
+  }
   for(int i=0; i<noElements; i++)
   {
-    output.at(i) = a0*input.at(i) + a1*in1.at(i) + a2*in2.at(i) - b1*out1.at(i) - b2*out2.at(i);
-    out2.at(i) = out1.at(i);
-    out1.at(i) = output.at(i);
-    in2.at(i) = in1.at(i);
-    in1.at(i) = input.at(i);
+    double in0 = input[i];
+    output[i] = a0*in0 + a1*in1[i] + a2*in2[i] - b1*out1[i] - b2*out2[i];
+    out2[i] = out1[i];
+    out1[i] = output[i];
+    in2[i] = in1[i];
+    in1[i] = in0;
   }
   return true;
-} 
+}
@@ -76,24 +76,22 @@ NetftUtils::NetftUtils(ros::NodeHandle nh) :
   deltaTFilter(0.0),
   cutoffFrequency(0.0),
   newFilter(false),
+  monitor(n),
   isBiased(false),
   isGravityBiased(false),
-  isNewBias(false),
   isNewGravityBias(false),
-  cancel_count(MAX_CANCEL),
-  cancel_wait(MAX_WAIT),
   forceMaxB(10.0),
   torqueMaxB(0.8),
   forceMaxU(50.0),
-  torqueMaxU(5.0),
-  payloadWeight(0.),
-  payloadLeverArm(0.)
+  torqueMaxU(5.0)
 {
+  for(int i = 0; i < 9; i++)
+    ft_to_world_rotation[i] = (i % 4 == 0) ? 1.0 : 0.0;
 }
 
 NetftUtils::~NetftUtils()
 {
-  delete listener;
+  monitor.stop();
   delete lp;
 }
 
@@ -111,9 +109,11 @@ void NetftUtils::initialize()
 
   //Initialize cancel message
   cancel_msg.toCancel = false;
+  updateLimits();
 
-  //Listen to the transfomation from the ft sensor to world frame.
-  listener = new tf::TransformListener(ros::Duration(300));
+  //The payload calibration is in the sensor's own axes, the tool frame here has force.x and torque.x negated
+  const double toolSigns[6] = {-1.0, 1.0, 1.0, -1.0, 1.0, 1.0};
+  payload.setToolSigns(toolSigns);
 
   //Subscribe to the NetFT topic.
   raw_data_sub = n.subscribe("netft_data",100, &NetftUtils::netftCallback, this);
@@ -132,6 +132,10 @@ void NetftUtils::initialize()
   weight_bias_service = n.advertiseService("set_weight_bias", &NetftUtils::setWeightBias, this);
   get_weight_service = n.advertiseService("get_weight", &NetftUtils::getWeight, this);
   filter_service = n.advertiseService("filter", &NetftUtils::setFilter, this);
+
+  //Rotation staleness is published with the other diagnostics
+  diag_pub = n.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 2);
+  last_diag_pub_time = ros::Time::now();
 }
 
 void NetftUtils::setUserInput(std::string world, std::string ft, double force, double torque)
@@ -146,6 +150,54 @@ void NetftUtils::setUserInput(std::string world, std::string ft, double force, d
   {
     torqueMaxU = torque;
   }
+
+  // Safety monitor: per axis limits and hysteresis from parameters, magnitude limits from forceMax/torqueMax.
+  // A trip is sent as robot_msgs/MotionAbort on ~motion_abort_topic, empty to only publish cancel.
+  ros::NodeHandle safety_n("~");
+  std::vector<double> axisLimits(6, 0.0);
+  double releaseRatio;
+  int tripSamples, releaseSamples;
+  std::string abortTopic;
+  if(safety_n.getParam("axis_limits", axisLimits) && axisLimits.size() != 6)
+  {
+    ROS_ERROR("~axis_limits needs 6 values, per axis limits disabled");
+    axisLimits.assign(6, 0.0);
+  }
+  safety_n.param("release_ratio", releaseRatio, 0.8);
+  safety_n.param("trip_samples", tripSamples, (int)SafetyMonitor::DEFAULT_TRIP_SAMPLES);
+  safety_n.param("release_samples", releaseSamples, 250);
+  safety_n.param<std::string>("motion_abort_topic", abortTopic, "/robot_driver/motion_abort");
+  safety.setAxisLimits(&axisLimits[0]);
+  safety.setHysteresis(releaseRatio, tripSamples, releaseSamples);
+  updateLimits();
+  if(!abortTopic.empty())
+    motion_abort_pub = n.advertise<robot_msgs::MotionAbort>(abortTopic, 1);
+
+  // Start the rotation source: joint states and FK if ~joint_state_topic and ~mdh are set, otherwise tf.
+  // Either way it runs off the wrench path and update() never waits for it.
+  ros::NodeHandle private_n("~");
+  std::string jointStateTopic;
+  std::vector<double> mdh;
+  std::vector<double> sensorRpy(3, 0.0);
+  double tfRate, warnAge, errorAge, maxExtrapolation;
+  private_n.param("tf_rate", tfRate, 200.0);
+  private_n.param("max_pose_extrapolation", maxExtrapolation, 0.05);
+  private_n.param("rotation_warn_age", warnAge, 0.1);
+  private_n.param("rotation_error_age", errorAge, 1.0);
+  private_n.getParam("sensor_rpy", sensorRpy);
+
+  monitor.setFrames(world_frame, ft_frame);
+  monitor.setStaleness(warnAge, errorAge);
+  monitor.setMaxExtrapolation(maxExtrapolation);
+  if(private_n.getParam("joint_state_topic", jointStateTopic) && private_n.getParam("mdh", mdh) &&
+     monitor.startJointState(jointStateTopic, mdh, sensorRpy))
+  {
+    ROS_INFO_STREAM("Sensor rotation from " << jointStateTopic << " and the MDH table");
+  }
+  else
+  {
+    monitor.startTf(tfRate);
+  }
 }
 
 void NetftUtils::update()
@@ -157,23 +209,8 @@ void NetftUtils::update()
     lp = new LPFilter(deltaTFilter,cutoffFrequency,6);
     newFilter = false;
   }
-  // Look up transform from ft to world frame
-  tf::StampedTransform tempTransform;
-  try
-  {
-    listener->waitForTransform(world_frame, ft_frame, ros::Time(0), ros::Duration(1.0));
-    listener->lookupTransform(world_frame, ft_frame, ros::Time(0), tempTransform);
-  }
-  catch (tf::TransformException ex)
-  {
-    ROS_ERROR("%s",ex.what());
-  }
-
-  // Set translation to zero before updating value
-  tempTransform.setOrigin(tf::Vector3(0.0,0.0,0.0));
-  ft_to_world = tempTransform;
-
-  checkMaxForce();
+  // The rotation is picked up by netftCallback from the monitor, nothing here waits for tf.
+  // Force limits are checked per sample in netftCallback.
 
   // Publish transformed dat
   netft_raw_world_data_pub.publish( raw_data_world );
@@ -181,6 +218,18 @@ void NetftUtils::update()
   netft_tool_data_pub.publish( tf_data_tool );
   netft_cancel_pub.publish( cancel_msg );
 
+  ros::Time current_time(ros::Time::now());
+  if((current_time - last_diag_pub_time).toSec() > 1.0)
+  {
+    diagnostic_msgs::DiagnosticArray diag_array;
+    diagnostic_updater::DiagnosticStatusWrapper diag_status;
+    monitor.diagnostics(diag_status);
+    diag_array.status.push_back(diag_status);
+    diag_array.header.stamp = current_time;
+    diag_pub.publish(diag_array);
+    last_diag_pub_time = current_time;
+  }
+
   ros::spinOnce();
 }
 
@@ -196,123 +245,55 @@ void NetftUtils::copyWrench(geometry_msgs::WrenchStamped &in, geometry_msgs::Wre
   out.wrench.torque.z = in.wrench.torque.z - bias.wrench.torque.z;
 }
 
-void NetftUtils::applyThreshold(double &value, double thresh)
+void NetftUtils::setWrench(const double data[6], const ros::Time &stamp, const std::string &frame, geometry_msgs::WrenchStamped &out)
 {
-  if(value <= thresh && value >= -thresh)
-  {
-    value = 0.0;
-  }
-}
-
-void NetftUtils::transformFrame(geometry_msgs::WrenchStamped in_data, geometry_msgs::WrenchStamped &out_data, char target_frame)
-{
-  tf::Vector3 tempF;
-  tf::Vector3 tempT;
-  tempF.setX(in_data.wrench.force.x);
-  tempF.setY(in_data.wrench.force.y);
-  tempF.setZ(in_data.wrench.force.z);
-  tempT.setX(in_data.wrench.torque.x);
-  tempT.setY(in_data.wrench.torque.y);
-  tempT.setZ(in_data.wrench.torque.z);
-  if(target_frame == 'w')
-  {
-      out_data.header.frame_id = world_frame;
-      tempF = ft_to_world * tempF;
-      tempT = ft_to_world * tempT;
-  }
-  else if(target_frame == 't')
-  {
-      out_data.header.frame_id = ft_frame;
-      tempF = ft_to_world.inverse() * tempF;
-      tempT = ft_to_world.inverse() * tempT;
-  }	
-  out_data.header.stamp = in_data.header.stamp;
-  out_data.wrench.force.x = tempF.getX();
-  out_data.wrench.force.y = tempF.getY();
-  out_data.wrench.force.z = tempF.getZ();
-  out_data.wrench.torque.x = tempT.getX();
-  out_data.wrench.torque.y = tempT.getY();
-  out_data.wrench.torque.z = tempT.getZ();
+  out.header.stamp = stamp;
+  out.header.frame_id = frame;
+  out.wrench.force.x = data[0];
+  out.wrench.force.y = data[1];
+  out.wrench.force.z = data[2];
+  out.wrench.torque.x = data[3];
+  out.wrench.torque.y = data[4];
+  out.wrench.torque.z = data[5];
 }
 
 // Runs when a new datapoint comes in
 void NetftUtils::netftCallback(const geometry_msgs::WrenchStamped::ConstPtr& data)
 {
+  // Apply negative to x data to follow right hand rule convention (ft raw data does not)
+  double rawData[6] = {-data->wrench.force.x, data->wrench.force.y, data->wrench.force.z,
+                       -data->wrench.torque.x, data->wrench.torque.y, data->wrench.torque.z};
+
   // Filter data
-  std::vector<double> tempData;
-  tempData.resize(6);
-  tempData.at(0) = -data->wrench.force.x;
-  tempData.at(1) = data->wrench.force.y;
-  tempData.at(2) = data->wrench.force.z;
-  tempData.at(3) = -data->wrench.torque.x;
-  tempData.at(4) = data->wrench.torque.y;
-  tempData.at(5) = data->wrench.torque.z;
-  
   if(isFilterOn && !newFilter)
-    lp->update(tempData,tempData);
-  
-  // Copy tool frame data. apply negative to x data to follow right hand rule convention (ft raw data does not)
-  raw_data_tool.header.stamp = data->header.stamp;
-  raw_data_tool.header.frame_id = ft_frame;
-  raw_data_tool.wrench.force.x = tempData.at(0);
-  raw_data_tool.wrench.force.y = tempData.at(1);
-  raw_data_tool.wrench.force.z = tempData.at(2);
-  raw_data_tool.wrench.torque.x = tempData.at(3);
-  raw_data_tool.wrench.torque.y = tempData.at(4);
-  raw_data_tool.wrench.torque.z = tempData.at(5);
-  
-  // Copy in new netft data in tool frame and transform to world frame
-  transformFrame(raw_data_tool, raw_data_world, 'w');
-  
-  if (isGravityBiased) // Compensate for gravity. Assumes world Z-axis is up
-  {
-      // Gravity moment = (payloadLeverArm) cross (payload force)  <== all in the sensor frame. Need to convert to world later
-      // Since it's assumed that the CoM of the payload is on the sensor's central axis, this calculation is simplified.
-      double gravMomentX = -payloadLeverArm*tf_data_tool.wrench.force.y;
-      double gravMomentY = payloadLeverArm*tf_data_tool.wrench.force.x;
-    
-      // Subtract the gravity torques from the previously-calculated wrench in the tool frame
-      tf_data_tool.wrench.torque.x = tf_data_tool.wrench.torque.x - gravMomentX;
-      tf_data_tool.wrench.torque.y = tf_data_tool.wrench.torque.y - gravMomentY;
-    
-      // Convert to world to account for the gravity force. Assumes world-Z is up.
-      //ROS_INFO_STREAM("gravity force in the world Z axis: "<< payloadWeight);
-      transformFrame(tf_data_tool, tf_data_world, 'w');
-      tf_data_world.wrench.force.z = tf_data_world.wrench.force.z - payloadWeight;
-    
-      // tf_data_world now accounts for gravity completely. Convert back to the tool frame to make that data available, too
-      transformFrame(tf_data_world, tf_data_tool, 't');
-  }
-  
-  if (isBiased) // Apply the bias for a static sensor frame
-  {
-    // Get tool bias in world frame
-    geometry_msgs::WrenchStamped world_bias;
-    transformFrame(bias, world_bias, 'w');
-    // Add bias and apply threshold to get transformed data
-    copyWrench(raw_data_world, tf_data_world, world_bias);
-  }
-  else // Just pass the data straight through
-  {
-    copyWrench(raw_data_world, tf_data_world, zero_wrench);
-    copyWrench(raw_data_tool, tf_data_tool, zero_wrench);
-  }
-                  
-  // Apply thresholds
-  applyThreshold(tf_data_world.wrench.force.x, threshold.wrench.force.x);
-  applyThreshold(tf_data_world.wrench.force.y, threshold.wrench.force.y);
-  applyThreshold(tf_data_world.wrench.force.z, threshold.wrench.force.z);
-  applyThreshold(tf_data_world.wrench.torque.x, threshold.wrench.torque.x);
-  applyThreshold(tf_data_world.wrench.torque.y, threshold.wrench.torque.y);
-  applyThreshold(tf_data_world.wrench.torque.z, threshold.wrench.torque.z);
-  applyThreshold(tf_data_tool.wrench.force.x, threshold.wrench.force.x);
-  applyThreshold(tf_data_tool.wrench.force.y, threshold.wrench.force.y);
-  applyThreshold(tf_data_tool.wrench.force.z, threshold.wrench.force.z);
-  applyThreshold(tf_data_tool.wrench.torque.x, threshold.wrench.torque.x);
-  applyThreshold(tf_data_tool.wrench.torque.y, threshold.wrench.torque.y);
-  applyThreshold(tf_data_tool.wrench.torque.z, threshold.wrench.torque.z);
+    lp->update(rawData, rawData);
+
+  // Rotation at the sample's own time, interpolated from the monitor's pose history without locks
+  double sampleTime = data->header.stamp.isZero() ? ros::Time::now().toSec() : data->header.stamp.toSec();
+  PoseBuffer::Status poseStatus = monitor.poses().lookup(sampleTime, NULL, ft_to_world_rotation);
+  if(poseStatus == PoseBuffer::TOO_OLD || poseStatus == PoseBuffer::TOO_NEW)
+    ROS_WARN_THROTTLE(5.0, "No pose around the wrench sample at %.3f, using the %s one", sampleTime,
+                      poseStatus == PoseBuffer::TOO_OLD ? "oldest" : "newest");
+  if(poseStatus != PoseBuffer::EMPTY)
+    pipeline.setRotation(ft_to_world_rotation);
+
+  // Offset (bias or gravity compensation), world frame transform and threshold in one pass
+  double rawWorld[6];
+  double tool[6];
+  double world[6];
+  pipeline.process(rawData, rawWorld, tool, world);
+
+  // Limits on every sample, before anything is published; a trip goes out from here
+  SafetyMonitor::Event event = safety.update(tool);
+  if(event != SafetyMonitor::NONE)
+    safetyEvent(event, data->header.stamp, tool);
+
+  setWrench(rawData, data->header.stamp, ft_frame, raw_data_tool);
+  setWrench(rawWorld, data->header.stamp, world_frame, raw_data_world);
+  setWrench(tool, data->header.stamp, ft_frame, tf_data_tool);
+  setWrench(world, data->header.stamp, world_frame, tf_data_world);
   //ROS_INFO_STREAM("Callback time: " << tf_data_tool.header.stamp.toSec()-ros::Time::now().toSec());
-}                 
+}
 
 // Set the readings from the sensor to zero at this instant and continue to apply the bias on future readings.
 // This doesn't account for gravity.
@@ -324,17 +305,23 @@ bool NetftUtils::fixedOrientationBias(netft_utils::SetBias::Request &req, netft_
   if(req.toBias)  
   {           
     copyWrench(raw_data_tool, bias, zero_wrench); // Store the current wrench readings in the 'bias' variable, to be applied hereafter
+    double toolBias[6] = {bias.wrench.force.x, bias.wrench.force.y, bias.wrench.force.z,
+                          bias.wrench.torque.x, bias.wrench.torque.y, bias.wrench.torque.z};
+    if(!isGravityBiased) // Gravity compensation already removes the offset
+      pipeline.setBias(toolBias);
     if(req.forceMax >= 0.0001) // if forceMax was specified and > 0
       forceMaxB = req.forceMax;
     if(req.torqueMax >= 0.0001)
       torqueMaxB = req.torqueMax; // if torqueMax was specified and > 0
     
-    isNewBias = true;
     isBiased = true;
+    updateLimits();
   }               
   else            
   {               
     copyWrench(zero_wrench, bias, zero_wrench); // Clear the stored bias if the argument was false
+    if(!isGravityBiased)
+      pipeline.clearOffset();
   }               
 
   res.success = true;
@@ -342,9 +329,11 @@ bool NetftUtils::fixedOrientationBias(netft_utils::SetBias::Request &req, netft_
   return true;    
 }
 
-// Calculate the payload's mass and center of mass so gravity can be compensated for, even as the sensor changes orientation.
-// It's assumed that the payload's center of mass is located on the sensor's central access.
-// Run this method when the sensor is stationary to avoid inertial effects.
+// Compensate for the payload's gravity and the sensor offset, even as the sensor changes orientation.
+// The calibration in the "payload" parameters (full 3-D center of mass, see wrench_compensation.h) is used if present.
+// It is the one gravity_calibration identifies on netft_data, before the x axis negation of netftCallback.
+// Otherwise it's assumed that the payload's center of mass is located on the sensor's central axis and
+// the payload's weight and lever arm are measured now: run this method when the sensor is stationary to avoid inertial effects.
 // Cannot do gravity compensation if sensor has already been biased.
 bool NetftUtils::compensateForGravity(netft_utils::SetBias::Request &req, netft_utils::SetBias::Response &res)
 {
@@ -359,14 +348,24 @@ bool NetftUtils::compensateForGravity(netft_utils::SetBias::Request &req, netft_
     }
     else  // Cannot compensate for gravity if the sensor has already been biased, i.e. useful data was wiped out 
     {
-      // Get the weight of the payload. Assumes the world Z axis is up.
-      payloadWeight = raw_data_world.wrench.force.z;
-  
-      // Calculate the z-coordinate of the payload's center of mass, in the sensor frame.
-      // It's assumed that the x- and y-coordinates are zero.
-      // This is a lever arm.
-      payloadLeverArm = raw_data_tool.wrench.torque.y/raw_data_tool.wrench.force.x;
-    
+      if(payload.loadCalibration(n))
+      {
+        ROS_INFO_STREAM("Payload calibration loaded, gravity " << payload.gravity());
+      }
+      else
+      {
+        // Get the weight of the payload. Assumes the world Z axis is up.
+        double payloadWeight = raw_data_world.wrench.force.z;
+
+        // Calculate the z-coordinate of the payload's center of mass, in the sensor frame.
+        // It's assumed that the x- and y-coordinates are zero.
+        // This is a lever arm. force.x is negated back to the sensor's own axes, like a loaded calibration.
+        double centroid[3] = {0.0, 0.0, raw_data_tool.wrench.torque.y/-raw_data_tool.wrench.force.x};
+        double zeroDrift[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        payload.setCalibration(payloadWeight, centroid, zeroDrift);
+      }
+
+      pipeline.setCompensation(payload);
       isNewGravityBias = true;
       isGravityBiased = true;
     }
@@ -399,6 +398,7 @@ bool NetftUtils::setMax(netft_utils::SetMax::Request &req, netft_utils::SetMax::
     forceMaxU = req.forceMax;
   if(req.torqueMax >= 0.0001)
     torqueMaxU = req.torqueMax;
+  updateLimits();
   
   res.success = true;             
   return true;    
@@ -436,55 +436,48 @@ bool NetftUtils::setThreshold(netft_utils::SetThreshold::Request &req, netft_uti
   threshold.wrench.torque.x = req.data.wrench.torque.x;
   threshold.wrench.torque.y = req.data.wrench.torque.y;
   threshold.wrench.torque.z = req.data.wrench.torque.z;
+  double thresholdData[6] = {threshold.wrench.force.x, threshold.wrench.force.y, threshold.wrench.force.z,
+                             threshold.wrench.torque.x, threshold.wrench.torque.y, threshold.wrench.torque.z};
+  pipeline.setThreshold(thresholdData);
                   
   res.success = true;
                   
   return true;    
 }
 
-void NetftUtils::checkMaxForce()
+void NetftUtils::updateLimits()
 {
-  double fMag = pow((pow(tf_data_tool.wrench.force.x, 2.0) + pow(tf_data_tool.wrench.force.y, 2.0) + pow(tf_data_tool.wrench.force.z, 2.0)), 0.5);
-  double tMag = pow((pow(tf_data_tool.wrench.torque.x, 2.0) + pow(tf_data_tool.wrench.torque.y, 2.0) + pow(tf_data_tool.wrench.torque.z, 2.0)), 0.5);
-  double fMax;
-  double tMax;
-  if(isBiased && !isNewBias)
-  {
-    fMax = forceMaxB;
-    tMax = torqueMaxB;
-  }
+  if(isBiased)
+    safety.setMagnitudeLimits(forceMaxB, torqueMaxB);
   else
-  {
-    if(isBiased && isNewBias)
-    {
-      isNewBias = false;
-    }
-
-    fMax = forceMaxU; //50.0;
-    tMax = torqueMaxU; //5.0;
-  }
+    safety.setMagnitudeLimits(forceMaxU, torqueMaxU);
+}
 
-  // If max FT exceeded, send cancel unless we have just sent it MAX_CANCEL times
-  //ROS_INFO("FMAG: %f TMAG: %f", fMag, tMag);
-  if((fabs(fMag) > fMax || fabs(tMag) > tMax) && cancel_count > 0)
+void NetftUtils::safetyEvent(SafetyMonitor::Event event, const ros::Time &stamp, const double wrench[6])
+{
+  if(event == SafetyMonitor::TRIPPED)
   {
+    // Abort first, everything else can wait
+    robot_msgs::MotionAbort abort_msg;
+    abort_msg.header.stamp = stamp;
+    abort_msg.detect_time = ros::Time::now();
+    for(int i = 0; i < 6; i++)
+      abort_msg.wrench[i] = wrench[i];
+    abort_msg.reason = "force/torque limit: " + SafetyMonitor::describe(safety.violations());
+    if(motion_abort_pub)
+      motion_abort_pub.publish(abort_msg);
+
     cancel_msg.toCancel = true;
-    //ROS_INFO("Force torque violation. Canceling move.");
-    ROS_INFO("FMAG: %f FMAX: %f TMAG:%f TMAX: %f count: %d wait: %d", fMag, fMax, tMag, tMax, cancel_count, cancel_wait);
-    cancel_count-=1;
+    netft_cancel_pub.publish(cancel_msg);
+    ROS_WARN("Force torque violation (%s), %.3f ms after the sample. Canceling move.",
+             abort_msg.reason.c_str(), (abort_msg.detect_time - stamp).toSec() * 1000.0);
   }
-  // If we have sent cancel MAX_CANCEL times, don't send cancel again for MAX_WAIT cycles
-  else if(cancel_count == 0 && cancel_wait > 0 && cancel_wait <= MAX_WAIT)
+  else if(event == SafetyMonitor::RELEASED)
   {
     cancel_msg.toCancel = false;
-    cancel_wait-=1;
+    netft_cancel_pub.publish(cancel_msg);
+    ROS_INFO("Force torque back below the release limits");
   }
-  // If we have just finished waiting MAX_WAIT times, or the max force is no longer exceeded, reset cancel_count and cancel_wait
-  else if(cancel_wait == 0 || !(fabs(fMag) > fMax || fabs(tMag) > tMax))
-  {
-    cancel_msg.toCancel = false;
-    cancel_count = MAX_CANCEL;
-    cancel_wait = MAX_WAIT;
-  }
-}               
+}
+               
                   
@@ -28,12 +28,11 @@ NetftUtilsLean::NetftUtilsLean(ros::NodeHandle* nh) :
   cutoffFrequency(0.0),
   newFilter(false),
   lpExists(false),
+  monitor(*nh),
+  isGravityCompensated(false),
   isBiased(false),
-  isNewBias(false),
   waitingForTransform(true),
   isActive(false),
-  cancel_count(MAX_CANCEL),
-  cancel_wait(MAX_WAIT),
   forceMaxB(10.0),
   torqueMaxB(0.8),
   forceMaxU(50.0),
@@ -41,11 +40,13 @@ NetftUtilsLean::NetftUtilsLean(ros::NodeHandle* nh) :
   toUpdate(false),
   toMonitor(false)
 {
+  for(int i = 0; i < 9; i++)
+    ft_to_world_rotation[i] = (i % 4 == 0) ? 1.0 : 0.0;
 }
 
 NetftUtilsLean::~NetftUtilsLean()
 {
-  delete listener;
+  monitor.stop();
   if(lpExists)
     delete lp;
 }
@@ -102,9 +103,11 @@ bool NetftUtilsLean::initialize(double rate, std::string world, std::string ft,
 
   //Initialize cancel message
   cancel_msg.toCancel = false;
+  updateLimits();
 
-  //Listen to the transfomation from the ft sensor to world frame.
-  listener = new tf::TransformListener(ros::Duration(300));
+  //Keep the transformation from the ft sensor to world frame up to date in its own thread.
+  monitor.setFrames(world_frame, ft_frame);
+  monitor.startTf(cycleRate);
 
   //Publish on the /cancel topic. Queue up to 100000 data points
   netft_cancel_pub = n->advertise<netft_utils::Cancel>("/netft/cancel", 100000);
@@ -112,6 +115,9 @@ bool NetftUtilsLean::initialize(double rate, std::string world, std::string ft,
   if(DEBUG_DATA)
     data_pub = n->advertise<geometry_msgs::WrenchStamped>("/netft/netft_data", 100000);
 
+  //Rotation staleness
+  diag_pub = n->advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 2);
+
   isInit = true;
   return true;
 }
@@ -260,6 +266,7 @@ bool NetftUtilsLean::update()
     return false;
   }
   ros::Rate r(cycleRate);
+  ros::Time last_diag_pub_time(ros::Time::now());
   while (ros::ok() && toUpdate)
   {
     // Check for a filter
@@ -272,27 +279,25 @@ bool NetftUtilsLean::update()
       newFilter = false;
     }
 
-    // Look up transform from ft to world frame
-    tf::StampedTransform tempTransform;
-    try
-    {
-      listener->waitForTransform(world_frame, ft_frame, ros::Time(0), ros::Duration(1.0));
-      listener->lookupTransform(world_frame, ft_frame, ros::Time(0), tempTransform);
-    }
-    catch (tf::TransformException ex)
-    {
-      ROS_ERROR("%s",ex.what());
-    }
-
-    // Set translation to zero before updating value
-    tempTransform.setOrigin(tf::Vector3(0.0,0.0,0.0));
-    ft_to_world = tempTransform;
-    waitingForTransform = false;
-
-    checkMaxForce();
+    // The monitor looks up the transform in its own thread, this loop never waits for tf
+    if(waitingForTransform && monitor.poses().count() != 0)
+      waitingForTransform = false;
 
+    // Force limits are checked per sample in netftCallback
     // Publish cancel_msg
     netft_cancel_pub.publish( cancel_msg );
+
+    ros::Time current_time(ros::Time::now());
+    if((current_time - last_diag_pub_time).toSec() > 1.0)
+    {
+      diagnostic_msgs::DiagnosticArray diag_array;
+      diagnostic_updater::DiagnosticStatusWrapper diag_status;
+      monitor.diagnostics(diag_status);
+      diag_array.status.push_back(diag_status);
+      diag_array.header.stamp = current_time;
+      diag_pub.publish(diag_array);
+      last_diag_pub_time = current_time;
+    }
     r.sleep();
   }
   return true;
@@ -376,6 +381,18 @@ void NetftUtilsLean::netftCallback(const geometry_msgs::WrenchStamped& data)
   if(isFilterOn && !newFilter)
     lp->update(tempData,tempData);
 
+  // Rotation at the sample's own time, interpolated from the monitor's pose history without locks
+  double sampleTime = data.header.stamp.isZero() ? ros::Time::now().toSec() : data.header.stamp.toSec();
+  PoseBuffer::Status poseStatus = monitor.poses().lookup(sampleTime, NULL, ft_to_world_rotation);
+  if(poseStatus == PoseBuffer::TOO_OLD || poseStatus == PoseBuffer::TOO_NEW)
+    ROS_WARN_THROTTLE(5.0, "No pose around the wrench sample at %.3f, using the %s one", sampleTime,
+                      poseStatus == PoseBuffer::TOO_OLD ? "oldest" : "newest");
+  if(poseStatus != PoseBuffer::EMPTY)
+  {
+    const double* R = ft_to_world_rotation;
+    ft_to_world.setBasis(tf::Matrix3x3(R[0], R[1], R[2], R[3], R[4], R[5], R[6], R[7], R[8]));
+  }
+
   // Copy tool frame data.
   raw_data_tool.header.stamp = data.header.stamp;
   raw_data_tool.header.frame_id = ft_frame;
@@ -386,8 +403,24 @@ void NetftUtilsLean::netftCallback(const geometry_msgs::WrenchStamped& data)
   raw_data_tool.wrench.torque.y = tempData.at(4);
   raw_data_tool.wrench.torque.z = tempData.at(5);
 
-  // Apply bias
-  copyWrench(raw_data_tool, tf_data_tool, bias);
+  if(isGravityCompensated)
+  {
+    // Subtract the payload's gravity wrench and the sensor offset, using the rotation at the sample's time
+    double compensated[6];
+    payload.compensate(ft_to_world_rotation, tempData.data(), compensated);
+    tf_data_tool.header = raw_data_tool.header;
+    tf_data_tool.wrench.force.x = compensated[0];
+    tf_data_tool.wrench.force.y = compensated[1];
+    tf_data_tool.wrench.force.z = compensated[2];
+    tf_data_tool.wrench.torque.x = compensated[3];
+    tf_data_tool.wrench.torque.y = compensated[4];
+    tf_data_tool.wrench.torque.z = compensated[5];
+  }
+  else
+  {
+    // Apply bias
+    copyWrench(raw_data_tool, tf_data_tool, bias);
+  }
 
   // Copy in new netft data in tool frame and transform to world frame
   transformFrame(tf_data_tool, tf_data_world, 'w');
@@ -406,6 +439,28 @@ void NetftUtilsLean::netftCallback(const geometry_msgs::WrenchStamped& data)
   applyThreshold(tf_data_tool.wrench.torque.y, threshold.wrench.torque.y);
   applyThreshold(tf_data_tool.wrench.torque.z, threshold.wrench.torque.z);
 
+  // Limits on every sample; a trip aborts the robot motion from here, without waiting for update()
+  double tool[6] = {tf_data_tool.wrench.force.x, tf_data_tool.wrench.force.y, tf_data_tool.wrench.force.z,
+                    tf_data_tool.wrench.torque.x, tf_data_tool.wrench.torque.y, tf_data_tool.wrench.torque.z};
+  SafetyMonitor::Event event = safety.update(tool);
+  if(event == SafetyMonitor::TRIPPED)
+  {
+    robot_msgs::MotionAbort abort_msg;
+    abort_msg.header.stamp = data.header.stamp;
+    abort_msg.detect_time = ros::Time::now();
+    for(int i = 0; i < 6; i++)
+      abort_msg.wrench[i] = tool[i];
+    abort_msg.reason = "force/torque limit: " + SafetyMonitor::describe(safety.violations());
+    if(motion_abort_pub)
+      motion_abort_pub.publish(abort_msg);
+    cancel_msg.toCancel = true;
+    ROS_WARN("Force torque violation (%s). Canceling move.", abort_msg.reason.c_str());
+  }
+  else if(event == SafetyMonitor::RELEASED)
+  {
+    cancel_msg.toCancel = false;
+  }
+
   // Publish data for debugging
   if(DEBUG_DATA)
     data_pub.publish(tf_data_tool);
@@ -459,16 +514,41 @@ bool NetftUtilsLean::biasSensor(bool toBias)
       raw_data_tool.wrench.torque.z = data.wrench.torque.z;
     }
     copyWrench(raw_data_tool, bias, zero_wrench);
-    isNewBias = true;
   }
   else
   {
     copyWrench(zero_wrench, bias, zero_wrench);
   }
   isBiased = toBias;
+  updateLimits();
   return true;
 }
 
+bool NetftUtilsLean::compensateForGravity(bool toCompensate)
+{
+  if(toCompensate)
+  {
+    if(!payload.loadCalibration(*n))
+    {
+      ROS_ERROR("Cannot compensate for gravity without a payload calibration");
+      return false;
+    }
+    ROS_INFO_STREAM("Payload calibration loaded, gravity " << payload.gravity());
+
+    // The calibration is in the sensor's own axes, netftCallback negates force.x and torque.x of a sensor at ftAddress
+    double sign = ftAddress.empty() ? 1.0 : -1.0;
+    const double toolSigns[6] = {sign, 1.0, 1.0, sign, 1.0, 1.0};
+    payload.setToolSigns(toolSigns);
+  }
+  isGravityCompensated = toCompensate;
+  return true;
+}
+
+bool NetftUtilsLean::setJointStateSource(const std::string &topic, const std::vector<double> &mdh, const std::vector<double> &sensorRpy)
+{
+  return monitor.startJointState(topic, mdh, sensorRpy);
+}
+
 bool NetftUtilsLean::setFilter(bool toFilter, double deltaT, double cutoffFreq)
 {
   if(toFilter)
@@ -494,6 +574,7 @@ bool NetftUtilsLean::setMax(double fMaxU, double tMaxU, double fMaxB, double tMa
     torqueMaxU = tMaxU;
     forceMaxB = fMaxB;
     torqueMaxB = tMaxB;
+    updateLimits();
     return true;
   }
   else
@@ -515,59 +596,26 @@ bool NetftUtilsLean::setThreshold(double fThresh, double tThresh)
   return true;
 }
 
-void NetftUtilsLean::checkMaxForce()
+void NetftUtilsLean::updateLimits()
 {
-  double fMag = pow((pow(tf_data_tool.wrench.force.x, 2.0) + pow(tf_data_tool.wrench.force.y, 2.0) + pow(tf_data_tool.wrench.force.z, 2.0)), 0.5);
-  double tMag = pow((pow(tf_data_tool.wrench.torque.x, 2.0) + pow(tf_data_tool.wrench.torque.y, 2.0) + pow(tf_data_tool.wrench.torque.z, 2.0)), 0.5);
-  double fMax;
-  double tMax;
-  if(isBiased && !isNewBias)
-  {
-    if(forceMaxB > 0.001 && torqueMaxB > 0.001)
-    {
-      fMax = forceMaxB;
-      tMax = torqueMaxB;
-    }
-    else
-    {
-      fMax = forceMaxU;
-      tMax = torqueMaxU;
-    }
-  }
+  if(isBiased && forceMaxB > 0.001 && torqueMaxB > 0.001)
+    safety.setMagnitudeLimits(forceMaxB, torqueMaxB);
   else
-  {
-    if(isBiased && isNewBias)
-    {
-      isNewBias = false;
-    }
-    fMax = forceMaxU;
-    tMax = torqueMaxU;
-  }
+    safety.setMagnitudeLimits(forceMaxU, torqueMaxU);
+}
 
-  // If max FT exceeded, send cancel unless we have just sent it MAX_CANCEL times
-  //ROS_INFO("FMAG: %f TMAG: %f", fMag, tMag);
-  if((fabs(fMag) > fMax || fabs(tMag) > tMax) && cancel_count > 0)
-  {
-    cancel_msg.toCancel = true;
-    //ROS_INFO("Force torque violation. Canceling move.");
-    ROS_INFO("FMAG: %f FMAX: %f TMAG:%f TMAX: %f count: %d wait: %d", fMag, fMax, tMag, tMax, cancel_count, cancel_wait);
-    cancel_count-=1;
-  }
-  // If we have sent cancel MAX_CANCEL times, don't send cancel again for MAX_WAIT cycles
-  else if(cancel_count == 0 && cancel_wait > 0 && cancel_wait <= MAX_WAIT)
-  {
-    cancel_msg.toCancel = false;
-    cancel_wait-=1;
-  }
-  // If we have just finished waiting MAX_WAIT times, or the max force is no longer exceeded, reset cancel_count and cancel_wait
-  else if(cancel_wait == 0 || !(fabs(fMag) > fMax || fabs(tMag) > tMax))
-  {
-    cancel_msg.toCancel = false;
-    cancel_count = MAX_CANCEL;
-    cancel_wait = MAX_WAIT;
-  }
+void NetftUtilsLean::setSafetyLimits(const double axisLimits[6], double releaseRatio, int tripSamples, int releaseSamples)
+{
+  safety.setAxisLimits(axisLimits);
+  safety.setHysteresis(releaseRatio, tripSamples, releaseSamples);
 }
 
+void NetftUtilsLean::setMotionAbortTopic(const std::string &topic)
+{
+  motion_abort_pub = n->advertise<robot_msgs::MotionAbort>(topic, 1);
+}
+
+
 void NetftUtilsLean::setFTAddress(std::string ftAd)
 {
   ftAddress = ftAd;
@@ -0,0 +1,241 @@
+#include "pose_buffer.h"
+
+#include <cmath>
+
+PoseBuffer::PoseBuffer() :
+  pushed(0),
+  maxExtrapolation(0.05)
+{
+  for(int k = 0; k < CAPACITY; k++)
+  {
+    entries[k].seq.store(0, std::memory_order_relaxed);
+    for(int i = 0; i < 8; i++)
+      entries[k].data[i].store(0.0, std::memory_order_relaxed);
+  }
+  newest.stamp = 0.0;
+  for(int i = 0; i < 3; i++)
+    newest.position[i] = 0.0;
+  newest.orientation[0] = 1.0;
+  for(int i = 1; i < 4; i++)
+    newest.orientation[i] = 0.0;
+}
+
+void PoseBuffer::push(double stamp, const double position[3], const double rotation[9])
+{
+  uint64_t n = pushed.load(std::memory_order_relaxed);
+  if(n > 0 && stamp <= newest.stamp)
+    return;
+
+  PoseSample sample;
+  sample.stamp = stamp;
+  for(int i = 0; i < 3; i++)
+    sample.position[i] = position[i];
+  rotationToQuaternion(rotation, sample.orientation);
+  // Stay in the hemisphere of the previous pose so consecutive quaternions are close
+  double dot = 0.0;
+  for(int i = 0; i < 4; i++)
+    dot += sample.orientation[i] * newest.orientation[i];
+  if(dot < 0.0)
+    for(int i = 0; i < 4; i++)
+      sample.orientation[i] = -sample.orientation[i];
+
+  write(entries[n % CAPACITY], sample);
+  newest = sample;
+  pushed.store(n + 1, std::memory_order_release);
+}
+
+PoseBuffer::Status PoseBuffer::lookup(double stamp, double position[3], double rotation[9]) const
+{
+  while(true)
+  {
+    uint64_t n = pushed.load(std::memory_order_acquire);
+    if(n == 0)
+      return EMPTY;
+
+    PoseSample later, earlier;
+    read(entries[(n - 1) % CAPACITY], later);
+
+    if(stamp >= later.stamp)
+    {
+      if(stamp - later.stamp > maxExtrapolation || n == 1)
+      {
+        interpolate(later, later, later.stamp, position, rotation);
+        return stamp - later.stamp > maxExtrapolation ? TOO_NEW : EXTRAPOLATED;
+      }
+      read(entries[(n - 2) % CAPACITY], earlier);
+      if(earlier.stamp >= later.stamp)
+        continue; // overtaken by the writer
+      interpolate(earlier, later, stamp, position, rotation);
+      return EXTRAPOLATED;
+    }
+
+    // Newest first, wrench samples are rarely more than a few poses old. The slot the writer fills
+    // next is left out; an entry overwritten during the scan shows up as a stamp out of order.
+    uint64_t oldest = n >= CAPACITY ? n - CAPACITY + 1 : 0;
+    bool overtaken = false;
+    for(uint64_t k = n - 1; k-- > oldest;)
+    {
+      read(entries[k % CAPACITY], earlier);
+      if(earlier.stamp >= later.stamp)
+      {
+        overtaken = true;
+        break;
+      }
+      if(stamp >= earlier.stamp)
+      {
+        interpolate(earlier, later, stamp, position, rotation);
+        return INTERPOLATED;
+      }
+      later = earlier;
+    }
+    if(overtaken)
+      continue;
+
+    interpolate(later, later, later.stamp, position, rotation);
+    return TOO_OLD;
+  }
+}
+
+bool PoseBuffer::latest(PoseSample &sample) const
+{
+  uint64_t n = pushed.load(std::memory_order_acquire);
+  if(n == 0)
+    return false;
+  read(entries[(n - 1) % CAPACITY], sample);
+  return true;
+}
+
+void PoseBuffer::write(Entry &entry, const PoseSample &sample)
+{
+  uint64_t s = entry.seq.load(std::memory_order_relaxed);
+  entry.seq.store(s + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  entry.data[0].store(sample.stamp, std::memory_order_relaxed);
+  for(int i = 0; i < 3; i++)
+    entry.data[1+i].store(sample.position[i], std::memory_order_relaxed);
+  for(int i = 0; i < 4; i++)
+    entry.data[4+i].store(sample.orientation[i], std::memory_order_relaxed);
+  entry.seq.store(s + 2, std::memory_order_release);
+}
+
+void PoseBuffer::read(const Entry &entry, PoseSample &sample) const
+{
+  while(true)
+  {
+    uint64_t before = entry.seq.load(std::memory_order_acquire);
+    if(before & 1)
+      continue;
+    sample.stamp = entry.data[0].load(std::memory_order_relaxed);
+    for(int i = 0; i < 3; i++)
+      sample.position[i] = entry.data[1+i].load(std::memory_order_relaxed);
+    for(int i = 0; i < 4; i++)
+      sample.orientation[i] = entry.data[4+i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(entry.seq.load(std::memory_order_relaxed) == before)
+      return;
+  }
+}
+
+void PoseBuffer::interpolate(const PoseSample &p0, const PoseSample &p1, double stamp, double position[3], double rotation[9])
+{
+  double t = p1.stamp > p0.stamp ? (stamp - p0.stamp) / (p1.stamp - p0.stamp) : 0.0;
+  if(position)
+    for(int i = 0; i < 3; i++)
+      position[i] = p0.position[i] + t * (p1.position[i] - p0.position[i]);
+  if(rotation)
+  {
+    double q[4];
+    slerp(p0.orientation, p1.orientation, t, q);
+    quaternionToRotation(q, rotation);
+  }
+}
+
+void PoseBuffer::slerp(const double q0[4], const double q1[4], double t, double q[4])
+{
+  double dot = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+  double sign = dot < 0.0 ? -1.0 : 1.0;
+
+  // Arc angle from |q1 - q0| and |q1 + q0|, accurate also for the small steps between 100 Hz poses
+  // where acos(dot) loses half of the digits
+  double difference = 0.0, sum = 0.0;
+  for(int i = 0; i < 4; i++)
+  {
+    difference += (sign * q1[i] - q0[i]) * (sign * q1[i] - q0[i]);
+    sum += (sign * q1[i] + q0[i]) * (sign * q1[i] + q0[i]);
+  }
+  double angle = 2.0 * std::atan2(std::sqrt(difference), std::sqrt(sum));
+
+  double w0, w1;
+  if(angle < 1e-9)
+  {
+    w0 = 1.0 - t;
+    w1 = t;
+  }
+  else
+  {
+    double s = std::sin(angle);
+    w0 = std::sin((1.0 - t) * angle) / s;
+    w1 = std::sin(t * angle) / s;
+  }
+
+  double norm = 0.0;
+  for(int i = 0; i < 4; i++)
+  {
+    q[i] = w0 * q0[i] + sign * w1 * q1[i];
+    norm += q[i] * q[i];
+  }
+  norm = std::sqrt(norm);
+  for(int i = 0; i < 4; i++)
+    q[i] /= norm;
+}
+
+void PoseBuffer::rotationToQuaternion(const double R[9], double q[4])
+{
+  double trace = R[0] + R[4] + R[8];
+  if(trace > 0.0)
+  {
+    double s = 2.0 * std::sqrt(trace + 1.0);
+    q[0] = 0.25 * s;
+    q[1] = (R[7] - R[5]) / s;
+    q[2] = (R[2] - R[6]) / s;
+    q[3] = (R[3] - R[1]) / s;
+  }
+  else if(R[0] > R[4] && R[0] > R[8])
+  {
+    double s = 2.0 * std::sqrt(1.0 + R[0] - R[4] - R[8]);
+    q[0] = (R[7] - R[5]) / s;
+    q[1] = 0.25 * s;
+    q[2] = (R[1] + R[3]) / s;
+    q[3] = (R[2] + R[6]) / s;
+  }
+  else if(R[4] > R[8])
+  {
+    double s = 2.0 * std::sqrt(1.0 + R[4] - R[0] - R[8]);
+    q[0] = (R[2] - R[6]) / s;
+    q[1] = (R[1] + R[3]) / s;
+    q[2] = 0.25 * s;
+    q[3] = (R[5] + R[7]) / s;
+  }
+  else
+  {
+    double s = 2.0 * std::sqrt(1.0 + R[8] - R[0] - R[4]);
+    q[0] = (R[3] - R[1]) / s;
+    q[1] = (R[2] + R[6]) / s;
+    q[2] = (R[5] + R[7]) / s;
+    q[3] = 0.25 * s;
+  }
+}
+
+void PoseBuffer::quaternionToRotation(const double q[4], double R[9])
+{
+  double w = q[0], x = q[1], y = q[2], z = q[3];
+  R[0] = 1.0 - 2.0 * (y*y + z*z);
+  R[1] = 2.0 * (x*y - w*z);
+  R[2] = 2.0 * (x*z + w*y);
+  R[3] = 2.0 * (x*y + w*z);
+  R[4] = 1.0 - 2.0 * (x*x + z*z);
+  R[5] = 2.0 * (y*z - w*x);
+  R[6] = 2.0 * (x*z - w*y);
+  R[7] = 2.0 * (y*z + w*x);
+  R[8] = 1.0 - 2.0 * (x*x + y*y);
+}
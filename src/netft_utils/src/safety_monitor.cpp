@@ -0,0 +1,117 @@
+#include "safety_monitor.h"
+
+#include <cmath>
+
+SafetyMonitor::SafetyMonitor() :
+  forceLimit(0.0),
+  torqueLimit(0.0),
+  releaseRatio(0.8),
+  tripSamples(DEFAULT_TRIP_SAMPLES),
+  releaseSamples(50),
+  isTripped(false),
+  count(0),
+  tripViolations(0)
+{
+  for(int i = 0; i < 6; i++)
+    axisLimit[i] = 0.0;
+  updateThresholds();
+}
+
+void SafetyMonitor::setAxisLimits(const double limits[6])
+{
+  for(int i = 0; i < 6; i++)
+    axisLimit[i] = limits[i];
+  updateThresholds();
+}
+
+void SafetyMonitor::setMagnitudeLimits(double force, double torque)
+{
+  forceLimit = force;
+  torqueLimit = torque;
+  updateThresholds();
+}
+
+void SafetyMonitor::setHysteresis(double ratio, int trip, int release)
+{
+  releaseRatio = ratio;
+  tripSamples = trip > 0 ? trip : 1;
+  releaseSamples = release > 0 ? release : 1;
+  updateThresholds();
+}
+
+void SafetyMonitor::reset()
+{
+  isTripped = false;
+  count = 0;
+  tripViolations = 0;
+}
+
+void SafetyMonitor::updateThresholds()
+{
+  for(int i = 0; i < 6; i++)
+  {
+    tripAxis[i] = axisLimit[i] > 0.0 ? axisLimit[i] : INFINITY;
+    releaseAxis[i] = axisLimit[i] > 0.0 ? releaseRatio * axisLimit[i] : INFINITY;
+  }
+  tripForceSq = forceLimit > 0.0 ? forceLimit * forceLimit : INFINITY;
+  tripTorqueSq = torqueLimit > 0.0 ? torqueLimit * torqueLimit : INFINITY;
+  releaseForceSq = forceLimit > 0.0 ? releaseRatio * releaseRatio * forceLimit * forceLimit : INFINITY;
+  releaseTorqueSq = torqueLimit > 0.0 ? releaseRatio * releaseRatio * torqueLimit * torqueLimit : INFINITY;
+}
+
+unsigned int SafetyMonitor::check(const double wrench[6], const double axis[6], double forceSq, double torqueSq)
+{
+  // Written as !(value <= limit) so a NaN sample counts as a violation
+  unsigned int violations = 0;
+  for(int i = 0; i < 6; i++)
+    violations |= !(std::fabs(wrench[i]) <= axis[i]) << i;
+  double fSq = wrench[0] * wrench[0] + wrench[1] * wrench[1] + wrench[2] * wrench[2];
+  double tSq = wrench[3] * wrench[3] + wrench[4] * wrench[4] + wrench[5] * wrench[5];
+  violations |= !(fSq <= forceSq) ? FORCE : 0;
+  violations |= !(tSq <= torqueSq) ? TORQUE : 0;
+  return violations;
+}
+
+SafetyMonitor::Event SafetyMonitor::update(const double wrench[6])
+{
+  if(!isTripped)
+  {
+    unsigned int violations = check(wrench, tripAxis, tripForceSq, tripTorqueSq);
+    if(!violations)
+    {
+      count = 0;
+      return NONE;
+    }
+    if(++count < tripSamples)
+      return NONE;
+    isTripped = true;
+    tripViolations = violations;
+    count = 0;
+    return TRIPPED;
+  }
+
+  if(check(wrench, releaseAxis, releaseForceSq, releaseTorqueSq))
+  {
+    count = 0;
+    return NONE;
+  }
+  if(++count < releaseSamples)
+    return NONE;
+  isTripped = false;
+  count = 0;
+  return RELEASED;
+}
+
+std::string SafetyMonitor::describe(unsigned int violations)
+{
+  static const char* names[8] = {"fx", "fy", "fz", "tx", "ty", "tz", "force magnitude", "torque magnitude"};
+  std::string text;
+  for(int i = 0; i < 8; i++)
+    if(violations & (1u << i))
+    {
+      if(!text.empty())
+        text += ", ";
+      text += names[i];
+    }
+  return text;
+}
@@ -0,0 +1,199 @@
+#include "transform_monitor.h"
+
+#include <cmath>
+#include "tf/transform_listener.h"
+
+TransformMonitor::TransformMonitor(ros::NodeHandle &nh) :
+  n(nh),
+  source("none"),
+  running(false),
+  failures(0),
+  warnAge(0.1),
+  errorAge(1.0)
+{
+  for(int i = 0; i < 24; i++)
+    mdhTable[i] = 0.0;
+  for(int i = 0; i < 9; i++)
+    sensorRotation[i] = (i % 4 == 0) ? 1.0 : 0.0;
+}
+
+TransformMonitor::~TransformMonitor()
+{
+  stop();
+}
+
+void TransformMonitor::setFrames(const std::string &world, const std::string &ft)
+{
+  world_frame = world;
+  ft_frame = ft;
+}
+
+void TransformMonitor::startTf(double rate)
+{
+  stop();
+  source = "tf " + world_frame + " <- " + ft_frame;
+  running = true;
+  tfThread = std::thread(&TransformMonitor::tfLoop, this, rate);
+}
+
+void TransformMonitor::stop()
+{
+  running = false;
+  if(tfThread.joinable())
+    tfThread.join();
+  joint_state_sub.shutdown();
+}
+
+void TransformMonitor::tfLoop(double rate)
+{
+  tf::TransformListener listener(ros::Duration(300));
+  ros::Rate r(rate);
+  while(running && ros::ok())
+  {
+    try
+    {
+      // Only this thread waits for tf; the wrench path keeps using the previous rotation meanwhile
+      if(listener.waitForTransform(world_frame, ft_frame, ros::Time(0), ros::Duration(0.1)))
+      {
+        tf::StampedTransform transform;
+        listener.lookupTransform(world_frame, ft_frame, ros::Time(0), transform);
+        double rotation[9];
+        double position[3] = {transform.getOrigin().x(), transform.getOrigin().y(), transform.getOrigin().z()};
+        for(int i = 0; i < 3; i++)
+        {
+          rotation[3*i] = transform.getBasis()[i].x();
+          rotation[3*i+1] = transform.getBasis()[i].y();
+          rotation[3*i+2] = transform.getBasis()[i].z();
+        }
+        // Static transforms carry no time stamp, they are valid now.
+        // The same transform looked up again is dropped by the buffer as not newer.
+        ros::Time stamp = transform.stamp_.isZero() ? ros::Time::now() : transform.stamp_;
+        poseBuffer.push(stamp.toSec(), position, rotation);
+        failures = 0;
+      }
+      else
+      {
+        failures++;
+      }
+    }
+    catch(tf::TransformException &ex)
+    {
+      failures++;
+      ROS_WARN_THROTTLE(5.0, "%s", ex.what());
+    }
+    r.sleep();
+  }
+}
+
+bool TransformMonitor::startJointState(const std::string &topic, const std::vector<double> &mdh, const std::vector<double> &sensorRpy)
+{
+  if(mdh.size() != 24 || sensorRpy.size() != 3)
+  {
+    ROS_ERROR_STREAM("Joint state rotation source needs 24 MDH values and 3 sensor rpy values");
+    return false;
+  }
+  stop();
+
+  for(int i = 0; i < 6; i++)
+  {
+    mdhTable[4*i] = mdh[4*i] / 1000.0;
+    mdhTable[4*i+1] = mdh[4*i+1] / 1000.0;
+    mdhTable[4*i+2] = mdh[4*i+2] / 180.0 * M_PI;
+    mdhTable[4*i+3] = mdh[4*i+3] / 180.0 * M_PI;
+  }
+
+  double cr = cos(sensorRpy[0]), sr = sin(sensorRpy[0]);
+  double cp = cos(sensorRpy[1]), sp = sin(sensorRpy[1]);
+  double cy = cos(sensorRpy[2]), sy = sin(sensorRpy[2]);
+  double rpy[9] = {cy*cp, cy*sp*sr - sy*cr, cy*sp*cr + sy*sr,
+                   sy*cp, sy*sp*sr + cy*cr, sy*sp*cr - cy*sr,
+                   -sp,   cp*sr,            cp*cr};
+  for(int i = 0; i < 9; i++)
+    sensorRotation[i] = rpy[i];
+
+  source = "joint states " + topic;
+  joint_state_sub = n.subscribe(topic, 10, &TransformMonitor::jointStateCallback, this);
+  return true;
+}
+
+void TransformMonitor::forwardKinematics(const double mdh[24], const double q[6], double rotation[9], double position[3])
+{
+  double R[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+  double p[3] = {0, 0, 0};
+  for(int j = 0; j < 6; j++)
+  {
+    // Modified DH link Rx(alpha) * Tx(a) * Rz(theta + q) * Tz(d)
+    double ct = cos(mdh[4*j+2] + q[j]), st = sin(mdh[4*j+2] + q[j]);
+    double ca = cos(mdh[4*j+3]), sa = sin(mdh[4*j+3]);
+    double offset[3] = {mdh[4*j], -sa * mdh[4*j+1], ca * mdh[4*j+1]};
+    for(int r = 0; r < 3; r++)
+      p[r] += R[3*r] * offset[0] + R[3*r+1] * offset[1] + R[3*r+2] * offset[2];
+    double link[9] = {ct,      -st,      0.0,
+                      st * ca, ct * ca,  -sa,
+                      st * sa, ct * sa,  ca};
+    double product[9];
+    for(int r = 0; r < 3; r++)
+      for(int c = 0; c < 3; c++)
+        product[3*r+c] = R[3*r] * link[c] + R[3*r+1] * link[3+c] + R[3*r+2] * link[6+c];
+    for(int i = 0; i < 9; i++)
+      R[i] = product[i];
+  }
+  for(int i = 0; i < 9; i++)
+    rotation[i] = R[i];
+  for(int i = 0; i < 3; i++)
+    position[i] = p[i];
+}
+
+void TransformMonitor::jointStateCallback(const sensor_msgs::JointState::ConstPtr &msg)
+{
+  if(msg->position.size() < 6)
+    return;
+
+  double flange[9];
+  double position[3];
+  forwardKinematics(mdhTable, &msg->position[0], flange, position);
+
+  double rotation[9];
+  for(int r = 0; r < 3; r++)
+    for(int c = 0; c < 3; c++)
+      rotation[3*r+c] = flange[3*r] * sensorRotation[c] + flange[3*r+1] * sensorRotation[3+c] + flange[3*r+2] * sensorRotation[6+c];
+
+  ros::Time stamp = msg->header.stamp.isZero() ? ros::Time::now() : msg->header.stamp;
+  poseBuffer.push(stamp.toSec(), position, rotation);
+}
+
+double TransformMonitor::age() const
+{
+  PoseSample pose;
+  if(!poseBuffer.latest(pose))
+    return INFINITY;
+  return ros::Time::now().toSec() - pose.stamp;
+}
+
+void TransformMonitor::setStaleness(double warn, double error)
+{
+  warnAge = warn;
+  errorAge = error;
+}
+
+void TransformMonitor::diagnostics(diagnostic_updater::DiagnosticStatusWrapper &d)
+{
+  d.name = "NetFT utils : " + ft_frame + " rotation";
+  d.hardware_id = "none";
+
+  double rotationAge = age();
+  d.clear();
+  if(std::isinf(rotationAge))
+    d.summary(d.ERROR, "No rotation received");
+  else if(rotationAge > errorAge)
+    d.summaryf(d.ERROR, "Rotation is %.2f s old", rotationAge);
+  else if(rotationAge > warnAge)
+    d.summaryf(d.WARN, "Rotation is %.2f s old", rotationAge);
+  else
+    d.summary(d.OK, "OK");
+
+  d.addf("Source", "%s", source.c_str());
+  d.addf("Age (s)", "%.3f", rotationAge);
+  d.addf("Updates", "%lu", (unsigned long)poseBuffer.count());
+  d.addf("TF failures since last update", "%u", (unsigned int)failures);
+}
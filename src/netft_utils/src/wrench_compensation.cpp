@@ -0,0 +1,107 @@
+#include "wrench_compensation.h"
+
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include "ros/ros.h"
+
+WrenchCompensation::WrenchCompensation()
+{
+  clear();
+  for(int i = 0; i < 6; i++)
+    toolSigns[i] = 1.0;
+}
+
+void WrenchCompensation::setCalibration(double gravity, const double centroid[3], const double zeroDrift[6])
+{
+  payloadGravity = gravity;
+  for(int i = 0; i < 3; i++)
+    payloadCentroid[i] = centroid[i];
+  for(int i = 0; i < 6; i++)
+    sensorZeroDrift[i] = zeroDrift[i];
+  calibrated = true;
+}
+
+void WrenchCompensation::setToolSigns(const double signs[6])
+{
+  for(int i = 0; i < 6; i++)
+    toolSigns[i] = signs[i];
+}
+
+void WrenchCompensation::clear()
+{
+  calibrated = false;
+  payloadGravity = 0.0;
+  for(int i = 0; i < 3; i++)
+    payloadCentroid[i] = 0.0;
+  for(int i = 0; i < 6; i++)
+    sensorZeroDrift[i] = 0.0;
+}
+
+bool WrenchCompensation::loadCalibration(const ros::NodeHandle& n, const std::string& ns)
+{
+  double gravity;
+  std::vector<double> centroid;
+  std::vector<double> zeroDrift;
+
+  if(!n.getParam(ns + "/gravity", gravity) || !n.getParam(ns + "/centroid", centroid) || !n.getParam(ns + "/zero_drift", zeroDrift))
+    return false;
+
+  if(centroid.size() != 3 || zeroDrift.size() != 6)
+  {
+    ROS_ERROR_STREAM("Payload calibration " << ns << " needs 3 centroid and 6 zero_drift values");
+    return false;
+  }
+
+  setCalibration(gravity, centroid.data(), zeroDrift.data());
+  return true;
+}
+
+bool WrenchCompensation::saveCalibration(const std::string& file) const
+{
+  std::ofstream out(file.c_str());
+  if(!out)
+    return false;
+
+  out << std::setprecision(10);
+  out << "# payload and sensor offset calibration, see wrench_compensation.h" << std::endl;
+  out << "# gravity: world Z component of the payload weight (N)" << std::endl;
+  out << "gravity: " << payloadGravity << std::endl;
+  out << "# centroid: payload center of mass in the sensor frame (m)" << std::endl;
+  out << "centroid: [" << payloadCentroid[0] << ", " << payloadCentroid[1] << ", " << payloadCentroid[2] << "]" << std::endl;
+  out << "# zero_drift: sensor offset, force (N) then torque (Nm)" << std::endl;
+  out << "zero_drift: [";
+  for(int i = 0; i < 6; i++)
+    out << (i == 0 ? "" : ", ") << sensorZeroDrift[i];
+  out << "]" << std::endl;
+
+  return out.good();
+}
+
+void WrenchCompensation::predict(const double rotation[9], double wrench[6]) const
+{
+  // Gravity force in the tool frame, R^T * (0, 0, gravity), then in the sensor axes of the calibration
+  double fx = toolSigns[0] * payloadGravity * rotation[6];
+  double fy = toolSigns[1] * payloadGravity * rotation[7];
+  double fz = toolSigns[2] * payloadGravity * rotation[8];
+  const double* c = payloadCentroid;
+
+  wrench[0] = fx + sensorZeroDrift[0];
+  wrench[1] = fy + sensorZeroDrift[1];
+  wrench[2] = fz + sensorZeroDrift[2];
+  wrench[3] = c[1] * fz - c[2] * fy + sensorZeroDrift[3];
+  wrench[4] = c[2] * fx - c[0] * fz + sensorZeroDrift[4];
+  wrench[5] = c[0] * fy - c[1] * fx + sensorZeroDrift[5];
+
+  // Back to the tool frame
+  for(int i = 0; i < 6; i++)
+    wrench[i] *= toolSigns[i];
+}
+
+void WrenchCompensation::compensate(const double rotation[9], const double in[6], double out[6]) const
+{
+  double expected[6];
+  predict(rotation, expected);
+  for(int i = 0; i < 6; i++)
+    out[i] = in[i] - expected[i];
+}
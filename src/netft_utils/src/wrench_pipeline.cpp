@@ -0,0 +1,80 @@
+#include "wrench_pipeline.h"
+
+WrenchPipeline::WrenchPipeline() :
+  offsetMode(RAW)
+{
+  for(int i = 0; i < 9; i++)
+  {
+    toWorld[i] = (i % 4 == 0) ? 1.0 : 0.0;
+    toTool[i] = toWorld[i];
+  }
+  for(int i = 0; i < 6; i++)
+  {
+    bias[i] = 0.0;
+    toolOffset[i] = 0.0;
+    threshold[i] = 0.0;
+  }
+}
+
+void WrenchPipeline::setRotation(const double rotation[9])
+{
+  for(int r = 0; r < 3; r++)
+    for(int c = 0; c < 3; c++)
+    {
+      toWorld[3*r+c] = rotation[3*r+c];
+      toTool[3*c+r] = rotation[3*r+c];
+    }
+  updateOffset();
+}
+
+void WrenchPipeline::setBias(const double newBias[6])
+{
+  for(int i = 0; i < 6; i++)
+    bias[i] = newBias[i];
+  offsetMode = BIASED;
+  updateOffset();
+}
+
+void WrenchPipeline::setCompensation(const WrenchCompensation& newCompensation)
+{
+  compensation = newCompensation;
+  offsetMode = GRAVITY_COMPENSATED;
+  updateOffset();
+}
+
+void WrenchPipeline::clearOffset()
+{
+  offsetMode = RAW;
+  updateOffset();
+}
+
+void WrenchPipeline::setThreshold(const double newThreshold[6])
+{
+  for(int i = 0; i < 6; i++)
+    threshold[i] = newThreshold[i];
+}
+
+void WrenchPipeline::updateOffset()
+{
+  if(offsetMode == GRAVITY_COMPENSATED)
+  {
+    compensation.predict(toWorld, toolOffset);
+  }
+  else
+  {
+    for(int i = 0; i < 6; i++)
+      toolOffset[i] = (offsetMode == BIASED) ? bias[i] : 0.0;
+  }
+}
+
+void WrenchPipeline::processBlock(const double* raw, int count, double* rawWorld, double* tool, double* world) const
+{
+  for(int k = 0; k < count; k++)
+    process(raw + 6*k, rawWorld + 6*k, tool + 6*k, world + 6*k);
+}
+
+void WrenchPipeline::worldToTool(const double world[6], double tool[6]) const
+{
+  rotate(toTool, world, tool);
+  rotate(toTool, world + 3, tool + 3);
+}
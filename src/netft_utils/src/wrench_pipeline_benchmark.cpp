@@ -0,0 +1,228 @@
+// Per-sample cost of the NetftUtils force/torque pipeline.
+// Compares the previous callback body (std::vector copy, WrenchStamped passed by value to transformFrame,
+// world frame bias and 12 scalar thresholds per sample) with WrenchPipeline::process and processBlock,
+// and checks that all of them produce the same output.
+// The sample buffer is small enough to stay in cache and is processed repeat times.
+// Usage: wrench_pipeline_benchmark [samples] [repeat]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "tf/transform_datatypes.h"
+#include "geometry_msgs/WrenchStamped.h"
+#include "wrench_pipeline.h"
+
+namespace
+{
+
+const std::string WORLD_FRAME = "base_link";
+const std::string FT_FRAME = "ft_frame";
+
+double seconds(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The callback as it was before WrenchPipeline, bias mode
+struct LegacyPipeline
+{
+  tf::Transform ft_to_world;
+  geometry_msgs::WrenchStamped bias;
+  geometry_msgs::WrenchStamped threshold;
+  geometry_msgs::WrenchStamped raw_data_tool;
+  geometry_msgs::WrenchStamped raw_data_world;
+  geometry_msgs::WrenchStamped tf_data_world;
+
+  void copyWrench(geometry_msgs::WrenchStamped &in, geometry_msgs::WrenchStamped &out, geometry_msgs::WrenchStamped &diff)
+  {
+    out.header.stamp = in.header.stamp;
+    out.header.frame_id = in.header.frame_id;
+    out.wrench.force.x = in.wrench.force.x - diff.wrench.force.x;
+    out.wrench.force.y = in.wrench.force.y - diff.wrench.force.y;
+    out.wrench.force.z = in.wrench.force.z - diff.wrench.force.z;
+    out.wrench.torque.x = in.wrench.torque.x - diff.wrench.torque.x;
+    out.wrench.torque.y = in.wrench.torque.y - diff.wrench.torque.y;
+    out.wrench.torque.z = in.wrench.torque.z - diff.wrench.torque.z;
+  }
+
+  void applyThreshold(double &value, double thresh)
+  {
+    if(value <= thresh && value >= -thresh)
+    {
+      value = 0.0;
+    }
+  }
+
+  void transformFrame(geometry_msgs::WrenchStamped in_data, geometry_msgs::WrenchStamped &out_data, char target_frame)
+  {
+    tf::Vector3 tempF(in_data.wrench.force.x, in_data.wrench.force.y, in_data.wrench.force.z);
+    tf::Vector3 tempT(in_data.wrench.torque.x, in_data.wrench.torque.y, in_data.wrench.torque.z);
+    if(target_frame == 'w')
+    {
+      out_data.header.frame_id = WORLD_FRAME;
+      tempF = ft_to_world * tempF;
+      tempT = ft_to_world * tempT;
+    }
+    else if(target_frame == 't')
+    {
+      out_data.header.frame_id = FT_FRAME;
+      tempF = ft_to_world.inverse() * tempF;
+      tempT = ft_to_world.inverse() * tempT;
+    }
+    out_data.header.stamp = in_data.header.stamp;
+    out_data.wrench.force.x = tempF.getX();
+    out_data.wrench.force.y = tempF.getY();
+    out_data.wrench.force.z = tempF.getZ();
+    out_data.wrench.torque.x = tempT.getX();
+    out_data.wrench.torque.y = tempT.getY();
+    out_data.wrench.torque.z = tempT.getZ();
+  }
+
+  void callback(const geometry_msgs::WrenchStamped& data)
+  {
+    std::vector<double> tempData;
+    tempData.resize(6);
+    tempData.at(0) = data.wrench.force.x;
+    tempData.at(1) = data.wrench.force.y;
+    tempData.at(2) = data.wrench.force.z;
+    tempData.at(3) = data.wrench.torque.x;
+    tempData.at(4) = data.wrench.torque.y;
+    tempData.at(5) = data.wrench.torque.z;
+
+    raw_data_tool.header.stamp = data.header.stamp;
+    raw_data_tool.header.frame_id = FT_FRAME;
+    raw_data_tool.wrench.force.x = tempData.at(0);
+    raw_data_tool.wrench.force.y = tempData.at(1);
+    raw_data_tool.wrench.force.z = tempData.at(2);
+    raw_data_tool.wrench.torque.x = tempData.at(3);
+    raw_data_tool.wrench.torque.y = tempData.at(4);
+    raw_data_tool.wrench.torque.z = tempData.at(5);
+
+    transformFrame(raw_data_tool, raw_data_world, 'w');
+
+    geometry_msgs::WrenchStamped world_bias;
+    transformFrame(bias, world_bias, 'w');
+    copyWrench(raw_data_world, tf_data_world, world_bias);
+
+    applyThreshold(tf_data_world.wrench.force.x, threshold.wrench.force.x);
+    applyThreshold(tf_data_world.wrench.force.y, threshold.wrench.force.y);
+    applyThreshold(tf_data_world.wrench.force.z, threshold.wrench.force.z);
+    applyThreshold(tf_data_world.wrench.torque.x, threshold.wrench.torque.x);
+    applyThreshold(tf_data_world.wrench.torque.y, threshold.wrench.torque.y);
+    applyThreshold(tf_data_world.wrench.torque.z, threshold.wrench.torque.z);
+  }
+};
+
+double uniform(double range)
+{
+  return range * (2.0 * rand() / RAND_MAX - 1.0);
+}
+
+}
+
+int main(int argc, char **argv)
+{
+  int samples = argc > 1 ? atoi(argv[1]) : 4096;
+  int repeat = argc > 2 ? atoi(argv[2]) : 200;
+  const int block = 64;
+  samples = (samples + block - 1) / block * block;
+
+  srand(1);
+  tf::Matrix3x3 basis;
+  basis.setRPY(0.3, -2.8, 1.1);
+
+  double rotation[9];
+  for(int r = 0; r < 3; r++)
+  {
+    rotation[3*r] = basis[r].x();
+    rotation[3*r+1] = basis[r].y();
+    rotation[3*r+2] = basis[r].z();
+  }
+  double bias[6] = {-5.49, -2.99, -0.21, -0.393, 0.172, -0.157};
+  double threshold[6] = {0.05, 0.05, 0.05, 0.002, 0.002, 0.002};
+
+  LegacyPipeline legacy;
+  legacy.ft_to_world = tf::Transform(basis, tf::Vector3(0.0, 0.0, 0.0));
+  legacy.bias.wrench.force.x = bias[0];
+  legacy.bias.wrench.force.y = bias[1];
+  legacy.bias.wrench.force.z = bias[2];
+  legacy.bias.wrench.torque.x = bias[3];
+  legacy.bias.wrench.torque.y = bias[4];
+  legacy.bias.wrench.torque.z = bias[5];
+  legacy.threshold.wrench.force.x = legacy.threshold.wrench.force.y = legacy.threshold.wrench.force.z = threshold[0];
+  legacy.threshold.wrench.torque.x = legacy.threshold.wrench.torque.y = legacy.threshold.wrench.torque.z = threshold[3];
+
+  WrenchPipeline pipeline;
+  pipeline.setRotation(rotation);
+  pipeline.setBias(bias);
+  pipeline.setThreshold(threshold);
+
+  std::vector<double> raw(6 * samples);
+  for(int i = 0; i < 6 * samples; i++)
+    raw[i] = bias[i % 6] + uniform(i % 6 < 3 ? 20.0 : 1.0);
+  std::vector<double> rawWorld(6 * samples), tool(6 * samples), world(6 * samples);
+
+  std::vector<geometry_msgs::WrenchStamped> messages(samples);
+  for(int k = 0; k < samples; k++)
+  {
+    messages[k].header.frame_id = FT_FRAME;
+    messages[k].wrench.force.x = raw[6*k];
+    messages[k].wrench.force.y = raw[6*k+1];
+    messages[k].wrench.force.z = raw[6*k+2];
+    messages[k].wrench.torque.x = raw[6*k+3];
+    messages[k].wrench.torque.y = raw[6*k+4];
+    messages[k].wrench.torque.z = raw[6*k+5];
+  }
+
+  // Consistency with the previous callback
+  double error = 0.0;
+  for(int k = 0; k < samples; k++)
+  {
+    legacy.callback(messages[k]);
+    pipeline.process(&raw[6*k], &rawWorld[6*k], &tool[6*k], &world[6*k]);
+    const geometry_msgs::Wrench& w = legacy.tf_data_world.wrench;
+    double expected[6] = {w.force.x, w.force.y, w.force.z, w.torque.x, w.torque.y, w.torque.z};
+    for(int i = 0; i < 6; i++)
+      error = std::fmax(error, std::fabs(expected[i] - world[6*k+i]));
+  }
+
+  double check = 0.0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(int n = 0; n < repeat; n++)
+    for(int k = 0; k < samples; k++)
+    {
+      legacy.callback(messages[k]);
+      check += legacy.tf_data_world.wrench.force.z;
+    }
+  double legacyTime = seconds(start);
+
+  start = std::chrono::steady_clock::now();
+  for(int n = 0; n < repeat; n++)
+    for(int k = 0; k < samples; k++)
+    {
+      pipeline.process(&raw[6*k], &rawWorld[6*k], &tool[6*k], &world[6*k]);
+      check += world[6*k+2];
+    }
+  double processTime = seconds(start);
+
+  start = std::chrono::steady_clock::now();
+  for(int n = 0; n < repeat; n++)
+    for(int k = 0; k < samples; k += block)
+    {
+      pipeline.processBlock(&raw[6*k], block, &rawWorld[6*k], &tool[6*k], &world[6*k]);
+      check += world[6*k+2];
+    }
+  double blockTime = seconds(start);
+
+  double count = (double)samples * repeat;
+  printf("%d samples x %d, max difference to the previous callback %g\n", samples, repeat, error);
+  printf("previous callback   : %8.1f ns/sample\n", legacyTime / count * 1e9);
+  printf("process             : %8.1f ns/sample\n", processTime / count * 1e9);
+  printf("processBlock (%3d)  : %8.1f ns/sample\n", block, blockTime / count * 1e9);
+  printf("(checksum %g)\n", check);
+  printf("%s\n", error < 1e-9 ? "PASS" : "FAIL");
+
+  return error < 1e-9 ? 0 : 1;
+}